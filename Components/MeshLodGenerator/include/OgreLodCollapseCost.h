@@ -51,7 +51,10 @@ public:
     virtual void initVertexCollapseCost(LodData* data, LodData::Vertex* vertex);
     /// Called when edge cost gets invalid.
     virtual void updateVertexCollapseCost(LodData* data, LodData::Vertex* vertex);
-    /// Called by initVertexCollapseCost and updateVertexCollapseCost, when the vertex minimal cost needs to be updated.
+    /** Called by initVertexCollapseCost and updateVertexCollapseCost, when the vertex minimal cost needs to be updated.
+
+        initCollapseCosts calls this concurrently for different vertices, so it may only modify the edges of the given vertex.
+    */
     virtual void computeVertexCollapseCost(LodData* data, LodData::Vertex* vertex, Real& collapseCost, LodData::Vertex*& collapseTo);
     /// Returns the collapse cost of the given edge. 
     virtual Real computeEdgeCollapseCost(LodData* data, LodData::Vertex* src, LodData::Edge* dstEdge) = 0;
@@ -169,6 +169,11 @@ struct _OgreLodExport LodConfig {
         Ogre::Real outsideWalkAngle;
         /// If the algorithm makes errors, you can fix it, by adding the edge to the profile.
         LodProfile profile;
+        /// Reorder the generated index buffers with MeshOptimizer for vertex cache hits. Compressed Lod
+        /// levels share their index buffers, so only the triangles within a shared or an own range can
+        /// be reordered. Disable useCompression for best results.
+        /// (disabled by default)
+        bool optimiseVertexCache;
         Advanced();
     } advanced;
 };
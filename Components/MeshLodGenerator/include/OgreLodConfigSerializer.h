@@ -82,6 +82,8 @@ private:
     size_t calcLodProfileSize();
     
     LodConfig* mLodConfig;
+    /// version of the file being imported
+    String mFileVersion;
 };
 }
 #endif
\ No newline at end of file
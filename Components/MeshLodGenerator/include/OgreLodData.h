@@ -63,12 +63,12 @@ struct _OgreLodExport LodData {
     struct Triangle;
     struct VertexHash;
     struct VertexEqual;
+    class CollapseCostHeap;
 
     typedef std::vector<Vertex> VertexList;
     typedef std::vector<Line> LineList;
     typedef std::vector<Triangle> TriangleList;
     typedef std::unordered_set<Vertex*, VertexHash, VertexEqual> UniqueVertexSet;
-    typedef std::multimap<Real, Vertex*> CollapseCostHeap;
 
     typedef VectorSet<Edge, 8> VEdges;
     typedef VectorSet<Line*, 7> VLines;
@@ -110,7 +110,7 @@ struct _OgreLodExport LodData {
         
         Vertex* collapseTo;
         bool seam;
-        CollapseCostHeap::iterator costHeapPosition; /// Iterator pointing to the position in the mCollapseCostSet, which allows fast remove.
+        size_t costHeapPosition; /// Position in the mCollapseCostHeap, which allows fast update and remove.
 
         void addEdge(const Edge& edge);
         void removeEdge(const Edge& edge);
@@ -152,6 +152,128 @@ struct _OgreLodExport LodData {
         bool isMalformed();
     };
 
+    /** Indexed binary min heap of the vertices, ordered by their collapse cost.
+
+        Every vertex knows its position in the heap, so its cost can be changed or it can be
+        removed in O(log n). Vertices with the same cost are ordered by the time they were
+        (re)inserted, so the collapse order is deterministic.
+    */
+    class _OgreLodExport CollapseCostHeap {
+    public:
+        /// Position of vertices, which are not in the heap.
+        static const size_t INVALID_POSITION = ~(size_t)0;
+
+        struct Entry {
+            Real cost;
+            size_t order; /// Insertion order, breaks ties between equal costs.
+            Vertex* vertex;
+        };
+        typedef std::vector<Entry> EntryList;
+        typedef EntryList::const_iterator const_iterator;
+
+        CollapseCostHeap() : mNextOrder(0) {}
+
+        size_t size() const { return mEntries.size(); }
+        bool empty() const { return mEntries.empty(); }
+        void clear() { mEntries.clear(); mNextOrder = 0; }
+        void reserve(size_t count) { mEntries.reserve(count); }
+
+        /// Iterates the vertices in heap order, not sorted by cost.
+        const_iterator begin() const { return mEntries.begin(); }
+        const_iterator end() const { return mEntries.end(); }
+
+        /// The vertex with the smallest collapse cost.
+        const Entry& top() const { return mEntries.front(); }
+
+        bool contains(const Vertex* v) const { return v->costHeapPosition != INVALID_POSITION; }
+        Real getCost(const Vertex* v) const { return mEntries[v->costHeapPosition].cost; }
+
+        void push(Vertex* v, Real cost)
+        {
+            Entry e = { cost, mNextOrder++, v };
+            mEntries.push_back(e);
+            siftUp(mEntries.size() - 1, e);
+        }
+
+        /// Changes the cost of a vertex in the heap, it is ordered as if it got removed and pushed again.
+        void update(Vertex* v, Real cost)
+        {
+            size_t pos = v->costHeapPosition;
+            Entry e = { cost, mNextOrder++, v };
+            // The new order is the largest, so only a lower cost can move it up.
+            if (cost < mEntries[pos].cost) {
+                siftUp(pos, e);
+            } else {
+                siftDown(pos, e);
+            }
+        }
+
+        void erase(Vertex* v)
+        {
+            size_t pos = v->costHeapPosition;
+            v->costHeapPosition = INVALID_POSITION;
+            Entry last = mEntries.back();
+            mEntries.pop_back();
+            if (pos < mEntries.size()) {
+                if (less(last, mEntries[pos])) {
+                    siftUp(pos, last);
+                } else {
+                    siftDown(pos, last);
+                }
+            }
+        }
+
+    private:
+        static bool less(const Entry& a, const Entry& b)
+        {
+            return a.cost < b.cost || (a.cost == b.cost && a.order < b.order);
+        }
+
+        void place(size_t pos, const Entry& e)
+        {
+            mEntries[pos] = e;
+            e.vertex->costHeapPosition = pos;
+        }
+
+        /// Moves the hole at pos up until e can be placed there.
+        void siftUp(size_t pos, const Entry& e)
+        {
+            while (pos > 0) {
+                size_t parent = (pos - 1) / 2;
+                if (!less(e, mEntries[parent])) {
+                    break;
+                }
+                place(pos, mEntries[parent]);
+                pos = parent;
+            }
+            place(pos, e);
+        }
+
+        /// Moves the hole at pos down until e can be placed there.
+        void siftDown(size_t pos, const Entry& e)
+        {
+            size_t count = mEntries.size();
+            for (;;) {
+                size_t child = pos * 2 + 1;
+                if (child >= count) {
+                    break;
+                }
+                if (child + 1 < count && less(mEntries[child + 1], mEntries[child])) {
+                    child++;
+                }
+                if (!less(mEntries[child], e)) {
+                    break;
+                }
+                place(pos, mEntries[child]);
+                pos = child;
+            }
+            place(pos, e);
+        }
+
+        EntryList mEntries;
+        size_t mNextOrder;
+    };
+
     union IndexBufferPointer {
         unsigned short* pshort;
         unsigned int* pint;
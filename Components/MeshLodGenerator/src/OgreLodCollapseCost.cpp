@@ -33,9 +33,26 @@ namespace Ogre
     void LodCollapseCost::initCollapseCosts( LodData* data )
     {
         data->mCollapseCostHeap.clear();
-        for (auto& v : data->mVertexList) {
+        data->mCollapseCostHeap.reserve(data->mVertexList.size());
+
+        // The costs of a vertex only depend on its neighbourhood, so they are computed in parallel.
+        // The vertices are still pushed in order, which keeps the collapse order deterministic.
+        std::vector<Real> costs(data->mVertexList.size(), LodData::UNINITIALIZED_COLLAPSE_COST);
+        WorkQueue::parallelFor(data->mVertexList.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                LodData::Vertex& v = data->mVertexList[i];
+                if (!v.edges.empty()) {
+                    LodData::Vertex* collapseTo = NULL;
+                    computeVertexCollapseCost(data, &v, costs[i], collapseTo);
+                    v.collapseTo = collapseTo;
+                }
+            }
+        });
+
+        for (size_t i = 0; i < data->mVertexList.size(); ++i) {
+            LodData::Vertex& v = data->mVertexList[i];
             if (!v.edges.empty()) {
-                initVertexCollapseCost(data, &v);
+                data->mCollapseCostHeap.push(&v, costs[i]);
             } else {
 #if OGRE_DEBUG_MODE
                 LogManager::getSingleton().stream() << "In " << data->mMeshName << " never used vertex found with ID: " << data->mCollapseCostHeap.size() << ". "
@@ -119,7 +136,7 @@ namespace Ogre
         computeVertexCollapseCost(data, vertex, collapseCost, collapseTo);
 
         vertex->collapseTo = collapseTo;
-        vertex->costHeapPosition = data->mCollapseCostHeap.emplace(collapseCost, vertex);
+        data->mCollapseCostHeap.push(vertex, collapseCost);
     }
 
     void LodCollapseCost::updateVertexCollapseCost( LodData* data, LodData::Vertex* vertex )
@@ -128,16 +145,16 @@ namespace Ogre
         LodData::Vertex* collapseTo = NULL;
         computeVertexCollapseCost(data, vertex, collapseCost, collapseTo);
 
-        if (vertex->collapseTo != collapseTo || collapseCost != vertex->costHeapPosition->first) {
-            OgreAssert(vertex->costHeapPosition != data->mCollapseCostHeap.end(), "");
-            data->mCollapseCostHeap.erase(vertex->costHeapPosition);
+        LodData::CollapseCostHeap& heap = data->mCollapseCostHeap;
+        OgreAssert(heap.contains(vertex), "");
+        if (vertex->collapseTo != collapseTo || collapseCost != heap.getCost(vertex)) {
             if (collapseCost != LodData::UNINITIALIZED_COLLAPSE_COST) {
                 vertex->collapseTo = collapseTo;
-                vertex->costHeapPosition = data->mCollapseCostHeap.emplace(collapseCost, vertex);
+                heap.update(vertex, collapseCost);
             } else {
+                heap.erase(vertex);
 #if OGRE_DEBUG_MODE
                 vertex->collapseTo = NULL;
-                vertex->costHeapPosition = data->mCollapseCostHeap.end();
 #endif
             }
         }
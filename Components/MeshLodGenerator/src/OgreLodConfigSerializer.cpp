@@ -31,9 +31,12 @@ THE SOFTWARE.
 namespace Ogre
 {
 
+    /// does not store LodConfig::Advanced::optimiseVertexCache
+    static const char* LOD_CONFIG_VERSION_1_0 = "[LodConfigSerializer_v1.0]";
+
     LodConfigSerializer::LodConfigSerializer()
     {
-        mVersion = "[LodConfigSerializer_v1.0]";
+        mVersion = "[LodConfigSerializer_v1.1]";
         mLodConfig = 0;
     }
 
@@ -58,8 +61,17 @@ namespace Ogre
         // Determine endianness (must be the first thing we do!)
         determineEndianness(mStream);
 
-        // Check header
-        readFileHeader(mStream);
+        // Check header. determineEndianness validated the header id already
+        unsigned short headerID;
+        readShorts(mStream, &headerID, 1);
+        mFileVersion = readString(mStream);
+        if (mFileVersion != mVersion && mFileVersion != LOD_CONFIG_VERSION_1_0)
+        {
+            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                "Invalid file: version incompatible, file reports " + mFileVersion +
+                " Serializer is version " + mVersion,
+                "LodConfigSerializer::importLodConfig");
+        }
 
         pushInnerChunk(mStream);
         while (!mStream->eof())
@@ -143,6 +155,8 @@ namespace Ogre
         readBools(mStream, &mLodConfig->advanced.useBackgroundQueue, 1);
         readFloats(mStream, &mLodConfig->advanced.outsideWeight, 1);
         readFloats(mStream, &mLodConfig->advanced.outsideWalkAngle, 1);
+        if (mFileVersion != LOD_CONFIG_VERSION_1_0)
+            readBools(mStream, &mLodConfig->advanced.optimiseVertexCache, 1);
     }
 
     void LodConfigSerializer::readLodProfile()
@@ -290,6 +304,7 @@ namespace Ogre
         writeBools(&mLodConfig->advanced.useBackgroundQueue, 1);
         writeFloats(&mLodConfig->advanced.outsideWeight, 1);
         writeFloats(&mLodConfig->advanced.outsideWalkAngle, 1);
+        writeBools(&mLodConfig->advanced.optimiseVertexCache, 1);
     }
 
     size_t LodConfigSerializer::calcLodAdvancedInfoSize()
@@ -306,6 +321,8 @@ namespace Ogre
         size += sizeof(float);
         // mLodConfig->advanced.outsideWalkAngle
         size += sizeof(float);
+        // mLodConfig->advanced.optimiseVertexCache
+        size += sizeof(bool);
 
         return size;
     }
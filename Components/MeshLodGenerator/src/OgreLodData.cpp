@@ -32,6 +32,7 @@ namespace Ogre
 // Use float limits instead of Real limits, because LodConfigSerializer may convert them to float.
 const Real LodData::NEVER_COLLAPSE_COST = std::numeric_limits<float>::max();
 const Real LodData::UNINITIALIZED_COLLAPSE_COST = std::numeric_limits<float>::infinity();
+const size_t LodData::CollapseCostHeap::INVALID_POSITION;
 
 void LodData::Vertex::addEdge( const LodData::Edge& edge )
 {
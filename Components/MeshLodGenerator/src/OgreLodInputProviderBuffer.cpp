@@ -80,9 +80,8 @@ namespace Ogre
                     pNormalOut++;
                 }
             } else {
-#if OGRE_DEBUG_MODE
-                v->costHeapPosition = data->mCollapseCostHeap.end();
-#endif
+                // the heap uses it to tell whether the vertex is queued
+                v->costHeapPosition = LodData::CollapseCostHeap::INVALID_POSITION;
                 v->seam = false;
                 if(data->mUseVertexNormals){
                     v->normal.normalise();
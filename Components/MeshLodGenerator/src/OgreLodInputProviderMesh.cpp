@@ -99,10 +99,8 @@ namespace Ogre
                 v = *ret.first; // Point to the existing vertex.
                 v->seam = true;
             } else {
-#if OGRE_DEBUG_MODE
-                // Needed for an assert, don't remove it.
-                v->costHeapPosition = data->mCollapseCostHeap.end();
-#endif
+                // the heap uses it to tell whether the vertex is queued
+                v->costHeapPosition = LodData::CollapseCostHeap::INVALID_POSITION;
                 v->seam = false;
             }
             lookup.push_back(v);
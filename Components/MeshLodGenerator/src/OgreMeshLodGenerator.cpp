@@ -116,6 +116,8 @@ void MeshLodGenerator::_configureMeshLodUsage(const LodConfig& lodConfig)
     }
     // Remove skipped Lod levels
     lodConfig.mesh->_setLodInfo(n + 1);
+    if(lodConfig.advanced.optimiseVertexCache)
+        MeshOptimizer(MeshOptimizer::MO_VERTEX_CACHE).optimise(lodConfig.mesh.get());
     if(edgeListWasBuilt)
         lodConfig.mesh->buildEdgeList();
 }
@@ -36,7 +36,9 @@ THE SOFTWARE.
 #include "OgreMeshManager.h"
 #include "OgreMesh.h"
 #include "OgreSubMesh.h"
+#include "OgreMeshOptimizer.h"
 #include "OgreLogManager.h"
+#include "OgreWorkQueue.h"
 
 #include "OgreMeshLodGenerator.h"
 #include "OgreLodWorkQueueInjectorListener.h"
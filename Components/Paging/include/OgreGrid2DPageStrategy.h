@@ -135,6 +135,22 @@ namespace Ogre
         int32 mMaxCellX;
         int32 mMaxCellY;
 
+        /// Seconds the camera motion is extrapolated for
+        Real mLookAheadTime;
+        std::vector<Vector3> mPathHints;
+        struct CameraMotion
+        {
+            Vector2 position;
+            Vector2 velocity;
+            Real time;
+        };
+        std::map<const Camera*, CameraMotion> mCameraMotion;
+        /// Accumulated frame time
+        Real mTime;
+        /// Grid position and velocity of the last notified camera, which pages are prioritised for
+        Vector2 mFocus;
+        Vector2 mFocusVelocity;
+
         void updateDerivedMetrics();
 
     public:
@@ -190,6 +206,40 @@ namespace Ogre
         /// get the index range of all cells (values outside this will be ignored)
         virtual int32 getCellRangeMaxY() const { return mMaxCellY; }
 
+        /** Set how far ahead the camera motion is predicted.
+
+            Pages are then also requested along the path the camera will travel
+            in this time, at its current velocity, and pages ahead of the camera
+            are prioritised. 0 disables the prediction.
+        @param seconds The look-ahead time. This is not saved with the section.
+        */
+        void setLookAheadTime(Real seconds) { mLookAheadTime = seconds; }
+        Real getLookAheadTime() const { return mLookAheadTime; }
+
+        /** Add a hint, that a camera is going to pass a world position.
+
+            Pages within the load radius of hints inside the hold radius
+            of the camera are requested, e.g. along a scripted camera path.
+        */
+        void addPathHint(const Vector3& worldPos) { mPathHints.push_back(worldPos); }
+        void clearPathHints() { mPathHints.clear(); }
+        const std::vector<Vector3>& getPathHints() const { return mPathHints; }
+
+        /// Advance the clock the camera velocity is measured with
+        void _notifyFrameTime(Real timeSinceLastFrame) { mTime += timeSinceLastFrame; }
+        /** Track a camera at the given grid position
+        @return The smoothed velocity of the camera in grid space
+        */
+        const Vector2& _updateCameraMotion(const Camera* cam, const Vector2& gridPos);
+
+        /** Get how urgently a page is needed by the last notified camera.
+
+            This is the distance of the page from the camera in cells. Pages ahead
+            of the camera appear closer, by the distance it travels in the look-ahead
+            time, but by no more than half.
+        */
+        Real getPagePriority(PageID pageID);
+
         /// Load this data from a stream (returns true if successful)
         bool load(StreamSerialiser& stream) override;
         /// Save this data to a stream
@@ -226,13 +276,17 @@ namespace Ogre
     */
     class _OgrePagingExport Grid2DPageStrategy : public PageStrategy
     {
+        /// request all pages within a square of the given radius
+        void loadPagesAround(const Vector2& gridPos, Real radiusInCells, PagedWorldSection* section);
     public:
         Grid2DPageStrategy(PageManager* manager);
 
         ~Grid2DPageStrategy();
 
         // Overridden members
+        void frameStart(Real timeSinceLastFrame, PagedWorldSection* section) override;
         void notifyCamera(Camera* cam, PagedWorldSection* section) override;
+        Real getPagePriority(PageID pageID, PagedWorldSection* section) override;
         PageStrategyData* createData() override;
         void destroyData(PageStrategyData* d) override;
         void updateDebugDisplay(Page* p, SceneNode* sn) override;
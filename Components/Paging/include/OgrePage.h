@@ -125,6 +125,21 @@ namespace Ogre
         */
         virtual void unload();
 
+        /** Prepare the page data of a deferred load.
+
+            You should not call this method directly. It is called by the PageManager,
+            possibly in a background thread.
+        @return The prepared data, to be passed to _load
+        */
+        WorkQueue::Response* _prepare();
+        /** Finish a deferred load in the main thread.
+
+            You should not call this method directly.
+        @param res The prepared data returned by _prepare, which is deleted
+        @param discard Throw the prepared data away instead, because the load was cancelled
+        */
+        void _load(WorkQueue::Response* res, bool discard = false);
+
 
         /** Returns whether this page was 'held' in the last frame, that is
             was it either directly needed, or requested to stay in memory (held - as
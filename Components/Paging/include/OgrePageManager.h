@@ -432,6 +432,55 @@ namespace Ogre
         /** Get whether paging operations are currently allowed to happen. */
         bool getPagingOperationsEnabled() const { return mPagingEnabled; }
 
+        /** Set the maximum number of pages that are prepared in the background at the same time.
+
+            Deferred page loads are queued, and started in the order of the priority
+            the PageStrategy of their section reports (see PageStrategy::getPagePriority),
+            so nearby pages are not held up behind pages that were merely requested earlier.
+            Queued pages that are no longer held are not started, and are cancelled once
+            their section unloads them.
+        @par
+            Sections which schedule the loading of their pages themselves, like
+            TerrainPagedWorldSection, apply the same limit to their own preparations.
+            Each such section and the deferred page loads are limited separately.
+        @param count The number of concurrent preparations, or 0 for no limit. Default is 0.
+        */
+        void setMaxConcurrentPreparations(uint32 count) { mMaxConcurrentPreparations = count; }
+        /** Get the maximum number of pages that are prepared in the background at the same time. */
+        uint32 getMaxConcurrentPreparations() const { return mMaxConcurrentPreparations; }
+
+        /** Set the time per frame that may be spent loading prepared pages in the main thread.
+
+            At least one prepared page is loaded each frame, the remaining ones are
+            loaded in the next frames once the limit is exceeded.
+        @param ms The limit in milliseconds, or 0 for no limit. Default is 0.
+        */
+        void setPageLoadTimeLimit(unsigned long ms) { mPageLoadTimeLimitMS = ms; }
+        /** Get the time per frame that may be spent loading prepared pages in the main thread. */
+        unsigned long getPageLoadTimeLimit() const { return mPageLoadTimeLimitMS; }
+
+        /** Get the number of deferred page loads that did not finish yet. */
+        size_t getPendingPageLoadCount() const { return mPageLoadJobs.size(); }
+
+        /** Queue a deferred load of a page. 
+
+            You should not call this method directly, use Page::load.
+        */
+        void _queuePageLoad(Page* page);
+        /** Cancel the deferred load of a page that is about to be destroyed.
+
+            You should not call this method directly.
+        @return true if the page is being prepared right now. The PageManager then takes
+            ownership of the page and destroys it once the preparation finished.
+        */
+        bool _cancelPageLoad(Page* page);
+        /** Cancel all deferred page loads of a section, waiting for the preparations in progress.
+
+            You should not call this method directly.
+        @param section The section, or null for all sections
+        */
+        void _cancelPageLoads(PagedWorldSection* section);
+
 
     private:
 
@@ -454,6 +503,13 @@ namespace Ogre
         void createStandardStrategies();
         void createStandardContentFactories();
 
+        struct PageLoadJob;
+        typedef std::vector<SharedPtr<PageLoadJob> > PageLoadJobList;
+        /// Load the prepared pages, within the time limit
+        void processPageLoads();
+        /// Start preparing the queued pages with the highest priority
+        void dispatchPageLoads();
+
         WorldMap mWorlds;
         StrategyMap mStrategies;
         ContentCollectionFactoryMap mContentCollectionFactories;
@@ -467,6 +523,10 @@ namespace Ogre
         uint8 mDebugDisplayLvl;
         bool mPagingEnabled;
 
+        PageLoadJobList mPageLoadJobs;
+        uint32 mMaxConcurrentPreparations;
+        unsigned long mPageLoadTimeLimitMS;
+
         Grid2DPageStrategy* mGrid2DPageStrategy;
         Grid3DPageStrategy* mGrid3DPageStrategy;
         SimplePageContentCollectionFactory* mSimpleCollectionFactory;
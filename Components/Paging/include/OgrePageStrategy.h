@@ -130,6 +130,11 @@ namespace Ogre
         @return The page ID
         */
         virtual PageID getPageID(const Vector3& worldPos, PagedWorldSection* section) = 0;
+
+        /** Get how urgently a page is needed, so requests can be served in order.
+        @return Lower values are more urgent. By default all pages are equal.
+        */
+        virtual Real getPagePriority(PageID pageID, PagedWorldSection* section) { return 0; }
     };
 
     /*@}*/
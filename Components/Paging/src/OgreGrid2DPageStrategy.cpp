@@ -57,6 +57,10 @@ namespace Ogre
         , mMinCellY(-32768)
         , mMaxCellX(32767)
         , mMaxCellY(32767)
+        , mLookAheadTime(0)
+        , mTime(0)
+        , mFocus(Vector2::ZERO)
+        , mFocusVelocity(Vector2::ZERO)
     {
         updateDerivedMetrics();
         
@@ -235,6 +239,48 @@ namespace Ogre
 
     }
     //---------------------------------------------------------------------
+    const Vector2& Grid2DPageStrategyData::_updateCameraMotion(const Camera* cam, const Vector2& gridPos)
+    {
+        auto it = mCameraMotion.find(cam);
+        if (it == mCameraMotion.end())
+        {
+            CameraMotion motion = {gridPos, Vector2::ZERO, mTime};
+            it = mCameraMotion.emplace(cam, motion).first;
+        }
+
+        CameraMotion& motion = it->second;
+        Real dt = mTime - motion.time;
+        if (dt > 0)
+        {
+            // smooth out jitter in the frame times
+            Vector2 velocity = (gridPos - motion.position) / dt;
+            motion.velocity = (motion.velocity + velocity) * 0.5f;
+            motion.position = gridPos;
+            motion.time = mTime;
+        }
+
+        mFocus = gridPos;
+        mFocusVelocity = motion.velocity;
+        return motion.velocity;
+    }
+    //---------------------------------------------------------------------
+    Real Grid2DPageStrategyData::getPagePriority(PageID pageID)
+    {
+        int32 x, y;
+        calculateCell(pageID, &x, &y);
+        Vector2 mid;
+        getMidPointGridSpace(x, y, mid);
+
+        Vector2 offset = mid - mFocus;
+        Real dist = offset.length();
+        if (dist < 1e-3f)
+            return 0;
+
+        Real ahead = offset.dotProduct(mFocusVelocity) / dist * mLookAheadTime;
+        ahead = Math::Clamp(ahead, Real(0), dist * 0.5f);
+        return (dist - ahead) / mCellSize;
+    }
+    //---------------------------------------------------------------------
     bool Grid2DPageStrategyData::load(StreamSerialiser& ser)
     {
         if (!ser.readChunkBegin(CHUNK_ID, CHUNK_VERSION, "Grid2DPageStrategyData"))
@@ -349,9 +395,55 @@ namespace Ogre
                 // other pages will by inference be marked for unloading
             }
         }   
-        
 
+        const Vector2& velocity = stratData->_updateCameraMotion(cam, gridpos);
+        Real lookAhead = stratData->getLookAheadTime();
+        if (lookAhead > 0 && velocity != Vector2::ZERO)
+        {
+            // request the pages along the predicted path, sampled once per cell
+            Vector2 travel = velocity * lookAhead;
+            int samples = (int)std::ceil(travel.length() / stratData->getCellSize());
+            for (int i = 1; i <= samples; ++i)
+                loadPagesAround(gridpos + travel * (Real(i) / samples), loadRadius, section);
+        }
+
+        Real holdDistance = stratData->getHoldRadius();
+        for (const Vector3& hint : stratData->getPathHints())
+        {
+            Vector2 hintpos;
+            stratData->convertWorldToGridSpace(hint, hintpos);
+            if (hintpos.squaredDistance(gridpos) <= holdDistance * holdDistance)
+                loadPagesAround(hintpos, loadRadius, section);
+        }
+
+    }
+    //---------------------------------------------------------------------
+    void Grid2DPageStrategy::loadPagesAround(const Vector2& gridPos, Real radiusInCells, PagedWorldSection* section)
+    {
+        Grid2DPageStrategyData* stratData = static_cast<Grid2DPageStrategyData*>(section->getStrategyData());
+        int32 x, y;
+        stratData->determineGridLocation(gridPos, &x, &y);
 
+        // Round UP max, round DOWN min
+        int32 xmin = std::max(stratData->getCellRangeMinX(), (int32)std::floor(x - radiusInCells));
+        int32 xmax = std::min(stratData->getCellRangeMaxX(), (int32)std::ceil(x + radiusInCells));
+        int32 ymin = std::max(stratData->getCellRangeMinY(), (int32)std::floor(y - radiusInCells));
+        int32 ymax = std::min(stratData->getCellRangeMaxY(), (int32)std::ceil(y + radiusInCells));
+        for (int32 cy = ymin; cy <= ymax; ++cy)
+        {
+            for (int32 cx = xmin; cx <= xmax; ++cx)
+                section->loadPage(stratData->calculatePageID(cx, cy));
+        }
+    }
+    //---------------------------------------------------------------------
+    void Grid2DPageStrategy::frameStart(Real timeSinceLastFrame, PagedWorldSection* section)
+    {
+        static_cast<Grid2DPageStrategyData*>(section->getStrategyData())->_notifyFrameTime(timeSinceLastFrame);
+    }
+    //---------------------------------------------------------------------
+    Real Grid2DPageStrategy::getPagePriority(PageID pageID, PagedWorldSection* section)
+    {
+        return static_cast<Grid2DPageStrategyData*>(section->getStrategyData())->getPagePriority(pageID);
     }
     //---------------------------------------------------------------------
     PageStrategyData* Grid2DPageStrategy::createData()
@@ -181,13 +181,7 @@ namespace Ogre
             }
             else
             {
-                Root::getSingleton().getWorkQueue()->addTask([this]() {
-                    auto res = handleRequest(NULL, NULL);
-                    Root::getSingleton().getWorkQueue()->addMainThreadTask([this, res]() {
-                        handleResponse(res, NULL);
-                        delete res;
-                    });
-                });
+                getManager()->_queuePageLoad(this);
             }
 
         }
@@ -199,6 +193,26 @@ namespace Ogre
         destroyAllContentCollections();
     }
     //---------------------------------------------------------------------
+    WorkQueue::Response* Page::_prepare()
+    {
+        return handleRequest(NULL, NULL);
+    }
+    //---------------------------------------------------------------------
+    void Page::_load(WorkQueue::Response* res, bool discard)
+    {
+        if (discard)
+        {
+            PageResponse pres = any_cast<PageResponse>(res->getData());
+            for (auto cc : pres.pageData->collectionsToAdd)
+                delete cc;
+            OGRE_DELETE pres.pageData;
+            mDeferredProcessInProgress = false;
+        }
+        else
+            handleResponse(res, NULL);
+        delete res;
+    }
+    //---------------------------------------------------------------------
     WorkQueue::Response* Page::handleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ)
     {
         // Background thread (maybe)
@@ -37,10 +37,39 @@ THE SOFTWARE.
 #include "OgreSimplePageContentCollection.h"
 #include "OgreStreamSerialiser.h"
 #include "OgreRoot.h"
+#include "OgreTimer.h"
 #include "OgrePageContent.h"
+#include "OgrePage.h"
+#include "OgrePageStrategy.h"
 
 namespace Ogre
 {
+    /// A deferred page load, shared with the background task preparing it
+    struct PageManager::PageLoadJob
+    {
+        enum State
+        {
+            QUEUED,
+            DISPATCHED,
+            RUNNING,
+            PREPARED
+        };
+        /// null once the page was destroyed
+        Page* page;
+        Real priority;
+        WorkQueue::Response* response;
+        State state;
+        bool cancelled;
+        OGRE_WQ_MUTEX(mutex);
+
+        PageLoadJob(Page* p) : page(p), priority(0), response(0), state(QUEUED), cancelled(false) {}
+
+        State getState() const
+        {
+            OGRE_WQ_LOCK_MUTEX(mutex);
+            return state;
+        }
+    };
     //---------------------------------------------------------------------
     PageManager::PageManager()
         : mWorldNameGenerator("World")
@@ -48,6 +77,8 @@ namespace Ogre
         , mPageResourceGroup(ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME)
         , mDebugDisplayLvl(0)
         , mPagingEnabled(true)
+        , mMaxConcurrentPreparations(0)
+        , mPageLoadTimeLimitMS(0)
         , mGrid2DPageStrategy(0)
         , mGrid3DPageStrategy(0)
         , mSimpleCollectionFactory(0)
@@ -72,6 +103,8 @@ namespace Ogre
             c->removeListener(&mEventRouter);
         }
         mCameraList.clear();
+
+        _cancelPageLoads(0);
         
         OGRE_DELETE mGrid3DPageStrategy;
         OGRE_DELETE mGrid2DPageStrategy;
@@ -505,6 +538,175 @@ namespace Ogre
         return mCameraList;
     }
     //---------------------------------------------------------------------
+    void PageManager::_queuePageLoad(Page* page)
+    {
+        mPageLoadJobs.push_back(std::make_shared<PageLoadJob>(page));
+    }
+    //---------------------------------------------------------------------
+    bool PageManager::_cancelPageLoad(Page* page)
+    {
+        for (PageLoadJobList::iterator i = mPageLoadJobs.begin(); i != mPageLoadJobs.end(); ++i)
+        {
+            // outlives the lock below
+            SharedPtr<PageLoadJob> job = *i;
+            if (job->page != page)
+                continue;
+
+            OGRE_WQ_LOCK_MUTEX(job->mutex);
+            switch (job->state)
+            {
+            case PageLoadJob::DISPATCHED:
+                // the task will notice and skip the page
+                job->cancelled = true;
+                job->page = 0;
+                return false;
+            case PageLoadJob::RUNNING:
+                // keep the page alive until it is prepared
+                job->cancelled = true;
+                return true;
+            case PageLoadJob::PREPARED:
+                page->_load(job->response, true);
+                break;
+            case PageLoadJob::QUEUED:
+                break;
+            }
+            mPageLoadJobs.erase(i);
+            return false;
+        }
+        return false;
+    }
+    //---------------------------------------------------------------------
+    void PageManager::_cancelPageLoads(PagedWorldSection* section)
+    {
+        for (size_t i = 0; i < mPageLoadJobs.size();)
+        {
+            PageLoadJob* job = mPageLoadJobs[i].get();
+            if (!job->page || (section && job->page->getParentSection() != section))
+            {
+                ++i;
+                continue;
+            }
+
+            if (job->getState() == PageLoadJob::DISPATCHED)
+            {
+                OGRE_WQ_LOCK_MUTEX(job->mutex);
+                if (job->state == PageLoadJob::DISPATCHED)
+                {
+                    job->cancelled = true;
+                    job->page = 0;
+                    ++i;
+                    continue;
+                }
+            }
+
+            // the section is going away, so wait for the preparation to finish
+            while (job->getState() == PageLoadJob::RUNNING)
+                OGRE_THREAD_SLEEP(1);
+
+            if (job->state == PageLoadJob::PREPARED)
+                job->page->_load(job->response, true);
+            // the section already dropped pages cancelled while running
+            if (job->cancelled)
+                OGRE_DELETE job->page;
+            mPageLoadJobs.erase(mPageLoadJobs.begin() + i);
+        }
+    }
+    //---------------------------------------------------------------------
+    void PageManager::processPageLoads()
+    {
+        PageLoadJobList prepared;
+        for (size_t i = 0; i < mPageLoadJobs.size();)
+        {
+            const SharedPtr<PageLoadJob>& job = mPageLoadJobs[i];
+            if (job->getState() != PageLoadJob::PREPARED)
+            {
+                ++i;
+                continue;
+            }
+
+            if (!job->cancelled)
+                prepared.push_back(job);
+            else if (job->page)
+            {
+                job->page->_load(job->response, true);
+                OGRE_DELETE job->page;
+            }
+            mPageLoadJobs.erase(mPageLoadJobs.begin() + i);
+        }
+
+        std::stable_sort(prepared.begin(), prepared.end(),
+                         [](const SharedPtr<PageLoadJob>& a, const SharedPtr<PageLoadJob>& b)
+                         { return a->priority < b->priority; });
+
+        unsigned long msStart = Root::getSingleton().getTimer()->getMilliseconds();
+        PageLoadJobList::iterator i = prepared.begin();
+        for (; i != prepared.end(); ++i)
+        {
+            (*i)->page->_load((*i)->response);
+
+            if (mPageLoadTimeLimitMS &&
+                Root::getSingleton().getTimer()->getMilliseconds() - msStart > mPageLoadTimeLimitMS)
+            {
+                ++i;
+                break;
+            }
+        }
+        // out of time, keep the rest for the next frame
+        mPageLoadJobs.insert(mPageLoadJobs.end(), i, prepared.end());
+    }
+    //---------------------------------------------------------------------
+    void PageManager::dispatchPageLoads()
+    {
+        size_t inFlight = 0;
+        PageLoadJobList queued;
+        for (const SharedPtr<PageLoadJob>& job : mPageLoadJobs)
+        {
+            PageLoadJob::State state = job->getState();
+            if (state == PageLoadJob::DISPATCHED || state == PageLoadJob::RUNNING)
+                ++inFlight;
+            else if (state == PageLoadJob::QUEUED && job->page->isHeld())
+            {
+                PagedWorldSection* section = job->page->getParentSection();
+                PageStrategy* strategy = section->getStrategy();
+                job->priority = strategy ? strategy->getPagePriority(job->page->getID(), section) : 0;
+                queued.push_back(job);
+            }
+        }
+
+        size_t count = queued.size();
+        if (mMaxConcurrentPreparations)
+            count = std::min(count, mMaxConcurrentPreparations > inFlight ? mMaxConcurrentPreparations - inFlight : 0);
+        if (!count)
+            return;
+
+        // nearest first, in request order otherwise
+        std::stable_sort(queued.begin(), queued.end(),
+                         [](const SharedPtr<PageLoadJob>& a, const SharedPtr<PageLoadJob>& b)
+                         { return a->priority < b->priority; });
+
+        WorkQueue* queue = Root::getSingleton().getWorkQueue();
+        for (size_t i = 0; i < count; ++i)
+        {
+            SharedPtr<PageLoadJob> job = queued[i];
+            job->state = PageLoadJob::DISPATCHED;
+            queue->addTask([job]() {
+                {
+                    OGRE_WQ_LOCK_MUTEX(job->mutex);
+                    if (job->cancelled)
+                    {
+                        job->state = PageLoadJob::PREPARED;
+                        return;
+                    }
+                    job->state = PageLoadJob::RUNNING;
+                }
+                WorkQueue::Response* res = job->page->_prepare();
+                OGRE_WQ_LOCK_MUTEX(job->mutex);
+                job->response = res;
+                job->state = PageLoadJob::PREPARED;
+            });
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     void PageManager::EventRouter::cameraPreRenderScene(Camera* cam)
     {
@@ -517,6 +719,8 @@ namespace Ogre
     //---------------------------------------------------------------------
     bool PageManager::EventRouter::frameStarted(const FrameEvent& evt)
     {
+        pManager->processPageLoads();
+
         if(pWorldMap->empty())
             return true;
 
@@ -533,6 +737,8 @@ namespace Ogre
             }
         }
 
+        pManager->dispatchPageLoads();
+
         return true;
     }
     //---------------------------------------------------------------------
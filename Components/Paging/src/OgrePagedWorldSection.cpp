@@ -53,6 +53,7 @@ namespace Ogre
             mStrategyData = 0;
         }
 
+        getManager()->_cancelPageLoads(this);
         removeAllPages();
     }
     //---------------------------------------------------------------------
@@ -236,7 +237,9 @@ namespace Ogre
 
             page->unload();
 
-            OGRE_DELETE page;
+            // a page still being prepared is destroyed by the manager once done
+            if (!getManager()->_cancelPageLoad(page))
+                OGRE_DELETE page;
             
         }
     }
@@ -311,6 +314,7 @@ namespace Ogre
         if (!mParent->getManager()->getPagingOperationsEnabled())
             return;
 
+        getManager()->_cancelPageLoads(this);
         for (auto & p : mPages)
         {
             OGRE_DELETE p.second;
@@ -1246,6 +1246,9 @@ namespace Ogre
         void finaliseNormals(const Rect& rect, PixelBox* normalsBox);
 
         /** Calculate (or recalculate) the terrain lightmap
+
+        Shadows are found by sweeping lines of texels along the light direction, while tracking
+        the horizon. Lines are processed in parallel by WorkQueue::parallelFor.
         @param rect Rectangle describing the area of heights that were changed
         @param extraTargetRect Rectangle describing a target area of the terrain that
             needs to be calculated additionally (e.g. from a neighbour)
@@ -1277,10 +1280,21 @@ namespace Ogre
             0 indicates no limit
          @return A pair which contains whether the ray hit the terrain and, if so, where.
          @remarks This can be called from any thread as long as no parallel write to
-         the heightmap data occurs.
+         the heightmap data occurs. Blocks of quads the ray passes entirely above or below
+         are skipped using a min/max height pyramid, that is kept up to date by dirtyRect.
          */
         std::pair<bool, Vector3> rayIntersects(const Ray& ray, 
             bool cascadeToNeighbours = false, Real distanceLimit = 0); //const;
+
+        /** Test many rays for intersection with the terrain at once
+
+         The rays are distributed across the threads of the WorkQueue.
+         @param rays The rays to test
+         @param results Receives the result for each ray, as returned by rayIntersects
+         @param cascadeToNeighbours, distanceLimit see rayIntersects
+         */
+        void rayIntersects(const std::vector<Ray>& rays, std::vector<std::pair<bool, Vector3> >& results,
+                           bool cascadeToNeighbours = false, Real distanceLimit = 0);
         
         /// Get the AABB (local coords) of the entire terrain
         const AxisAlignedBox& getAABB() const;
@@ -1353,6 +1367,19 @@ namespace Ogre
         */
         TerrainLayerBlendMap* getLayerBlendMap(uint8 layerIndex);
 
+        /** Apply a batch of brush stamps to the layer blend maps.
+
+            The stamps are applied in order, each adding its weight to the blend
+            map of its layer. Rows of the blend maps are processed in parallel.
+            The touched regions are collected per layer and uploaded once, when
+            the main thread tasks are processed at the end of the frame. If the
+            WorkQueue does not accept requests, they are uploaded immediately.
+        @param stamps The stamps to apply
+        @param normalise Whether painting a layer also fades out the layers above
+            it by the same amount, so the painted layer becomes visible
+        */
+        void applyBlendStamps(const std::vector<TerrainBlendStamp>& stamps, bool normalise = true);
+
         /** Get the index of the blend texture that a given layer uses.
         @param layerIndex The layer index, must be >= 1 and less than the number
             of layers
@@ -1589,9 +1616,13 @@ namespace Ogre
         // It should be read-locked whenever using neighbours in calculations which are possibly running in a
         // background thread.
         OGRE_RW_MUTEX(mNeighbourMutex);
+        // Guards merging the height deltas of tiles processed in parallel
+        OGRE_WQ_MUTEX(mDeltaMutex);
 
         void waitForDerivedProcesses();
     private:
+        /// upload the changes of all blend maps and cancel a queued upload
+        void uploadBlendMaps();
         /// WorkQueue::RequestHandler override
         WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ);
         /// WorkQueue::ResponseHandler override
@@ -1679,6 +1710,10 @@ namespace Ogre
         float* mHeightData;
         /// The delta information defining how a vertex moves before it is removed at a lower LOD
         float* mDeltaData;
+        /// Number of quads along each side of the smallest blocks in mHeightBounds
+        static const int HEIGHT_BOUNDS_BLOCK_SIZE = 8;
+        /// Minimum and maximum height of blocks of quads, each level halving the resolution
+        std::vector<std::vector<std::pair<float, float> > > mHeightBounds;
         Alignment mAlign;
         Real mWorldSize;
         uint16 mSize;
@@ -1711,6 +1746,9 @@ namespace Ogre
         uint8 mDerivedUpdatePendingMask;
 
         bool mGenerateMaterialInProgress;
+        /// Set while the blend maps wait for the upload at the end of the frame. The queued task only
+        /// holds a weak reference, so it is skipped once the maps were uploaded otherwise
+        std::shared_ptr<bool> mBlendMapUpload;
         /// Don't release Height/DeltaData when preparing
         mutable bool mPrepareInProgress;
         /// A data holder for communicating with the background derived data update
@@ -1822,6 +1860,8 @@ namespace Ogre
     private:
         /// Test a single quad of the terrain for ray intersection.
         OGRE_FORCE_INLINE std::pair<bool, Vector3> checkQuadIntersection(int x, int y, const Ray& ray) const;
+        /// Update the height bounds of the blocks touching the given rectangle of vertices
+        void updateHeightBounds(const Rect& rect);
     };
 
 
@@ -1857,6 +1897,7 @@ namespace Ogre
         Real mCompositeMapDistance;
         String mResourceGroup;
         bool mUseVertexCompressionWhenAvailable;
+        Real mHeightSavePrecision;
 
     public:
         TerrainGlobalOptions();
@@ -2037,6 +2078,18 @@ namespace Ogre
          */
         void setUseVertexCompressionWhenAvailable(bool enable) { mUseVertexCompressionWhenAvailable = enable; }
 
+        /** Set the precision, at which Terrain::save stores heights
+
+            With a precision above 0, the heights of each LOD level are stored as quantised
+            differences to the heights interpolated from the coarser levels. This makes pages
+            a fraction of the size and faster to stream, but heights read back may differ by up to
+            half the precision. The default is 0, which stores the heights exactly.
+            @param precision the quantisation step in world units
+         */
+        void setHeightSavePrecision(Real precision) { mHeightSavePrecision = precision; }
+        /// @copydoc setHeightSavePrecision
+        Real getHeightSavePrecision() const { return mHeightSavePrecision; }
+
         /// @copydoc Singleton::getSingleton()
         static TerrainGlobalOptions& getSingleton(void);
         /// @copydoc Singleton::getSingleton()
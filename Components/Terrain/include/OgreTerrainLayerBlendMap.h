@@ -46,6 +46,20 @@ namespace Ogre
     */
 
 
+    /** A weighted brush stamp, applied in batches by Terrain::applyBlendStamps.
+    */
+    struct TerrainBlendStamp
+    {
+        /// Centre of the stamp in blend map image space (top down)
+        Real x, y;
+        /// Radius of the stamp in texels
+        Real radius;
+        /// Value added at the centre, falling off smoothly to 0 at the radius. Negative values erase.
+        float weight;
+        /// The layer to paint. Painting layer 0 erases all layers above it.
+        uint8 layer;
+    };
+
     /** Class exposing an interface to a blend map for a given layer. 
     Each layer after the first layer in a terrain has a blend map which 
     expresses how it is alpha blended with the layers beneath. Internally, this
@@ -64,8 +78,8 @@ namespace Ogre
         uint8 mLayerIdx;
         uint8 mChannel; // RGBA
         uint8 mChannelOffset; // in pixel format
-        Box mDirtyBox;
-        bool mDirty;
+        /// Pending regions to upload, kept disjoint
+        std::vector<Box> mDirtyBoxes;
         HardwarePixelBuffer* mBuffer;
         Image mData;
 
@@ -140,6 +154,9 @@ namespace Ogre
         void dirty();
 
         /** Indicate that a portion of the blend data is dirty and needs updating.
+
+            Overlapping or touching regions are merged, so that update() only uploads
+            the coalesced regions rather than their whole bounding box.
         @param rect Rectangle in image space
         */
         void dirtyRect(const Rect& rect);
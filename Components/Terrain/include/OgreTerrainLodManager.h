@@ -144,6 +144,19 @@ namespace Ogre
                 0: 01 03 05 06 07 08 09 11 13 15 16 17 18 19 21 23
           */
         static void separateData(float* data, uint16 size, uint16 numLodLevels, LodsData& lods );
+
+        /** Encode the geometry data of a LOD level as quantised heights and deltas
+        @param terrain The terrain to encode
+        @param lodLevel The LOD level to encode
+        @param precision The quantisation step
+        @param encoded Receives the heights as varint encoded differences to the heights interpolated
+            from the coarser levels, followed by the quantised deltas
+        */
+        static void encodeLodData(const Terrain* terrain, uint lodLevel, float precision, std::vector<uint8>& encoded);
+        /** Decode data written by encodeLodData into the separated form used by fillBufferAtLod
+        @remarks The coarser LOD levels must be filled already, as the heights are predicted from them.
+        */
+        void decodeLodData(uint lodLevel, float precision, const std::vector<uint8>& encoded, float* data, uint dataSize);
     private:
         Terrain* mTerrain;
         DataStreamPtr mDataStream;
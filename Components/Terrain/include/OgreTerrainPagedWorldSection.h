@@ -142,6 +142,29 @@ namespace Ogre
         /// Get the interval between the loading of single pages in milliseconds (ms)
         virtual uint32 getLoadingIntervalMs() const;
 
+        /// Set how far ahead the camera motion is predicted, see Grid2DPageStrategyData::setLookAheadTime
+        void setLookAheadTime(Real seconds);
+        Real getLookAheadTime() const;
+
+        /// Timings of a page load, as Timer milliseconds
+        struct PageLoadStatistics
+        {
+            /// when the page was requested
+            unsigned long requested;
+            /// when the terrain was defined and its loading started
+            unsigned long started;
+            /// when the terrain finished loading, 0 while in progress
+            unsigned long loaded;
+
+            /// time from the request until the terrain was loaded
+            unsigned long getLatency() const { return loaded ? loaded - requested : 0; }
+        };
+        typedef std::map<PageID, PageLoadStatistics> PageLoadStatisticsMap;
+        /// Get the load timings of the currently requested and loaded pages
+        const PageLoadStatisticsMap& getPageLoadStatistics() const { return mPageLoadStatistics; }
+
+        /// Overridden from PagedWorldSection
+        void frameStart(Real timeSinceLastFrame) override;
         /// Overridden from PagedWorldSection
         void loadPage(PageID pageID, bool forceSynchronous = false) override;
         /// Overridden from PagedWorldSection
@@ -168,9 +191,16 @@ namespace Ogre
         TerrainGroup* mTerrainGroup;
         TerrainDefiner* mTerrainDefiner;
         std::list<PageID> mPagesInLoading;
+        /// Pages whose terrain is being prepared
+        std::vector<PageID> mPagesInPreparation;
         bool mHasRunningTasks;
         unsigned long mNextLoadingTime;
         uint32 mLoadingIntervalMs;
+        PageLoadStatisticsMap mPageLoadStatistics;
+
+        /** start defining the most urgent page, in the order of Grid2DPageStrategy::getPagePriority,
+            if PageManager::getMaxConcurrentPreparations allows */
+        void startNextPage();
 
         /// WorkQueue::RequestHandler override
         WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ);
@@ -111,6 +111,7 @@ namespace Ogre
         , mCompositeMapDistance(4000)
         , mResourceGroup(ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME)
         , mUseVertexCompressionWhenAvailable(true)
+        , mHeightSavePrecision(0)
     {
     }
     //---------------------------------------------------------------------
@@ -730,6 +731,8 @@ namespace Ogre
         // Create & load quadtree
         mQuadTree = OGRE_NEW TerrainQuadTreeNode(this, 0, 0, 0, mSize, mNumLodLevels - 1, 0);
         mQuadTree->prepare(stream);
+        // heights of newer versions are filled in by the TerrainLodManager, which updates them again
+        updateHeightBounds(Rect(0, 0, mSize, mSize));
 
         // stop uncompressing
         if(mainChunk->version > 1)
@@ -865,6 +868,7 @@ namespace Ogre
 
         // calculate entire terrain
         Rect rect(0, 0, mSize, mSize);
+        updateHeightBounds(rect);
         calculateHeightDeltas(rect);
         finaliseHeightDeltas(rect, true);
 
@@ -1810,6 +1814,7 @@ namespace Ogre
         mDirtyGeometryRectForNeighbours.merge(rect);
         mDirtyDerivedDataRect.merge(rect);
         mCompositeMapDirtyRect.merge(rect);
+        updateHeightBounds(rect);
 
         mModified = true;
         mHeightDataModified = true;
@@ -1931,6 +1936,10 @@ namespace Ogre
     //---------------------------------------------------------------------
     void Terrain::waitForDerivedProcesses()
     {
+        // the queue may drop the task without telling, e.g. a custom one that is shutting down
+        if (mBlendMapUpload)
+            uploadBlendMaps();
+
         while (mDerivedDataUpdateInProgress || mGenerateMaterialInProgress || mPrepareInProgress)
         {
             // we need to wait for this to finish
@@ -1947,6 +1956,7 @@ namespace Ogre
 
         OGRE_FREE(mDeltaData, MEMCATEGORY_GEOMETRY);
         mDeltaData = 0;
+        mHeightBounds.clear();
 
         OGRE_DELETE mQuadTree;
         mQuadTree = 0;
@@ -2024,6 +2034,11 @@ namespace Ogre
 
         mQuadTree->preDeltaCalculation(clampedRect);
 
+        // leaf nodes of the quadtree cover cells of this many intervals
+        const int cellSize = mMinBatchSize - 1;
+        const int numCells = (mSize - 1) / cellSize;
+        std::vector<Real> cellDeltas(numCells * numCells, -std::numeric_limits<Real>::max());
+
         /// Iterate over target levels, 
         for (int targetLevel = 1; targetLevel < mNumLodLevels; ++targetLevel)
         {
@@ -2054,113 +2069,148 @@ namespace Ogre
             if (lodRect.bottom % step)
                 lodRect.bottom += step - (lodRect.bottom % step);
 
-            for (int j = lodRect.top; j < lodRect.bottom - step; j += step )
-            {
-                for (int i = lodRect.left; i < lodRect.right - step; i += step )
+            // Rows of quads write distinct vertices, so process them in parallel. The quadtree only
+            // keeps the maximum delta per node, so tiles first reduce their deltas per cell of
+            // the smallest batch size and the quadtree is notified once per cell afterwards.
+            int numRows = std::max(0, (lodRect.bottom - step - lodRect.top + step - 1) / step);
+            WorkQueue::parallelFor(numRows, 8, [&](size_t begin, size_t end) {
+                std::vector<Real> tileDeltas(numCells * numCells, -std::numeric_limits<Real>::max());
+                // vertices on a cell border belong to the batches on both sides
+                auto notifyCellDelta = [&](int x, int y, Real delta)
                 {
-                    // Form planes relating to the lower detail tris to be produced
-                    // For even tri strip rows, they are this shape:
-                    // 2---3
-                    // | / |
-                    // 0---1
-                    // For odd tri strip rows, they are this shape:
-                    // 2---3
-                    // | \ |
-                    // 0---1
-
-                    Vector3 v0, v1, v2, v3;
-                    getPointAlign(i, j, ALIGN_X_Y, &v0);
-                    getPointAlign(i + step, j, ALIGN_X_Y, &v1);
-                    getPointAlign(i, j + step, ALIGN_X_Y, &v2);
-                    getPointAlign(i + step, j + step, ALIGN_X_Y, &v3);
-
-                    Vector4 t1, t2;
-                    bool backwardTri = false;
-                    // Odd or even in terms of target level
-                    if ((j / step) % 2 == 0)
-                    {
-                        t1 = Math::calculateFaceNormalWithoutNormalize(v0, v1, v3);
-                        t2 = Math::calculateFaceNormalWithoutNormalize(v0, v3, v2);
-                    }
-                    else
-                    {
-                        t1 = Math::calculateFaceNormalWithoutNormalize(v1, v3, v2);
-                        t2 = Math::calculateFaceNormalWithoutNormalize(v0, v1, v2);
-                        backwardTri = true;
-                    }
+                    int cx = std::min(x / cellSize, numCells - 1), cy = std::min(y / cellSize, numCells - 1);
+                    int cx0 = (x % cellSize == 0 && x > 0) ? x / cellSize - 1 : cx;
+                    int cy0 = (y % cellSize == 0 && y > 0) ? y / cellSize - 1 : cy;
+                    for (int celly = cy0; celly <= cy; ++celly)
+                        for (int cellx = cx0; cellx <= cx; ++cellx)
+                            tileDeltas[celly * numCells + cellx] = std::max(tileDeltas[celly * numCells + cellx], delta);
+                };
 
-                    // include the bottommost row of vertices if this is the last row
-                    int yubound = (j == (mSize - step)? step : step - 1);
-                    for ( int y = 0; y <= yubound; y++ )
+                for (int j = lodRect.top + int(begin) * step; j < lodRect.top + int(end) * step; j += step )
+                {
+                    for (int i = lodRect.left; i < lodRect.right - step; i += step )
                     {
-                        // include the rightmost col of vertices if this is the last col
-                        int xubound = (i == (mSize - step)? step : step - 1);
-                        for ( int x = 0; x <= xubound; x++ )
+                        // Form planes relating to the lower detail tris to be produced
+                        // For even tri strip rows, they are this shape:
+                        // 2---3
+                        // | / |
+                        // 0---1
+                        // For odd tri strip rows, they are this shape:
+                        // 2---3
+                        // | \ |
+                        // 0---1
+
+                        Vector3 v0, v1, v2, v3;
+                        getPointAlign(i, j, ALIGN_X_Y, &v0);
+                        getPointAlign(i + step, j, ALIGN_X_Y, &v1);
+                        getPointAlign(i, j + step, ALIGN_X_Y, &v2);
+                        getPointAlign(i + step, j + step, ALIGN_X_Y, &v3);
+
+                        Vector4 t1, t2;
+                        bool backwardTri = false;
+                        // Odd or even in terms of target level
+                        if ((j / step) % 2 == 0)
                         {
-                            int fulldetailx = static_cast<int>(i + x);
-                            int fulldetaily = static_cast<int>(j + y);
-                            if ( fulldetailx % step == 0 && 
-                                fulldetaily % step == 0 )
-                            {
-                                // Skip, this one is a vertex at this level
-                                continue;
-                            }
-
-                            Real ypct = (Real)y / (Real)step;
-                            Real xpct = (Real)x / (Real)step;
+                            t1 = Math::calculateFaceNormalWithoutNormalize(v0, v1, v3);
+                            t2 = Math::calculateFaceNormalWithoutNormalize(v0, v3, v2);
+                        }
+                        else
+                        {
+                            t1 = Math::calculateFaceNormalWithoutNormalize(v1, v3, v2);
+                            t2 = Math::calculateFaceNormalWithoutNormalize(v0, v1, v2);
+                            backwardTri = true;
+                        }
 
-                            //interpolated height
-                            Vector3 actualPos;
-                            getPointAlign(fulldetailx, fulldetaily, ALIGN_X_Y, &actualPos);
-                            Real interp_h;
-                            // Determine which tri we're on 
-                            if ((xpct > ypct && !backwardTri) ||
-                                (xpct > (1-ypct) && backwardTri))
-                            {
-                                // Solve for x/z
-                                interp_h = 
-                                    (-t1.x * actualPos.x
-                                    - t1.y * actualPos.y
-                                    - t1.w) / t1.z;
-                            }
-                            else
+                        // include the bottommost row of vertices if this is the last row
+                        int yubound = (j == (mSize - step)? step : step - 1);
+                        for ( int y = 0; y <= yubound; y++ )
+                        {
+                            // include the rightmost col of vertices if this is the last col
+                            int xubound = (i == (mSize - step)? step : step - 1);
+                            for ( int x = 0; x <= xubound; x++ )
                             {
-                                // Second tri
-                                interp_h = 
-                                    (-t2.x * actualPos.x
-                                    - t2.y * actualPos.y
-                                    - t2.w) / t2.z;
-                            }
-
-                            Real actual_h = actualPos.z;
-                            Real delta = interp_h - actual_h;
-
-                            // max(delta) is the worst case scenario at this LOD
-                            // compared to the original heightmap
-
-                            // tell the quadtree about this 
-                            mQuadTree->notifyDelta(fulldetailx, fulldetaily, sourceLevel, delta);
-
+                                int fulldetailx = static_cast<int>(i + x);
+                                int fulldetaily = static_cast<int>(j + y);
+                                if ( fulldetailx % step == 0 && 
+                                    fulldetaily % step == 0 )
+                                {
+                                    // Skip, this one is a vertex at this level
+                                    continue;
+                                }
+
+                                Real ypct = (Real)y / (Real)step;
+                                Real xpct = (Real)x / (Real)step;
+
+                                //interpolated height
+                                Vector3 actualPos;
+                                getPointAlign(fulldetailx, fulldetaily, ALIGN_X_Y, &actualPos);
+                                Real interp_h;
+                                // Determine which tri we're on 
+                                if ((xpct > ypct && !backwardTri) ||
+                                    (xpct > (1-ypct) && backwardTri))
+                                {
+                                    // Solve for x/z
+                                    interp_h = 
+                                        (-t1.x * actualPos.x
+                                        - t1.y * actualPos.y
+                                        - t1.w) / t1.z;
+                                }
+                                else
+                                {
+                                    // Second tri
+                                    interp_h = 
+                                        (-t2.x * actualPos.x
+                                        - t2.y * actualPos.y
+                                        - t2.w) / t2.z;
+                                }
+
+                                Real actual_h = actualPos.z;
+                                Real delta = interp_h - actual_h;
+
+                                // max(delta) is the worst case scenario at this LOD
+                                // compared to the original heightmap
+
+                                // tell the quadtree about this 
+                                notifyCellDelta(fulldetailx, fulldetaily, delta);
+
+
+                                // If this vertex is being removed at this LOD, 
+                                // then save the height difference since that's the move
+                                // it will need to make. Vertices to be removed at this LOD
+                                // are halfway between the steps, but exclude those that
+                                // would have been eliminated at earlier levels
+                                int halfStep = step / 2;
+                                if (
+                                 ((fulldetailx % step) == halfStep && (fulldetaily % halfStep) == 0) ||
+                                 ((fulldetaily % step) == halfStep && (fulldetailx % halfStep) == 0))
+                                {
+                                    // Save height difference 
+                                    mDeltaData[fulldetailx + (fulldetaily * mSize)] = delta;
+                                }
 
-                            // If this vertex is being removed at this LOD, 
-                            // then save the height difference since that's the move
-                            // it will need to make. Vertices to be removed at this LOD
-                            // are halfway between the steps, but exclude those that
-                            // would have been eliminated at earlier levels
-                            int halfStep = step / 2;
-                            if (
-                             ((fulldetailx % step) == halfStep && (fulldetaily % halfStep) == 0) ||
-                             ((fulldetaily % step) == halfStep && (fulldetailx % halfStep) == 0))
-                            {
-                                // Save height difference 
-                                mDeltaData[fulldetailx + (fulldetaily * mSize)] = delta;
                             }
 
                         }
+                    } // i
+                } // j
 
-                    }
-                } // i
-            } // j
+                OGRE_WQ_LOCK_MUTEX(mDeltaMutex);
+                for (size_t c = 0; c < cellDeltas.size(); ++c)
+                    cellDeltas[c] = std::max(cellDeltas[c], tileDeltas[c]);
+            });
+
+            // tell the quadtree about the deltas, a point inside each cell hits the same nodes
+            for (int cy = 0; cy < numCells; ++cy)
+            {
+                for (int cx = 0; cx < numCells; ++cx)
+                {
+                    Real& delta = cellDeltas[cy * numCells + cx];
+                    if (delta == -std::numeric_limits<Real>::max())
+                        continue;
+                    mQuadTree->notifyDelta(cx * cellSize + 1, cy * cellSize + 1, sourceLevel, delta);
+                    delta = -std::numeric_limits<Real>::max();
+                }
+            }
 
         } // targetLevel
 
@@ -2329,40 +2379,88 @@ namespace Ogre
         // now check every quad the ray touches
         int quadX = std::min(std::max(static_cast<int>(cur.x), 0), (int)mSize-2);
         int quadZ = std::min(std::max(static_cast<int>(cur.z), 0), (int)mSize-2);
-        int flipX = (rayDirection.x < 0 ? 0 : 1);
-        int flipZ = (rayDirection.z < 0 ? 0 : 1);
         int xDir = (rayDirection.x < 0 ? -1 : 1);
         int zDir = (rayDirection.z < 0 ? -1 : 1);
 
-        Result result(true, Vector3::ZERO);
-        Real dummyHighValue = (Real)mSize * 10000.0f;
-
+        Result result(false, Vector3::ZERO);
+        Real t = aabbTest.second;
+        const Real dummyHighValue = std::numeric_limits<Real>::max();
+        // ray parameter at which it leaves the interval [low, high] along one axis
+        auto exitParam = [dummyHighValue](int low, int high, Real origin, Real direction)
+        {
+            if (Math::RealEqual(direction, 0.0))
+                return dummyHighValue;
+            return ((direction < 0 ? low : high) - origin) / direction;
+        };
+        const int lastQuad = (int)mSize - 1;
 
-        while (cur.y >= (minHeight - 1e-3) && cur.y <= (maxHeight + 1e-3))
+        while (quadX >= 0 && quadX < lastQuad && quadZ >= 0 && quadZ < lastQuad)
         {
-            if (quadX < 0 || quadX >= (int)mSize-1 || quadZ < 0 || quadZ >= (int)mSize-1)
+            Real y = rayOrigin.y + rayDirection.y * t;
+            if (y < (minHeight - 1e-3) || y > (maxHeight + 1e-3))
                 break;
 
-            result = checkQuadIntersection(quadX, quadZ, localRay);
-            if (result.first)
-                break;
+            // find the largest block around the quad, that the ray passes entirely above or below
+            int level = int(mHeightBounds.size()) - 1;
+            int x0 = 0, x1 = 0, z0 = 0, z1 = 0;
+            Real xExit = 0, zExit = 0;
+            for (; level >= 0; --level)
+            {
+                int span = HEIGHT_BOUNDS_BLOCK_SIZE << level;
+                x0 = quadX / span * span;
+                z0 = quadZ / span * span;
+                x1 = std::min(x0 + span, lastQuad);
+                z1 = std::min(z0 + span, lastQuad);
+                xExit = exitParam(x0, x1, rayOrigin.x, rayDirection.x);
+                zExit = exitParam(z0, z1, rayOrigin.z, rayDirection.z);
+                Real yExit = rayOrigin.y + rayDirection.y * std::min(xExit, zExit);
+
+                int blocksPerSide = (lastQuad + span - 1) / span;
+                const std::pair<float, float>& bounds = mHeightBounds[level][quadZ / span * blocksPerSide + quadX / span];
+                if (std::min(y, yExit) > bounds.second || std::max(y, yExit) < bounds.first)
+                    break;
+            }
 
-            // determine next quad to test
-            Real xDist = Math::RealEqual(rayDirection.x, 0.0) ? dummyHighValue : 
-                (quadX - cur.x + flipX) / rayDirection.x;
-            Real zDist = Math::RealEqual(rayDirection.z, 0.0) ? dummyHighValue : 
-                (quadZ - cur.z + flipZ) / rayDirection.z;
-            if (xDist < zDist)
+            if (level < 0)
             {
-                quadX += xDir;
-                cur += rayDirection * xDist;
+                // test each quad of the smallest block, x0 etc. still describe it
+                while (quadX >= x0 && quadX < x1 && quadZ >= z0 && quadZ < z1)
+                {
+                    result = checkQuadIntersection(quadX, quadZ, localRay);
+                    if (result.first)
+                        break;
+
+                    // determine next quad to test
+                    Real xDist = exitParam(quadX, quadX + 1, rayOrigin.x, rayDirection.x);
+                    Real zDist = exitParam(quadZ, quadZ + 1, rayOrigin.z, rayDirection.z);
+                    if (xDist < zDist)
+                    {
+                        quadX += xDir;
+                        t = xDist;
+                    }
+                    else
+                    {
+                        quadZ += zDir;
+                        t = zDist;
+                    }
+                }
+                if (result.first)
+                    break;
+                continue;
+            }
+
+            // skip the whole block
+            t = std::min(xExit, zExit);
+            if (xExit <= zExit)
+            {
+                quadX = xDir > 0 ? x1 : x0 - 1;
+                quadZ = Math::Clamp(int(std::floor(rayOrigin.z + rayDirection.z * t)), z0, z1 - 1);
             }
             else
             {
-                quadZ += zDir;
-                cur += rayDirection * zDist;
+                quadZ = zDir > 0 ? z1 : z0 - 1;
+                quadX = Math::Clamp(int(std::floor(rayOrigin.x + rayDirection.x * t)), x0, x1 - 1);
             }
-
         }
 
         if (result.first)
@@ -2399,6 +2497,90 @@ namespace Ogre
         return result;
     }
     //---------------------------------------------------------------------
+    void Terrain::rayIntersects(const std::vector<Ray>& rays, std::vector<std::pair<bool, Vector3> >& results,
+                                bool cascadeToNeighbours, Real distanceLimit)
+    {
+        results.resize(rays.size());
+        WorkQueue::parallelFor(rays.size(), 64, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                results[i] = rayIntersects(rays[i], cascadeToNeighbours, distanceLimit);
+        });
+    }
+    //---------------------------------------------------------------------
+    void Terrain::updateHeightBounds(const Rect& rect)
+    {
+        if (!mHeightData)
+            return;
+
+        const int lastQuad = (int)mSize - 1;
+        Rect quadRect(0, 0, lastQuad, lastQuad);
+        if (mHeightBounds.empty())
+        {
+            for (int span = HEIGHT_BOUNDS_BLOCK_SIZE;; span *= 2)
+            {
+                int blocksPerSide = (lastQuad + span - 1) / span;
+                mHeightBounds.emplace_back(blocksPerSide * blocksPerSide);
+                if (blocksPerSide == 1)
+                    break;
+            }
+        }
+        else
+        {
+            // changing a vertex affects the quads on both sides
+            quadRect = quadRect.intersect(Rect(rect.left - 1, rect.top - 1, rect.right, rect.bottom));
+            if (quadRect.isNull())
+                return;
+        }
+
+        for (int level = 0; level < (int)mHeightBounds.size(); ++level)
+        {
+            int span = HEIGHT_BOUNDS_BLOCK_SIZE << level;
+            int blocksPerSide = (lastQuad + span - 1) / span;
+            Rect blockRect(quadRect.left / span, quadRect.top / span, (quadRect.right + span - 1) / span,
+                           (quadRect.bottom + span - 1) / span);
+
+            WorkQueue::parallelFor(blockRect.height(), 4, [&](size_t begin, size_t end) {
+                for (int by = blockRect.top + int(begin); by < blockRect.top + int(end); ++by)
+                {
+                    for (int bx = blockRect.left; bx < blockRect.right; ++bx)
+                    {
+                        std::pair<float, float> bounds(std::numeric_limits<float>::max(),
+                                                       -std::numeric_limits<float>::max());
+                        if (level == 0)
+                        {
+                            // the vertices of the quads, including the far edges
+                            for (int y = by * span; y <= std::min((by + 1) * span, lastQuad); ++y)
+                            {
+                                for (int x = bx * span; x <= std::min((bx + 1) * span, lastQuad); ++x)
+                                {
+                                    float h = mHeightData[y * mSize + x];
+                                    bounds.first = std::min(bounds.first, h);
+                                    bounds.second = std::max(bounds.second, h);
+                                }
+                            }
+                        }
+                        else
+                        {
+                            // merge the children of the finer level
+                            const auto& finer = mHeightBounds[level - 1];
+                            int finerPerSide = (lastQuad + span / 2 - 1) / (span / 2);
+                            for (int cy = by * 2; cy < std::min(by * 2 + 2, finerPerSide); ++cy)
+                            {
+                                for (int cx = bx * 2; cx < std::min(bx * 2 + 2, finerPerSide); ++cx)
+                                {
+                                    const auto& child = finer[cy * finerPerSide + cx];
+                                    bounds.first = std::min(bounds.first, child.first);
+                                    bounds.second = std::max(bounds.second, child.second);
+                                }
+                            }
+                        }
+                        mHeightBounds[level][by * blocksPerSide + bx] = bounds;
+                    }
+                }
+            });
+        }
+    }
+    //---------------------------------------------------------------------
     std::pair<bool, Vector3> Terrain::checkQuadIntersection(int x, int z, const Ray& ray) const
     {
         // build the two planes belonging to the quad's triangles
@@ -2671,6 +2853,129 @@ namespace Ogre
 
     }
     //---------------------------------------------------------------------
+    void Terrain::applyBlendStamps(const std::vector<TerrainBlendStamp>& stamps, bool normalise)
+    {
+        uint8 numMaps = static_cast<uint8>(mLayerBlendMapList.size());
+        if (stamps.empty() || !numMaps)
+            return;
+
+        std::vector<TerrainLayerBlendMap*> maps(numMaps);
+        std::vector<float*> data(numMaps);
+        for (uint8 i = 0; i < numMaps; ++i)
+        {
+            maps[i] = getLayerBlendMap(i + 1);
+            data[i] = maps[i]->getBlendPointer();
+        }
+
+        // clip the stamps to the blend map, in image space
+        int32 size = mLayerBlendMapSize;
+        std::vector<Rect> rects(stamps.size());
+        Rect bounds(0, 0, 0, 0);
+        for (size_t s = 0; s < stamps.size(); ++s)
+        {
+            const TerrainBlendStamp& stamp = stamps[s];
+            OgreAssert(stamp.layer <= numMaps, "Invalid layer index");
+            Rect& r = rects[s];
+            r.left = std::max(0, (int32)std::ceil(stamp.x - stamp.radius));
+            r.top = std::max(0, (int32)std::ceil(stamp.y - stamp.radius));
+            r.right = std::min(size, (int32)std::floor(stamp.x + stamp.radius) + 1);
+            r.bottom = std::min(size, (int32)std::floor(stamp.y + stamp.radius) + 1);
+            if (r.left >= r.right || r.top >= r.bottom)
+                r.setNull();
+            else
+                bounds.merge(r);
+        }
+        if (bounds.isNull())
+            return;
+
+        // rows are independent, so each band applies all stamps in order
+        WorkQueue::parallelFor(bounds.height(), 16, [&](size_t begin, size_t end) {
+            std::vector<float> weights(size);
+            for (int32 y = bounds.top + int32(begin); y < bounds.top + int32(end); ++y)
+            {
+                for (size_t s = 0; s < stamps.size(); ++s)
+                {
+                    const TerrainBlendStamp& stamp = stamps[s];
+                    const Rect& r = rects[s];
+                    if (r.isNull() || y < r.top || y >= r.bottom)
+                        continue;
+
+                    // smooth falloff, (1 - d^2/r^2)^2
+                    int32 count = r.width();
+                    float dy = y - stamp.y;
+                    float invRadiusSq = 1.0f / (stamp.radius * stamp.radius);
+                    float* w = weights.data();
+                    for (int32 i = 0; i < count; ++i)
+                    {
+                        float dx = (r.left + i) - stamp.x;
+                        float t = std::max(0.0f, 1.0f - (dx * dx + dy * dy) * invRadiusSq);
+                        w[i] = stamp.weight * t * t;
+                    }
+
+                    size_t rowOffset = size_t(y) * size + r.left;
+                    if (stamp.layer)
+                    {
+                        float* row = data[stamp.layer - 1] + rowOffset;
+                        for (int32 i = 0; i < count; ++i)
+                            row[i] = std::min(1.0f, std::max(0.0f, row[i] + w[i]));
+                    }
+                    if (normalise && stamp.weight > 0)
+                    {
+                        for (uint8 m = stamp.layer; m < numMaps; ++m)
+                        {
+                            float* row = data[m] + rowOffset;
+                            for (int32 i = 0; i < count; ++i)
+                                row[i] *= 1.0f - std::min(1.0f, w[i]);
+                        }
+                    }
+                }
+            }
+        });
+
+        for (size_t s = 0; s < stamps.size(); ++s)
+        {
+            const TerrainBlendStamp& stamp = stamps[s];
+            if (rects[s].isNull())
+                continue;
+            if (stamp.layer)
+                maps[stamp.layer - 1]->dirtyRect(rects[s]);
+            if (normalise && stamp.weight > 0)
+            {
+                for (uint8 m = stamp.layer; m < numMaps; ++m)
+                    maps[m]->dirtyRect(rects[s]);
+            }
+        }
+
+        if (mBlendMapUpload)
+            return;
+
+        // the queue silently drops main thread tasks, when it does not accept requests
+        WorkQueue* queue = Root::getSingleton().getWorkQueue();
+        if (!queue->getRequestsAccepted())
+        {
+            uploadBlendMaps();
+            return;
+        }
+
+        // upload once per frame, no matter how many batches were applied
+        mBlendMapUpload = std::make_shared<bool>(true);
+        std::weak_ptr<bool> pending = mBlendMapUpload;
+        queue->addMainThreadTask([this, pending]() {
+            if (pending.lock())
+                uploadBlendMaps();
+        });
+    }
+    //---------------------------------------------------------------------
+    void Terrain::uploadBlendMaps()
+    {
+        mBlendMapUpload.reset();
+        for (auto *map : mLayerBlendMapList)
+        {
+            if (map)
+                map->update();
+        }
+    }
+    //---------------------------------------------------------------------
     uint8 Terrain::getBlendTextureCount() const
     {
         return (uint8)mBlendTextureList.size();
@@ -3001,27 +3306,28 @@ namespace Ogre
         // Background thread (maybe)
         DerivedDataRequest ddr = any_cast<DerivedDataRequest>(req->getData());
         DerivedDataResponse ddres;
-        ddres.remainingTypeMask = ddr.typeMask & DERIVED_DATA_ALL;
 
-        // Do only ONE type of task per background iteration, in order of priority
-        // this means we return faster, can abort faster and we repeat less redundant calcs
+        // The types of derived data only depend on the heights, so compute all requested ones
+        // concurrently. Each is split into tiles itself, so a single type still uses all workers.
         // we don't do this as separate requests, because we only want one background
         // task per Terrain instance in flight at once
-        if (ddr.typeMask & DERIVED_DATA_DELTAS)
-        {
-            ddres.deltaUpdateRect = calculateHeightDeltas(ddr.dirtyRect);
-            ddres.remainingTypeMask &= ~ DERIVED_DATA_DELTAS;
-        }
-        else if (ddr.typeMask & DERIVED_DATA_NORMALS)
-        {
-            ddres.normalMapBox = calculateNormals(ddr.dirtyRect, ddres.normalUpdateRect);
-            ddres.remainingTypeMask &= ~ DERIVED_DATA_NORMALS;
-        }
-        else if (ddr.typeMask & DERIVED_DATA_LIGHTMAP)
-        {
-            ddres.lightMapBox = calculateLightmap(ddr.dirtyRect, ddr.lightmapExtraDirtyRect, ddres.lightmapUpdateRect);
-            ddres.remainingTypeMask &= ~ DERIVED_DATA_LIGHTMAP;
-        }
+        uint8 types[] = {DERIVED_DATA_DELTAS, DERIVED_DATA_NORMALS, DERIVED_DATA_LIGHTMAP};
+        WorkQueue::parallelFor(3, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!(ddr.typeMask & types[i]))
+                    continue;
+                if (types[i] == DERIVED_DATA_DELTAS)
+                    ddres.deltaUpdateRect = calculateHeightDeltas(ddr.dirtyRect);
+                else if (types[i] == DERIVED_DATA_NORMALS)
+                    ddres.normalMapBox = calculateNormals(ddr.dirtyRect, ddres.normalUpdateRect);
+                else
+                    ddres.lightMapBox = calculateLightmap(ddr.dirtyRect, ddr.lightmapExtraDirtyRect,
+                                                          ddres.lightmapUpdateRect);
+            }
+        });
+        // all requested types are done, nothing needs another iteration
+        ddres.remainingTypeMask = 0;
 
         ddres.terrain = ddr.terrain;
         WorkQueue::Response* response = OGRE_NEW WorkQueue::Response(req, true, ddres);
@@ -3156,46 +3462,49 @@ namespace Ogre
         //  | / | \ |
         //  5---6---7
 
-        for (int y = widenedRect.top; y < widenedRect.bottom; ++y)
-        {
-            for (int x = widenedRect.left; x < widenedRect.right; ++x)
+        // rows are independent, so process them in parallel
+        WorkQueue::parallelFor(widenedRect.height(), 16, [&](size_t begin, size_t end) {
+            for (int y = widenedRect.top + int(begin); y < widenedRect.top + int(end); ++y)
             {
-                Vector3 cumulativeNormal = Vector3::ZERO;
-
-                // Build points to sample
-                Vector3 centrePoint;
-                Vector3 adjacentPoints[8];
-                getPointFromSelfOrNeighbour(x  , y,   &centrePoint);
-                getPointFromSelfOrNeighbour(x+1, y,   &adjacentPoints[0]);
-                getPointFromSelfOrNeighbour(x+1, y+1, &adjacentPoints[1]);
-                getPointFromSelfOrNeighbour(x,   y+1, &adjacentPoints[2]);
-                getPointFromSelfOrNeighbour(x-1, y+1, &adjacentPoints[3]);
-                getPointFromSelfOrNeighbour(x-1, y,   &adjacentPoints[4]);
-                getPointFromSelfOrNeighbour(x-1, y-1, &adjacentPoints[5]);
-                getPointFromSelfOrNeighbour(x,   y-1, &adjacentPoints[6]);
-                getPointFromSelfOrNeighbour(x+1, y-1, &adjacentPoints[7]);
-
-                for (int i = 0; i < 8; ++i)
+                for (int x = widenedRect.left; x < widenedRect.right; ++x)
                 {
-                    cumulativeNormal += Math::calculateBasicFaceNormal(centrePoint, adjacentPoints[i], adjacentPoints[(i+1)%8]);
-                }
+                    Vector3 cumulativeNormal = Vector3::ZERO;
+
+                    // Build points to sample
+                    Vector3 centrePoint;
+                    Vector3 adjacentPoints[8];
+                    getPointFromSelfOrNeighbour(x  , y,   &centrePoint);
+                    getPointFromSelfOrNeighbour(x+1, y,   &adjacentPoints[0]);
+                    getPointFromSelfOrNeighbour(x+1, y+1, &adjacentPoints[1]);
+                    getPointFromSelfOrNeighbour(x,   y+1, &adjacentPoints[2]);
+                    getPointFromSelfOrNeighbour(x-1, y+1, &adjacentPoints[3]);
+                    getPointFromSelfOrNeighbour(x-1, y,   &adjacentPoints[4]);
+                    getPointFromSelfOrNeighbour(x-1, y-1, &adjacentPoints[5]);
+                    getPointFromSelfOrNeighbour(x,   y-1, &adjacentPoints[6]);
+                    getPointFromSelfOrNeighbour(x+1, y-1, &adjacentPoints[7]);
+
+                    for (int i = 0; i < 8; ++i)
+                    {
+                        cumulativeNormal += Math::calculateBasicFaceNormal(centrePoint, adjacentPoints[i], adjacentPoints[(i+1)%8]);
+                    }
 
-                // normalise & store normal
-                cumulativeNormal.normalise();
+                    // normalise & store normal
+                    cumulativeNormal.normalise();
 
-                // encode as RGB, object space
-                // invert the Y to deal with image space
-                long storeX = x - widenedRect.left;
-                long storeY = widenedRect.bottom - y - 1;
+                    // encode as RGB, object space
+                    // invert the Y to deal with image space
+                    long storeX = x - widenedRect.left;
+                    long storeY = widenedRect.bottom - y - 1;
 
-                uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX) * 3;
-                *pStore++ = static_cast<uint8>((cumulativeNormal.x + 1.0f) * 0.5f * 255.0f);
-                *pStore++ = static_cast<uint8>((cumulativeNormal.y + 1.0f) * 0.5f * 255.0f);
-                *pStore++ = static_cast<uint8>((cumulativeNormal.z + 1.0f) * 0.5f * 255.0f);
+                    uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX) * 3;
+                    *pStore++ = static_cast<uint8>((cumulativeNormal.x + 1.0f) * 0.5f * 255.0f);
+                    *pStore++ = static_cast<uint8>((cumulativeNormal.y + 1.0f) * 0.5f * 255.0f);
+                    *pStore++ = static_cast<uint8>((cumulativeNormal.z + 1.0f) * 0.5f * 255.0f);
 
 
+                }
             }
-        }
+        });
 
         finalRect = widenedRect;
 
@@ -3330,41 +3639,102 @@ namespace Ogre
 
         Real heightPad = (getMaxHeight() - getMinHeight()) * 1.0e-3f;
 
-        for (long y = widenedRect.top; y < widenedRect.bottom; ++y)
-        {
-            for (long x = widenedRect.left; x < widenedRect.right; ++x)
+        // Instead of casting a ray per texel, sweep lines of texels along the light direction.
+        // Walking away from the light, each line keeps the horizon cast by everything it passed,
+        // so a texel is in shadow if the horizon lies above it.
+        Vector3 rayDir; // towards the light
+        getTerrainVector(-lightVec, &rayDir);
+        Real horizLength = Math::Sqrt(rayDir.x * rayDir.x + rayDir.y * rayDir.y);
+        const long lightmapSize = mLightmapSizeActual;
+        const long width = widenedRect.width();
+
+        if (widenedRect.isNull())
+            return pixbox;
+
+        if (horizLength <= std::abs(rayDir.z) * 1.0e-4f)
+        {
+            // light from straight above or below
+            memset(pData, rayDir.z > 0 ? 255 : 0, width * widenedRect.height());
+            return pixbox;
+        }
+
+        // walk along the axis the light direction is closer to, one texel per step
+        int major = std::abs(rayDir.x) >= std::abs(rayDir.y) ? 0 : 1;
+        int minor = 1 - major;
+        long majorStep = rayDir[major] > 0 ? -1 : 1;
+        Real minorStep = -rayDir[minor] / std::abs(rayDir[major]);
+        // the horizon sinks by this much per step
+        Real texelWorldSize = mWorldSize / (lightmapSize - 1);
+        Real horizonDrop = rayDir.z / std::abs(rayDir[major]) * texelWorldSize;
+
+        long rectMin[2] = {widenedRect.left, widenedRect.top};
+        long rectMax[2] = {widenedRect.right, widenedRect.bottom};
+        // start up to a terrain size towards the light, like the ray cast cascading into neighbours
+        long upwind = lightmapSize - 1;
+        long numSteps = rectMax[major] - rectMin[major] + upwind;
+        long majorStart = majorStep > 0 ? rectMin[major] - upwind : rectMax[major] - 1 + upwind;
+
+        // minor offset of the texel each line visits per step
+        std::vector<long> minorOffsets(numSteps);
+        for (long i = 0; i < numSteps; ++i)
+            minorOffsets[i] = static_cast<long>(std::floor(i * minorStep + 0.5f));
+        // lines are identified by their minor coordinate at the first step. Cover all texels of the rect.
+        long lineBegin = rectMin[minor] - std::max(minorOffsets[upwind], minorOffsets[numSteps - 1]);
+        long lineEnd = rectMax[minor] - std::min(minorOffsets[upwind], minorOffsets[numSteps - 1]);
+
+        auto sampleHeight = [this, lightmapSize](long x, long y, float& height)
+        {
+            Real tx = (Real)x / (lightmapSize - 1);
+            Real ty = (Real)y / (lightmapSize - 1);
+            long offsetX = tx < 0 ? -1 : (tx > 1 ? 1 : 0);
+            long offsetY = ty < 0 ? -1 : (ty > 1 ? 1 : 0);
+            if (!offsetX && !offsetY)
             {
-                float litVal = 1.0f;
-
-                // convert to terrain space (not points, allow this to go between points)
-                float Tx = (float)x / (float)(mLightmapSizeActual-1);
-                float Ty = (float)y / (float)(mLightmapSizeActual-1);
+                height = getHeightAtTerrainPosition(tx, ty);
+                return true;
+            }
+            // heights across the edge come from the neighbour
+            Terrain* neighbour = getNeighbour(getNeighbourIndex(offsetX, offsetY));
+            tx -= offsetX;
+            ty -= offsetY;
+            if (!neighbour || tx < 0 || tx > 1 || ty < 0 || ty > 1)
+                return false;
+            height = neighbour->getHeightAtTerrainPosition(tx, ty);
+            return true;
+        };
 
-                // get world space point
-                // add a little height padding to stop shadowing self
-                Vector3 wpos = Vector3::ZERO;
-                getPosition(Tx, Ty, getHeightAtTerrainPosition(Tx, Ty) + heightPad, &wpos);
-                wpos += getPosition();
-                // build ray, cast backwards along light direction
-                Ray ray(wpos, -lightVec);
+        WorkQueue::parallelFor(lineEnd - lineBegin, 16, [&](size_t begin, size_t end) {
+            for (long line = lineBegin + long(begin); line < lineBegin + long(end); ++line)
+            {
+                float horizon = -std::numeric_limits<float>::max();
+                for (long i = 0; i < numSteps; ++i)
+                {
+                    long coord[2];
+                    coord[major] = majorStart + i * majorStep;
+                    coord[minor] = line + minorOffsets[i];
 
-                // Cascade into neighbours when casting, but don't travel further
-                // than world size
-                std::pair<bool, Vector3> rayHit = rayIntersects(ray, true, mWorldSize);
+                    horizon -= horizonDrop;
+                    float height;
+                    if (!sampleHeight(coord[0], coord[1], height))
+                        continue;
 
-                if (rayHit.first)
-                    litVal = 0.0f;
+                    if (i >= upwind && coord[minor] >= rectMin[minor] && coord[minor] < rectMax[minor])
+                    {
+                        float litVal = horizon > height + heightPad ? 0.0f : 1.0f;
 
-                // encode as L8
-                // invert the Y to deal with image space
-                long storeX = x - widenedRect.left;
-                long storeY = widenedRect.bottom - y - 1;
+                        // encode as L8
+                        // invert the Y to deal with image space
+                        long storeX = coord[0] - widenedRect.left;
+                        long storeY = widenedRect.bottom - coord[1] - 1;
 
-                uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX);
-                *pStore = (unsigned char)(litVal * 255.0);
+                        uint8* pStore = pData + ((storeY * width) + storeX);
+                        *pStore = (unsigned char)(litVal * 255.0);
+                    }
 
+                    horizon = std::max(horizon, height);
+                }
             }
-        }
+        });
 
         return pixbox;
 
@@ -4377,6 +4747,7 @@ namespace Ogre
             Rect rect;
             rect.top = 0; rect.bottom = mSize;
             rect.left = 0; rect.right = mSize;
+            updateHeightBounds(rect);
             calculateHeightDeltas(rect);
             finaliseHeightDeltas(rect, true);
 
@@ -43,7 +43,6 @@ namespace Ogre
         : mParent(parent)
         , mLayerIdx(layerIndex)
         , mChannel((layerIndex-1) % 4)
-        , mDirty(false)
         , mBuffer(buf)
     {
         mData.create(PF_FLOAT32_R, mBuffer->getWidth(), mBuffer->getHeight());
@@ -148,34 +147,60 @@ namespace Ogre
     //---------------------------------------------------------------------
     void TerrainLayerBlendMap::dirtyRect(const Rect& rect)
     {
-        if (mDirty)
+        // beyond this many regions the per lock overhead outweighs the saved texels
+        static const size_t MAX_DIRTY_BOXES = 16;
+
+        Box box(rect);
+        for (size_t i = 0; i < mDirtyBoxes.size();)
         {
-            mDirtyBox.left = std::min(mDirtyBox.left, static_cast<uint32>(rect.left));
-            mDirtyBox.top = std::min(mDirtyBox.top, static_cast<uint32>(rect.top));
-            mDirtyBox.right = std::max(mDirtyBox.right, static_cast<uint32>(rect.right));
-            mDirtyBox.bottom = std::max(mDirtyBox.bottom, static_cast<uint32>(rect.bottom));
+            const Box& b = mDirtyBoxes[i];
+            if (b.left <= box.right && box.left <= b.right && b.top <= box.bottom && box.top <= b.bottom)
+            {
+                box.left = std::min(box.left, b.left);
+                box.top = std::min(box.top, b.top);
+                box.right = std::max(box.right, b.right);
+                box.bottom = std::max(box.bottom, b.bottom);
+                mDirtyBoxes[i] = mDirtyBoxes.back();
+                mDirtyBoxes.pop_back();
+                // the grown box may now touch regions we already checked
+                i = 0;
+            }
+            else
+                ++i;
         }
-        else
+
+        if (mDirtyBoxes.size() >= MAX_DIRTY_BOXES)
         {
-            mDirtyBox = Box(rect);
-            mDirty = true;
+            for (const Box& b : mDirtyBoxes)
+            {
+                box.left = std::min(box.left, b.left);
+                box.top = std::min(box.top, b.top);
+                box.right = std::max(box.right, b.right);
+                box.bottom = std::max(box.bottom, b.bottom);
+            }
+            mDirtyBoxes.clear();
         }
+        mDirtyBoxes.push_back(box);
     }
     //---------------------------------------------------------------------
     void TerrainLayerBlendMap::update()
     {
-        if (mData.getData() && mDirty)
+        if (!mData.getData())
+            return;
+
+        size_t dstInc = PixelUtil::getNumElemBytes(mBuffer->getFormat());
+        float blendToTerrain = (float)mParent->getSize() / (float)mBuffer->getWidth();
+        for (const Box& dirtyBox : mDirtyBoxes)
         {
             // Upload data
-            float* pSrcBase = mData.getData<float>(mDirtyBox.left, mDirtyBox.top);
-            uint8* pDstBase = mBuffer->lock(mDirtyBox, HardwarePixelBuffer::HBL_NORMAL).data;
+            float* pSrcBase = mData.getData<float>(dirtyBox.left, dirtyBox.top);
+            uint8* pDstBase = mBuffer->lock(dirtyBox, HardwarePixelBuffer::HBL_NORMAL).data;
             pDstBase += mChannelOffset;
-            size_t dstInc = PixelUtil::getNumElemBytes(mBuffer->getFormat());
-            for (size_t y = 0; y < mDirtyBox.getHeight(); ++y)
+            for (size_t y = 0; y < dirtyBox.getHeight(); ++y)
             {
                 float* pSrc = pSrcBase + y * mBuffer->getWidth();
                 uint8* pDst = pDstBase + y * mBuffer->getWidth() * dstInc;
-                for (size_t x = 0; x < mDirtyBox.getWidth(); ++x)
+                for (size_t x = 0; x < dirtyBox.getWidth(); ++x)
                 {
                     *pDst = static_cast<uint8>(*pSrc++ * 255);
                     pDst += dstInc;
@@ -183,19 +208,20 @@ namespace Ogre
             }
             mBuffer->unlock();
 
-            mDirty = false;
-
             // make sure composite map is updated
-            // mDirtyBox is in image space, convert to terrain units
+            // dirtyBox is in image space, convert to terrain units
             Rect compositeMapRect;
-            float blendToTerrain = (float)mParent->getSize() / (float)mBuffer->getWidth();
-            compositeMapRect.left = (mDirtyBox.left * blendToTerrain);
-            compositeMapRect.right = (mDirtyBox.right * blendToTerrain + 1);
-            compositeMapRect.top = ((mBuffer->getHeight() - mDirtyBox.bottom) * blendToTerrain);
-            compositeMapRect.bottom = ((mBuffer->getHeight() - mDirtyBox.top) * blendToTerrain + 1);
+            compositeMapRect.left = (dirtyBox.left * blendToTerrain);
+            compositeMapRect.right = (dirtyBox.right * blendToTerrain + 1);
+            compositeMapRect.top = ((mBuffer->getHeight() - dirtyBox.bottom) * blendToTerrain);
+            compositeMapRect.bottom = ((mBuffer->getHeight() - dirtyBox.top) * blendToTerrain + 1);
             mParent->_dirtyCompositeMapRect(compositeMapRect);
-            mParent->updateCompositeMapWithDelay();
+        }
 
+        if (!mDirtyBoxes.empty())
+        {
+            mDirtyBoxes.clear();
+            mParent->updateCompositeMapWithDelay();
         }
     }
     //---------------------------------------------------------------------
@@ -35,7 +35,76 @@ THE SOFTWARE.
 namespace Ogre
 {
     const uint32 TerrainLodManager::TERRAINLODDATA_CHUNK_ID = StreamSerialiser::makeIdentifier("TLDA");
-    const uint16 TerrainLodManager::TERRAINLODDATA_CHUNK_VERSION = 1;
+    const uint16 TerrainLodManager::TERRAINLODDATA_CHUNK_VERSION = 2;
+
+    namespace
+    {
+        /// calls func(x, y) for each vertex stored at the given LOD level, in the order of the file
+        template <typename Func>
+        void forEachVertexAtLod(uint16 size, uint16 numLodLevels, uint lodLevel, Func func)
+        {
+            unsigned int inc = 1 << lodLevel;
+            unsigned int prev = 1 << (lodLevel + 1);
+            bool coarsest = lodLevel == numLodLevels - static_cast<uint>(1);
+
+            for (uint16 y = 0; y < size; y += inc)
+            {
+                for (uint16 x = 0; x < size-1; x += inc)
+                    if (coarsest || (x % prev) || (y % prev))
+                        func(x, y);
+                if (coarsest || (y % prev))
+                    func(size-1, y);
+                if (y+inc > size)
+                    break;
+            }
+        }
+
+        /// interpolate a vertex between the vertices of the next coarser LOD level
+        template <typename Height>
+        int64 predictFromCoarser(uint16 x, uint16 y, uint lodLevel, Height height)
+        {
+            unsigned int inc = 1 << lodLevel;
+            unsigned int prev = 1 << (lodLevel + 1);
+            if ((x % prev) && (y % prev))
+                return (height(x - inc, y - inc) + height(x + inc, y - inc) + height(x - inc, y + inc) +
+                        height(x + inc, y + inc)) / 4;
+            if (x % prev)
+                return (height(x - inc, y) + height(x + inc, y)) / 2;
+            return (height(x, y - inc) + height(x, y + inc)) / 2;
+        }
+
+        int64 quantise(float value, float precision)
+        {
+            return static_cast<int64>(std::floor(double(value) / precision + 0.5));
+        }
+
+        void writeVarint(std::vector<uint8>& out, int64 value)
+        {
+            // zigzag, so small negative values stay short
+            uint64 bits = (uint64(value) << 1) ^ uint64(value >> 63);
+            while (bits >= 0x80)
+            {
+                out.push_back(uint8(bits) | 0x80);
+                bits >>= 7;
+            }
+            out.push_back(uint8(bits));
+        }
+
+        int64 readVarint(const uint8*& ptr, const uint8* end)
+        {
+            uint64 bits = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                if (ptr == end || shift > 63)
+                    OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt terrain LOD data");
+                uint8 byte = *ptr++;
+                bits |= uint64(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    break;
+            }
+            return int64(bits >> 1) ^ -int64(bits & 1);
+        }
+    }
 
     TerrainLodManager::TerrainLodManager(Terrain* t, DataStreamPtr& stream)
         : mTerrain(t)
@@ -221,19 +290,8 @@ namespace Ogre
         lods.resize(numLodLevels);
         for (int level = numLodLevels - 1; level >= 0; level--)
         {
-            unsigned int inc = 1 << level;
-            unsigned int prev = 1 << (level + 1);
-
-            for (uint16 y = 0; y < size; y += inc)
-            {
-                for (uint16 x = 0; x < size-1; x += inc)
-                    if ((level == numLodLevels - 1) || ((x % prev != 0) || (y % prev != 0)))
-                        lods[level].push_back( data[y*size + x] );
-                if ((level == numLodLevels -1) || (y % prev) != 0)
-                    lods[level].push_back( data[y*size + size-1] );
-                if (y+inc > size)
-                    break;
-            }
+            forEachVertexAtLod(size, numLodLevels, level,
+                               [&](uint16 x, uint16 y) { lods[level].push_back(data[y * size + x]); });
         }
     }
     //---------------------------------------------------------------------
@@ -301,12 +359,35 @@ namespace Ogre
         uint16 numLodLevels = terrain->getNumLodLevels();
 
         LodsData lods;
-        separateData(terrain->mHeightData, terrain->getSize(), numLodLevels, lods);
-        separateData(terrain->mDeltaData, terrain->getSize(), numLodLevels, lods);
+        if (TerrainGlobalOptions::getSingleton().getHeightSavePrecision() <= 0)
+        {
+            separateData(terrain->mHeightData, terrain->getSize(), numLodLevels, lods);
+            separateData(terrain->mDeltaData, terrain->getSize(), numLodLevels, lods);
+        }
+
+        float precision = TerrainGlobalOptions::getSingleton().getHeightSavePrecision();
+        std::vector<uint8> encoded;
 
         for (int level = numLodLevels - 1; level >=0; level--)
         {
-            stream.writeChunkBegin(TERRAINLODDATA_CHUNK_ID, TERRAINLODDATA_CHUNK_VERSION);
+            if (precision > 0)
+            {
+                // version 2 stores quantised data
+                encoded.clear();
+                encodeLodData(terrain, level, precision, encoded);
+                uint32 encodedSize = uint32(encoded.size());
+
+                stream.writeChunkBegin(TERRAINLODDATA_CHUNK_ID, TERRAINLODDATA_CHUNK_VERSION);
+                stream.startDeflate();
+                stream.write(&precision);
+                stream.write(&encodedSize);
+                stream.write(encoded.data(), encoded.size());
+                stream.stopDeflate();
+                stream.writeChunkEnd(TERRAINLODDATA_CHUNK_ID);
+                continue;
+            }
+
+            stream.writeChunkBegin(TERRAINLODDATA_CHUNK_ID, 1);
             stream.startDeflate();
             stream.write(&(lods[level][0]), lods[level].size());
             stream.stopDeflate();
@@ -341,6 +422,7 @@ namespace Ogre
             // uncompress
             uint maxSize = 2 * mTerrain->getGeoDataSizeAtLod(higherLodBound);
             float *lodData = OGRE_ALLOC_T(float, maxSize, MEMCATEGORY_GENERAL);
+            std::vector<uint8> encoded;
 
             for(int level=lowerLodBound; level>=higherLodBound; level-- )
             {
@@ -351,43 +433,86 @@ namespace Ogre
                 const StreamSerialiser::Chunk *c = stream.readChunkBegin(TERRAINLODDATA_CHUNK_ID,
                         TERRAINLODDATA_CHUNK_VERSION);
                 stream.startDeflate(c->length);
-                stream.read(lodData, dataSize);
+                if (c->version > 1)
+                {
+                    float precision;
+                    uint32 encodedSize;
+                    stream.read(&precision);
+                    stream.read(&encodedSize);
+                    encoded.resize(encodedSize);
+                    stream.read(encoded.data(), encodedSize);
+                    decodeLodData(level, precision, encoded, lodData, dataSize);
+                }
+                else
+                    stream.read(lodData, dataSize);
                 stream.stopDeflate();
                 stream.readChunkEnd(TERRAINLODDATA_CHUNK_ID);
 
                 fillBufferAtLod(level, lodData, dataSize);
             }
             stream.readChunkEnd(Terrain::TERRAIN_CHUNK_ID);
+            mTerrain->updateHeightBounds(Rect(0, 0, mTerrain->getSize(), mTerrain->getSize()));
 
             OGRE_FREE(lodData, MEMCATEGORY_GENERAL);
         }
     }
     void TerrainLodManager::fillBufferAtLod(uint lodLevel, const float* data, uint dataSize )
     {
-        unsigned int inc = 1 << lodLevel;
-        unsigned int prev = 1 << (lodLevel + 1);
-        uint16 numLodLevels = mTerrain->getNumLodLevels();
         uint16 size = mTerrain->getSize();
 
         const float* heightDataPtr = data;
         const float* deltaDataPtr = data+dataSize/2;
 
-        for (uint16 y = 0; y < size; y += inc)
-        {
-            for (uint16 x = 0; x < size-1; x += inc)
-                if ((lodLevel == numLodLevels - static_cast<uint>(1)) || (x % prev) || (y % prev))
-                {
-                    mTerrain->mHeightData[y*size + x] = *(heightDataPtr++);
-                    mTerrain->mDeltaData[y*size + x] = *(deltaDataPtr++);
-                }
-            if ((lodLevel == numLodLevels - static_cast<uint>(1)) || (y % prev))
-            {
-                mTerrain->mHeightData[y*size + size-1] = *(heightDataPtr++);
-                mTerrain->mDeltaData[y*size + size-1] = *(deltaDataPtr++);
-            }
-            if (y+inc > size)
-                break;
-        }
+        forEachVertexAtLod(size, mTerrain->getNumLodLevels(), lodLevel, [&](uint16 x, uint16 y) {
+            mTerrain->mHeightData[y*size + x] = *(heightDataPtr++);
+            mTerrain->mDeltaData[y*size + x] = *(deltaDataPtr++);
+        });
+    }
+    void TerrainLodManager::encodeLodData(const Terrain* terrain, uint lodLevel, float precision,
+                                          std::vector<uint8>& encoded)
+    {
+        uint16 size = terrain->getSize();
+        uint16 numLodLevels = terrain->getNumLodLevels();
+        auto height = [&](uint16 x, uint16 y) { return quantise(terrain->mHeightData[y*size + x], precision); };
+
+        // the coarsest level is predicted from the previous vertex, finer ones by interpolation
+        int64 previous = 0;
+        bool coarsest = lodLevel == numLodLevels - static_cast<uint>(1);
+        forEachVertexAtLod(size, numLodLevels, lodLevel, [&](uint16 x, uint16 y) {
+            int64 value = height(x, y);
+            int64 predicted = coarsest ? previous : predictFromCoarser(x, y, lodLevel, height);
+            previous = value;
+            writeVarint(encoded, value - predicted);
+        });
+
+        forEachVertexAtLod(size, numLodLevels, lodLevel, [&](uint16 x, uint16 y) {
+            writeVarint(encoded, quantise(terrain->mDeltaData[y*size + x], precision));
+        });
+    }
+    void TerrainLodManager::decodeLodData(uint lodLevel, float precision, const std::vector<uint8>& encoded,
+                                          float* data, uint dataSize)
+    {
+        uint16 size = mTerrain->getSize();
+        uint16 numLodLevels = mTerrain->getNumLodLevels();
+        const float* heights = mTerrain->mHeightData;
+        auto height = [&](uint16 x, uint16 y) { return quantise(heights[y*size + x], precision); };
+
+        const uint8* ptr = encoded.data();
+        const uint8* end = ptr + encoded.size();
+        float* heightDataPtr = data;
+        float* deltaDataPtr = data+dataSize/2;
+
+        int64 previous = 0;
+        bool coarsest = lodLevel == numLodLevels - static_cast<uint>(1);
+        forEachVertexAtLod(size, numLodLevels, lodLevel, [&](uint16 x, uint16 y) {
+            int64 predicted = coarsest ? previous : predictFromCoarser(x, y, lodLevel, height);
+            previous = predicted + readVarint(ptr, end);
+            *(heightDataPtr++) = float(previous * double(precision));
+        });
+
+        forEachVertexAtLod(size, numLodLevels, lodLevel, [&](uint16 x, uint16 y) {
+            *(deltaDataPtr++) = float(readVarint(ptr, end) * double(precision));
+        });
     }
     void TerrainLodManager::waitForDerivedProcesses()
     {
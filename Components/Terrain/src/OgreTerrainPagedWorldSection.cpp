@@ -51,7 +51,9 @@ namespace Ogre
     TerrainPagedWorldSection::~TerrainPagedWorldSection()
     {
         //remove the pending tasks, but keep the front one, as it may have been in running
-        if(!mPagesInLoading.empty())
+        if(!mHasRunningTasks)
+            mPagesInLoading.clear();
+        else if(!mPagesInLoading.empty())
             mPagesInLoading.erase( ++mPagesInLoading.begin(), mPagesInLoading.end() );
 
         while(!mPagesInLoading.empty())
@@ -189,6 +191,79 @@ namespace Ogre
         return mLoadingIntervalMs;
     }
 
+    //---------------------------------------------------------------------
+    void TerrainPagedWorldSection::setLookAheadTime(Real seconds)
+    {
+        getGridStrategyData()->setLookAheadTime(seconds);
+    }
+    //---------------------------------------------------------------------
+    Real TerrainPagedWorldSection::getLookAheadTime() const
+    {
+        return getGridStrategyData()->getLookAheadTime();
+    }
+    //---------------------------------------------------------------------
+    void TerrainPagedWorldSection::frameStart(Real timeSinceLastFrame)
+    {
+        PagedWorldSection::frameStart(timeSinceLastFrame);
+
+        unsigned long currentTime = Root::getSingletonPtr()->getTimer()->getMilliseconds();
+        for (size_t i = 0; i < mPagesInPreparation.size();)
+        {
+            PageID pageID = mPagesInPreparation[i];
+            long x, y;
+            mTerrainGroup->unpackIndex(pageID, &x, &y);
+            Terrain* terrain = mTerrainGroup->getTerrain(x, y);
+            if (terrain && !terrain->isLoaded())
+            {
+                ++i;
+                continue;
+            }
+
+            auto stats = mPageLoadStatistics.find(pageID);
+            if (terrain && stats != mPageLoadStatistics.end())
+                stats->second.loaded = currentTime;
+            mPagesInPreparation[i] = mPagesInPreparation.back();
+            mPagesInPreparation.pop_back();
+        }
+
+        // resume, if we were waiting for preparations to finish
+        if (!mHasRunningTasks && !mPagesInLoading.empty())
+            startNextPage();
+    }
+    //---------------------------------------------------------------------
+    void TerrainPagedWorldSection::startNextPage()
+    {
+        uint32 maxPreparations = mParent->getManager()->getMaxConcurrentPreparations();
+        if (mPagesInLoading.empty() ||
+            (maxPreparations && mPagesInPreparation.size() >= maxPreparations))
+        {
+            mHasRunningTasks = false;
+            return;
+        }
+
+        // move the most urgent page to the front, where the tasks pick it up
+        auto best = mPagesInLoading.begin();
+        Real bestPriority = std::numeric_limits<Real>::max();
+        for (auto it = mPagesInLoading.begin(); it != mPagesInLoading.end(); ++it)
+        {
+            Real priority = getStrategy()->getPagePriority(*it, this);
+            if (priority < bestPriority)
+            {
+                bestPriority = priority;
+                best = it;
+            }
+        }
+        mPagesInLoading.splice(mPagesInLoading.begin(), mPagesInLoading, best);
+
+        mHasRunningTasks = true;
+        Root::getSingleton().getWorkQueue()->addTask([this]() {
+            handleRequest(NULL, NULL);
+            if(mPagesInLoading.empty())
+                return;
+            // continue loading in main thread
+            Root::getSingleton().getWorkQueue()->addMainThreadTask([this]() { handleResponse(NULL, NULL); });
+        });
+    }
     //---------------------------------------------------------------------
     void TerrainPagedWorldSection::loadSubtypeData(StreamSerialiser& ser)
     {
@@ -224,28 +299,23 @@ namespace Ogre
             std::list<PageID>::iterator it = find( mPagesInLoading.begin(), mPagesInLoading.end(), pageID);
             if(it==mPagesInLoading.end())
             {
-                mPagesInLoading.push_back(pageID);
-                mHasRunningTasks = true;
+                it = mPagesInLoading.insert(mPagesInLoading.end(), pageID);
+                PageLoadStatistics stats = {Root::getSingletonPtr()->getTimer()->getMilliseconds(), 0, 0};
+                mPageLoadStatistics[pageID] = stats;
             }
-            
+
             // no running tasks, start the new one
-            if(mPagesInLoading.size()==1)
+            if(!mHasRunningTasks)
             {
                 if(forceSynchronous)
                 {
+                    mPagesInLoading.splice(mPagesInLoading.begin(), mPagesInLoading, it);
+                    mHasRunningTasks = true;
                     handleRequest(NULL, NULL);
                     handleResponse(NULL, NULL);
                 }
                 else
-                {
-                    Root::getSingleton().getWorkQueue()->addTask([this]() {
-                        handleRequest(NULL, NULL);
-                        if(mPagesInLoading.empty())
-                            return;
-                        // continue loading in main thread
-                        Root::getSingleton().getWorkQueue()->addMainThreadTask([this]() { handleResponse(NULL, NULL); });
-                    });
-                }
+                    startNextPage();
             }
         }
 
@@ -259,6 +329,8 @@ namespace Ogre
 
         PagedWorldSection::unloadPage(pageID, forceSynchronous);
 
+        mPageLoadStatistics.erase(pageID);
+
         std::list<PageID>::iterator it = find( mPagesInLoading.begin(), mPagesInLoading.end(), pageID);
         // hasn't been loaded, just remove from the queue
         if(it!=mPagesInLoading.end())
@@ -317,18 +389,16 @@ namespace Ogre
             mTerrainGroup->unpackIndex(pageID, &x, &y);
             mTerrainGroup->loadTerrain(x, y, false);
             mPagesInLoading.pop_front();
+            mPagesInPreparation.push_back(pageID);
 
             unsigned long currentTime = Root::getSingletonPtr()->getTimer()->getMilliseconds();
             mNextLoadingTime = currentTime + mLoadingIntervalMs;
+            auto stats = mPageLoadStatistics.find(pageID);
+            if (stats != mPageLoadStatistics.end())
+                stats->second.started = currentTime;
 
             // Continue loading other pages
-            Root::getSingleton().getWorkQueue()->addTask([this]() {
-                handleRequest(NULL, NULL);
-                if(mPagesInLoading.empty())
-                    return;
-                // continue loading in main thread
-                Root::getSingleton().getWorkQueue()->addMainThreadTask([this]() { handleResponse(NULL, NULL); });
-            });
+            startNextPage();
         }
         else
             mHasRunningTasks = false;
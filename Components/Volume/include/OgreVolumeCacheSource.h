@@ -29,6 +29,7 @@ THE SOFTWARE.
 #define __Ogre_Volume_CacheSource_H__
 
 #include "OgreVector.h"
+#include "Threading/OgreThreadHeaders.h"
 
 #include "OgreVolumeSource.h"
 #include "OgreVolumePrerequisites.h"
@@ -52,47 +53,81 @@ namespace Volume {
     bool _OgreVolumeExport operator<(const Vector3& a, const Vector3& b);
 
     /** A caching Source.
+
+        The density values and gradients are kept in a set associative hash table,
+        split in independently locked stripes, so the cache may be read and filled from
+        multiple threads at the same time. Each stripe starts empty and doubles its
+        number of sets, when a set runs full, until the memory budget is reached.
+        From then on, the oldest entry of a full set is replaced.
     */
     class _OgreVolumeExport CacheSource : public Source
     {
     protected:
-        
-        /// Map for the cache
-        typedef std::map<Vector3, Vector4> UMapPositionValue;
-        mutable UMapPositionValue mCache;
+
+        /// A cached density value (w-component) and gradient (x, y and z component)
+        struct CacheEntry
+        {
+            Vector3 position;
+            Vector4 value;
+            bool valid;
+            CacheEntry() : valid(false) {}
+        };
+
+        /// An independently growing part of the table, guarded by one lock
+        struct CacheStripe
+        {
+            OGRE_WQ_MUTEX(mutex);
+            std::vector<CacheEntry> entries;
+            /// The way to replace next, per set
+            std::vector<uint8> nextVictim;
+        };
+
+        /// Entries per set
+        static const size_t WAYS = 4;
+        /// Number of lock stripes, a power of two
+        static const size_t STRIPES = 64;
+        /// Sets of a stripe, once it stores the first value
+        static const size_t INITIAL_STRIPE_SETS = 4;
+
+        mutable std::vector<CacheStripe> mStripes;
+        /// Sets of a stripe, when the memory budget is reached
+        size_t mMaxStripeSets;
 
         /// The source to cache.
         const Source *mSrc;
         
+        /** Looks up a cached density value and gradient.
+        @return
+            Whether the position was cached.
+        */
+        bool lookup(const Vector3 &position, Vector4 &value) const;
+
+        /** Caches a density value and gradient, growing the stripe or replacing the oldest
+            entry of the set.
+        */
+        void store(const Vector3 &position, const Vector4 &value) const;
+
+        /// Doubles the sets of a stripe, the caller holds its lock
+        void grow(CacheStripe &stripe) const;
+
         /** Gets a density value and gradient from the cache.
         @param position
             The position of the density value and gradient.
         @return
             The density value (w-component) and the gradient (x, y and z component).
         */
-        inline Vector4 getFromCache(const Vector3 &position) const
-        {
-            Vector4 result;
-            std::map<Vector3, Vector4>::iterator it = mCache.find(position);
-            if (it == mCache.end())
-            {
-                result = mSrc->getValueAndGradient(position);
-                mCache[position] = result;
-            }
-            else
-            {
-                result = it->second;
-            }
-            return result;
-        }
+        Vector4 getFromCache(const Vector3 &position) const;
 
     public:
         
         /** Constructor.
         @param src
             The source to cache.
+        @param memoryBudget
+            The maximal size of the cache in bytes. It is rounded down to a power of two number
+            of sets. The memory is only allocated, as the cache fills.
         */
-        CacheSource(const Source *src);
+        CacheSource(const Source *src, size_t memoryBudget = 16 * 1024 * 1024);
         
         /** Overridden from Source.
         */
@@ -102,6 +137,28 @@ namespace Volume {
         */
         Real getValue(const Vector3 &position) const override;
 
+        /** Overridden from Source.
+        */
+        void getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const override;
+
+        /** Overridden from Source.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
+
+        /** Drops all cached values and frees their memory, e.g. after the cached source changed.
+        @note
+            Must not be called while other threads read from the cache.
+        */
+        void clear();
+
+        /** Gets the number of values the cache can hold, once the memory budget is reached.
+        */
+        size_t getCapacity() const { return STRIPES * mMaxStripeSets * WAYS; }
+
+        /** Gets the memory currently allocated for cached values in bytes.
+        */
+        size_t getMemoryUsage() const;
+
     };
     /** @} */
     /** @} */
@@ -96,12 +96,15 @@ namespace Volume {
         /// Whether to load the chunks async. if set to false, the call to load waits for the whole chunk. false is the default.
         bool async;
 
+        /// Whether to split the octree and contour the dualgrid of a single chunk on multiple threads of the WorkQueue. The source must support concurrent reads. false is the default.
+        bool parallelMeshing;
+
         /** Constructor.
         */
         ChunkParameters(void) :
             sceneManager(0), src(0), baseError((Real)0.0), errorMultiplicator((Real)1.0), createOctreeVisualization(false),
             createDualGridVisualization(false), skirtFactor(0), lodCallback(0), scale((Real)1.0), maxScreenSpaceError(0), createGeometryFromLevel(0),
-            updateFrom(Vector3::ZERO), updateTo(Vector3::ZERO), async(false)
+            updateFrom(Vector3::ZERO), updateTo(Vector3::ZERO), async(false), parallelMeshing(false)
         {
         }
     } ChunkParameters;
@@ -125,9 +128,22 @@ namespace Volume {
         /// The parameters with which the chunktree got loaded.
         ChunkParameters *parameters;
 
+        /// The parent scene node of the volume.
+        SceneNode *parent;
+
+        /// The back lower left corner of the world.
+        Vector3 totalFrom;
+
+        /// The front upper right corner of the world.
+        Vector3 totalTo;
+
+        /// The amount of LOD levels.
+        size_t maxLevels;
+
         /** Constructor.
         */
-        ChunkTreeSharedData(const ChunkParameters *params) : octreeVisible(false), dualGridVisible(false), volumeVisible(true), chunksBeingProcessed(0)
+        ChunkTreeSharedData(const ChunkParameters *params) : octreeVisible(false), dualGridVisible(false), volumeVisible(true), chunksBeingProcessed(0),
+            parent(0), totalFrom(Vector3::ZERO), totalTo(Vector3::ZERO), maxLevels(0)
         {
             this->parameters = new ChunkParameters(*params);
         }
@@ -173,6 +189,9 @@ namespace Volume {
 
         /// Whether this is an update of an existing tree
         bool isUpdate;
+
+        /// The generation of the chunk when this request was made.
+        size_t generation;
     };
 
     protected:
@@ -200,6 +219,9 @@ namespace Volume {
         /// Holds some shared data among all chunks of the tree.
         ChunkTreeSharedData *mShared;
 
+        /// Incremented on every update of this chunk, so results of outdated requests can be dropped.
+        size_t mGeneration;
+
         /** Loads a single chunk of the tree.
         @param parent
             The parent scene node for the volume
@@ -295,6 +317,14 @@ namespace Volume {
         */
         virtual void loadGeometry(MeshBuilder *meshBuilder, DualGridGenerator *dualGridGenerator, OctreeNode *root, size_t level, bool isUpdate);
 
+        /** Frees the geometry and the debug visualizations of this chunk and its children, when an
+            update removed the surface from them.
+        */
+        void unloadGeometry(void);
+
+        /// Destroys the debug visualization entities of this chunk.
+        void destroyVisualizations(void);
+
         /** Sets the visibility of this chunk.
         @param visible
             Whether this chunk is visible or not.
@@ -391,6 +421,18 @@ namespace Volume {
             The resource group where to search for the configuration file.
         */
         virtual void load(SceneNode *parent, SceneManager *sceneManager, const String& filename, bool validSourceResult = false, MeshBuilderCallback *lodCallback = 0, const String& resourceGroup = ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME);
+
+        /** Remeshes the chunks of all LOD levels intersecting a modified region of the source, for
+            example after TextureSource::combineWithSource. Only to be called on the loaded root chunk.
+            The meshes are rebuilt in the background if the tree got loaded async. The old geometry
+            of a chunk stays visible until its new mesh is ready and is then replaced at once.
+            The update vectors of the chunk parameters are zero again afterwards.
+        @param from
+            The back lower left corner of the modified region.
+        @param to
+            The front upper right corner of the modified region.
+        */
+        virtual void update(const Vector3 &from, const Vector3 &to);
         
         /** Shows the debug visualization entity of the dualgrid.
         @param visible
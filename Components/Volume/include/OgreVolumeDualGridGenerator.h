@@ -70,6 +70,9 @@ namespace Volume {
     class _OgreVolumeExport DualGridGenerator : public UtilityAlloc
     {
     protected:
+
+        /// The amount of independent steps of nodeProc, see nodeProcStep.
+        static const size_t NODE_PROC_STEPS;
         
         /// To give the debug manual object an unique name.
         static size_t mDualGridI;
@@ -189,12 +192,29 @@ namespace Volume {
             }
         }
 
+        /* Counts the leaves near the isosurface, an estimate of the dualcells which get contoured.
+        @param n
+            The node to start with.
+        @return
+            The amount of leaves near the isosurface.
+        */
+        static size_t countSurfaceLeaves(const OctreeNode *n);
+
         /* Startpoint for the creation recursion.
         @param n
             The node to start with.
         */
         void nodeProc(const OctreeNode *n);
 
+        /* Executes a single step of nodeProc on a subdivided node. The steps don't depend
+            on each other, so they can be run concurrently.
+        @param n
+            The node to work on.
+        @param step
+            The step, from 0 (nodeProc of the first child) to NODE_PROC_STEPS - 1 (vertProc).
+        */
+        void nodeProcStep(const OctreeNode *n, size_t step);
+
         /* faceProc with variing X and Y of the nodes, see the paper for faceProc().
             Direction of parameters: Z+ (n0 and n3 for example of parent cell)
         @param n0
@@ -319,8 +339,11 @@ namespace Volume {
             The global to.
         @param saveDualCells
             Whether to save the generated dualcells of the generated dual cells.
+        @param parallel
+            Whether to contour the subtrees of the root concurrently on the WorkQueue.
+            The generated mesh is the same, but the source must support concurrent reads.
         */
-        void generateDualGrid(const OctreeNode *root, IsoSurface *is, MeshBuilder *mb, Real maxMSDistance, const Vector3 &totalFrom, const Vector3 &totalTo, bool saveDualCells);
+        void generateDualGrid(const OctreeNode *root, IsoSurface *is, MeshBuilder *mb, Real maxMSDistance, const Vector3 &totalFrom, const Vector3 &totalTo, bool saveDualCells, bool parallel = false);
 
         /** Gets the lazily created entity of the dualgrid debug visualization.
         @param sceneManager
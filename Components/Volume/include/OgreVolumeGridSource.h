@@ -158,6 +158,14 @@ namespace Volume {
         */
         Real getValue(const Vector3 &position) const override;
 
+        /** Overridden from VolumeSource.
+        */
+        void getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const override;
+
+        /** Overridden from VolumeSource.
+        */
+        void getValues(const Vector3 *positions, Real *values, size_t count) const override;
+
         /** Gets the width of the texture.
         @return
             The width of the texture.
@@ -138,9 +138,11 @@ namespace Volume {
         /// The buffer binding.
         static const unsigned short MAIN_BINDING;
 
-        /// Map to get a vertex index.
-        typedef std::map<Vertex, size_t> UMapVertexIndex;
-        UMapVertexIndex mIndexMap;
+        /** Open addressing hash table to get a vertex index. Holds the index + 1 of the vertex,
+            0 marks a free slot. The size is always a power of two.
+        */
+        typedef std::vector<uint32> VecWeldTable;
+        VecWeldTable mWeldTable;
 
          /// Holds the vertices of the mesh.
         VecVertex mVertices;
@@ -153,6 +155,20 @@ namespace Volume {
 
         /// Holds whether the initial bounding box has been set
         bool mBoxInit;
+
+        /** Rebuilds the weld table with room for at least the given amount of vertices.
+        @param vertexCount
+            The amount of vertices to make room for.
+        */
+        void growWeldTable(size_t vertexCount);
+
+        /** Gets the index of a vertex, adding it if it is not known yet.
+        @param v
+            The vertex.
+        @return
+            The index of the vertex.
+        */
+        size_t weldVertex(const Vertex &v);
         
         /** Adds a vertex to the data structure, reusing the index if it is already known.
         @param v
@@ -160,52 +176,7 @@ namespace Volume {
         */
         inline void addVertex(const Vertex &v)
         {
-            size_t i = 0;
-            if (mIndexMap.find(v) == mIndexMap.end())
-            {
-                i = mVertices.size();
-                mIndexMap[v] = i;
-                mVertices.push_back(v);
-
-                // Update bounding box
-                if (!mBoxInit)
-                {
-                    mBox.setExtents(v.x, v.y, v.z, v.x, v.y, v.z);
-                    mBoxInit = true;
-                }
-                else
-                {
-                    if (v.x < mBox.getMinimum().x)
-                    {
-                        mBox.setMinimumX(v.x);
-                    }
-                    if (v.y < mBox.getMinimum().y)
-                    {
-                        mBox.setMinimumY(v.y);
-                    }
-                    if (v.z < mBox.getMinimum().z)
-                    {
-                        mBox.setMinimumZ(v.z);
-                    }
-                    if (v.x > mBox.getMaximum().x)
-                    {
-                        mBox.setMaximumX(v.x);
-                    }
-                    if (v.y > mBox.getMaximum().y)
-                    {
-                        mBox.setMaximumY(v.y);
-                    }
-                    if (v.z > mBox.getMaximum().z)
-                    {
-                        mBox.setMaximumZ(v.z);
-                    }
-                }
-            }
-            else
-            {
-                i = mIndexMap[v];
-            }
-            mIndices.push_back(i);
+            mIndices.push_back(weldVertex(v));
         }
 
     public:
@@ -301,6 +272,22 @@ namespace Volume {
             addVertex(Vertex(v2, n2));
         }
 
+        /** Reserves memory for the expected size of the mesh, to avoid rehashing and reallocation
+            while adding triangles.
+        @param vertexCount
+            The expected amount of unique vertices.
+        @param indexCount
+            The expected amount of indices, three per triangle.
+        */
+        void reserve(size_t vertexCount, size_t indexCount);
+
+        /** Appends the triangles of another MeshBuilder, reusing already existent vertices.
+            The result is the same as if the triangles had been added to this instance directly.
+        @param other
+            The MeshBuilder to take the triangles from.
+        */
+        void append(const MeshBuilder &other);
+
         /** Generates the vertex- and indexbuffer of this mesh on the given
             RenderOperation.
         @param operation
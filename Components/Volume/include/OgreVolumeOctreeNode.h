@@ -142,8 +142,11 @@ namespace Volume {
             The volume source.
         @param geometricError
             The accepted geometric error.
+        @param parallelDepth
+            The amount of top levels whose children are split concurrently on the WorkQueue.
+            The source must support concurrent reads if this is not 0.
         */
-        void split(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError);
+        void split(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError, size_t parallelDepth = 0);
 
         /** Getter for the octree debug visualization of the octree starting with
             this node.
@@ -101,6 +101,31 @@ namespace Volume {
         */
         virtual Real getValue(const Vector3 &position) const = 0;
 
+        /** Gets the density values and gradients at many positions at once.
+
+            Evaluating a whole brick in one call saves a virtual call per position and
+            lets sources process the positions in tight loops. The default implementation
+            calls getValueAndGradient for each position.
+        @param positions
+            The positions.
+        @param values
+            Will hold the gradient in x, y, z and the density in w for each position.
+        @param count
+            The amount of positions.
+        */
+        virtual void getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const;
+
+        /** Gets the density values at many positions at once.
+        @see getValuesAndGradients
+        @param positions
+            The positions.
+        @param values
+            Will hold the density for each position.
+        @param count
+            The amount of positions.
+        */
+        virtual void getValues(const Vector3 *positions, Real *values, size_t count) const;
+
         /** Serializes a volume source to a discrete grid file with deflated
         compression. To achieve better compression, all density values are clamped
         within a maximum absolute value of (to - from).length() / 16.0. The values
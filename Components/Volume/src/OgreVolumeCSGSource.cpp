@@ -30,6 +30,93 @@ THE SOFTWARE.
 namespace Ogre {
 namespace Volume {
 
+    namespace
+    {
+        /// Positions evaluated per brick by the operations, bounding their scratch buffers
+        const size_t BATCH_SIZE = 64;
+
+        inline Real density(Real value)
+        {
+            return value;
+        }
+
+        inline Real density(const Vector4 &value)
+        {
+            return value.w;
+        }
+
+        inline void evaluate(const Source *src, const Vector3 *positions, Real *values, size_t count)
+        {
+            src->getValues(positions, values, count);
+        }
+
+        inline void evaluate(const Source *src, const Vector3 *positions, Vector4 *values, size_t count)
+        {
+            src->getValuesAndGradients(positions, values, count);
+        }
+
+        /// Evaluates both sources brick by brick and lets op merge the values of b into the ones of a
+        template <typename T, typename Op>
+        void combine(const Source *a, const Source *b, const Vector3 *positions, T *values, size_t count, Op op)
+        {
+            T valuesB[BATCH_SIZE];
+            for (size_t start = 0; start < count; start += BATCH_SIZE)
+            {
+                size_t n = std::min(BATCH_SIZE, count - start);
+                evaluate(a, positions + start, values + start, n);
+                evaluate(b, positions + start, valuesB, n);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    op(values[start + i], valuesB[i]);
+                }
+            }
+        }
+
+        template <typename T>
+        void intersect(T &a, const T &b)
+        {
+            if (!(density(a) < density(b)))
+            {
+                a = b;
+            }
+        }
+
+        template <typename T>
+        void unite(T &a, const T &b)
+        {
+            if (!(density(a) > density(b)))
+            {
+                a = b;
+            }
+        }
+
+        template <typename T>
+        void subtract(T &a, const T &b)
+        {
+            intersect(a, T((Real)-1.0 * b));
+        }
+
+        /// Evaluates the source at the positions scaled down, brick by brick
+        template <typename T>
+        void scale(const Source *src, Real s, const Vector3 *positions, T *values, size_t count)
+        {
+            Vector3 scaled[BATCH_SIZE];
+            for (size_t start = 0; start < count; start += BATCH_SIZE)
+            {
+                size_t n = std::min(BATCH_SIZE, count - start);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    scaled[i] = positions[start + i] / s;
+                }
+                evaluate(src, scaled, values + start, n);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    values[start + i] = values[start + i] * s;
+                }
+            }
+        }
+    }
+
     Vector3 CSGCubeSource::mBoxNormals[6] = {
         Vector3::UNIT_X,
         Vector3::UNIT_Y,
@@ -69,6 +156,28 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGSphereSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Vector3 gradient = positions[i] - mCenter;
+            Real distance = gradient.normalise();
+            values[i] = Vector4(gradient.x, gradient.y, gradient.z, mR - distance);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGSphereSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = mR - (positions[i] - mCenter).length();
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGPlaneSource::CSGPlaneSource(const Real d, const Vector3 &normal) : mD(d), mNormal(normal.normalisedCopy())
     {
     }
@@ -96,6 +205,26 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGPlaneSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = Vector4(mNormal.x, mNormal.y, mNormal.z, mD - mNormal.dotProduct(positions[i]));
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGPlaneSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = mD - mNormal.dotProduct(positions[i]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGCubeSource::CSGCubeSource(const Vector3 &min, const Vector3 &max)
     {
         mBox.setExtents(min, max);
@@ -127,6 +256,26 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGCubeSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = CSGCubeSource::getValueAndGradient(positions[i]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGCubeSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = distanceTo(positions[i]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGOperationSource::CSGOperationSource(const Source *a, const Source *b) : mA(a), mB(b)
     {
     }
@@ -205,6 +354,20 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGIntersectionSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        combine(mA, mB, positions, values, count, intersect<Vector4>);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGIntersectionSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        combine(mA, mB, positions, values, count, intersect<Real>);
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGUnionSource::CSGUnionSource(const Source *a, const Source *b) : CSGOperationSource(a, b)
     {
     }
@@ -243,6 +406,20 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGUnionSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        combine(mA, mB, positions, values, count, unite<Vector4>);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGUnionSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        combine(mA, mB, positions, values, count, unite<Real>);
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGDifferenceSource::CSGDifferenceSource(const Source *a, const Source *b) : CSGOperationSource(a, b)
     {
     }
@@ -281,6 +458,20 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGDifferenceSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        combine(mA, mB, positions, values, count, subtract<Vector4>);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGDifferenceSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        combine(mA, mB, positions, values, count, subtract<Real>);
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGUnarySource::CSGUnarySource(const Source *src) : mSrc(src)
     {
     }
@@ -333,6 +524,28 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGNegateSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        mSrc->getValuesAndGradients(positions, values, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = (Real)-1.0 * values[i];
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGNegateSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        mSrc->getValues(positions, values, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = -values[i];
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGScaleSource::CSGScaleSource(const Source *src, const Real scale) : CSGUnarySource(src), mScale(scale)
     {
     }
@@ -353,6 +566,20 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGScaleSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        scale(mSrc, mScale, positions, values, count);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGScaleSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        scale(mSrc, mScale, positions, values, count);
+    }
+    
+    //-----------------------------------------------------------------------
+
     void CSGNoiseSource::setData(void)
     {
         mGradientOff = fabs(mFrequencies[0]);
@@ -403,6 +630,75 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGNoiseSource::getInternalValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        mSrc->getValues(positions, values, count);
+        Real toAdd[BATCH_SIZE];
+        for (size_t start = 0; start < count; start += BATCH_SIZE)
+        {
+            size_t n = std::min(BATCH_SIZE, count - start);
+            const Vector3 *brick = positions + start;
+            std::fill(toAdd, toAdd + n, (Real)0.0);
+            for (size_t o = 0; o < mNumOctaves; ++o)
+            {
+                Real frequency = mFrequencies[o];
+                Real amplitude = mAmplitudes[o];
+                for (size_t i = 0; i < n; ++i)
+                {
+                    toAdd[i] += mNoise.noise(brick[i].x * frequency, brick[i].y * frequency, brick[i].z * frequency) * amplitude;
+                }
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                values[start + i] += toAdd[i];
+            }
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGNoiseSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        // The position and its six central difference neighbours, each in its own run
+        Vector3 samples[7 * BATCH_SIZE];
+        Real sampled[7 * BATCH_SIZE];
+        const Vector3 offsets[7] = {
+            Vector3::ZERO,
+            Vector3(mGradientOff, 0, 0), Vector3(-mGradientOff, 0, 0),
+            Vector3(0, mGradientOff, 0), Vector3(0, -mGradientOff, 0),
+            Vector3(0, 0, mGradientOff), Vector3(0, 0, -mGradientOff)
+        };
+        for (size_t start = 0; start < count; start += BATCH_SIZE)
+        {
+            size_t n = std::min(BATCH_SIZE, count - start);
+            for (size_t k = 0; k < 7; ++k)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    samples[k * n + i] = positions[start + i] + offsets[k];
+                }
+            }
+            getInternalValues(samples, sampled, 7 * n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                values[start + i] = Vector4(
+                    -(sampled[n + i] - sampled[2 * n + i]),
+                    -(sampled[3 * n + i] - sampled[4 * n + i]),
+                    -(sampled[5 * n + i] - sampled[6 * n + i]),
+                    sampled[i]);
+            }
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGNoiseSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        getInternalValues(positions, values, count);
+    }
+    
+    //-----------------------------------------------------------------------
+
     long CSGNoiseSource::getSeed(void) const
     {
         return mSeed;
@@ -25,6 +25,7 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "OgreVolumeCacheSource.h"
+#include "OgreCommon.h"
 
 namespace Ogre {
 namespace Volume {
@@ -38,8 +39,140 @@ namespace Volume {
 
     //-----------------------------------------------------------------------
 
-    CacheSource::CacheSource(const Source *src) : mSrc(src)
+    CacheSource::CacheSource(const Source *src, size_t memoryBudget) : mStripes(STRIPES), mSrc(src)
     {
+        mMaxStripeSets = 1;
+        while (STRIPES * mMaxStripeSets * 2 * WAYS * sizeof(CacheEntry) <= memoryBudget)
+            mMaxStripeSets *= 2;
+    }
+    
+    //-----------------------------------------------------------------------
+
+    namespace
+    {
+        // the low bits pick the stripe, the remaining ones the set in it
+        uint32 hashPosition(const Vector3 &position)
+        {
+            return FastHash((const char*)position.ptr(), sizeof(Vector3));
+        }
+
+        size_t getSet(uint32 hash, size_t numSets, size_t stripes)
+        {
+            return (hash / stripes) & (numSets - 1);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool CacheSource::lookup(const Vector3 &position, Vector4 &value) const
+    {
+        uint32 hash = hashPosition(position);
+        CacheStripe& stripe = mStripes[hash & (STRIPES - 1)];
+        OGRE_WQ_LOCK_MUTEX(stripe.mutex);
+        if (stripe.entries.empty())
+            return false;
+        const CacheEntry* entries = &stripe.entries[getSet(hash, stripe.nextVictim.size(), STRIPES) * WAYS];
+        for (size_t i = 0; i < WAYS; ++i)
+        {
+            if (entries[i].valid && entries[i].position == position)
+            {
+                value = entries[i].value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void CacheSource::grow(CacheStripe &stripe) const
+    {
+        size_t numSets = stripe.nextVictim.empty() ? std::min(INITIAL_STRIPE_SETS, mMaxStripeSets)
+                                                   : stripe.nextVictim.size() * 2;
+        std::vector<CacheEntry> entries(numSets * WAYS);
+        // a set splits into two, so the entries of a set always fit
+        for (const CacheEntry& e : stripe.entries)
+        {
+            if (!e.valid)
+                continue;
+            CacheEntry* set = &entries[getSet(hashPosition(e.position), numSets, STRIPES) * WAYS];
+            size_t way = 0;
+            while (set[way].valid)
+                ++way;
+            set[way] = e;
+        }
+        stripe.entries.swap(entries);
+        stripe.nextVictim.assign(numSets, 0);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void CacheSource::store(const Vector3 &position, const Vector4 &value) const
+    {
+        uint32 hash = hashPosition(position);
+        CacheStripe& stripe = mStripes[hash & (STRIPES - 1)];
+        OGRE_WQ_LOCK_MUTEX(stripe.mutex);
+        if (stripe.entries.empty())
+            grow(stripe);
+
+        size_t set = getSet(hash, stripe.nextVictim.size(), STRIPES);
+        if (stripe.entries[set * WAYS + WAYS - 1].valid && stripe.nextVictim.size() < mMaxStripeSets)
+        {
+            grow(stripe);
+            set = getSet(hash, stripe.nextVictim.size(), STRIPES);
+        }
+
+        // fill the free ways first, then replace the oldest entry
+        CacheEntry* entries = &stripe.entries[set * WAYS];
+        size_t way = 0;
+        while (way < WAYS && entries[way].valid)
+            ++way;
+        if (way == WAYS)
+        {
+            way = stripe.nextVictim[set];
+            stripe.nextVictim[set] = uint8((way + 1) % WAYS);
+        }
+        entries[way].position = position;
+        entries[way].value = value;
+        entries[way].valid = true;
+    }
+
+    //-----------------------------------------------------------------------
+
+    Vector4 CacheSource::getFromCache(const Vector3 &position) const
+    {
+        Vector4 result;
+        if (!lookup(position, result))
+        {
+            // evaluated without holding a lock, another thread might store the same value meanwhile
+            result = mSrc->getValueAndGradient(position);
+            store(position, result);
+        }
+        return result;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void CacheSource::clear()
+    {
+        for (CacheStripe& stripe : mStripes)
+        {
+            std::vector<CacheEntry>().swap(stripe.entries);
+            std::vector<uint8>().swap(stripe.nextVictim);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t CacheSource::getMemoryUsage() const
+    {
+        size_t usage = 0;
+        for (CacheStripe& stripe : mStripes)
+        {
+            OGRE_WQ_LOCK_MUTEX(stripe.mutex);
+            usage += stripe.entries.size() * sizeof(CacheEntry) + stripe.nextVictim.size();
+        }
+        return usage;
     }
     
     //-----------------------------------------------------------------------
@@ -56,5 +189,57 @@ namespace Volume {
         return getFromCache(position).w;
     }
 
+    //-----------------------------------------------------------------------
+
+    void CacheSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        // Gather the misses of a brick to evaluate them in one go
+        static const size_t BATCH_SIZE = 64;
+        Vector3 missPositions[BATCH_SIZE];
+        Vector4 missValues[BATCH_SIZE];
+        size_t missIndices[BATCH_SIZE];
+        for (size_t start = 0; start < count; start += BATCH_SIZE)
+        {
+            size_t n = std::min(BATCH_SIZE, count - start);
+            size_t misses = 0;
+            for (size_t i = start; i < start + n; ++i)
+            {
+                if (!lookup(positions[i], values[i]))
+                {
+                    missPositions[misses] = positions[i];
+                    missIndices[misses++] = i;
+                }
+            }
+            if (!misses)
+            {
+                continue;
+            }
+            mSrc->getValuesAndGradients(missPositions, missValues, misses);
+            for (size_t i = 0; i < misses; ++i)
+            {
+                values[missIndices[i]] = missValues[i];
+                store(missPositions[i], missValues[i]);
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void CacheSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        // The cache holds the gradients too, so fetch them along
+        static const size_t BATCH_SIZE = 64;
+        Vector4 brick[BATCH_SIZE];
+        for (size_t start = 0; start < count; start += BATCH_SIZE)
+        {
+            size_t n = std::min(BATCH_SIZE, count - start);
+            getValuesAndGradients(positions + start, brick, n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                values[start + i] = brick[i].w;
+            }
+        }
+    }
+
 }
 }
\ No newline at end of file
@@ -70,6 +70,7 @@ namespace Volume {
             req.level = level;
             req.maxLevels = maxLevels;
             req.isUpdate = mShared->parameters->updateFrom != Vector3::ZERO || mShared->parameters->updateTo != Vector3::ZERO;
+            req.generation = mGeneration;
 
             req.root = OGRE_NEW OctreeNode(from, to);
             req.meshBuilder = OGRE_NEW MeshBuilder();
@@ -78,7 +79,15 @@ namespace Volume {
             Root::getSingleton().getWorkQueue()->addTask([this, req]() {
                 prepareGeometry(req.level, req.root, req.dualGridGenerator, req.meshBuilder, req.totalFrom, req.totalTo);
                 Root::getSingleton().getWorkQueue()->addMainThreadTask([this, req]() {
-                    loadGeometry(req.meshBuilder, req.dualGridGenerator, req.root, req.level, req.isUpdate);
+                    // A newer update of this chunk superseded this request.
+                    if (req.generation == mGeneration)
+                    {
+                        loadGeometry(req.meshBuilder, req.dualGridGenerator, req.root, req.level, req.isUpdate);
+                    }
+                    else
+                    {
+                        mShared->chunksBeingProcessed--;
+                    }
                     delete req.root;
                     delete req.meshBuilder;
                     delete req.dualGridGenerator;
@@ -158,7 +167,8 @@ namespace Volume {
     {
 
         // Handle the situation where we update an existing tree
-        if (mShared->parameters->updateFrom != Vector3::ZERO || mShared->parameters->updateTo != Vector3::ZERO)
+        bool isUpdate = mShared->parameters->updateFrom != Vector3::ZERO || mShared->parameters->updateTo != Vector3::ZERO;
+        if (isUpdate)
         {
             // Early out if an update of a part of the tree volume is going on and this chunk is outside of the area.
             AxisAlignedBox chunkCube(from, to);
@@ -167,26 +177,23 @@ namespace Volume {
             {
                 return;
             }
-            // Free memory from old mesh version
-            if (mRenderOp.vertexData)
-            {
-                OGRE_DELETE mRenderOp.vertexData;
-                mRenderOp.vertexData = 0;
-            }
-            if (mRenderOp.indexData)
-            {
-                OGRE_DELETE mRenderOp.indexData;
-                mRenderOp.indexData = 0;
-            }
+            // The old mesh stays until the new one is ready, pending results of earlier updates are dropped.
+            mGeneration++;
+        }
+        else
+        {
+            // Set to invisible for now.
+            mVisible = false;
+            mInvisible = true;
         }
-
-        // Set to invisible for now.
-        mVisible = false;
-        mInvisible = true;
         
         // Don't generate this chunk if it doesn't contribute to the whole volume.
         if (!contributesToVolumeMesh(from, to))
         {
+            if (isUpdate)
+            {
+                unloadGeometry();
+            }
             return;
         }
     
@@ -202,11 +209,12 @@ namespace Volume {
         OctreeNodeSplitPolicy policy(mShared->parameters->src,
             mShared->parameters->errorMultiplicator * mShared->parameters->baseError);
         mError = (Real)level * mShared->parameters->errorMultiplicator * mShared->parameters->baseError;
-        root->split(&policy, mShared->parameters->src, mError);
+        // Forking the first two levels gives up to 64 independent subtrees.
+        root->split(&policy, mShared->parameters->src, mError, mShared->parameters->parallelMeshing ? 2 : 0);
         Real maxMSDistance = (Real)level * mShared->parameters->errorMultiplicator * mShared->parameters->baseError * mShared->parameters->skirtFactor;
         IsoSurface *is = OGRE_NEW IsoSurfaceMC(mShared->parameters->src);
         dualGridGenerator->generateDualGrid(root, is, meshBuilder, maxMSDistance, totalFrom, totalTo,
-            mShared->parameters->createDualGridVisualization);
+            mShared->parameters->createDualGridVisualization, mShared->parameters->parallelMeshing);
         OGRE_DELETE is;
     }
     
@@ -214,6 +222,16 @@ namespace Volume {
 
     void Chunk::loadGeometry(MeshBuilder *meshBuilder, DualGridGenerator *dualGridGenerator, OctreeNode *root, size_t level, bool isUpdate)
     {
+        if (isUpdate)
+        {
+            // Swap in the new mesh, so there is no frame without geometry.
+            OGRE_DELETE mRenderOp.vertexData;
+            mRenderOp.vertexData = 0;
+            OGRE_DELETE mRenderOp.indexData;
+            mRenderOp.indexData = 0;
+            destroyVisualizations();
+        }
+
         size_t chunkTriangles = meshBuilder->generateBuffers(mRenderOp);
         mInvisible = chunkTriangles == 0;
 
@@ -226,14 +244,21 @@ namespace Volume {
 
         if (!mInvisible)
         {
-            if (isUpdate)
+            if (!isAttached())
             {
-                mNode->detachObject(this);
+                mNode->attachObject(this);
             }
-            mNode->attachObject(this);
+        }
+        else if (isAttached())
+        {
+            mNode->detachObject(this);
         }
 
-        mVisible = false;
+        // An updated chunk keeps its visibility, it is only changed with the next LOD selection.
+        if (!isUpdate)
+        {
+            mVisible = false;
+        }
 
         if (mShared->parameters->createDualGridVisualization)
         {
@@ -256,8 +281,58 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void Chunk::unloadGeometry(void)
+    {
+        // Drops the results of requests still in flight.
+        mGeneration++;
+        if (isAttached())
+        {
+            mNode->detachObject(this);
+        }
+        OGRE_DELETE mRenderOp.vertexData;
+        mRenderOp.vertexData = 0;
+        OGRE_DELETE mRenderOp.indexData;
+        mRenderOp.indexData = 0;
+        destroyVisualizations();
+        mVisible = false;
+        mInvisible = true;
+
+        if (mChildren)
+        {
+            mChildren[0]->unloadGeometry();
+            if (mChildren[1])
+            {
+                mChildren[1]->unloadGeometry();
+                mChildren[2]->unloadGeometry();
+                mChildren[3]->unloadGeometry();
+                mChildren[4]->unloadGeometry();
+                mChildren[5]->unloadGeometry();
+                mChildren[6]->unloadGeometry();
+                mChildren[7]->unloadGeometry();
+            }
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void Chunk::destroyVisualizations(void)
+    {
+        if (mDualGrid)
+        {
+            mShared->parameters->sceneManager->destroyEntity(mDualGrid);
+            mDualGrid = 0;
+        }
+        if (mOctree)
+        {
+            mShared->parameters->sceneManager->destroyEntity(mOctree);
+            mOctree = 0;
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     Chunk::Chunk(void) : mNode(0), mError(false), mDualGrid(0), mOctree(0), mChildren(0),
-        mInvisible(false), isRoot(false), mShared(0)
+        mInvisible(false), isRoot(false), mShared(0), mGeneration(0)
     {
     }
     
@@ -332,10 +407,12 @@ namespace Volume {
         if (parameters->updateFrom == Vector3::ZERO && parameters->updateTo == Vector3::ZERO)
         {
             mShared = new ChunkTreeSharedData(parameters);
+            mShared->parent = parent;
+            mShared->totalFrom = from;
+            mShared->totalTo = to;
+            mShared->maxLevels = level;
             parent->scale(Vector3(parameters->scale));
         }
-
-        mShared->chunksBeingProcessed = 0;
         
         doLoad(parent, from, to, from, to, level, level);
 
@@ -359,6 +436,32 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void Chunk::update(const Vector3 &from, const Vector3 &to)
+    {
+        OgreAssert(isRoot && mShared, "update needs a loaded root chunk");
+
+        mShared->parameters->updateFrom = from;
+        mShared->parameters->updateTo = to;
+
+        doLoad(mShared->parent, mShared->totalFrom, mShared->totalTo, mShared->totalFrom, mShared->totalTo, mShared->maxLevels, mShared->maxLevels);
+
+        // The requests know that they are updates, later loads of the tree must not be partial.
+        mShared->parameters->updateFrom = Vector3::ZERO;
+        mShared->parameters->updateTo = Vector3::ZERO;
+
+        // Wait for the threads.
+        if (!mShared->parameters->async)
+        {
+            while(mShared->chunksBeingProcessed)
+            {
+                OGRE_THREAD_SLEEP(0);
+                Root::getSingleton().getWorkQueue()->processMainThreadTasks();
+            }
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     void Chunk::load(SceneNode *parent, SceneManager *sceneManager, const String& filename, bool validSourceResult, MeshBuilderCallback *lodCallback, const String& resourceGroup)
     {
         ConfigFile config;
@@ -392,6 +495,7 @@ namespace Volume {
         parameters.createDualGridVisualization = StringConverter::parseBool(config.getSetting("createDualGridVisualization"));
         parameters.skirtFactor = StringConverter::parseReal(config.getSetting("skirtFactor"));
         parameters.async = async;
+        parameters.parallelMeshing = StringConverter::parseBool(config.getSetting("parallelMeshing"));
     
         load(parent, from, to, level, &parameters);
         
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "OgreManualObject.h"
 #include "OgreSceneManager.h"
 #include "OgreVolumeMeshBuilder.h"
+#include "OgreWorkQueue.h"
 
 namespace Ogre {
 namespace Volume {
@@ -36,54 +37,70 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    const size_t DualGridGenerator::NODE_PROC_STEPS = 27;
+    
+    //-----------------------------------------------------------------------
+
     void DualGridGenerator::nodeProc(const OctreeNode *n)
     {
         if (n->isSubdivided())
         {
-        
-            const OctreeNode *c0 = n->getChild(0);
-            const OctreeNode *c1 = n->getChild(1);
-            const OctreeNode *c2 = n->getChild(2);
-            const OctreeNode *c3 = n->getChild(3);
-            const OctreeNode *c4 = n->getChild(4);
-            const OctreeNode *c5 = n->getChild(5);
-            const OctreeNode *c6 = n->getChild(6);
-            const OctreeNode *c7 = n->getChild(7);
-
-            nodeProc(c0);
-            nodeProc(c1);
-            nodeProc(c2);
-            nodeProc(c3);
-            nodeProc(c4);
-            nodeProc(c5);
-            nodeProc(c6);
-            nodeProc(c7);
-        
-            faceProcXY(c0, c3);
-            faceProcXY(c1, c2);
-            faceProcXY(c4, c7);
-            faceProcXY(c5, c6);
-
-            faceProcZY(c0, c1);
-            faceProcZY(c3, c2);
-            faceProcZY(c4, c5);
-            faceProcZY(c7, c6);
-
-            faceProcXZ(c4, c0);
-            faceProcXZ(c5, c1);
-            faceProcXZ(c7, c3);
-            faceProcXZ(c6, c2);
-        
-            edgeProcX(c0, c3, c7, c4);
-            edgeProcX(c1, c2, c6, c5);
-
-            edgeProcY(c0, c1, c2, c3);
-            edgeProcY(c4, c5, c6, c7);
-
-            edgeProcZ(c7, c6, c2, c3);
-            edgeProcZ(c4, c5, c1, c0);
+            for (size_t step = 0; step < NODE_PROC_STEPS; ++step)
+            {
+                nodeProcStep(n, step);
+            }
+        }
+    }
+    
+    //-----------------------------------------------------------------------
 
-            vertProc(c0, c1, c2, c3, c4, c5, c6, c7);
+    void DualGridGenerator::nodeProcStep(const OctreeNode *n, size_t step)
+    {
+        const OctreeNode *c0 = n->getChild(0);
+        const OctreeNode *c1 = n->getChild(1);
+        const OctreeNode *c2 = n->getChild(2);
+        const OctreeNode *c3 = n->getChild(3);
+        const OctreeNode *c4 = n->getChild(4);
+        const OctreeNode *c5 = n->getChild(5);
+        const OctreeNode *c6 = n->getChild(6);
+        const OctreeNode *c7 = n->getChild(7);
+
+        switch (step)
+        {
+        case 0: nodeProc(c0); break;
+        case 1: nodeProc(c1); break;
+        case 2: nodeProc(c2); break;
+        case 3: nodeProc(c3); break;
+        case 4: nodeProc(c4); break;
+        case 5: nodeProc(c5); break;
+        case 6: nodeProc(c6); break;
+        case 7: nodeProc(c7); break;
+
+        case 8: faceProcXY(c0, c3); break;
+        case 9: faceProcXY(c1, c2); break;
+        case 10: faceProcXY(c4, c7); break;
+        case 11: faceProcXY(c5, c6); break;
+
+        case 12: faceProcZY(c0, c1); break;
+        case 13: faceProcZY(c3, c2); break;
+        case 14: faceProcZY(c4, c5); break;
+        case 15: faceProcZY(c7, c6); break;
+
+        case 16: faceProcXZ(c4, c0); break;
+        case 17: faceProcXZ(c5, c1); break;
+        case 18: faceProcXZ(c7, c3); break;
+        case 19: faceProcXZ(c6, c2); break;
+
+        case 20: edgeProcX(c0, c3, c7, c4); break;
+        case 21: edgeProcX(c1, c2, c6, c5); break;
+
+        case 22: edgeProcY(c0, c1, c2, c3); break;
+        case 23: edgeProcY(c4, c5, c6, c7); break;
+
+        case 24: edgeProcZ(c7, c6, c2, c3); break;
+        case 25: edgeProcZ(c4, c5, c1, c0); break;
+
+        case 26: vertProc(c0, c1, c2, c3, c4, c5, c6, c7); break;
         }
     }
     
@@ -464,13 +481,29 @@ namespace Volume {
 
     //-----------------------------------------------------------------------
 
+    size_t DualGridGenerator::countSurfaceLeaves(const OctreeNode *n)
+    {
+        if (!n->isSubdivided())
+        {
+            return n->isIsoSurfaceNear() ? 1 : 0;
+        }
+        size_t count = 0;
+        for (size_t i = 0; i < OctreeNode::OCTREE_CHILDREN_COUNT; ++i)
+        {
+            count += countSurfaceLeaves(n->getChild(i));
+        }
+        return count;
+    }
+
+    //-----------------------------------------------------------------------
+
     DualGridGenerator::DualGridGenerator(): mDualGrid(0), mRoot(0), mSaveDualCells(0), mIs(0), mMb(0), mMaxMSDistance(0)
     {
     }
     
     //-----------------------------------------------------------------------
 
-    void DualGridGenerator::generateDualGrid(const OctreeNode *root, IsoSurface *is, MeshBuilder *mb, Real maxMSDistance, const Vector3 &totalFrom, const Vector3 &totalTo, bool saveDualCells)
+    void DualGridGenerator::generateDualGrid(const OctreeNode *root, IsoSurface *is, MeshBuilder *mb, Real maxMSDistance, const Vector3 &totalFrom, const Vector3 &totalTo, bool saveDualCells, bool parallel)
     {
         mRoot = root;
         mIs = is;
@@ -480,7 +513,43 @@ namespace Volume {
         mTotalTo = totalTo;
         mSaveDualCells = saveDualCells;
 
-        nodeProc(root);
+        // Roughly one vertex and two triangles per contoured dualcell, this saves most of the
+        // rehashing and reallocation while contouring and merging the steps.
+        size_t surfaceCells = countSurfaceLeaves(root);
+        mb->reserve(surfaceCells, surfaceCells * 6);
+
+        if (parallel && root->isSubdivided())
+        {
+            // Every step of the root contours into its own MeshBuilder. Merging them in
+            // the order of the steps gives exactly the mesh of the sequential traversal.
+            std::vector<MeshBuilder> builders(NODE_PROC_STEPS);
+            std::vector<VecDualCell> dualCells(NODE_PROC_STEPS);
+            WorkQueue::parallelFor(NODE_PROC_STEPS, 1, [&](size_t begin, size_t end) {
+                for (size_t step = begin; step < end; ++step)
+                {
+                    DualGridGenerator generator;
+                    generator.mRoot = root;
+                    generator.mIs = is;
+                    generator.mMb = &builders[step];
+                    generator.mMaxMSDistance = maxMSDistance;
+                    generator.mTotalFrom = totalFrom;
+                    generator.mTotalTo = totalTo;
+                    generator.mSaveDualCells = saveDualCells;
+                    generator.nodeProcStep(root, step);
+                    dualCells[step].swap(generator.mDualCells);
+                }
+            });
+
+            for (size_t step = 0; step < NODE_PROC_STEPS; ++step)
+            {
+                mb->append(builders[step]);
+                mDualCells.insert(mDualCells.end(), dualCells[step].begin(), dualCells[step].end());
+            }
+        }
+        else
+        {
+            nodeProc(root);
+        }
 
         // Build up a minimal dualgrid for octrees without children.
         if (!root->isSubdivided())
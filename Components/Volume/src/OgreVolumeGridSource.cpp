@@ -198,6 +198,26 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
     
+    void GridSource::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = GridSource::getValueAndGradient(positions[i]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+    
+    void GridSource::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = GridSource::getValue(positions[i]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+    
     size_t GridSource::getWidth(void) const
     {
         return mWidth;
@@ -231,7 +251,6 @@ namespace Volume {
         // cells anyway.
         bool oldTrilinearValue = mTrilinearValue;
         mTrilinearValue = false;
-        float value;
         int x, y;
         Vector3 scaledCenter(center.x * mPosXScale, center.y * mPosYScale, center.z * mPosZScale);
         int xStart = Math::Clamp(static_cast<int>(scaledCenter.x - radius * mPosXScale), 0, static_cast<int>(mWidth));
@@ -240,18 +259,21 @@ namespace Volume {
         int yEnd = Math::Clamp(static_cast<int>(scaledCenter.y + radius * mPosYScale), 0, static_cast<int>(mHeight));
         int zStart = Math::Clamp(static_cast<int>(scaledCenter.z - radius * mPosZScale), 0, static_cast<int>(mDepth));
         int zEnd = Math::Clamp(static_cast<int>(scaledCenter.z + radius * mPosZScale), 0, static_cast<int>(mDepth));
-        Vector3 pos;
+        // Evaluate a row at a time
+        std::vector<Vector3> row(std::max(xEnd - xStart, 0));
+        std::vector<Real> rowValues(row.size());
         for (int z = zStart; z < zEnd; ++z)
         {
             for (y = yStart; y < yEnd; ++y)
             {
                 for (x = xStart; x < xEnd; ++x)
                 {
-                    pos.x = x * worldWidthScale;
-                    pos.y = y * worldHeightScale;
-                    pos.z = z * worldDepthScale;
-                    value = operation->getValue(pos);
-                    setVolumeGridValue(x, y, z, value);
+                    row[x - xStart] = Vector3(x * worldWidthScale, y * worldHeightScale, z * worldDepthScale);
+                }
+                operation->getValues(row.data(), rowValues.data(), row.size());
+                for (x = xStart; x < xEnd; ++x)
+                {
+                    setVolumeGridValue(x, y, z, rowValues[x - xStart]);
                 }
             }
         }
@@ -45,18 +45,18 @@ namespace Volume {
     {
         unsigned char cubeIndex = 0;
         Vector4 values[8];
+        if (volumeValues)
+        {
+            std::copy(volumeValues, volumeValues + 8, values);
+        }
+        else
+        {
+            mSrc->getValuesAndGradients(corners, values, 8);
+        }
 
         // Find out the case.
         for (size_t i = 0; i < 8; ++i)
         {
-            if (volumeValues)
-            {
-                values[i] = volumeValues[i];
-            }
-            else
-            {
-                values[i] = mSrc->getValueAndGradient(corners[i]);
-            }
             if (values[i].w >= ISO_LEVEL)
             {
                 cubeIndex |= 1 << i;
@@ -138,18 +138,22 @@ namespace Volume {
     {
         unsigned char squareIndex = 0;
         Vector4 values[4];
-
-        // Find out the case.
-        for (size_t i = 0; i < 4; ++i)
+        if (volumeValues)
         {
-            if (volumeValues)
+            for (size_t i = 0; i < 4; ++i)
             {
                 values[i] = Vector4(volumeValues[indices[i]].w);
             }
-            else
-            {
-                values[i] = mSrc->getValueAndGradient(corners[indices[i]]);
-            }
+        }
+        else
+        {
+            const Vector3 squareCorners[4] = {corners[indices[0]], corners[indices[1]], corners[indices[2]], corners[indices[3]]};
+            mSrc->getValuesAndGradients(squareCorners, values, 4);
+        }
+
+        // Find out the case.
+        for (size_t i = 0; i < 4; ++i)
+        {
             if (values[i].w >= ISO_LEVEL)
             {
                 squareIndex |= 1 << i;
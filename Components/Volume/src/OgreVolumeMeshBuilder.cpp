@@ -65,6 +65,100 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void MeshBuilder::growWeldTable(size_t vertexCount)
+    {
+        // Keep the load factor at or below one half so the probe sequences stay short.
+        size_t size = 64;
+        while (size < vertexCount * 2)
+        {
+            size *= 2;
+        }
+        if (size <= mWeldTable.size())
+        {
+            return;
+        }
+
+        mWeldTable.assign(size, 0);
+        const size_t mask = size - 1;
+        for (size_t i = 0; i < mVertices.size(); ++i)
+        {
+            size_t slot = FastHash((const char*)&mVertices[i], sizeof(Real) * 3) & mask;
+            while (mWeldTable[slot])
+            {
+                slot = (slot + 1) & mask;
+            }
+            mWeldTable[slot] = static_cast<uint32>(i + 1);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    size_t MeshBuilder::weldVertex(const Vertex &v)
+    {
+        if ((mVertices.size() + 1) * 2 > mWeldTable.size())
+        {
+            growWeldTable(mVertices.size() + 1);
+        }
+
+        // Vertices are only welded if they are bitwise identical, hashing the position is enough.
+        const size_t mask = mWeldTable.size() - 1;
+        size_t slot = FastHash((const char*)&v, sizeof(Real) * 3) & mask;
+        while (uint32 entry = mWeldTable[slot])
+        {
+            if (memcmp(&mVertices[entry - 1], &v, sizeof(Vertex)) == 0)
+            {
+                return entry - 1;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        size_t i = mVertices.size();
+        mWeldTable[slot] = static_cast<uint32>(i + 1);
+        mVertices.push_back(v);
+
+        // Update bounding box
+        if (!mBoxInit)
+        {
+            mBox.setExtents(v.x, v.y, v.z, v.x, v.y, v.z);
+            mBoxInit = true;
+        }
+        else
+        {
+            mBox.merge(Vector3(v.x, v.y, v.z));
+        }
+        return i;
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void MeshBuilder::reserve(size_t vertexCount, size_t indexCount)
+    {
+        growWeldTable(vertexCount);
+        mVertices.reserve(vertexCount);
+        mIndices.reserve(indexCount);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void MeshBuilder::append(const MeshBuilder &other)
+    {
+        reserve(mVertices.size() + other.mVertices.size(), mIndices.size() + other.mIndices.size());
+
+        // Weld the vertices of other once, in order of their first use, so the indices match a sequential build.
+        VecIndices remap(other.mVertices.size());
+        for (size_t i = 0; i < other.mVertices.size(); ++i)
+        {
+            remap[i] = weldVertex(other.mVertices[i]);
+        }
+
+        for (VecIndices::const_iterator it = other.mIndices.begin(); it != other.mIndices.end(); ++it)
+        {
+            mIndices.push_back(remap[*it]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     size_t MeshBuilder::generateBuffers(RenderOperation &operation)
     {
         // Early out if nothing to do.
@@ -98,6 +192,11 @@ namespace Volume {
     
         bind->setBinding(0, vbuf);
 
+#if OGRE_DOUBLE_PRECISION == 0
+        // Vertex has the same layout as the buffer, so upload it as it is.
+        static_assert(sizeof(Vertex) == sizeof(float) * 6, "Vertex does not match the buffer layout");
+        vbuf->writeData(0, vbuf->getSizeInBytes(), &mVertices[0], true);
+#else
         float* vertices = static_cast<float*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
     
         VecVertex::const_iterator endVertices = mVertices.end();
@@ -112,6 +211,7 @@ namespace Volume {
         }
 
         vbuf->unlock();
+#endif
     
         // Get Indexarray
         operation.indexData = OGRE_NEW IndexData();
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "OgreVolumeSource.h"
 #include "OgreVolumeOctreeNodeSplitPolicy.h"
 #include "OgreSceneManager.h"
+#include "OgreWorkQueue.h"
 
 namespace Ogre {
 namespace Volume {
@@ -103,7 +104,7 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
-    void OctreeNode::split(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError)
+    void OctreeNode::split(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError, size_t parallelDepth)
     {
         if (splitPolicy->doSplit(this, geometricError))
         {
@@ -119,21 +120,31 @@ namespace Volume {
             */
             mChildren = new OctreeNode*[OCTREE_CHILDREN_COUNT];
             mChildren[0] = createInstance(mFrom, newCenter);
-            mChildren[0]->split(splitPolicy, src, geometricError);
             mChildren[1] = createInstance(mFrom + xWidth, newCenter + xWidth);
-            mChildren[1]->split(splitPolicy, src, geometricError);
             mChildren[2] = createInstance(mFrom + xWidth + zWidth, newCenter + xWidth + zWidth);
-            mChildren[2]->split(splitPolicy, src, geometricError);
             mChildren[3] = createInstance(mFrom + zWidth, newCenter + zWidth);
-            mChildren[3]->split(splitPolicy, src, geometricError);
             mChildren[4] = createInstance(mFrom + yWidth, newCenter + yWidth);
-            mChildren[4]->split(splitPolicy, src, geometricError);
             mChildren[5] = createInstance(mFrom + yWidth + xWidth, newCenter + yWidth + xWidth);
-            mChildren[5]->split(splitPolicy, src, geometricError);
             mChildren[6] = createInstance(mFrom + yWidth + xWidth + zWidth, newCenter + yWidth + xWidth + zWidth);
-            mChildren[6]->split(splitPolicy, src, geometricError);
             mChildren[7] = createInstance(mFrom + yWidth + zWidth, newCenter + yWidth + zWidth);
-            mChildren[7]->split(splitPolicy, src, geometricError);
+
+            if (parallelDepth > 0)
+            {
+                // The octants don't share any state, so their subtrees can be built independently.
+                WorkQueue::parallelFor(OCTREE_CHILDREN_COUNT, 1, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        mChildren[i]->split(splitPolicy, src, geometricError, parallelDepth - 1);
+                    }
+                });
+            }
+            else
+            {
+                for (size_t i = 0; i < OCTREE_CHILDREN_COUNT; ++i)
+                {
+                    mChildren[i]->split(splitPolicy, src, geometricError);
+                }
+            }
         }
         else
         {
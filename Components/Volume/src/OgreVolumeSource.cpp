@@ -61,6 +61,26 @@ namespace Volume {
 
     //-----------------------------------------------------------------------
 
+    void Source::getValuesAndGradients(const Vector3 *positions, Vector4 *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = getValueAndGradient(positions[i]);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Source::getValues(const Vector3 *positions, Real *values, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = getValue(positions[i]);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
     void Source::serialize(const Vector3 &from, const Vector3 &to, float voxelWidth, const String &file)
     {
         Real maxClampedAbsoluteDensity = (from - to).length() / (Real)16.0;
@@ -93,8 +113,9 @@ namespace Volume {
         ser.write<size_t>(&gridHeight);
         ser.write<size_t>(&gridDepth);
 
-        // Go over the volume and write the density data.
-        Vector3 pos;
+        // Go over the volume and write the density data, a column at a time.
+        std::vector<Vector3> column(gridHeight);
+        std::vector<Real> columnValues(gridHeight);
         Real realVal;
         size_t x;
         size_t y;
@@ -106,10 +127,14 @@ namespace Volume {
             {
                 for (y = 0; y < gridHeight; ++y)
                 {
-                    pos.x = x * voxelWidth + from.x;
-                    pos.y = y * voxelWidth + from.y;
-                    pos.z = z * voxelWidth + from.z;
-                    realVal = Math::Clamp<Real>(getValue(pos), -maxClampedAbsoluteDensity, maxClampedAbsoluteDensity);
+                    column[y].x = x * voxelWidth + from.x;
+                    column[y].y = y * voxelWidth + from.y;
+                    column[y].z = z * voxelWidth + from.z;
+                }
+                getValues(column.data(), columnValues.data(), gridHeight);
+                for (y = 0; y < gridHeight; ++y)
+                {
+                    realVal = Math::Clamp<Real>(columnValues[y], -maxClampedAbsoluteDensity, maxClampedAbsoluteDensity);
                     buffer[bufferI] = Bitwise::floatToHalf(realVal);
                     bufferI++;
                     if (bufferI == SERIALIZATION_CHUNK_SIZE)
@@ -167,6 +167,8 @@ namespace Ogre {
         bool mAlwaysUpdateMainSkeleton : 1;
         /// Flag indicating whether to update the bounding box from the bones of the skeleton.
         bool mUpdateBoundingBoxFromSkeleton : 1;
+        /// Flag indicating whether the meshlets of the SubMeshes are culled per camera.
+        bool mClusterCulling : 1;
         /// Flag indicating whether we have a vertex program in use on any of our subentities.
         bool mVertexProgramInUse : 1;
         /// Has this entity been initialised yet?
@@ -864,6 +866,25 @@ namespace Ogre {
             return mUpdateBoundingBoxFromSkeleton;
         }
 
+        /** If true, only the meshlets of the SubMeshes, which are in the view frustum and not facing away
+            from the camera, are rendered (see SubMesh::meshlets).
+
+            The culling runs on the CPU for each camera. The remaining index ranges are copied into an
+            index buffer owned by the SubEntity, whenever the set of visible meshlets changes.
+            Useful for large static meshes, that are only partially visible.
+        @par
+            Culling is suspended while a LOD level other than 0 is displayed, for entities with
+            skeletal or vertex animation and during shadow texture rendering. Back-facing meshlets are
+            kept for non uniformly scaled nodes, reflected cameras and materials with passes using a
+            culling mode other than CULL_CLOCKWISE.
+        */
+        void setClusterCulling(bool enabled);
+
+        /// Returns whether the meshlets of the SubMeshes are culled, see setClusterCulling
+        bool getClusterCulling() const {
+            return mClusterCulling;
+        }
+
         
     };
     /** @} */
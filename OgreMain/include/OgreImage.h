@@ -426,7 +426,13 @@ namespace Ogre {
         {
             FILTER_NEAREST,
             FILTER_LINEAR,
-            FILTER_BILINEAR = FILTER_LINEAR
+            FILTER_BILINEAR = FILTER_LINEAR,
+            /// separable box filter, averages all covered pixels. The classic mipmap filter
+            FILTER_BOX,
+            /// separable Kaiser windowed sinc filter. Sharper than FILTER_BOX
+            FILTER_KAISER,
+            /// separable Lanczos filter with 3 lobes. Sharpest, but may ring at hard edges
+            FILTER_LANCZOS
         };
         /** Scale a 1D, 2D or 3D image volume. 
             @param  src         PixelBox containing the source pointer, dimensions and format
@@ -439,6 +445,26 @@ namespace Ogre {
         
         /** Resize a 2D image, applying the appropriate filter. */
         void resize(ushort width, ushort height, Filter filter = FILTER_BILINEAR);
+
+        /** Generate the full mipmap chain of this image on the CPU
+
+            Each level is filtered from the previous one, which is kept in float precision, so
+            the base level is converted only once. Mipmaps already present are replaced.
+            @param filter the filter used for reducing the levels. FILTER_NEAREST and FILTER_LINEAR
+            are treated as FILTER_BOX
+            @param gammaCorrect filter in linear space. Use this for images storing sRGB colours
+        */
+        void generateMipmaps(Filter filter = FILTER_BOX, bool gammaCorrect = false);
+
+        /** Encode all faces and mipmaps of this image to a block compressed format on the CPU
+
+            Rows of blocks are encoded concurrently on the WorkQueue. Save the result to .dds or .ktx
+            to keep it in a compressed file.
+            @param format one of #PF_DXT1, #PF_DXT3, #PF_DXT5, #PF_BC4_UNORM, #PF_BC5_UNORM, #PF_BC7_UNORM,
+            #PF_ETC1_RGB8, #PF_ETC2_RGB8 or #PF_ETC2_RGBA8
+            @param quality in [0, 1], trades encoding speed for lower error
+        */
+        void compress(PixelFormat format, float quality = 0.5f);
         
         /// Static function to calculate size in bytes from the number of mipmaps, faces and the dimensions
         static size_t calculateSize(uint32 mipmaps, uint32 faces, uint32 width, uint32 height, uint32 depth, PixelFormat format);
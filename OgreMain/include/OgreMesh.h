@@ -95,6 +95,7 @@ namespace Ogre {
         friend class MeshSerializerImpl_v1_3;
         friend class MeshSerializerImpl_v1_2;
         friend class MeshSerializerImpl_v1_1;
+        friend class MeshSerializerImpl_Flat;
 
     public:
         typedef std::vector<Real> LodValueList;
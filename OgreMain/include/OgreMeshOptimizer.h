@@ -0,0 +1,162 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __MeshOptimizer_H__
+#define __MeshOptimizer_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+    /** Reorders the index and vertex data of meshes for faster rendering.
+
+        The following passes are available, which are applied in this order:
+        - vertex cache: triangles are reordered per index buffer to maximise post-transform
+        vertex cache hits, using the algorithm by Tom Forsyth
+        - overdraw: clusters of cache coherent triangles are sorted, so that outward facing
+        clusters are drawn first and occlude the rest of the mesh
+        - meshlets: the triangles of each submesh are grouped into small spatially coherent
+        clusters with bounds for culling, see SubMesh::meshlets
+        - vertex fetch: vertices are reordered in the order they are first referenced,
+        so the GPU reads the vertex buffers linearly
+
+        Only triangle lists are processed.
+    */
+    class _OgreExport MeshOptimizer
+    {
+    public:
+        enum Passes
+        {
+            MO_VERTEX_CACHE = 1,
+            MO_OVERDRAW = 2,
+            MO_VERTEX_FETCH = 4,
+            MO_MESHLETS = 8,
+            /// all reordering passes, the meshlets have to be requested explicitly
+            MO_ALL = MO_VERTEX_CACHE | MO_OVERDRAW | MO_VERTEX_FETCH
+        };
+
+        /// @param passes combination of #Passes
+        explicit MeshOptimizer(uint32 passes = MO_VERTEX_CACHE | MO_VERTEX_FETCH);
+
+        /** Sets the vertex cache size assumed for optimising and for the ACMR
+
+            Modern GPUs do not use a fixed size FIFO, but 16 is a good approximation of their behaviour.
+        */
+        void setCacheSize(uint32 size) { mCacheSize = size; }
+        uint32 getCacheSize() const { return mCacheSize; }
+
+        /** Sets how much the ACMR may grow by sorting for overdraw
+
+            @param threshold 1.05 allows the ACMR to get worse by 5%, which results in more clusters
+        */
+        void setOverdrawThreshold(float threshold) { mOverdrawThreshold = threshold; }
+        float getOverdrawThreshold() const { return mOverdrawThreshold; }
+
+        /** Sets the maximal size of the meshlets
+
+            Smaller meshlets are culled more precisely, but each costs a bounds test per frame.
+            @param maxVertices maximal number of unique vertices per meshlet. Default is 64.
+            @param maxTriangles maximal number of triangles per meshlet. Default is 124.
+        */
+        void setMeshletSize(uint32 maxVertices, uint32 maxTriangles)
+        {
+            mMeshletMaxVertices = std::max(maxVertices, 3u);
+            mMeshletMaxTriangles = std::max(maxTriangles, 1u);
+        }
+        uint32 getMeshletMaxVertices() const { return mMeshletMaxVertices; }
+        uint32 getMeshletMaxTriangles() const { return mMeshletMaxTriangles; }
+
+        /** Optimises all submeshes and generated LOD levels of the mesh
+
+            Index buffers shared between LOD levels, like compressed ones, are split at the bounds
+            of the levels for the vertex cache and overdraw passes, so every level keeps its
+            triangles. The vertex fetch pass remaps the indices of all indexed submeshes,
+            whatever their operation type. It is skipped for meshes with poses or vertex
+            animation and for shared vertices used by a submesh without indices, while bone
+            assignments are remapped. Meshlets of submeshes, whose triangles
+            are reordered without #MO_MESHLETS, are discarded.
+        */
+        void optimise(Mesh* mesh);
+
+        /// Reorders the triangles of the index data to maximise vertex cache hits
+        void optimiseVertexCache(IndexData* indexData) const;
+
+        /// Sorts clusters of triangles front to back, if they do not make the ACMR exceed the threshold
+        void optimiseOverdraw(IndexData* indexData, const VertexData* vertexData) const;
+
+        /** Partitions the triangles of the submesh into meshlets
+
+            The triangles are grouped greedily by connectivity, position and orientation, preserving
+            their order within a meshlet. Then they are reordered, so each meshlet is a contiguous
+            range of the index data. Only #VET_FLOAT3 positions are supported.
+            @return false, if the submesh is not supported. Its meshlets are cleared then.
+        */
+        bool buildMeshlets(SubMesh* subMesh) const;
+
+        /** Reorders the vertices by their first reference in the index data
+
+            Vertices that are not referenced are moved to the end.
+            @param vertexData the vertex data to reorder
+            @param indexData all index data referencing vertexData, in order of priority. The indices are remapped.
+            @return mapping from the old to the new vertex index
+        */
+        static std::vector<uint32> optimiseVertexFetch(VertexData* vertexData,
+                                                       const std::vector<IndexData*>& indexData);
+
+        /** Get the average cache miss ratio of the index data, assuming a FIFO cache
+
+            @return ratio of vertex cache misses to the triangle count (0.5 - 3.0)
+        */
+        float getAvgCacheMissRatio(const IndexData* indexData) const;
+
+        /// ACMR of all processed index data before the last call to optimise()
+        float getAvgCacheMissRatioBefore() const { return mAcmrBefore; }
+        /// ACMR of all processed index data after the last call to optimise()
+        float getAvgCacheMissRatioAfter() const { return mAcmrAfter; }
+    private:
+        uint32 mPasses;
+        uint32 mCacheSize;
+        float mOverdrawThreshold;
+        uint32 mMeshletMaxVertices;
+        uint32 mMeshletMaxTriangles;
+        float mAcmrBefore;
+        float mAcmrAfter;
+    };
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
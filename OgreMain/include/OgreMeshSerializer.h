@@ -41,7 +41,7 @@ namespace Ogre {
     /// Mesh compatibility versions
     enum MeshVersion 
     {
-        /// Latest version available
+        /// Latest version available. #MESH_VERSION_14_2 for meshes with meshlets, else #MESH_VERSION_1_10
         MESH_VERSION_LATEST,
         
         /// OGRE version v1.10+
@@ -56,7 +56,18 @@ namespace Ogre {
         MESH_VERSION_1_0,
         
         /// Legacy versions, DO NOT USE for writing
-        MESH_VERSION_LEGACY
+        MESH_VERSION_LEGACY,
+
+        /** Flat container of the renderable data, that loads without per element parsing
+
+            Meshes with poses or vertex animation can not be written in this format.
+            Edge lists and submesh extremity points are not stored, edge lists are
+            rebuilt on demand after loading.
+        */
+        MESH_VERSION_FLAT,
+
+        /// OGRE version v14.2+, adds SubMesh::meshlets
+        MESH_VERSION_14_2
     };
 
     /** \addtogroup Core
@@ -143,12 +154,37 @@ namespace Ogre {
         void setListener(MeshSerializerListener *listener);
         /// Returns the current listener
         MeshSerializerListener *getListener();
+
+        /// Encodings that can be applied to the buffers of a #MESH_VERSION_FLAT mesh
+        enum EncodingFlags
+        {
+            /// store buffers in GPU layout, so they are uploaded without any decoding
+            EF_NONE = 0,
+            /** quantise #VES_POSITION to 16 bit per component, relative to the bounds of the buffer
+
+                This is lossy. The positions are dequantised to #VET_FLOAT3 on import.
+            */
+            EF_QUANTISE_POSITIONS = 1,
+            /// delta code vertex and index streams. This is lossless and decodes at close to memcpy speed.
+            EF_COMPRESS_STREAMS = 2
+        };
+
+        /** Sets the encodings used when exporting #MESH_VERSION_FLAT meshes
+
+            To reduce the size of the vertex data on the GPU as well, convert the elements to compact types
+            prior to exporting, e.g. #VET_INT_10_10_10_2_NORM normals and #VET_USHORT2_NORM texture coordinates
+            via VertexData::convertVertexElement.
+            @param flags combination of #EncodingFlags
+        */
+        void setEncodingFlags(uint32 flags) { mEncodingFlags = flags; }
+        uint32 getEncodingFlags() const { return mEncodingFlags; }
         
     private:
         typedef std::vector<MeshVersionData*> MeshVersionDataList;
         MeshVersionDataList mVersionData;
 
         MeshSerializerListener *mListener;
+        uint32 mEncodingFlags;
 
     };
 
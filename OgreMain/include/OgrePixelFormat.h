@@ -646,6 +646,10 @@ namespace Ogre {
             @param  dst         PixelBox containing the destination pixels, pitches and format
             @remarks The source and destination boxes must have the same
             dimensions. In case the source and destination format match, a plain copy is done.
+            @remarks The DXT, BC4/BC5, ETC1/ETC2 and EAC block formats can be decompressed to any
+            uncompressed format. The source box then has to span whole slices. Likewise DXT1/3/5, BC4/BC5,
+            ETC1 and ETC2 RGB/RGBA can be encoded from any uncompressed format, see Image::compress
+            to control the quality.
         */
         static void bulkPixelConversion(const PixelBox &src, const PixelBox &dst);
 
@@ -177,6 +177,8 @@ namespace Ogre {
             Vector3 scale;
         };
         typedef std::vector<QueuedGeometry*> QueuedGeometryList;
+        /// Lock pointers of all buffers involved in a build
+        typedef std::map<const HardwareBuffer*, void*> BufferLockMap;
         
         // forward declarations
         class LODBucket;
@@ -203,6 +205,8 @@ namespace Ogre {
             size_t mMaxVertexIndex;
         public:
             GeometryBucket(MaterialBucket* parent, const VertexData* vData, const IndexData* iData);
+            /// Construct from data written by save
+            GeometryBucket(MaterialBucket* parent, StreamSerialiser& stream);
             virtual ~GeometryBucket();
             MaterialBucket* getParent(void) { return mParent; }
             /// Get the vertex data for this geometry 
@@ -222,8 +226,24 @@ namespace Ogre {
             @return false if there is no room left in this bucket
             */
             bool assign(QueuedGeometry* qsm);
-            /// Build
+            /// Create the buffers for the assigned geometry, which is copied by copyGeometry
             void build(bool stencilShadows);
+            /** Transform and copy queued geometry into the buffers of this bucket
+
+                Every geometry only touches its own range of the buffers, so distinct
+                geometry can be copied concurrently.
+            @param qgeom The queued geometry
+            @param vertexStart, indexStart Where it starts in the buffers of this bucket
+            @param locks The locked source and destination buffers
+            */
+            void copyGeometry(const QueuedGeometry* qgeom, uint32 vertexStart, size_t indexStart,
+                              const BufferLockMap& locks) const;
+            /// Prepare the copied geometry for stencil shadow volumes
+            void prepareForShadowVolume(void);
+            /// Write the built geometry to a stream
+            void save(StreamSerialiser& stream) const;
+            /// Get the geometry assigned to this bucket
+            const QueuedGeometryList& getQueuedGeometry(void) const { return mQueuedGeometry; }
             /// Dump contents for diagnostics
             _OgreExport friend std::ostream& operator<<(std::ostream& o, const GeometryBucket& b);
         };
@@ -256,8 +276,12 @@ namespace Ogre {
             const String& getMaterialName(void) const { return mMaterial->getName(); }
             /// Assign geometry to this bucket
             void assign(QueuedGeometry* qsm);
-            /// Build
+            /// Load the material and create the geometry buffers
             void build(bool stencilShadows);
+            /// Write the built geometry buckets to a stream
+            void save(StreamSerialiser& stream) const;
+            /// Read geometry buckets written by save and load the material
+            void load(StreamSerialiser& stream);
             /// Add children to the render queue
             void addRenderables(RenderQueue* queue, uint8 group, 
                 Real lodValue);
@@ -314,8 +338,14 @@ namespace Ogre {
             Real getLodValue(void) const { return mLodValue; }
             /// Assign a queued submesh to this bucket, using specified mesh LOD
             void assign(QueuedSubMesh* qsm, ushort atLod);
-            /// Build
+            /// Create the material buckets and their geometry buffers
             void build(bool stencilShadows);
+            /// Prepare the copied geometry for stencil shadows and build the edge list
+            void buildShadowData(void);
+            /// Write the built material buckets to a stream
+            void save(StreamSerialiser& stream) const;
+            /// Read material buckets written by save
+            void load(StreamSerialiser& stream);
             /// Add children to the render queue
             void addRenderables(RenderQueue* queue, uint8 group, 
                 Real lodValue);
@@ -387,8 +417,22 @@ namespace Ogre {
             StaticGeometry* getParent(void) const { return mParent;}
             /// Assign a queued mesh to this region, read for final build
             void assign(QueuedSubMesh* qmesh);
-            /// Build this region
+            /** Build the buckets of this region
+
+                The geometry buffers are only filled in by StaticGeometry::build afterwards,
+                all regions at once.
+            */
             void build(bool stencilShadows);
+            /// Write the bounds, LOD values and the built geometry to a stream
+            void save(StreamSerialiser& stream) const;
+            /// Read the bounds and LOD values written by save, but not the geometry
+            void prepare(StreamSerialiser& stream);
+            /// Read the geometry written by save, following prepare
+            void load(StreamSerialiser& stream, bool stencilShadows);
+            /// Drop the geometry and remove the region from the scene, it can be loaded again
+            void unload(void);
+            /// Whether the region has geometry, either built or loaded
+            bool isLoaded(void) const { return !mLodBucketList.empty(); }
             /// Get the region ID of this region
             uint32 getID(void) const { return mRegionID; }
             /// Get the centre point of the region
@@ -422,6 +466,17 @@ namespace Ogre {
             _OgreExport friend std::ostream& operator<<(std::ostream& o, const Region& r);
             
         };
+        /** Listener for the regions streamed in and out, see loadRegions.
+        */
+        class _OgreExport Listener
+        {
+        public:
+            virtual ~Listener() {}
+            /// Called on the main thread, once a region has been loaded and attached to the scene
+            virtual void regionLoaded(StaticGeometry* geometry, Region* region) {}
+            /// Called before a region is unloaded
+            virtual void regionUnloaded(StaticGeometry* geometry, Region* region) {}
+        };
         /** Indexed region map based on packed x/y/z region index, 10 bits for
             each axis.
 
@@ -463,6 +518,30 @@ namespace Ogre {
         /// Map of regions
         RegionMap mRegionMap;
 
+        /// Region streaming state
+        struct StreamedRegion
+        {
+            /// Where the geometry of the region starts in the region cache
+            size_t offset;
+            /// Size of the geometry of the region in bytes
+            size_t size;
+            /// Last frame a camera was within the unload distance
+            unsigned long lastFrame;
+            /// Whether the region is being loaded in the background
+            bool pending;
+        };
+        typedef std::map<uint32, StreamedRegion> StreamedRegionMap;
+        StreamedRegionMap mStreamedRegions;
+        struct RegionCache;
+        /// Shared with the loading tasks in flight
+        std::shared_ptr<RegionCache> mRegionCache;
+        Real mStreamingHysteresis;
+        Listener* mListener;
+        class StreamingListener;
+        std::unique_ptr<StreamingListener> mStreamingListener;
+        /// Reads a streamed region on the WorkQueue and loads it on the main thread
+        void loadRegionAsync(uint32 id, const StreamedRegion& streamed);
+
         /** Virtual method for getting a region most suitable for the
             passed in bounds. Can be overridden by subclasses.
         */
@@ -473,6 +552,8 @@ namespace Ogre {
         virtual Region* getRegion(ushort x, ushort y, ushort z, bool autoCreate);
         /** Get the region using a packed index, returns null if it doesn't exist. */
         virtual Region* getRegion(uint32 index);
+        /** Create a region and add it to the scene, but not to a node yet */
+        Region* createRegion(uint32 index, const Vector3& centre);
         /** Get the region indexes for a point.
         */
         virtual void getRegionIndexes(const Vector3& point, 
@@ -499,6 +580,13 @@ namespace Ogre {
         /** Split some shared geometry into dedicated geometry. */
         void splitGeometry(VertexData* vd, IndexData* id, 
             SubMeshLodGeometryLink* targetGeomLink);
+        /** Copy the queued geometry into the buffers of all geometry buckets
+
+            The regions are filled one after the other. Their buffers are locked
+            on the calling thread, while the geometry is transformed and copied
+            on the WorkQueue worker threads.
+        */
+        void fillGeometryBuckets(void);
 
         typedef std::map<size_t, size_t> IndexRemap;
         /** Method for figuring out which vertices are used by an index buffer
@@ -587,12 +675,78 @@ namespace Ogre {
             options which have been set, this method constructs the batched 
             geometry structures required. The batches are added to the scene 
             and will be rendered unless you specifically hide them.
+        @par
+            The vertices are transformed and copied on the worker threads of
+            the WorkQueue, if there are any. The result does not depend on the
+            number of threads.
         @note
-            Once you have called this method, you can no longer add any more 
+            Once you have called this method, you can no longer add any more
             entities.
         */
         virtual void build(void);
 
+        /** Save the built regions to a cache file.
+
+            The file can be loaded with loadRegions, instead of queueing and building
+            the geometry again. Each region is stored separately, so that regions can
+            be streamed in as the camera approaches them.
+        @note
+            The file stores the geometry in the native byte order and references
+            materials by name. Treat it as a cache, that is rebuilt when the source
+            meshes change.
+        @param filename The file to write, in the writable location of the default resource
+            group if there is one
+        */
+        void saveRegions(const String& filename);
+        /// @overload
+        void saveRegions(const DataStreamPtr& stream);
+
+        /** Load regions written by saveRegions, replacing any built geometry.
+
+            Queued geometry is not touched, so you can still call build() later.
+        @param filename The file to read
+        @param groupName The resource group to look for the file in
+        @param streaming If false, all regions are loaded right away. Otherwise only the
+            bounds of the regions are read and the file is kept open. Regions are then loaded
+            when a camera comes within the rendering distance and unloaded once all cameras
+            are beyond the rendering distance times the streaming hysteresis.
+            Without a rendering distance, all regions are requested by the first update.
+            The file is read on the WorkQueue and the hardware buffers are created
+            by a main thread task, so a region appears a few frames after it was
+            requested. See Listener to be notified.
+        */
+        void loadRegions(const String& filename, const String& groupName = RGN_DEFAULT,
+                         bool streaming = false);
+        /// @overload
+        void loadRegions(const DataStreamPtr& stream, bool streaming = false);
+
+        /** Load and unload streamed regions for a camera.
+
+            This is called automatically for the camera of every viewport, before
+            searching for visible objects. You can call it for other positions of
+            interest, for example to preload the regions around a spawn point.
+            Regions stay loaded while any camera wanted them in this or the
+            previous frame. Loading finishes asynchronously, when the WorkQueue
+            processes its main thread tasks.
+        */
+        void updateRegionStreaming(const Camera* cam);
+
+        /** Sets how far beyond the rendering distance streamed regions are kept.
+
+            Regions are unloaded once farther than the rendering distance times
+            this factor, so that moving back and forth at the edge does not
+            load the same region over and over.
+        @param factor At least 1. The default is 1.25.
+        */
+        void setStreamingHysteresis(Real factor);
+        /// Gets how far beyond the rendering distance streamed regions are kept
+        Real getStreamingHysteresis(void) const { return mStreamingHysteresis; }
+
+        /// Sets a listener to be notified when streamed regions are loaded or unloaded
+        void setListener(Listener* listener) { mListener = listener; }
+        /// Gets the listener for streamed regions
+        Listener* getListener(void) const { return mListener; }
+
         /** Destroys all the built geometry state (reverse of build). 
 
             You can call build() again after this and it will pick up all the
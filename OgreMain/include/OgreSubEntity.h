@@ -117,6 +117,19 @@ namespace Ogre {
         /// The camera for which the cached distance is valid
         mutable const Camera *mCachedCamera;
 
+        /// Index data of the meshlets, that passed cluster culling
+        std::unique_ptr<IndexData> mClusterIndexData;
+        /// Which meshlets are contained in mClusterIndexData
+        std::vector<bool> mVisibleClusters;
+        /// Whether mClusterIndexData is rendered instead of the SubMesh index data
+        bool mClusterCulled;
+
+        /** Internal method to cull the meshlets of the SubMesh for the given camera.
+            Passing NULL renders all of them. See Entity::setClusterCulling. */
+        void updateClusterCulling(const Camera* cam);
+        /// Whether cluster culling left nothing to render
+        bool isClusterCulledOut() const { return mClusterCulled && mClusterIndexData->indexCount == 0; }
+
         /** Internal method for preparing this Entity for use in animation. */
         void prepareTempBlendBuffers(void);
 
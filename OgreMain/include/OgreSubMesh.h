@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "OgreVertexBoneAssignment.h"
 #include "OgreAnimationTrack.h"
 #include "OgreResourceGroupManager.h"
+#include "OgreVector.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre {
@@ -63,6 +64,7 @@ namespace Ogre {
         friend class MeshSerializerImpl;
         friend class MeshSerializerImpl_v1_2;
         friend class MeshSerializerImpl_v1_1;
+        friend class MeshSerializerImpl_Flat;
     public:
         SubMesh();
         ~SubMesh();
@@ -136,6 +138,38 @@ namespace Ogre {
          */
         std::vector<Vector3> extremityPoints;
 
+        /** A cluster of nearby triangles, which can be culled as a whole.
+
+            The bounds are in object space. Viewed from a position in the cone with the apex
+            coneApex, the axis coneAxis and the cosine coneCutoff, all triangles face away.
+        */
+        struct Meshlet
+        {
+            /// first index of the cluster in indexData->indexBuffer
+            uint32 indexStart;
+            uint32 indexCount;
+            /// bounding sphere of the triangles
+            Vector3 center;
+            Real radius;
+            Vector3 coneApex;
+            Vector3 coneAxis;
+            /// 1 if the triangles face too many directions to be back-face culled as a whole
+            Real coneCutoff;
+        };
+        typedef std::vector<Meshlet> MeshletList;
+
+        /** A partition of the triangles of indexData into clusters (optional).
+
+                The meshlets are contiguous ranges of indexData, ordered by indexStart. They are
+                generated by MeshOptimizer::MO_MESHLETS and stored in the .mesh file since
+                #MESH_VERSION_14_2. Entities use them to skip clusters outside the view frustum
+                or facing away from the camera, see Entity::setClusterCulling.
+            @par
+                They only describe the first LOD level. Reordering the indices of indexData makes
+                them invalid.
+        */
+        MeshletList meshlets;
+
         /// Reference to parent Mesh (not a smart pointer so child does not keep parent alive).
         Mesh* parent;
 
@@ -441,6 +441,48 @@ namespace Ogre {
             mLayerNames = names;
         }
 
+        /** Load this texture progressively
+
+            On load only the smallest mipmaps, up to TextureManager::getStreamingBaseSize, are
+            uploaded and the hardware texture is created at their size. Higher levels are decoded
+            on the WorkQueue once visible objects need them and the texture is recreated with them.
+            They are dropped again, least recently used first, when the TextureManager streaming
+            budget is exceeded. getSrcWidth and getSrcHeight keep the full size. Applies to 2D
+            textures loaded from a single image file. Images without mipmaps get them generated
+            on the CPU, unless they are compressed.
+            @note Must be called before any 'load' method.
+        */
+        void setStreaming(bool enabled) { mStreaming = enabled; }
+        /// @copydoc setStreaming
+        bool isStreaming() const { return mStreaming; }
+
+        /** Mipmap level of the source image, that is currently the top level of this texture
+
+            0 if all levels are resident or the texture is not streamed. The texture has the size
+            of this level.
+        */
+        uint32 getResidentMip() const { return mResidentMip; }
+
+        /// @name Internal streaming interface, driven by TextureManager
+        /// @{
+        /// request a mip level of the source image for the current frame
+        void _requestMip(uint32 mip);
+        /// highest requested level since the last _resetMipRequest and the frame it was requested in
+        uint32 _getRequestedMip() const { return mRequestedMip; }
+        unsigned long _getLastRequestFrame() const { return mLastRequestFrame; }
+        void _resetMipRequest();
+        /// whether a level is being decoded in the background
+        bool _isStreamingPending() const { return mStreamingPending; }
+        /// the lowest level the texture can be reduced to
+        uint32 _getStreamingTailMip() const { return mStreamingTailMip; }
+        /// memory used with the given top level: the hardware levels and the tail kept on the CPU
+        size_t _getStreamingSize(uint32 mip) const;
+        /// decode the levels up to the given one in the background and recreate the texture with them
+        void _streamIn(uint32 mip);
+        /// recreate the texture with the streaming tail only
+        void _evictMips();
+        /// @}
+
     protected:
         uint32 mHeight;
         uint32 mWidth;
@@ -512,8 +554,23 @@ namespace Ogre {
         typedef std::vector<Image> LoadedImages;
         LoadedImages mLoadedImages;
 
+        bool mStreaming;
+        bool mStreamingPending;
+        uint32 mResidentMip;
+        uint32 mRequestedMip;
+        unsigned long mLastRequestFrame;
+        /// incremented whenever pending streaming results become stale
+        uint32 mStreamingGeneration;
+        /// the smallest levels, that stay resident while streaming
+        Image mStreamingTail;
+        uint32 mStreamingTailMip;
+
         void readImage(LoadedImages& imgs, const String& name, const String& ext, bool haveNPOT);
         void freeInternalResources(void);
+        /// copy the levels first to last of img into levels
+        static void extractMips(const Image& img, uint32 first, uint32 last, Image& levels);
+        /// recreate the hardware texture with mip as top level from levels, that hold the ones above the tail
+        void createResidentMips(const Image* levels, uint32 mip);
     };
     /** @} */
     /** @} */
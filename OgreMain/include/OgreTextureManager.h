@@ -400,6 +400,47 @@ namespace Ogre {
             return mDefaultNumMipmaps;
         }
 
+        /** Sets the memory budget of streamed textures
+
+            All allocated hardware levels of each texture are counted, together with the small levels
+            kept on the CPU to drop back to. When exceeded, textures that were not visible in the last frame
+            drop their streamed levels, least recently used first. Levels are also only streamed
+            in while they fit.
+            @see Texture::setStreaming
+            @note The default value is unlimited.
+        */
+        void setStreamingBudget(size_t bytes) { mStreamingBudget = bytes; }
+        /// @copydoc setStreamingBudget
+        size_t getStreamingBudget() const { return mStreamingBudget; }
+
+        /** Sets the size in texels streamed textures start with and can drop back to
+
+            @note The default value is 64.
+        */
+        void setStreamingBaseSize(uint32 size) { mStreamingBaseSize = size; }
+        /// @copydoc setStreamingBaseSize
+        uint32 getStreamingBaseSize() const { return mStreamingBaseSize; }
+
+        /// Current memory usage of streamed textures, see setStreamingBudget
+        size_t getStreamingMemoryUsage() const;
+
+        /** Request the mip levels of streamed textures used by a visible object
+
+            The level is chosen, so the texture resolution matches the projected size of
+            the object bounds on the viewport of cam. Called by RenderQueue for every visible object.
+        */
+        void _notifyObjectVisible(MovableObject* mo, const Camera* cam);
+
+        /** Stream in requested levels and enforce the streaming budget
+
+            Called by Root at the end of every frame.
+        */
+        void _updateStreaming();
+
+        /// Internal method to track loaded streamed textures
+        void _notifyStreamingTexture(Texture* tex, bool loaded);
+        bool _hasStreamingTextures() const { return !mStreamingTextures.empty(); }
+
         /// Internal method to create a warning texture (bound when a texture unit is blank)
         const TexturePtr& _getWarningTexture();
 
@@ -421,6 +462,14 @@ namespace Ogre {
         TexturePtr mWarningTexture;
         SamplerPtr mDefaultSampler;
         std::map<String, SamplerPtr> mNamedSamplers;
+
+        size_t mStreamingBudget;
+        uint32 mStreamingBaseSize;
+        /// raw pointer to identify textures being unloaded, weak reference to use them safely
+        std::vector<std::pair<Texture*, std::weak_ptr<Texture>>> mStreamingTextures;
+
+        /// strong references to the tracked textures, dropping expired ones
+        std::vector<TexturePtr> getStreamingTextures();
     };
 
     /// Specialisation of TextureManager for offline processing. Cannot be used with an active RenderSystem.
@@ -145,7 +145,12 @@ namespace Ogre {
         */
         void prepareForShadowVolume(void);
 
-        /// converts between #VET_FLOAT3 or #VET_FLOAT4 and #VET_INT_10_10_10_2_NORM
+        /** converts between #VET_FLOAT3 or #VET_FLOAT4 and #VET_INT_10_10_10_2_NORM and between #VET_FLOAT2 and #VET_USHORT2_NORM
+
+            All elements with the given semantic are converted, e.g. every texture coordinate set.
+            Conversion to #VET_USHORT2_NORM is skipped for elements that are not #VET_FLOAT2 or
+            not in the 0..1 range
+        */
         void convertVertexElement(VertexElementSemantic semantic, VertexElementType dstType);
 
         /** Additional shadow volume vertex buffer storage. 
@@ -159,6 +159,19 @@ namespace Ogre
 
         /** Add a new task to the queue */
         virtual void addTask(std::function<void()> task) = 0;
+
+        /** Process a range of items in chunks, that run concurrently on the worker threads
+
+            The range is split into at most a few chunks per worker thread of the WorkQueue owned
+            by Root. The calling thread processes chunks as well and only returns once all of
+            them are done, so this is safe to call from within a task. Without Root or threading
+            support the whole range is processed on the calling thread.
+            @param count number of items
+            @param grainSize minimal number of items per chunk
+            @param task called with the [begin, end) range of each chunk. Exceptions are rethrown
+            on the calling thread.
+        */
+        static void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& task);
         
         /** Set whether to pause further processing of any requests. 
         If true, any further requests will simply be queued and not processed until
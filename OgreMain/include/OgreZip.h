@@ -52,6 +52,10 @@ namespace Ogre {
 
         This archive format supports all archives compressed in the standard
         zip format, including iD pk3 files.
+
+        Entries are inflated straight from the archive memory, so they can be opened
+        concurrently from multiple threads. Recently inflated entries are kept in a
+        bounded LRU cache, while large entries are decompressed on demand as they are read.
     */
     class _OgreExport ZipArchiveFactory : public ArchiveFactory
     {
@@ -63,6 +67,24 @@ namespace Ogre {
         using ArchiveFactory::createInstance;
 
         Archive *createInstance( const String& name, bool readOnly ) override;
+
+        /** Set the memory budget of the per archive cache of recently inflated entries
+
+            Opening a cached entry read-only does not decompress it again.
+            @param bytes the budget in bytes. 0 disables the cache. Default is 16 MiB.
+        */
+        static void setEntryCacheBudget(size_t bytes);
+        static size_t getEntryCacheBudget();
+
+        /** Set the size above which entries are streamed
+
+            Entries opened read-only that inflate to at least this size are not decompressed
+            into memory at once. Instead a seekable stream is returned, that inflates the data
+            in chunks as it is read.
+            @param bytes the threshold in bytes. Default is 8 MiB.
+        */
+        static void setStreamingThreshold(size_t bytes);
+        static size_t getStreamingThreshold();
     };
 
     /** Specialisation of ZipArchiveFactory for embedded Zip files. */
@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include <cmath>
 #include "OgreImage.h"
+#include "OgreBlockCompression.h"
 
 namespace Ogre {
 
@@ -267,6 +268,16 @@ namespace Ogre {
         // Always 1 mip level per file
         image->create(format, xsize, ysize, zsize, 1, 0);
         stream->read(image->getData(), image->getSize());
+
+        // 3D blocks are only passed through to the RenderSystem
+        RenderSystem* rs = Root::getSingleton().getRenderSystem();
+        if (zdim > 1 || (rs && rs->getCapabilities()->hasCapability(RSC_TEXTURE_COMPRESSION_ASTC)))
+            return;
+
+        // there is no RenderSystem or it can not sample ASTC, so decode it in software
+        Image compressed(*image);
+        image->create(PF_BYTE_RGBA, xsize, ysize, zsize, 1, 0);
+        PixelUtil::bulkPixelConversion(compressed.getPixelBox(), image->getPixelBox());
     }
     //---------------------------------------------------------------------    
     String ASTCCodec::getType() const 
@@ -0,0 +1,2367 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreBlockCompression.h"
+#include "OgreWorkQueue.h"
+
+#include <cfloat>
+#include <climits>
+
+#if __OGRE_HAVE_SSE && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define OGRE_BLOCKCOMPRESSION_SSE2 1
+#endif
+
+namespace Ogre {
+namespace BlockCompression {
+    namespace {
+    // decoded blocks are written as RGBA8 pixels, or RGBA16F for BC6H, with a pitch given in bytes
+
+    inline uint8 clampByte(int v) { return uint8(std::min(std::max(v, 0), 255)); }
+
+    inline void expand565(uint16 c, uint8* rgba)
+    {
+        uint8 r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+        rgba[0] = uint8((r << 3) | (r >> 2));
+        rgba[1] = uint8((g << 2) | (g >> 4));
+        rgba[2] = uint8((b << 3) | (b >> 2));
+        rgba[3] = 255;
+    }
+
+    /// palette of a BC1 colour block. With threeColour, the last entry is transparent black
+    void buildColourPalette(uint16 c0, uint16 c1, bool threeColour, uint8 (&palette)[4][4])
+    {
+        expand565(c0, palette[0]);
+        expand565(c1, palette[1]);
+        if (!threeColour)
+        {
+            for (int ch = 0; ch < 3; ch++)
+            {
+                palette[2][ch] = uint8((2 * palette[0][ch] + palette[1][ch] + 1) / 3);
+                palette[3][ch] = uint8((palette[0][ch] + 2 * palette[1][ch] + 1) / 3);
+            }
+            palette[2][3] = palette[3][3] = 255;
+        }
+        else
+        {
+            for (int ch = 0; ch < 3; ch++)
+                palette[2][ch] = uint8((palette[0][ch] + palette[1][ch] + 1) / 2);
+            palette[2][3] = 255;
+            // transparent black
+            memset(palette[3], 0, 4);
+        }
+    }
+
+    /// BC1 colour block, also used by BC2 and BC3, which always use 4 colours
+    void decodeColourBlock(const uint8* block, uint8* out, size_t pitch, bool allowPunchThrough)
+    {
+        uint16 c0 = uint16(block[0] | (block[1] << 8));
+        uint16 c1 = uint16(block[2] | (block[3] << 8));
+
+        uint8 palette[4][4];
+        buildColourPalette(c0, c1, c0 <= c1 && allowPunchThrough, palette);
+
+        uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32(block[7]) << 24);
+        for (int y = 0; y < 4; y++)
+        {
+            uint8* row = out + y * pitch;
+            for (int x = 0; x < 4; x++, indices >>= 2)
+                memcpy(row + x * 4, palette[indices & 0x3], 4);
+        }
+    }
+
+    /// BC2 explicit 4 bit alpha
+    void decodeExplicitAlphaBlock(const uint8* block, uint8* out, size_t pitch)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            uint16 bits = uint16(block[2 * y] | (block[2 * y + 1] << 8));
+            for (int x = 0; x < 4; x++, bits >>= 4)
+                out[y * pitch + x * 4 + 3] = uint8((bits & 0xF) * 17);
+        }
+    }
+
+    /// palette of a BC3 alpha or BC4/ BC5 channel block
+    void buildInterpolatedPalette(int v0, int v1, uint8 (&values)[8])
+    {
+        values[0] = uint8(v0);
+        values[1] = uint8(v1);
+        if (v0 > v1)
+        {
+            for (int i = 1; i < 7; i++)
+                values[i + 1] = uint8(((7 - i) * v0 + i * v1 + 3) / 7);
+        }
+        else
+        {
+            for (int i = 1; i < 5; i++)
+                values[i + 1] = uint8(((5 - i) * v0 + i * v1 + 2) / 5);
+            values[6] = 0;
+            values[7] = 255;
+        }
+    }
+
+    /// BC3 alpha and BC4/ BC5 channels, written to the channel out points to
+    void decodeInterpolatedBlock(const uint8* block, uint8* out, size_t pitch)
+    {
+        uint8 values[8];
+        buildInterpolatedPalette(block[0], block[1], values);
+
+        uint64 indices = 0;
+        for (int i = 0; i < 6; i++)
+            indices |= uint64(block[2 + i]) << (8 * i);
+        for (int i = 0; i < 16; i++, indices >>= 3)
+            out[(i / 4) * pitch + (i % 4) * 4] = values[indices & 0x7];
+    }
+
+    /// fill a block with opaque black, for formats that only store some channels
+    void clearBlock(uint8* out, size_t pitch)
+    {
+        for (int y = 0; y < 4; y++)
+            for (int x = 0; x < 4; x++)
+            {
+                uint8* p = out + y * pitch + x * 4;
+                p[0] = p[1] = p[2] = 0;
+                p[3] = 255;
+            }
+    }
+
+    const int ETC_MODIFIERS[8][2] = {{2, 8},   {5, 17},  {9, 29},   {13, 42},
+                                     {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+    const int ETC_DISTANCES[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+    inline uint8 extend4(int v) { return uint8((v << 4) | v); }
+    inline uint8 extend5(int v) { return uint8((v << 3) | (v >> 2)); }
+    inline uint8 extend6(int v) { return uint8((v << 2) | (v >> 4)); }
+    inline uint8 extend7(int v) { return uint8((v << 1) | (v >> 6)); }
+
+    /** ETC1 and ETC2 RGB blocks, with the T, H and planar modes of ETC2
+
+        @param punchThrough decode as ETC2_RGB8A1, where the differential bit is the opacity flag
+    */
+    void decodeETCBlock(const uint8* in, uint8* out, size_t pitch, bool punchThrough)
+    {
+        const bool diff = (in[3] & 0x2) != 0;
+        const bool flip = (in[3] & 0x1) != 0;
+        const bool opaque = !punchThrough || diff;
+
+        // pixel indices are stored column major, lsb and msb in separate planes
+        const uint32 indices = (uint32(in[4]) << 24) | (in[5] << 16) | (in[6] << 8) | in[7];
+
+        int base[2][3];
+        if (diff || punchThrough)
+        {
+            int r = in[0] >> 3, g = in[1] >> 3, b = in[2] >> 3;
+            // 3 bit signed deltas
+            int dr = ((in[0] & 0x7) ^ 0x4) - 0x4, dg = ((in[1] & 0x7) ^ 0x4) - 0x4, db = ((in[2] & 0x7) ^ 0x4) - 0x4;
+
+            if (r + dr < 0 || r + dr > 31 || g + dg < 0 || g + dg > 31)
+            {
+                // T and H modes: 4 paint colours selected directly by the pixel index
+                uint8 paint[4][4];
+                int c1[3], c2[3];
+                int distance;
+                if (r + dr < 0 || r + dr > 31)
+                {
+                    // T mode
+                    c1[0] = extend4((((in[0] >> 3) & 0x3) << 2) | (in[0] & 0x3));
+                    c1[1] = extend4(in[1] >> 4);
+                    c1[2] = extend4(in[1] & 0xF);
+                    c2[0] = extend4(in[2] >> 4);
+                    c2[1] = extend4(in[2] & 0xF);
+                    c2[2] = extend4(in[3] >> 4);
+                    distance = ETC_DISTANCES[((in[3] >> 1) & 0x6) | (in[3] & 0x1)];
+                    for (int ch = 0; ch < 3; ch++)
+                    {
+                        paint[0][ch] = uint8(c1[ch]);
+                        paint[1][ch] = clampByte(c2[ch] + distance);
+                        paint[2][ch] = uint8(c2[ch]);
+                        paint[3][ch] = clampByte(c2[ch] - distance);
+                    }
+                }
+                else
+                {
+                    // H mode
+                    c1[0] = extend4((in[0] >> 3) & 0xF);
+                    c1[1] = extend4(((in[0] & 0x7) << 1) | ((in[1] >> 4) & 0x1));
+                    c1[2] = extend4((in[1] & 0x8) | ((in[1] & 0x3) << 1) | (in[2] >> 7));
+                    c2[0] = extend4((in[2] >> 3) & 0xF);
+                    c2[1] = extend4(((in[2] & 0x7) << 1) | (in[3] >> 7));
+                    c2[2] = extend4((in[3] >> 3) & 0xF);
+                    int v1 = (c1[0] << 16) | (c1[1] << 8) | c1[2];
+                    int v2 = (c2[0] << 16) | (c2[1] << 8) | c2[2];
+                    distance = ETC_DISTANCES[(in[3] & 0x4) | ((in[3] & 0x1) << 1) | (v1 >= v2 ? 1 : 0)];
+                    for (int ch = 0; ch < 3; ch++)
+                    {
+                        paint[0][ch] = clampByte(c1[ch] + distance);
+                        paint[1][ch] = clampByte(c1[ch] - distance);
+                        paint[2][ch] = clampByte(c2[ch] + distance);
+                        paint[3][ch] = clampByte(c2[ch] - distance);
+                    }
+                }
+                for (int i = 0; i < 4; i++)
+                    paint[i][3] = 255;
+                if (!opaque)
+                    memset(paint[2], 0, 4);
+
+                for (int i = 0; i < 16; i++)
+                {
+                    int idx = (((indices >> (16 + i)) & 0x1) << 1) | ((indices >> i) & 0x1);
+                    memcpy(out + (i % 4) * pitch + (i / 4) * 4, paint[idx], 4);
+                }
+                return;
+            }
+
+            if (b + db < 0 || b + db > 31)
+            {
+                // planar mode: colour gradient given by origin, horizontal and vertical colours
+                int o[3], h[3], v[3];
+                o[0] = extend6((in[0] >> 1) & 0x3F);
+                o[1] = extend7(((in[0] & 0x1) << 6) | ((in[1] >> 1) & 0x3F));
+                o[2] = extend6(((in[1] & 0x1) << 5) | (in[2] & 0x18) | ((in[2] & 0x3) << 1) | (in[3] >> 7));
+                h[0] = extend6(((in[3] & 0x7C) >> 1) | (in[3] & 0x1));
+                h[1] = extend7((in[4] >> 1) & 0x7F);
+                h[2] = extend6(((in[4] & 0x1) << 5) | ((in[5] >> 3) & 0x1F));
+                v[0] = extend6(((in[5] & 0x7) << 3) | ((in[6] >> 5) & 0x7));
+                v[1] = extend7(((in[6] & 0x1F) << 2) | ((in[7] >> 6) & 0x3));
+                v[2] = extend6(in[7] & 0x3F);
+                for (int y = 0; y < 4; y++)
+                    for (int x = 0; x < 4; x++)
+                    {
+                        uint8* p = out + y * pitch + x * 4;
+                        for (int ch = 0; ch < 3; ch++)
+                            p[ch] = clampByte((x * (h[ch] - o[ch]) + y * (v[ch] - o[ch]) + 4 * o[ch] + 2) >> 2);
+                        p[3] = 255;
+                    }
+                return;
+            }
+
+            base[0][0] = extend5(r);
+            base[0][1] = extend5(g);
+            base[0][2] = extend5(b);
+            base[1][0] = extend5(r + dr);
+            base[1][1] = extend5(g + dg);
+            base[1][2] = extend5(b + db);
+        }
+        else
+        {
+            for (int ch = 0; ch < 3; ch++)
+            {
+                base[0][ch] = extend4(in[ch] >> 4);
+                base[1][ch] = extend4(in[ch] & 0xF);
+            }
+        }
+
+        const int* tables[2] = {ETC_MODIFIERS[in[3] >> 5], ETC_MODIFIERS[(in[3] >> 2) & 0x7]};
+        for (int i = 0; i < 16; i++)
+        {
+            int x = i / 4, y = i % 4;
+            int sub = flip ? (y >= 2) : (x >= 2);
+            int msb = (indices >> (16 + i)) & 0x1, lsb = (indices >> i) & 0x1;
+            uint8* p = out + y * pitch + x * 4;
+
+            if (!opaque && msb && !lsb)
+            {
+                memset(p, 0, 4);
+                continue;
+            }
+
+            int modifier = tables[sub][lsb];
+            if (msb)
+                modifier = -modifier;
+            // the smaller modifiers are zero without the opacity flag
+            if (!opaque && !lsb)
+                modifier = 0;
+            for (int ch = 0; ch < 3; ch++)
+                p[ch] = clampByte(base[sub][ch] + modifier);
+            p[3] = 255;
+        }
+    }
+
+    const int EAC_MODIFIERS[16][8] = {
+        {-3, -6, -9, -15, 2, 5, 8, 14},  {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+        {-2, -4, -6, -13, 1, 3, 5, 12},  {-3, -6, -8, -12, 2, 5, 7, 11},  {-3, -7, -9, -11, 2, 6, 8, 10},
+        {-4, -7, -8, -11, 3, 6, 7, 10},  {-3, -5, -8, -11, 2, 4, 7, 10},  {-2, -6, -8, -10, 1, 5, 7, 9},
+        {-2, -5, -8, -10, 1, 4, 7, 9},   {-2, -4, -8, -10, 1, 3, 7, 9},   {-2, -5, -7, -10, 1, 4, 6, 9},
+        {-3, -4, -7, -10, 2, 3, 6, 9},   {-1, -2, -3, -10, 0, 1, 2, 9},   {-4, -6, -8, -9, 3, 5, 7, 8},
+        {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+    /// ETC2 EAC alpha
+    void decodeEACBlock(const uint8* in, uint8* out, size_t pitch)
+    {
+        int base = in[0];
+        int multiplier = in[1] >> 4;
+        const int* modifiers = EAC_MODIFIERS[in[1] & 0xF];
+
+        uint64 indices = 0;
+        for (int i = 2; i < 8; i++)
+            indices = (indices << 8) | in[i];
+        // 3 bit indices, msb first in column major order
+        for (int i = 0; i < 16; i++)
+        {
+            int idx = int((indices >> (45 - 3 * i)) & 0x7);
+            out[(i % 4) * pitch + (i / 4) * 4] = clampByte(base + modifiers[idx] * multiplier);
+        }
+    }
+
+    /// BC7 partitions of 2 subsets, one bit per pixel
+    const uint16 BC7_PARTITIONS2[64] = {
+        0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+        0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+        0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+        0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+        0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+        0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+        0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+        0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22};
+
+    /// BC7 partitions of 3 subsets, two bits per pixel
+    const uint32 BC7_PARTITIONS3[64] = {
+        0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+        0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+        0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+        0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+        0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+        0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+        0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+        0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254};
+
+    /// pixels that store one index bit less, for the second subset of 2 and the second and third of 3
+    const uint8 BC7_ANCHORS2[64] = {
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+        15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+        15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+         6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15};
+    const uint8 BC7_ANCHORS3[2][64] = {
+        {
+             3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+             3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+             8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+             3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3},
+        {
+            15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+            15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+            15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+            15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8}};
+
+    const uint8 BC7_WEIGHTS[3][16] = {{0, 21, 43, 64},
+                                      {0, 9, 18, 27, 37, 46, 55, 64},
+                                      {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64}};
+
+    /// bit layout of the BC7 modes
+    struct BC7Mode
+    {
+        uint8 subsets, partitionBits, rotationBits, indexSelectionBits;
+        uint8 colourBits, alphaBits, endpointPBits, sharedPBits, indexBits, indexBits2;
+    };
+    const BC7Mode BC7_MODES[8] = {{3, 4, 0, 0, 4, 0, 1, 0, 3, 0}, {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+                                  {3, 6, 0, 0, 5, 0, 0, 0, 2, 0}, {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+                                  {1, 0, 2, 1, 5, 6, 0, 0, 2, 3}, {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+                                  {1, 0, 0, 0, 7, 7, 1, 0, 4, 0}, {2, 6, 0, 0, 5, 5, 1, 0, 2, 0}};
+
+    inline int bc7Subset(int subsets, uint32 partition, int pixel)
+    {
+        if (subsets == 2)
+            return (BC7_PARTITIONS2[partition] >> pixel) & 0x1;
+        if (subsets == 3)
+            return (BC7_PARTITIONS3[partition] >> (2 * pixel)) & 0x3;
+        return 0;
+    }
+
+    inline bool bc7IsAnchor(int subsets, uint32 partition, int pixel)
+    {
+        if (pixel == 0)
+            return true;
+        if (subsets == 2)
+            return pixel == BC7_ANCHORS2[partition];
+        if (subsets == 3)
+            return pixel == BC7_ANCHORS3[0][partition] || pixel == BC7_ANCHORS3[1][partition];
+        return false;
+    }
+
+    inline uint8 bc7Interpolate(int e0, int e1, int weight)
+    {
+        return uint8(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+    }
+
+    /** interpolate count RGBA8 pixels between the endpoints e0 and e1, with weights in [0, 64] per channel
+
+        As in BC7, the result is ((64 - w) * e0 + w * e1 + 32) >> 6. With unorm16 the endpoints are expanded to
+        16 bits first and the top 8 bits of the result are kept, which is how ASTC decodes LDR blocks to 8 bits.
+    */
+    template <bool unorm16>
+    void interpolateEndpoints(const uint8* e0, const uint8* e1, const uint8* weights, uint8* out, size_t count)
+    {
+        size_t i = 0;
+#if OGRE_BLOCKCOMPRESSION_SSE2
+        // two pixels at a time: madd sums the interleaved endpoint and weight pairs of each channel
+        const __m128i zero = _mm_setzero_si128(), full = _mm_set1_epi16(64), half = _mm_set1_epi32(32);
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(e0 + 4 * i)), zero);
+            __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(e1 + 4 * i)), zero);
+            __m128i w = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(weights + 4 * i)), zero);
+            __m128i iw = _mm_sub_epi16(full, w);
+            __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), _mm_unpacklo_epi16(iw, w));
+            __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), _mm_unpackhi_epi16(iw, w));
+            if (unorm16)
+            {
+                // v * 257 is the sum expanded to 16 bits
+                lo = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(lo, 8), lo), half), 14);
+                hi = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(hi, 8), hi), half), 14);
+            }
+            else
+            {
+                lo = _mm_srli_epi32(_mm_add_epi32(lo, half), 6);
+                hi = _mm_srli_epi32(_mm_add_epi32(hi, half), 6);
+            }
+            __m128i packed = _mm_packs_epi32(lo, hi);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * i), _mm_packus_epi16(packed, packed));
+        }
+#endif
+        for (i *= 4; i < count * 4; i++)
+        {
+            int v = (64 - weights[i]) * e0[i] + weights[i] * e1[i];
+            out[i] = uint8(unorm16 ? (v * 257 + 32) >> 14 : (v + 32) >> 6);
+        }
+    }
+
+    /// reads the bits of a 16 byte block, starting at the lsb of its first byte. Bits past the end read as 0
+    struct BlockBitReader
+    {
+        const uint8* data;
+        uint32 pos;
+
+        uint32 read(uint32 count)
+        {
+            // gather the bytes holding the at most 32 bits, instead of reading them one by one
+            uint64 v = 0;
+            const uint32 first = pos >> 3, last = std::min<uint32>((pos + count + 7) >> 3, 16);
+            for (uint32 i = first; i < last; i++)
+                v |= uint64(data[i]) << (8 * (i - first));
+            v >>= pos & 0x7;
+            pos += count;
+            return uint32(v & ((uint64(1) << count) - 1));
+        }
+    };
+
+    /// BC7, all 8 modes
+    void decodeBC7Block(const uint8* in, uint8* out, size_t pitch)
+    {
+        int mode = 0;
+        while (mode < 8 && !(in[0] & (1 << mode)))
+            mode++;
+        if (mode == 8)
+        {
+            // reserved mode, decodes to transparent black
+            for (int y = 0; y < 4; y++)
+                memset(out + y * pitch, 0, 16);
+            return;
+        }
+
+        const BC7Mode& m = BC7_MODES[mode];
+        BlockBitReader bits = {in, uint32(mode + 1)};
+        const uint32 partition = bits.read(m.partitionBits);
+        const uint32 rotation = bits.read(m.rotationBits);
+        const uint32 indexSelection = bits.read(m.indexSelectionBits);
+
+        // endpoints are stored channel by channel, then the p bits follow
+        const int numEndpoints = m.subsets * 2;
+        int endpoints[6][4];
+        for (int ch = 0; ch < 4; ch++)
+        {
+            const int precision = ch < 3 ? m.colourBits : m.alphaBits;
+            for (int e = 0; e < numEndpoints; e++)
+                endpoints[e][ch] = int(bits.read(precision));
+        }
+
+        int pbits[6] = {};
+        if (m.endpointPBits)
+        {
+            for (int e = 0; e < numEndpoints; e++)
+                pbits[e] = int(bits.read(1));
+        }
+        else if (m.sharedPBits)
+        {
+            for (int s = 0; s < m.subsets; s++)
+                pbits[2 * s] = pbits[2 * s + 1] = int(bits.read(1));
+        }
+
+        for (int e = 0; e < numEndpoints; e++)
+        {
+            for (int ch = 0; ch < 4; ch++)
+            {
+                int precision = ch < 3 ? m.colourBits : m.alphaBits;
+                if (precision == 0)
+                {
+                    endpoints[e][ch] = 255;
+                    continue;
+                }
+                int v = endpoints[e][ch];
+                if (m.endpointPBits || m.sharedPBits)
+                {
+                    v = (v << 1) | pbits[e];
+                    precision++;
+                }
+                // replicate the msbs into the low bits
+                endpoints[e][ch] = (v << (8 - precision)) | (v >> (2 * precision - 8));
+            }
+        }
+
+        int indices[16], indices2[16] = {};
+        for (int i = 0; i < 16; i++)
+            indices[i] = int(bits.read(m.indexBits - bc7IsAnchor(m.subsets, partition, i)));
+        if (m.indexBits2)
+        {
+            for (int i = 0; i < 16; i++)
+                indices2[i] = int(bits.read(m.indexBits2 - (i == 0)));
+        }
+
+        // modes without a second index set interpolate alpha with the colour indices
+        const int* colourIndices = indices;
+        const int* alphaIndices = m.indexBits2 ? indices2 : indices;
+        int colourBits = m.indexBits, alphaBits = m.indexBits2 ? m.indexBits2 : m.indexBits;
+        if (indexSelection)
+        {
+            std::swap(colourIndices, alphaIndices);
+            std::swap(colourBits, alphaBits);
+        }
+        const uint8* colourWeights = BC7_WEIGHTS[colourBits - 2];
+        const uint8* alphaWeights = BC7_WEIGHTS[alphaBits - 2];
+
+        uint8 lo[64], hi[64], weights[64], pixels[64];
+        for (int i = 0; i < 16; i++)
+        {
+            const int s = bc7Subset(m.subsets, partition, i);
+            for (int ch = 0; ch < 4; ch++)
+            {
+                lo[i * 4 + ch] = uint8(endpoints[2 * s][ch]);
+                hi[i * 4 + ch] = uint8(endpoints[2 * s + 1][ch]);
+            }
+            memset(weights + i * 4, colourWeights[colourIndices[i]], 3);
+            weights[i * 4 + 3] = alphaWeights[alphaIndices[i]];
+        }
+        interpolateEndpoints<false>(lo, hi, weights, pixels, 16);
+
+        for (int i = 0; i < 16; i++)
+        {
+            // the rotation swaps alpha with one of the colour channels
+            if (rotation)
+                std::swap(pixels[i * 4 + 3], pixels[i * 4 + rotation - 1]);
+        }
+        for (int y = 0; y < 4; y++)
+            memcpy(out + y * pitch, pixels + y * 16, 16);
+    }
+
+    /// BC6H endpoint fields: the channel times 4 plus the endpoint, in the w, x, y, z naming of the format
+    enum BC6HField { RW, RX, RY, RZ, GW, GX, GY, GZ, BW, BX, BY, BZ };
+
+    /// bits of a field, stored from lo to hi. Some modes store bits in reverse, with lo above hi
+    struct BC6HRun
+    {
+        uint8 field, hi, lo;
+    };
+
+    /// bit layout of the BC6H modes. The runs follow the mode bits up to the partition or the indices
+    struct BC6HMode
+    {
+        bool transformed;
+        uint8 regions, endpointBits, deltaBits[3];
+        BC6HRun runs[24];
+    };
+    const BC6HMode BC6H_MODES[14] = {
+        {true, 2, 10, {5, 5, 5},
+         {{GY, 4, 4}, {BY, 4, 4}, {BZ, 4, 4}, {RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 4, 0}, {GZ, 4, 4},
+          {GY, 3, 0}, {GX, 4, 0}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BZ, 1, 1}, {BY, 3, 0}, {RY, 4, 0},
+          {BZ, 2, 2}, {RZ, 4, 0}, {BZ, 3, 3}}},
+        {true, 2, 7, {6, 6, 6},
+         {{GY, 5, 5}, {GZ, 4, 4}, {GZ, 5, 5}, {RW, 6, 0}, {BZ, 0, 0}, {BZ, 1, 1}, {BY, 4, 4}, {GW, 6, 0},
+          {BY, 5, 5}, {BZ, 2, 2}, {GY, 4, 4}, {BW, 6, 0}, {BZ, 3, 3}, {BZ, 5, 5}, {BZ, 4, 4}, {RX, 5, 0},
+          {GY, 3, 0}, {GX, 5, 0}, {GZ, 3, 0}, {BX, 5, 0}, {BY, 3, 0}, {RY, 5, 0}, {RZ, 5, 0}}},
+        {true, 2, 11, {5, 4, 4},
+         {{RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 4, 0}, {RW, 10, 10}, {GY, 3, 0}, {GX, 3, 0}, {GW, 10, 10},
+          {BZ, 0, 0}, {GZ, 3, 0}, {BX, 3, 0}, {BW, 10, 10}, {BZ, 1, 1}, {BY, 3, 0}, {RY, 4, 0}, {BZ, 2, 2},
+          {RZ, 4, 0}, {BZ, 3, 3}}},
+        {true, 2, 11, {4, 5, 4},
+         {{RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 3, 0}, {RW, 10, 10}, {GZ, 4, 4}, {GY, 3, 0}, {GX, 4, 0},
+          {GW, 10, 10}, {GZ, 3, 0}, {BX, 3, 0}, {BW, 10, 10}, {BZ, 1, 1}, {BY, 3, 0}, {RY, 3, 0}, {BZ, 0, 0},
+          {BZ, 2, 2}, {RZ, 3, 0}, {GY, 4, 4}, {BZ, 3, 3}}},
+        {true, 2, 11, {4, 4, 5},
+         {{RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 3, 0}, {RW, 10, 10}, {BY, 4, 4}, {GY, 3, 0}, {GX, 3, 0},
+          {GW, 10, 10}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BW, 10, 10}, {BY, 3, 0}, {RY, 3, 0}, {BZ, 1, 1},
+          {BZ, 2, 2}, {RZ, 3, 0}, {BZ, 4, 4}, {BZ, 3, 3}}},
+        {true, 2, 9, {5, 5, 5},
+         {{RW, 8, 0}, {BY, 4, 4}, {GW, 8, 0}, {GY, 4, 4}, {BW, 8, 0}, {BZ, 4, 4}, {RX, 4, 0}, {GZ, 4, 4},
+          {GY, 3, 0}, {GX, 4, 0}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BZ, 1, 1}, {BY, 3, 0}, {RY, 4, 0},
+          {BZ, 2, 2}, {RZ, 4, 0}, {BZ, 3, 3}}},
+        {true, 2, 8, {6, 5, 5},
+         {{RW, 7, 0}, {GZ, 4, 4}, {BY, 4, 4}, {GW, 7, 0}, {BZ, 2, 2}, {GY, 4, 4}, {BW, 7, 0}, {BZ, 3, 3},
+          {BZ, 4, 4}, {RX, 5, 0}, {GY, 3, 0}, {GX, 4, 0}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BZ, 1, 1},
+          {BY, 3, 0}, {RY, 5, 0}, {RZ, 5, 0}}},
+        {true, 2, 8, {5, 6, 5},
+         {{RW, 7, 0}, {BZ, 0, 0}, {BY, 4, 4}, {GW, 7, 0}, {GY, 5, 5}, {GY, 4, 4}, {BW, 7, 0}, {GZ, 5, 5},
+          {BZ, 4, 4}, {RX, 4, 0}, {GZ, 4, 4}, {GY, 3, 0}, {GX, 5, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BZ, 1, 1},
+          {BY, 3, 0}, {RY, 4, 0}, {BZ, 2, 2}, {RZ, 4, 0}, {BZ, 3, 3}}},
+        {true, 2, 8, {5, 5, 6},
+         {{RW, 7, 0}, {BZ, 1, 1}, {BY, 4, 4}, {GW, 7, 0}, {BY, 5, 5}, {GY, 4, 4}, {BW, 7, 0}, {BZ, 5, 5},
+          {BZ, 4, 4}, {RX, 4, 0}, {GZ, 4, 4}, {GY, 3, 0}, {GX, 4, 0}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 5, 0},
+          {BY, 3, 0}, {RY, 4, 0}, {BZ, 2, 2}, {RZ, 4, 0}, {BZ, 3, 3}}},
+        {false, 2, 6, {6, 6, 6},
+         {{RW, 5, 0}, {GZ, 4, 4}, {BZ, 0, 0}, {BZ, 1, 1}, {BY, 4, 4}, {GW, 5, 0}, {GY, 5, 5}, {BY, 5, 5},
+          {BZ, 2, 2}, {GY, 4, 4}, {BW, 5, 0}, {GZ, 5, 5}, {BZ, 3, 3}, {BZ, 5, 5}, {BZ, 4, 4}, {RX, 5, 0},
+          {GY, 3, 0}, {GX, 5, 0}, {GZ, 3, 0}, {BX, 5, 0}, {BY, 3, 0}, {RY, 5, 0}, {RZ, 5, 0}}},
+        {false, 1, 10, {10, 10, 10}, {{RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 9, 0}, {GX, 9, 0}, {BX, 9, 0}}},
+        {true, 1, 11, {9, 9, 9},
+         {{RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 8, 0}, {RW, 10, 10}, {GX, 8, 0}, {GW, 10, 10}, {BX, 8, 0},
+          {BW, 10, 10}}},
+        {true, 1, 12, {8, 8, 8},
+         {{RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 7, 0}, {RW, 10, 11}, {GX, 7, 0}, {GW, 10, 11}, {BX, 7, 0},
+          {BW, 10, 11}}},
+        {true, 1, 16, {4, 4, 4},
+         {{RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 3, 0}, {RW, 10, 15}, {GX, 3, 0}, {GW, 10, 15}, {BX, 3, 0},
+          {BW, 10, 15}}}};
+
+    inline int signExtend(int v, int bits) { return (v ^ (1 << (bits - 1))) - (1 << (bits - 1)); }
+
+    /// expand a BC6H endpoint to the 16 bit range of the format
+    int unquantiseBC6H(int v, int bits, bool isSigned)
+    {
+        if (!isSigned)
+        {
+            if (bits >= 15 || v == 0)
+                return v;
+            if (v == (1 << bits) - 1)
+                return 0xFFFF;
+            return ((v << 16) + 0x8000) >> bits;
+        }
+
+        if (bits >= 16)
+            return v;
+        const bool negative = v < 0;
+        v = std::abs(v);
+        int q = 0;
+        if (v >= (1 << (bits - 1)) - 1)
+            q = 0x7FFF;
+        else if (v != 0)
+            q = ((v << 15) + 0x4000) >> (bits - 1);
+        return negative ? -q : q;
+    }
+
+    /// half float bits of an interpolated BC6H value, scaled by 31/64 or 31/32 to the finite range
+    inline uint16 finishBC6H(int v, bool isSigned)
+    {
+        if (!isSigned)
+            return uint16((v * 31) >> 6);
+        return v < 0 ? uint16(0x8000 | ((-v * 31) >> 5)) : uint16((v * 31) >> 5);
+    }
+
+    /// BC6H, all 14 modes. Pixels are written as RGBA16F with an alpha of 1
+    void decodeBC6HBlock(const uint8* in, uint8* out, size_t pitch, bool isSigned)
+    {
+        const uint16 ONE = 0x3C00;
+
+        BlockBitReader bits = {in, 0};
+        uint32 mode = bits.read(2);
+        if (mode > 1)
+        {
+            // 5 bit modes ending in 10 are the transformed 2 region modes, of those ending in 11 only 4 exist
+            mode |= bits.read(3) << 2;
+            mode = (mode & 0x3) == 2 ? 2 + (mode >> 2) : (mode >> 2) < 4 ? 10 + (mode >> 2) : 14;
+        }
+        if (mode == 14)
+        {
+            // reserved mode, decodes to black
+            const uint16 black[4] = {0, 0, 0, ONE};
+            for (int i = 0; i < 16; i++)
+                memcpy(out + (i / 4) * pitch + (i % 4) * 8, black, 8);
+            return;
+        }
+
+        const BC6HMode& m = BC6H_MODES[mode];
+        int endpoints[4][3] = {};
+        for (const BC6HRun* run = m.runs; bits.pos < (m.regions == 2 ? 77u : 65u); run++)
+        {
+            const int count = std::abs(run->hi - run->lo) + 1;
+            const uint32 v = bits.read(count);
+            for (int i = 0; i < count; i++)
+                endpoints[run->field & 0x3][run->field >> 2] |=
+                    int((v >> i) & 0x1) << (run->hi >= run->lo ? run->lo + i : run->lo - i);
+        }
+
+        // transformed modes store the other endpoints as signed deltas to the first one
+        const int numEndpoints = 2 * m.regions, mask = (1 << m.endpointBits) - 1;
+        for (int ch = 0; ch < 3; ch++)
+        {
+            const int base = isSigned ? signExtend(endpoints[0][ch], m.endpointBits) : endpoints[0][ch];
+            for (int e = 1; e < numEndpoints; e++)
+            {
+                int v = endpoints[e][ch];
+                if (m.transformed)
+                    v = (base + signExtend(v, m.deltaBits[ch])) & mask;
+                if (isSigned)
+                    v = signExtend(v, m.endpointBits);
+                endpoints[e][ch] = unquantiseBC6H(v, m.endpointBits, isSigned);
+            }
+            endpoints[0][ch] = unquantiseBC6H(base, m.endpointBits, isSigned);
+        }
+
+        // the 32 partitions of 2 regions are the first ones of BC7
+        const uint32 partition = m.regions == 2 ? bits.read(5) : 0;
+        const int indexBits = m.regions == 2 ? 3 : 4;
+        const uint8* weights = BC7_WEIGHTS[indexBits - 2];
+        for (int i = 0; i < 16; i++)
+        {
+            const int s = bc7Subset(m.regions, partition, i);
+            const int w = weights[bits.read(indexBits - bc7IsAnchor(m.regions, partition, i))];
+            uint16 p[4] = {0, 0, 0, ONE};
+            for (int ch = 0; ch < 3; ch++)
+                p[ch] = finishBC6H((endpoints[2 * s][ch] * (64 - w) + endpoints[2 * s + 1][ch] * w + 32) >> 6,
+                                   isSigned);
+            memcpy(out + (i / 4) * pitch + (i % 4) * 8, p, 8);
+        }
+    }
+
+    /// ASTC footprints in the order of the pixel formats
+    const uint8 ASTC_FOOTPRINTS[14][2] = {{4, 4}, {5, 4},  {5, 5},  {6, 5},   {6, 6},    {8, 5},   {8, 6},
+                                          {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+
+    inline bool isASTC(PixelFormat format)
+    {
+        return format >= PF_ASTC_RGBA_4X4_LDR && format <= PF_ASTC_RGBA_12X12_LDR;
+    }
+
+    /// the ASTC ranges of the integer sequence encoding, from 2 to 256 levels
+    struct ASTCRange
+    {
+        uint8 trits, quints, bits;
+    };
+    const ASTCRange ASTC_RANGES[21] = {{0, 0, 1}, {1, 0, 0}, {0, 0, 2}, {0, 1, 0}, {1, 0, 1}, {0, 0, 3}, {0, 1, 1},
+                                       {1, 0, 2}, {0, 0, 4}, {0, 1, 2}, {1, 0, 3}, {0, 0, 5}, {0, 1, 3}, {1, 0, 4},
+                                       {0, 0, 6}, {0, 1, 4}, {1, 0, 5}, {0, 0, 7}, {0, 1, 5}, {1, 0, 6}, {0, 0, 8}};
+    /// the coarsest range of colour endpoints
+    const int ASTC_MIN_COLOUR_RANGE = 4;
+
+    inline uint32 astcSequenceBits(uint32 count, int range)
+    {
+        const ASTCRange& r = ASTC_RANGES[range];
+        return count * r.bits + (r.trits ? (8 * count + 4) / 5 : 0) + (r.quints ? (7 * count + 2) / 3 : 0);
+    }
+
+    /// 5 trits packed into 8 bits
+    void decodeTrits(uint32 T, uint32 (&t)[5])
+    {
+        uint32 C;
+        if (((T >> 2) & 0x7) == 0x7)
+        {
+            C = ((T >> 5) << 2) | (T & 0x3);
+            t[4] = t[3] = 2;
+        }
+        else
+        {
+            C = T & 0x1F;
+            if (((T >> 5) & 0x3) == 0x3)
+            {
+                t[4] = 2;
+                t[3] = (T >> 7) & 0x1;
+            }
+            else
+            {
+                t[4] = (T >> 7) & 0x1;
+                t[3] = (T >> 5) & 0x3;
+            }
+        }
+
+        if ((C & 0x3) == 0x3)
+        {
+            t[2] = 2;
+            t[1] = (C >> 4) & 0x1;
+            t[0] = (((C >> 3) & 0x1) << 1) | ((C >> 2) & ~(C >> 3) & 0x1);
+        }
+        else if (((C >> 2) & 0x3) == 0x3)
+        {
+            t[2] = t[1] = 2;
+            t[0] = C & 0x3;
+        }
+        else
+        {
+            t[2] = (C >> 4) & 0x1;
+            t[1] = (C >> 2) & 0x3;
+            t[0] = (((C >> 1) & 0x1) << 1) | (C & ~(C >> 1) & 0x1);
+        }
+    }
+
+    /// 3 quints packed into 7 bits
+    void decodeQuints(uint32 Q, uint32 (&q)[3])
+    {
+        if (((Q >> 1) & 0x3) == 0x3 && ((Q >> 5) & 0x3) == 0)
+        {
+            q[2] = ((Q & 0x1) << 2) | ((((Q >> 4) & ~Q) & 0x1) << 1) | (((Q >> 3) & ~Q) & 0x1);
+            q[1] = q[0] = 4;
+            return;
+        }
+
+        uint32 C;
+        if (((Q >> 1) & 0x3) == 0x3)
+        {
+            q[2] = 4;
+            C = (((Q >> 3) & 0x3) << 3) | ((~(Q >> 5) & 0x3) << 1) | (Q & 0x1);
+        }
+        else
+        {
+            q[2] = (Q >> 5) & 0x3;
+            C = Q & 0x1F;
+        }
+
+        if ((C & 0x7) == 0x5)
+        {
+            q[1] = 4;
+            q[0] = (C >> 3) & 0x3;
+        }
+        else
+        {
+            q[1] = (C >> 3) & 0x3;
+            q[0] = C & 0x7;
+        }
+    }
+
+    /// count values of the integer sequence encoding, from bits that are 0 past the end of the sequence
+    void decodeASTCSequence(const uint8* data, uint32 count, int range, uint32* values)
+    {
+        const ASTCRange& r = ASTC_RANGES[range];
+        BlockBitReader bits = {data, 0};
+        if (r.trits)
+        {
+            // the bits of each value are followed by some bits of the trits of the group
+            const uint32 TRIT_BITS[5] = {2, 2, 1, 2, 1};
+            for (uint32 i = 0; i < count; i += 5)
+            {
+                uint32 m[5], t[5], T = 0;
+                for (uint32 j = 0, shift = 0; j < 5; shift += TRIT_BITS[j], j++)
+                {
+                    m[j] = bits.read(r.bits);
+                    T |= bits.read(TRIT_BITS[j]) << shift;
+                }
+                decodeTrits(T, t);
+                for (uint32 j = 0; j < 5 && i + j < count; j++)
+                    values[i + j] = (t[j] << r.bits) | m[j];
+            }
+        }
+        else if (r.quints)
+        {
+            const uint32 QUINT_BITS[3] = {3, 2, 2};
+            for (uint32 i = 0; i < count; i += 3)
+            {
+                uint32 m[3], q[3], Q = 0;
+                for (uint32 j = 0, shift = 0; j < 3; shift += QUINT_BITS[j], j++)
+                {
+                    m[j] = bits.read(r.bits);
+                    Q |= bits.read(QUINT_BITS[j]) << shift;
+                }
+                decodeQuints(Q, q);
+                for (uint32 j = 0; j < 3 && i + j < count; j++)
+                    values[i + j] = (q[j] << r.bits) | m[j];
+            }
+        }
+        else
+        {
+            for (uint32 i = 0; i < count; i++)
+                values[i] = bits.read(r.bits);
+        }
+    }
+
+    /// replicate the bits of v to fill the given width
+    inline uint32 replicateBits(uint32 v, uint32 bits, uint32 width)
+    {
+        uint32 result = 0;
+        for (int shift = int(width) - int(bits); shift > -int(bits); shift -= int(bits))
+            result |= shift >= 0 ? v << shift : v >> -shift;
+        return result;
+    }
+
+    /// colour endpoint value in [0, 255]. The trits and quints are scaled by C, while B spreads the low bits
+    uint32 unquantiseASTCColour(uint32 v, int range)
+    {
+        const ASTCRange& r = ASTC_RANGES[range];
+        if (!r.trits && !r.quints)
+            return replicateBits(v, r.bits, 8);
+
+        const uint32 D = v >> r.bits, A = (v & 0x1) ? 0x1FF : 0;
+        const uint32 b = (v >> 1) & 0x1, c = (v >> 2) & 0x1, d = (v >> 3) & 0x1, e = (v >> 4) & 0x1,
+                     f = (v >> 5) & 0x1;
+        uint32 B = 0, C = 0;
+        if (r.trits)
+        {
+            switch (r.bits)
+            {
+            case 1: C = 204; break;
+            case 2: C = 93; B = b * 0x116; break;
+            case 3: C = 44; B = c * 0x10A + b * 0x85; break;
+            case 4: C = 22; B = d * 0x104 + c * 0x82 + b * 0x41; break;
+            case 5: C = 11; B = e * 0x102 + d * 0x81 + c * 0x40 + b * 0x20; break;
+            default: C = 5; B = f * 0x101 + e * 0x80 + d * 0x40 + c * 0x20 + b * 0x10; break;
+            }
+        }
+        else
+        {
+            switch (r.bits)
+            {
+            case 1: C = 113; break;
+            case 2: C = 54; B = b * 0x10C; break;
+            case 3: C = 26; B = c * 0x105 + b * 0x82; break;
+            case 4: C = 13; B = d * 0x102 + c * 0x81 + b * 0x40; break;
+            default: C = 6; B = e * 0x101 + d * 0x80 + c * 0x40 + b * 0x20; break;
+            }
+        }
+        const uint32 T = (D * C + B) ^ A;
+        return (A & 0x80) | (T >> 2);
+    }
+
+    /// weight in [0, 64]
+    uint32 unquantiseASTCWeight(uint32 v, int range)
+    {
+        const ASTCRange& r = ASTC_RANGES[range];
+        uint32 w;
+        if (!r.trits && !r.quints)
+            w = replicateBits(v, r.bits, 6);
+        else if (r.bits == 0)
+            return v * (r.trits ? 32 : 16);
+        else
+        {
+            const uint32 D = v >> r.bits, A = (v & 0x1) ? 0x7F : 0;
+            const uint32 b = (v >> 1) & 0x1, c = (v >> 2) & 0x1;
+            uint32 B = 0, C;
+            if (r.trits)
+            {
+                switch (r.bits)
+                {
+                case 1: C = 50; break;
+                case 2: C = 23; B = b * 0x45; break;
+                default: C = 11; B = c * 0x42 + b * 0x21; break;
+                }
+            }
+            else
+            {
+                C = r.bits == 1 ? 28 : 13;
+                B = r.bits == 1 ? 0 : b * 0x42;
+            }
+            const uint32 T = (D * C + B) ^ A;
+            w = (A & 0x20) | (T >> 2);
+        }
+        return w > 32 ? w + 1 : w;
+    }
+
+    /// weight grid size, planes and weight range of a block mode. False for the reserved modes
+    bool decodeASTCBlockMode(uint32 mode, uint32& width, uint32& height, bool& dualPlane, int& range)
+    {
+        uint32 a = (mode >> 5) & 0x3, b = (mode >> 7) & 0x3, r = (mode >> 4) & 0x1;
+        bool high = (mode >> 9) & 0x1;
+        dualPlane = (mode >> 10) & 0x1;
+        if (mode & 0x3)
+        {
+            r |= (mode & 0x3) << 1;
+            switch ((mode >> 2) & 0x3)
+            {
+            case 0: width = b + 4; height = a + 2; break;
+            case 1: width = b + 8; height = a + 2; break;
+            case 2: width = a + 2; height = b + 8; break;
+            default:
+                b &= 0x1;
+                width = (mode & 0x100) ? b + 2 : a + 2;
+                height = (mode & 0x100) ? a + 2 : b + 6;
+                break;
+            }
+        }
+        else
+        {
+            if (((mode >> 2) & 0x3) == 0)
+                return false;
+            r |= ((mode >> 2) & 0x3) << 1;
+            switch ((mode >> 7) & 0x3)
+            {
+            case 0: width = 12; height = a + 2; break;
+            case 1: width = a + 2; height = 12; break;
+            case 2:
+                width = a + 6;
+                height = ((mode >> 9) & 0x3) + 6;
+                dualPlane = high = false;
+                break;
+            default:
+                if (a > 1)
+                    return false;
+                width = a ? 10 : 6;
+                height = a ? 6 : 10;
+                break;
+            }
+        }
+        range = int(r) - 2 + (high ? 6 : 0);
+        return true;
+    }
+
+    /// LDR endpoints of a colour endpoint mode. False for the HDR modes
+    bool decodeASTCEndpoints(uint32 cem, const uint32* values, uint8* e0, uint8* e1)
+    {
+        int v[8];
+        for (int i = 0; i < 8; i++)
+            v[i] = int(values[i]);
+
+        // move the top bit of the offset a into the base b, leaving a 6 bit signed offset
+        auto bitTransferSigned = [](int& a, int& b) {
+            b = (b >> 1) | (a & 0x80);
+            a = (a >> 1) & 0x3F;
+            if (a & 0x20)
+                a -= 0x40;
+        };
+        // endpoints with more weight on blue store red and green relative to it
+        auto blueContract = [](int* c) {
+            c[0] = (c[0] + c[2]) >> 1;
+            c[1] = (c[1] + c[2]) >> 1;
+        };
+
+        int a[4], b[4];
+        switch (cem)
+        {
+        case 0: // luminance
+            a[0] = a[1] = a[2] = v[0];
+            b[0] = b[1] = b[2] = v[1];
+            a[3] = b[3] = 255;
+            break;
+        case 1: // luminance, base and offset
+            a[0] = a[1] = a[2] = (v[0] >> 2) | (v[1] & 0xC0);
+            b[0] = b[1] = b[2] = std::min(a[0] + (v[1] & 0x3F), 255);
+            a[3] = b[3] = 255;
+            break;
+        case 4: // luminance and alpha
+            a[0] = a[1] = a[2] = v[0];
+            b[0] = b[1] = b[2] = v[1];
+            a[3] = v[2];
+            b[3] = v[3];
+            break;
+        case 5: // luminance and alpha, base and offset
+            bitTransferSigned(v[1], v[0]);
+            bitTransferSigned(v[3], v[2]);
+            a[0] = a[1] = a[2] = v[0];
+            b[0] = b[1] = b[2] = v[0] + v[1];
+            a[3] = v[2];
+            b[3] = v[2] + v[3];
+            break;
+        case 6: // RGB and scale
+        case 10: // RGB and scale, plus two alphas
+            for (int ch = 0; ch < 3; ch++)
+            {
+                a[ch] = (v[ch] * v[3]) >> 8;
+                b[ch] = v[ch];
+            }
+            a[3] = cem == 10 ? v[4] : 255;
+            b[3] = cem == 10 ? v[5] : 255;
+            break;
+        case 8: // RGB
+        case 12: // RGBA
+            if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4])
+            {
+                for (int ch = 0; ch < 4; ch++)
+                {
+                    a[ch] = v[2 * ch];
+                    b[ch] = v[2 * ch + 1];
+                }
+            }
+            else
+            {
+                for (int ch = 0; ch < 4; ch++)
+                {
+                    a[ch] = v[2 * ch + 1];
+                    b[ch] = v[2 * ch];
+                }
+                blueContract(a);
+                blueContract(b);
+            }
+            if (cem == 8)
+                a[3] = b[3] = 255;
+            break;
+        case 9: // RGB, base and offset
+        case 13: // RGBA, base and offset
+            for (int ch = 0; ch < 4; ch++)
+                bitTransferSigned(v[2 * ch + 1], v[2 * ch]);
+            if (v[1] + v[3] + v[5] >= 0)
+            {
+                for (int ch = 0; ch < 4; ch++)
+                {
+                    a[ch] = v[2 * ch];
+                    b[ch] = v[2 * ch] + v[2 * ch + 1];
+                }
+            }
+            else
+            {
+                for (int ch = 0; ch < 4; ch++)
+                {
+                    a[ch] = v[2 * ch] + v[2 * ch + 1];
+                    b[ch] = v[2 * ch];
+                }
+                blueContract(a);
+                blueContract(b);
+            }
+            if (cem == 9)
+                a[3] = b[3] = 255;
+            break;
+        default:
+            return false;
+        }
+
+        for (int ch = 0; ch < 4; ch++)
+        {
+            e0[ch] = clampByte(a[ch]);
+            e1[ch] = clampByte(b[ch]);
+        }
+        return true;
+    }
+
+    /// partition of a texel, given by a hash of the seed and the position
+    uint32 selectASTCPartition(uint32 seed, uint32 x, uint32 y, uint32 partitions, bool smallBlock)
+    {
+        if (smallBlock)
+        {
+            x <<= 1;
+            y <<= 1;
+        }
+        seed += (partitions - 1) * 1024;
+
+        uint32 rnum = seed;
+        rnum ^= rnum >> 15;
+        rnum *= 0xEEDE0891;
+        rnum ^= rnum >> 5;
+        rnum += rnum << 16;
+        rnum ^= rnum >> 7;
+        rnum ^= rnum >> 3;
+        rnum ^= rnum << 6;
+        rnum ^= rnum >> 17;
+
+        uint32 seeds[8];
+        for (int i = 0; i < 8; i++)
+        {
+            seeds[i] = (rnum >> (4 * i)) & 0xF;
+            seeds[i] *= seeds[i];
+        }
+        uint32 sh1, sh2;
+        if (seed & 0x1)
+        {
+            sh1 = (seed & 0x2) ? 4 : 5;
+            sh2 = partitions == 3 ? 6 : 5;
+        }
+        else
+        {
+            sh1 = partitions == 3 ? 6 : 5;
+            sh2 = (seed & 0x2) ? 4 : 5;
+        }
+
+        // the z terms of 3D blocks are left out
+        uint32 a = (((seeds[0] >> sh1) * x + (seeds[1] >> sh2) * y + (rnum >> 14)) & 0x3F);
+        uint32 b = (((seeds[2] >> sh1) * x + (seeds[3] >> sh2) * y + (rnum >> 10)) & 0x3F);
+        uint32 c = partitions < 3 ? 0 : (((seeds[4] >> sh1) * x + (seeds[5] >> sh2) * y + (rnum >> 6)) & 0x3F);
+        uint32 d = partitions < 4 ? 0 : (((seeds[6] >> sh1) * x + (seeds[7] >> sh2) * y + (rnum >> 2)) & 0x3F);
+
+        if (a >= b && a >= c && a >= d)
+            return 0;
+        if (b >= c && b >= d)
+            return 1;
+        return c >= d ? 2 : 3;
+    }
+
+    inline uint8 reverseBits(uint8 v)
+    {
+        v = uint8((v >> 4) | (v << 4));
+        v = uint8(((v & 0xCC) >> 2) | ((v & 0x33) << 2));
+        return uint8(((v & 0xAA) >> 1) | ((v & 0x55) << 1));
+    }
+
+    /// copy count bits of the reader to the start of out, clearing the rest
+    void copyBits(BlockBitReader bits, uint32 count, uint8 (&out)[16])
+    {
+        memset(out, 0, sizeof(out));
+        for (uint32 i = 0; i < count; i += 8)
+            out[i / 8] = uint8(bits.read(std::min(8u, count - i)));
+    }
+
+    /** ASTC LDR blocks of a 2D footprint
+
+        Texels are decoded to 8 bits as with the decode_unorm8 mode of ASTC. Invalid blocks and HDR content
+        decode to the error colour magenta.
+    */
+    void decodeASTCBlock(const uint8* in, uint8* out, size_t pitch, uint32 blockWidth, uint32 blockHeight)
+    {
+        const uint8 ERROR_COLOUR[4] = {255, 0, 255, 255};
+        auto fill = [&](const uint8* colour) {
+            for (uint32 y = 0; y < blockHeight; y++)
+                for (uint32 x = 0; x < blockWidth; x++)
+                    memcpy(out + y * pitch + x * 4, colour, 4);
+        };
+
+        const uint32 blockMode = in[0] | ((in[1] & 0x7) << 8);
+        if ((blockMode & 0x1FF) == 0x1FC)
+        {
+            // void extent: a constant UNORM16 colour, the extent is only a hint for the sampler
+            const uint8 colour[4] = {in[9], in[11], in[13], in[15]};
+            fill(blockMode & 0x200 ? ERROR_COLOUR : colour);
+            return;
+        }
+
+        uint32 gridWidth, gridHeight;
+        bool dualPlane;
+        int weightRange;
+        const uint32 partitions = ((in[1] >> 3) & 0x3) + 1;
+        if (!decodeASTCBlockMode(blockMode, gridWidth, gridHeight, dualPlane, weightRange) ||
+            gridWidth > blockWidth || gridHeight > blockHeight || (dualPlane && partitions == 4))
+        {
+            fill(ERROR_COLOUR);
+            return;
+        }
+        const uint32 planes = dualPlane ? 2 : 1;
+        const uint32 numWeights = gridWidth * gridHeight * planes;
+        const uint32 weightBits = astcSequenceBits(numWeights, weightRange);
+        if (numWeights > 64 || weightBits < 24 || weightBits > 96)
+        {
+            fill(ERROR_COLOUR);
+            return;
+        }
+
+        // colour endpoint modes, then the bits below the weights that belong to them and to the second plane
+        uint32 cems[4], seed = 0, colourStart = 17, belowWeights = 128 - weightBits;
+        BlockBitReader bits = {in, 13};
+        if (partitions == 1)
+            cems[0] = bits.read(4);
+        else
+        {
+            seed = bits.read(10);
+            uint32 encoded = bits.read(6);
+            colourStart = 29;
+            if ((encoded & 0x3) == 0)
+                std::fill(cems, cems + partitions, encoded >> 2);
+            else
+            {
+                const uint32 extraBits = 3 * partitions - 4;
+                belowWeights -= extraBits;
+                BlockBitReader extra = {in, belowWeights};
+                encoded |= extra.read(extraBits) << 6;
+                // a class per partition relative to the base, then the mode within the class
+                const uint32 baseClass = (encoded & 0x3) - 1;
+                for (uint32 p = 0; p < partitions; p++)
+                    cems[p] = ((baseClass + ((encoded >> (2 + p)) & 0x1)) << 2) |
+                              ((encoded >> (2 + partitions + 2 * p)) & 0x3);
+            }
+        }
+        int planeChannel = -1;
+        if (dualPlane)
+        {
+            belowWeights -= 2;
+            BlockBitReader selector = {in, belowWeights};
+            planeChannel = int(selector.read(2));
+        }
+
+        // the endpoints use the finest range that fits between the modes and the weights
+        uint32 numValues = 0;
+        for (uint32 p = 0; p < partitions; p++)
+            numValues += ((cems[p] >> 2) + 1) * 2;
+        int colourRange = 20;
+        while (colourRange >= ASTC_MIN_COLOUR_RANGE &&
+               colourStart + astcSequenceBits(numValues, colourRange) > belowWeights)
+            colourRange--;
+        if (numValues > 18 || colourRange < ASTC_MIN_COLOUR_RANGE)
+        {
+            fill(ERROR_COLOUR);
+            return;
+        }
+
+        uint8 sequence[16];
+        uint32 values[18];
+        bits.pos = colourStart;
+        copyBits(bits, astcSequenceBits(numValues, colourRange), sequence);
+        decodeASTCSequence(sequence, numValues, colourRange, values);
+        for (uint32 i = 0; i < numValues; i++)
+            values[i] = unquantiseASTCColour(values[i], colourRange);
+
+        uint8 endpoints[4][2][4];
+        for (uint32 p = 0, offset = 0; p < partitions; offset += ((cems[p] >> 2) + 1) * 2, p++)
+        {
+            if (!decodeASTCEndpoints(cems[p], values + offset, endpoints[p][0], endpoints[p][1]))
+            {
+                fill(ERROR_COLOUR);
+                return;
+            }
+        }
+
+        // weights are stored bit reversed from the top of the block, the planes interleaved
+        uint8 reversed[16];
+        for (int i = 0; i < 16; i++)
+            reversed[i] = reverseBits(in[15 - i]);
+        copyBits({reversed, 0}, weightBits, sequence);
+        uint32 grid[64];
+        decodeASTCSequence(sequence, numWeights, weightRange, grid);
+        for (uint32 i = 0; i < numWeights; i++)
+            grid[i] = unquantiseASTCWeight(grid[i], weightRange);
+
+        // bilinear infill of the weight grid in the fixed point steps of the specification
+        const uint32 ds = (1024 + blockWidth / 2) / (blockWidth - 1), dt = (1024 + blockHeight / 2) / (blockHeight - 1);
+        uint8 lo[12 * 4], hi[12 * 4], weights[12 * 4];
+        for (uint32 y = 0; y < blockHeight; y++)
+        {
+            const uint32 gt = (dt * y * (gridHeight - 1) + 32) >> 6;
+            const uint32 jt = gt >> 4, ft = gt & 0xF, jt1 = std::min(jt + 1, gridHeight - 1);
+            for (uint32 x = 0; x < blockWidth; x++)
+            {
+                const uint32 gs = (ds * x * (gridWidth - 1) + 32) >> 6;
+                const uint32 js = gs >> 4, fs = gs & 0xF, js1 = std::min(js + 1, gridWidth - 1);
+                const uint32 w11 = (fs * ft + 8) >> 4, w10 = ft - w11, w01 = fs - w11, w00 = 16 - fs - ft + w11;
+
+                uint32 w[2] = {};
+                for (uint32 plane = 0; plane < planes; plane++)
+                {
+                    const uint32* g = grid + plane;
+                    w[plane] = (g[(jt * gridWidth + js) * planes] * w00 + g[(jt * gridWidth + js1) * planes] * w01 +
+                                g[(jt1 * gridWidth + js) * planes] * w10 + g[(jt1 * gridWidth + js1) * planes] * w11 +
+                                8) >> 4;
+                }
+
+                const uint32 p = partitions > 1 ? selectASTCPartition(seed, x, y, partitions,
+                                                                      blockWidth * blockHeight < 31)
+                                                : 0;
+                memcpy(lo + x * 4, endpoints[p][0], 4);
+                memcpy(hi + x * 4, endpoints[p][1], 4);
+                for (int ch = 0; ch < 4; ch++)
+                    weights[x * 4 + ch] = uint8(w[ch == planeChannel]);
+            }
+            interpolateEndpoints<true>(lo, hi, weights, out + y * pitch, blockWidth);
+        }
+    }
+
+    size_t getBlockSize(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PF_DXT1:
+        case PF_BC4_UNORM:
+        case PF_ETC1_RGB8:
+        case PF_ETC2_RGB8:
+        case PF_ETC2_RGB8A1:
+            return 8;
+        case PF_DXT2:
+        case PF_DXT3:
+        case PF_DXT4:
+        case PF_DXT5:
+        case PF_BC5_UNORM:
+        case PF_BC6H_UF16:
+        case PF_BC6H_SF16:
+        case PF_BC7_UNORM:
+        case PF_ETC2_RGBA8:
+            return 16;
+        default:
+            return isASTC(format) ? 16 : 0;
+        }
+    }
+
+    /// pixels covered by a block
+    void getBlockFootprint(PixelFormat format, uint32& width, uint32& height)
+    {
+        width = height = 4;
+        if (isASTC(format))
+        {
+            width = ASTC_FOOTPRINTS[format - PF_ASTC_RGBA_4X4_LDR][0];
+            height = ASTC_FOOTPRINTS[format - PF_ASTC_RGBA_4X4_LDR][1];
+        }
+    }
+
+    /// format of the decoded pixels
+    PixelFormat getDecodedFormat(PixelFormat format)
+    {
+        return format == PF_BC6H_UF16 || format == PF_BC6H_SF16 ? PF_FLOAT16_RGBA : PF_BYTE_RGBA;
+    }
+
+    void decodeBlock(PixelFormat format, const uint8* block, uint8* out, size_t pitch)
+    {
+        switch (format)
+        {
+        case PF_DXT1:
+            decodeColourBlock(block, out, pitch, true);
+            break;
+        case PF_DXT2:
+        case PF_DXT3:
+            decodeColourBlock(block + 8, out, pitch, false);
+            decodeExplicitAlphaBlock(block, out, pitch);
+            break;
+        case PF_DXT4:
+        case PF_DXT5:
+            decodeColourBlock(block + 8, out, pitch, false);
+            decodeInterpolatedBlock(block, out + 3, pitch);
+            break;
+        case PF_BC4_UNORM:
+            clearBlock(out, pitch);
+            decodeInterpolatedBlock(block, out, pitch);
+            break;
+        case PF_BC5_UNORM:
+            clearBlock(out, pitch);
+            decodeInterpolatedBlock(block, out, pitch);
+            decodeInterpolatedBlock(block + 8, out + 1, pitch);
+            break;
+        case PF_BC6H_UF16:
+        case PF_BC6H_SF16:
+            decodeBC6HBlock(block, out, pitch, format == PF_BC6H_SF16);
+            break;
+        case PF_BC7_UNORM:
+            decodeBC7Block(block, out, pitch);
+            break;
+        case PF_ETC1_RGB8:
+        case PF_ETC2_RGB8:
+            decodeETCBlock(block, out, pitch, false);
+            break;
+        case PF_ETC2_RGB8A1:
+            decodeETCBlock(block, out, pitch, true);
+            break;
+        case PF_ETC2_RGBA8:
+            decodeETCBlock(block + 8, out, pitch, false);
+            decodeEACBlock(block, out + 3, pitch);
+            break;
+        default:
+            if (isASTC(format))
+            {
+                const uint8* footprint = ASTC_FOOTPRINTS[format - PF_ASTC_RGBA_4X4_LDR];
+                decodeASTCBlock(block, out, pitch, footprint[0], footprint[1]);
+            }
+            break;
+        }
+    }
+
+    // encoders read a block as 16 consecutive RGBA8 pixels in row major order
+
+    inline int squaredDistance(const uint8* a, const uint8* b)
+    {
+        int dr = a[0] - b[0], dg = a[1] - b[1], db = a[2] - b[2];
+        return dr * dr + dg * dg + db * db;
+    }
+
+    inline int quantise(float v, int maxValue)
+    {
+        return std::min(std::max(int(v * maxValue / 255.0f + 0.5f), 0), maxValue);
+    }
+
+    inline uint16 quantise565(const float* c)
+    {
+        return uint16((quantise(c[0], 31) << 11) | (quantise(c[1], 63) << 5) | quantise(c[2], 31));
+    }
+
+    /// pick the closest palette entries and return the squared error
+    int fitColourIndices(const uint8* px, const bool* transparent, uint16 c0, uint16 c1, bool threeColour,
+                         uint8* indices)
+    {
+        uint8 palette[4][4];
+        buildColourPalette(c0, c1, threeColour, palette);
+        const int numColours = threeColour ? 3 : 4;
+
+        int error = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            if (transparent[i])
+            {
+                indices[i] = 3;
+                continue;
+            }
+            int best = INT_MAX;
+            for (int c = 0; c < numColours; c++)
+            {
+                int d = squaredDistance(px + i * 4, palette[c]);
+                if (d < best)
+                {
+                    best = d;
+                    indices[i] = uint8(c);
+                }
+            }
+            error += best;
+        }
+        return error;
+    }
+
+    /** BC1 colour block
+
+        Endpoints start at the bounding box or, with higher quality, at the extent along the principal
+        axis of the colours. They are then refined by least squares fits to the chosen indices.
+        @param punchThrough encode pixels with alpha below 128 as transparent, as in DXT1
+    */
+    void encodeColourBlock(const uint8* px, uint8* out, float quality, bool punchThrough)
+    {
+        bool transparent[16];
+        bool threeColour = false;
+        float mean[3] = {0, 0, 0};
+        float lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+        int count = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            transparent[i] = punchThrough && px[i * 4 + 3] < 128;
+            threeColour |= transparent[i];
+            if (transparent[i])
+                continue;
+            for (int ch = 0; ch < 3; ch++)
+            {
+                mean[ch] += px[i * 4 + ch];
+                lo[ch] = std::min(lo[ch], float(px[i * 4 + ch]));
+                hi[ch] = std::max(hi[ch], float(px[i * 4 + ch]));
+            }
+            count++;
+        }
+
+        if (count == 0)
+        {
+            // fully transparent
+            memset(out, 0, 4);
+            memset(out + 4, 0xFF, 4);
+            return;
+        }
+
+        if (quality < 0.25f)
+        {
+            // inset the bounding box, as the extremes are rarely hit exactly
+            for (int ch = 0; ch < 3; ch++)
+            {
+                float inset = (hi[ch] - lo[ch]) / 16;
+                lo[ch] += inset;
+                hi[ch] -= inset;
+            }
+        }
+        else
+        {
+            for (float& m : mean)
+                m /= count;
+
+            float cov[6] = {0, 0, 0, 0, 0, 0};
+            for (int i = 0; i < 16; i++)
+            {
+                if (transparent[i])
+                    continue;
+                float r = px[i * 4] - mean[0], g = px[i * 4 + 1] - mean[1], b = px[i * 4 + 2] - mean[2];
+                cov[0] += r * r;
+                cov[1] += r * g;
+                cov[2] += r * b;
+                cov[3] += g * g;
+                cov[4] += g * b;
+                cov[5] += b * b;
+            }
+
+            // power iteration, starting at the bounding box diagonal
+            float axis[3] = {hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]};
+            for (int iter = 0; iter < 8; iter++)
+            {
+                float next[3] = {cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                                 cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                                 cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+                float len = std::max(std::abs(next[0]), std::max(std::abs(next[1]), std::abs(next[2])));
+                if (len < 1e-6f)
+                    break;
+                for (int ch = 0; ch < 3; ch++)
+                    axis[ch] = next[ch] / len;
+            }
+            float len2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+            if (len2 > 1e-6f)
+            {
+                float tmin = FLT_MAX, tmax = -FLT_MAX;
+                for (int i = 0; i < 16; i++)
+                {
+                    if (transparent[i])
+                        continue;
+                    float t = 0;
+                    for (int ch = 0; ch < 3; ch++)
+                        t += (px[i * 4 + ch] - mean[ch]) * axis[ch];
+                    tmin = std::min(tmin, t);
+                    tmax = std::max(tmax, t);
+                }
+                for (int ch = 0; ch < 3; ch++)
+                {
+                    lo[ch] = mean[ch] + tmin / len2 * axis[ch];
+                    hi[ch] = mean[ch] + tmax / len2 * axis[ch];
+                }
+            }
+        }
+
+        // weight of the first endpoint per index
+        const float weights4[4] = {1, 0, 2.0f / 3, 1.0f / 3};
+        const float weights3[4] = {1, 0, 0.5f, 0};
+        const float* weights = threeColour ? weights3 : weights4;
+
+        const int refinements = quality < 0.5f ? 0 : quality < 0.9f ? 1 : 4;
+        int bestError = INT_MAX;
+        uint16 bestC0 = 0, bestC1 = 0;
+        uint8 bestIndices[16];
+        for (int iter = 0;; iter++)
+        {
+            uint16 c0 = quantise565(hi), c1 = quantise565(lo);
+            // the endpoint order selects the mode
+            if ((c0 < c1) != threeColour && c0 != c1)
+                std::swap(c0, c1);
+
+            uint8 indices[16];
+            int error;
+            if (c0 == c1 && !threeColour)
+            {
+                // all colours equal, which would decode as three colour mode
+                memset(indices, 0, sizeof(indices));
+                uint8 palette[4][4];
+                buildColourPalette(c0, c1, false, palette);
+                error = 0;
+                for (int i = 0; i < 16; i++)
+                    error += squaredDistance(px + i * 4, palette[0]);
+            }
+            else
+                error = fitColourIndices(px, transparent, c0, c1, threeColour, indices);
+
+            if (error < bestError)
+            {
+                bestError = error;
+                bestC0 = c0;
+                bestC1 = c1;
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+
+            if (iter == refinements || error == 0)
+                break;
+
+            // least squares endpoints for the chosen indices
+            float aa = 0, ab = 0, bb = 0, ax[3] = {0, 0, 0}, bx[3] = {0, 0, 0};
+            for (int i = 0; i < 16; i++)
+            {
+                if (transparent[i])
+                    continue;
+                float a = weights[indices[i]], b = 1 - a;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (int ch = 0; ch < 3; ch++)
+                {
+                    ax[ch] += a * px[i * 4 + ch];
+                    bx[ch] += b * px[i * 4 + ch];
+                }
+            }
+            float det = aa * bb - ab * ab;
+            if (std::abs(det) < 1e-6f)
+                break;
+            // solve for the endpoints as ordered in the block, the next pass restores the mode
+            for (int ch = 0; ch < 3; ch++)
+            {
+                hi[ch] = (ax[ch] * bb - bx[ch] * ab) / det;
+                lo[ch] = (bx[ch] * aa - ax[ch] * ab) / det;
+            }
+        }
+
+        out[0] = uint8(bestC0);
+        out[1] = uint8(bestC0 >> 8);
+        out[2] = uint8(bestC1);
+        out[3] = uint8(bestC1 >> 8);
+        uint32 bits = 0;
+        for (int i = 0; i < 16; i++)
+            bits |= uint32(bestIndices[i]) << (2 * i);
+        for (int i = 0; i < 4; i++)
+            out[4 + i] = uint8(bits >> (8 * i));
+    }
+
+    /// BC2 explicit 4 bit alpha
+    void encodeExplicitAlphaBlock(const uint8* px, uint8* out)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            uint16 bits = 0;
+            for (int x = 0; x < 4; x++)
+                bits |= uint16(((px[(y * 4 + x) * 4 + 3] * 15 + 127) / 255) << (4 * x));
+            out[2 * y] = uint8(bits);
+            out[2 * y + 1] = uint8(bits >> 8);
+        }
+    }
+
+    /// encode one interpolated block for the given endpoints and return the squared error
+    int fitInterpolatedBlock(const int* values, int v0, int v1, uint8* out)
+    {
+        uint8 palette[8];
+        buildInterpolatedPalette(v0, v1, palette);
+        out[0] = uint8(v0);
+        out[1] = uint8(v1);
+
+        int error = 0;
+        uint64 indices = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            int best = INT_MAX, bestIdx = 0;
+            for (int c = 0; c < 8; c++)
+            {
+                int d = (values[i] - palette[c]) * (values[i] - palette[c]);
+                if (d < best)
+                {
+                    best = d;
+                    bestIdx = c;
+                }
+            }
+            indices |= uint64(bestIdx) << (3 * i);
+            error += best;
+        }
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = uint8(indices >> (8 * i));
+        return error;
+    }
+
+    /// BC3 alpha and BC4/ BC5 channels, read from the channel px points to
+    void encodeInterpolatedBlock(const uint8* px, uint8* out, float quality)
+    {
+        int values[16];
+        int lo = 255, hi = 0, innerLo = 255, innerHi = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            values[i] = px[i * 4];
+            lo = std::min(lo, values[i]);
+            hi = std::max(hi, values[i]);
+            if (values[i] != 0 && values[i] != 255)
+            {
+                innerLo = std::min(innerLo, values[i]);
+                innerHi = std::max(innerHi, values[i]);
+            }
+        }
+
+        int bestError = fitInterpolatedBlock(values, hi, lo, out);
+        if (bestError == 0 || quality < 0.5f)
+            return;
+
+        uint8 candidate[8];
+        // six interpolated values plus explicit 0 and 255
+        if (innerLo <= innerHi)
+        {
+            int error = fitInterpolatedBlock(values, innerLo, innerHi, candidate);
+            if (error < bestError)
+            {
+                bestError = error;
+                memcpy(out, candidate, 8);
+            }
+        }
+
+        if (quality < 0.9f)
+            return;
+
+        // shrink the range, trading the extremes for finer steps
+        for (int dhi = 0; dhi <= 2; dhi++)
+        {
+            for (int dlo = 0; dlo <= 2; dlo++)
+            {
+                if ((dhi == 0 && dlo == 0) || hi - dhi <= lo + dlo)
+                    continue;
+                int error = fitInterpolatedBlock(values, hi - dhi, lo + dlo, candidate);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    memcpy(out, candidate, 8);
+                }
+            }
+        }
+    }
+
+    /** best ETC modifier table and selectors for a sub block
+
+        @param pixels indices of the 8 pixels in the sub block
+        @param selectors receives the 2 bit selector per pixel, with the sign in bit 1
+    */
+    int fitETCSubBlock(const uint8* px, const int* pixels, const int* base, int& table, uint8* selectors)
+    {
+        int bestError = INT_MAX;
+        for (int t = 0; t < 8; t++)
+        {
+            const int modifiers[4] = {ETC_MODIFIERS[t][0], ETC_MODIFIERS[t][1], -ETC_MODIFIERS[t][0],
+                                      -ETC_MODIFIERS[t][1]};
+            uint8 colours[4][4];
+            for (int m = 0; m < 4; m++)
+                for (int ch = 0; ch < 3; ch++)
+                    colours[m][ch] = clampByte(base[ch] + modifiers[m]);
+
+            int error = 0;
+            uint8 sel[8];
+            for (int i = 0; i < 8 && error < bestError; i++)
+            {
+                int best = INT_MAX;
+                for (int m = 0; m < 4; m++)
+                {
+                    int d = squaredDistance(px + pixels[i] * 4, colours[m]);
+                    if (d < best)
+                    {
+                        best = d;
+                        sel[i] = uint8(m);
+                    }
+                }
+                error += best;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                table = t;
+                memcpy(selectors, sel, sizeof(sel));
+            }
+        }
+        return bestError;
+    }
+
+    /** ETC1 block, which is also a valid ETC2 RGB block
+
+        Both sub block orientations are tried, using the differential mode when the sub block
+        colours are close enough. Higher quality also tries the individual mode and shifts the
+        base colours along the luminance axis, which the modifier tables act on.
+    */
+    void encodeETCBlock(const uint8* px, uint8* out, float quality)
+    {
+        int bestError = INT_MAX;
+        for (int flip = 0; flip < 2; flip++)
+        {
+            int pixels[2][8];
+            int counts[2] = {0, 0};
+            float avg[2][3] = {{0, 0, 0}, {0, 0, 0}};
+            for (int y = 0; y < 4; y++)
+            {
+                for (int x = 0; x < 4; x++)
+                {
+                    int sub = flip ? (y >= 2) : (x >= 2);
+                    int i = y * 4 + x;
+                    pixels[sub][counts[sub]++] = i;
+                    for (int ch = 0; ch < 3; ch++)
+                        avg[sub][ch] += px[i * 4 + ch] / 8.0f;
+                }
+            }
+
+            for (int diff = 1; diff >= 0; diff--)
+            {
+                const int maxValue = diff ? 31 : 15;
+                int q[2][3];
+                for (int sub = 0; sub < 2; sub++)
+                    for (int ch = 0; ch < 3; ch++)
+                        q[sub][ch] = quantise(avg[sub][ch], maxValue);
+
+                bool fitsDelta = true;
+                for (int ch = 0; ch < 3; ch++)
+                    fitsDelta &= q[1][ch] - q[0][ch] >= -4 && q[1][ch] - q[0][ch] <= 3;
+                if (diff && !fitsDelta)
+                    continue;
+
+                const int maxShift = quality < 0.9f ? 0 : 1;
+                int tables[2] = {};
+                uint8 selectors[2][8] = {};
+                int shifts[2] = {};
+                int error = 0;
+                for (int sub = 0; sub < 2; sub++)
+                {
+                    int subError = INT_MAX;
+                    for (int shift = -maxShift; shift <= maxShift; shift++)
+                    {
+                        int shifted[3], base[3];
+                        for (int ch = 0; ch < 3; ch++)
+                        {
+                            shifted[ch] = std::min(std::max(q[sub][ch] + shift, 0), maxValue);
+                            base[ch] = diff ? extend5(shifted[ch]) : extend4(shifted[ch]);
+                        }
+                        int table = 0;
+                        uint8 sel[8] = {};
+                        int e = fitETCSubBlock(px, pixels[sub], base, table, sel);
+                        if (e < subError)
+                        {
+                            subError = e;
+                            tables[sub] = table;
+                            shifts[sub] = shift;
+                            memcpy(selectors[sub], sel, sizeof(sel));
+                        }
+                    }
+                    error += subError;
+                }
+
+                int colours[2][3];
+                bool valid = true;
+                for (int sub = 0; sub < 2; sub++)
+                    for (int ch = 0; ch < 3; ch++)
+                        colours[sub][ch] = std::min(std::max(q[sub][ch] + shifts[sub], 0), maxValue);
+                for (int ch = 0; diff && ch < 3; ch++)
+                    valid &= colours[1][ch] - colours[0][ch] >= -4 && colours[1][ch] - colours[0][ch] <= 3;
+                // the shifted colours may break the delta range, these blocks are skipped
+                if (!valid)
+                    continue;
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    for (int ch = 0; ch < 3; ch++)
+                    {
+                        if (diff)
+                            out[ch] = uint8((colours[0][ch] << 3) | ((colours[1][ch] - colours[0][ch]) & 0x7));
+                        else
+                            out[ch] = uint8((colours[0][ch] << 4) | colours[1][ch]);
+                    }
+                    out[3] = uint8((tables[0] << 5) | (tables[1] << 2) | (diff << 1) | flip);
+
+                    // selectors are stored column major, lsb and msb in separate planes
+                    uint32 bits = 0;
+                    for (int sub = 0; sub < 2; sub++)
+                    {
+                        for (int i = 0; i < 8; i++)
+                        {
+                            int p = pixels[sub][i];
+                            int bit = (p % 4) * 4 + p / 4;
+                            bits |= uint32(selectors[sub][i] & 0x1) << bit;
+                            bits |= uint32(selectors[sub][i] >> 1) << (16 + bit);
+                        }
+                    }
+                    for (int i = 0; i < 4; i++)
+                        out[4 + i] = uint8(bits >> (24 - 8 * i));
+                }
+
+                // the individual mode rarely wins when the differential one fits
+                if (diff && quality < 0.5f)
+                    break;
+            }
+        }
+    }
+
+    /// ETC2 EAC alpha, read from the channel px points to
+    void encodeEACBlock(const uint8* px, uint8* out, float quality)
+    {
+        int values[16];
+        int lo = 255, hi = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            // column major, like the selectors
+            values[i] = px[((i % 4) * 4 + i / 4) * 4];
+            lo = std::min(lo, values[i]);
+            hi = std::max(hi, values[i]);
+        }
+
+        int bestError = INT_MAX;
+        for (int t = 0; t < 16 && bestError > 0; t++)
+        {
+            const int* modifiers = EAC_MODIFIERS[t];
+            // the most negative and most positive modifiers
+            const int mlo = modifiers[3], mhi = modifiers[7];
+            const int ideal = std::max((hi - lo + (mhi - mlo) / 2) / (mhi - mlo), 1);
+            const int spread = quality < 0.5f ? 0 : quality < 0.9f ? 1 : 2;
+            for (int k = std::max(ideal - spread, 1); k <= std::min(ideal + spread, 15); k++)
+            {
+                int centre = (lo + hi - k * (mhi + mlo)) / 2;
+                for (int base = centre - spread; base <= centre + spread; base++)
+                {
+                    if (base < 0 || base > 255)
+                        continue;
+                    int error = 0;
+                    uint64 indices = 0;
+                    for (int i = 0; i < 16 && error < bestError; i++)
+                    {
+                        int best = INT_MAX, bestIdx = 0;
+                        for (int m = 0; m < 8; m++)
+                        {
+                            int d = values[i] - clampByte(base + modifiers[m] * k);
+                            if (d * d < best)
+                            {
+                                best = d * d;
+                                bestIdx = m;
+                            }
+                        }
+                        error += best;
+                        indices |= uint64(bestIdx) << (45 - 3 * i);
+                    }
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        out[0] = uint8(base);
+                        out[1] = uint8((k << 4) | t);
+                        for (int i = 0; i < 6; i++)
+                            out[2 + i] = uint8(indices >> (40 - 8 * i));
+                    }
+                }
+            }
+        }
+    }
+
+    /// writes the bits of a block, starting at the lsb of its first byte
+    struct BlockBitWriter
+    {
+        uint8* data;
+        uint32 pos;
+
+        void write(uint32 v, uint32 count)
+        {
+            for (uint32 i = 0; i < count; i++, pos++)
+                data[pos >> 3] |= uint8(((v >> i) & 0x1) << (pos & 0x7));
+        }
+    };
+
+    inline int squaredDistanceRGBA(const uint8* a, const uint8* b)
+    {
+        int da = a[3] - b[3];
+        return squaredDistance(a, b) + da * da;
+    }
+
+    /// nearest 7 bit RGBA endpoint of BC7 mode 6, with the p bit that fits it best
+    void quantiseBC7Endpoint(const float* v, int* q, int& pbit, int* decoded)
+    {
+        int bestError = INT_MAX;
+        for (int p = 0; p < 2; p++)
+        {
+            int error = 0, cand[4];
+            for (int ch = 0; ch < 4; ch++)
+            {
+                cand[ch] = std::min(std::max(int((v[ch] - p) / 2 + 0.5f), 0), 127);
+                int d = ((cand[ch] << 1) | p) - std::min(std::max(int(v[ch] + 0.5f), 0), 255);
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                pbit = p;
+                for (int ch = 0; ch < 4; ch++)
+                {
+                    q[ch] = cand[ch];
+                    decoded[ch] = (cand[ch] << 1) | p;
+                }
+            }
+        }
+    }
+
+    /** BC7 in mode 6, a single subset with RGBA endpoints and 4 bit indices
+
+        The endpoints are found as for BC1, but along the principal axis of the RGBA values.
+        The partitioned modes are not searched, which costs quality on blocks with several
+        distinct colours.
+    */
+    void encodeBC7Block(const uint8* px, uint8* out, float quality)
+    {
+        float mean[4] = {0, 0, 0, 0};
+        float lo[4] = {255, 255, 255, 255}, hi[4] = {0, 0, 0, 0};
+        for (int i = 0; i < 16; i++)
+        {
+            for (int ch = 0; ch < 4; ch++)
+            {
+                mean[ch] += px[i * 4 + ch];
+                lo[ch] = std::min(lo[ch], float(px[i * 4 + ch]));
+                hi[ch] = std::max(hi[ch], float(px[i * 4 + ch]));
+            }
+        }
+
+        if (quality < 0.25f)
+        {
+            // inset the bounding box, as the extremes are rarely hit exactly
+            for (int ch = 0; ch < 4; ch++)
+            {
+                float inset = (hi[ch] - lo[ch]) / 32;
+                lo[ch] += inset;
+                hi[ch] -= inset;
+            }
+        }
+        else
+        {
+            for (float& m : mean)
+                m /= 16;
+
+            float cov[4][4] = {};
+            for (int i = 0; i < 16; i++)
+            {
+                float d[4];
+                for (int ch = 0; ch < 4; ch++)
+                    d[ch] = px[i * 4 + ch] - mean[ch];
+                for (int a = 0; a < 4; a++)
+                    for (int b = 0; b < 4; b++)
+                        cov[a][b] += d[a] * d[b];
+            }
+
+            // power iteration, starting at the bounding box diagonal
+            float axis[4] = {hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2], hi[3] - lo[3]};
+            for (int iter = 0; iter < 8; iter++)
+            {
+                float next[4] = {0, 0, 0, 0}, len = 0;
+                for (int a = 0; a < 4; a++)
+                {
+                    for (int b = 0; b < 4; b++)
+                        next[a] += cov[a][b] * axis[b];
+                    len = std::max(len, std::abs(next[a]));
+                }
+                if (len < 1e-6f)
+                    break;
+                for (int ch = 0; ch < 4; ch++)
+                    axis[ch] = next[ch] / len;
+            }
+            float len2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3];
+
+            if (len2 > 1e-6f)
+            {
+                float tmin = FLT_MAX, tmax = -FLT_MAX;
+                for (int i = 0; i < 16; i++)
+                {
+                    float t = 0;
+                    for (int ch = 0; ch < 4; ch++)
+                        t += (px[i * 4 + ch] - mean[ch]) * axis[ch];
+                    tmin = std::min(tmin, t);
+                    tmax = std::max(tmax, t);
+                }
+                for (int ch = 0; ch < 4; ch++)
+                {
+                    lo[ch] = mean[ch] + tmin / len2 * axis[ch];
+                    hi[ch] = mean[ch] + tmax / len2 * axis[ch];
+                }
+            }
+        }
+
+        const int refinements = quality < 0.5f ? 0 : quality < 0.9f ? 1 : 4;
+        int bestError = INT_MAX;
+        int bestQ[2][4], bestP[2];
+        uint8 bestIndices[16];
+        for (int iter = 0;; iter++)
+        {
+            int q[2][4], p[2], endpoints[2][4];
+            quantiseBC7Endpoint(lo, q[0], p[0], endpoints[0]);
+            quantiseBC7Endpoint(hi, q[1], p[1], endpoints[1]);
+
+            uint8 palette[16][4];
+            for (int i = 0; i < 16; i++)
+                for (int ch = 0; ch < 4; ch++)
+                    palette[i][ch] = bc7Interpolate(endpoints[0][ch], endpoints[1][ch], BC7_WEIGHTS[2][i]);
+
+            uint8 indices[16];
+            int error = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                int best = INT_MAX;
+                for (int c = 0; c < 16; c++)
+                {
+                    int d = squaredDistanceRGBA(px + i * 4, palette[c]);
+                    if (d < best)
+                    {
+                        best = d;
+                        indices[i] = uint8(c);
+                    }
+                }
+                error += best;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                memcpy(bestQ, q, sizeof(q));
+                memcpy(bestP, p, sizeof(p));
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+
+            if (iter == refinements || error == 0)
+                break;
+
+            // least squares endpoints for the chosen indices
+            float aa = 0, ab = 0, bb = 0, ax[4] = {0, 0, 0, 0}, bx[4] = {0, 0, 0, 0};
+            for (int i = 0; i < 16; i++)
+            {
+                float b = BC7_WEIGHTS[2][indices[i]] / 64.0f, a = 1 - b;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (int ch = 0; ch < 4; ch++)
+                {
+                    ax[ch] += a * px[i * 4 + ch];
+                    bx[ch] += b * px[i * 4 + ch];
+                }
+            }
+            float det = aa * bb - ab * ab;
+            if (std::abs(det) < 1e-6f)
+                break;
+            for (int ch = 0; ch < 4; ch++)
+            {
+                lo[ch] = (ax[ch] * bb - bx[ch] * ab) / det;
+                hi[ch] = (bx[ch] * aa - ax[ch] * ab) / det;
+            }
+        }
+
+        // the msb of the first index is implied to be 0, which swapping the endpoints ensures
+        if (bestIndices[0] & 0x8)
+        {
+            std::swap(bestQ[0], bestQ[1]);
+            std::swap(bestP[0], bestP[1]);
+            for (uint8& idx : bestIndices)
+                idx = uint8(15 - idx);
+        }
+
+        memset(out, 0, 16);
+        BlockBitWriter bits = {out, 0};
+        bits.write(1 << 6, 7);
+        for (int ch = 0; ch < 4; ch++)
+        {
+            bits.write(uint32(bestQ[0][ch]), 7);
+            bits.write(uint32(bestQ[1][ch]), 7);
+        }
+        bits.write(uint32(bestP[0]), 1);
+        bits.write(uint32(bestP[1]), 1);
+        for (int i = 0; i < 16; i++)
+            bits.write(bestIndices[i], i == 0 ? 3 : 4);
+    }
+
+    void encodeBlock(PixelFormat format, const uint8* px, uint8* block, float quality)
+    {
+        switch (format)
+        {
+        case PF_DXT1:
+            encodeColourBlock(px, block, quality, true);
+            break;
+        case PF_DXT3:
+            encodeExplicitAlphaBlock(px, block);
+            encodeColourBlock(px, block + 8, quality, false);
+            break;
+        case PF_DXT5:
+            encodeInterpolatedBlock(px + 3, block, quality);
+            encodeColourBlock(px, block + 8, quality, false);
+            break;
+        case PF_BC4_UNORM:
+            encodeInterpolatedBlock(px, block, quality);
+            break;
+        case PF_BC5_UNORM:
+            encodeInterpolatedBlock(px, block, quality);
+            encodeInterpolatedBlock(px + 1, block + 8, quality);
+            break;
+        case PF_BC7_UNORM:
+            encodeBC7Block(px, block, quality);
+            break;
+        case PF_ETC1_RGB8:
+        case PF_ETC2_RGB8:
+            encodeETCBlock(px, block, quality);
+            break;
+        case PF_ETC2_RGBA8:
+            encodeEACBlock(px + 3, block, quality);
+            encodeETCBlock(px, block + 8, quality);
+            break;
+        default:
+            break;
+        }
+    }
+    }
+
+    bool canDecompress(PixelFormat format)
+    {
+        return getBlockSize(format) != 0;
+    }
+
+    void decompress(const PixelBox& src, const PixelBox& dst)
+    {
+        OgreAssert(canDecompress(src.format), "decompression of this format is not supported");
+        OgreAssert(src.getSize() == dst.getSize() && !PixelUtil::isCompressed(dst.format), "");
+
+        const size_t blockSize = getBlockSize(src.format);
+        uint32 blockWidth, blockHeight;
+        getBlockFootprint(src.format, blockWidth, blockHeight);
+        const PixelFormat stripFormat = getDecodedFormat(src.format);
+        const size_t pixelSize = PixelUtil::getNumElemBytes(stripFormat);
+        const size_t width = src.getWidth(), height = src.getHeight();
+        const size_t blocksX = (width + blockWidth - 1) / blockWidth, blocksY = (height + blockHeight - 1) / blockHeight;
+        const uint8* data = src.data + src.front * PixelUtil::getMemorySize(width, height, 1, src.format);
+
+        // decode rows of blocks into strips of the block height, then convert them into place
+        WorkQueue::parallelFor(blocksY * src.getDepth(), std::max<size_t>(1, 1024 / blocksX),
+                               [&](size_t begin, size_t end) {
+            const size_t stripPitch = blocksX * blockWidth * pixelSize;
+            std::vector<uint8> strip(stripPitch * blockHeight);
+            for (size_t r = begin; r < end; r++)
+            {
+                const uint8* blocks = data + r * blocksX * blockSize;
+                for (size_t bx = 0; bx < blocksX; bx++)
+                    decodeBlock(src.format, blocks + bx * blockSize, strip.data() + bx * blockWidth * pixelSize,
+                                stripPitch);
+
+                size_t z = r / blocksY, y = (r % blocksY) * blockHeight;
+                PixelBox stripBox(Box(0, 0, uint32(width), uint32(std::min<size_t>(blockHeight, height - y))),
+                                  stripFormat, strip.data());
+                stripBox.rowPitch = uint32(blocksX * blockWidth);
+                stripBox.slicePitch = stripBox.rowPitch * blockHeight;
+
+                PixelBox dstBox = dst;
+                dstBox.top = uint32(dst.top + y);
+                dstBox.bottom = uint32(dstBox.top + stripBox.getHeight());
+                dstBox.front = uint32(dst.front + z);
+                dstBox.back = dstBox.front + 1;
+                PixelUtil::bulkPixelConversion(stripBox, dstBox);
+            }
+        });
+    }
+
+    bool canCompress(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PF_DXT1:
+        case PF_DXT3:
+        case PF_DXT5:
+        case PF_BC4_UNORM:
+        case PF_BC5_UNORM:
+        case PF_BC7_UNORM:
+        case PF_ETC1_RGB8:
+        case PF_ETC2_RGB8:
+        case PF_ETC2_RGBA8:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void compress(const PixelBox& src, const PixelBox& dst, float quality)
+    {
+        OgreAssert(canCompress(dst.format), "compression to this format is not supported");
+        OgreAssert(src.getSize() == dst.getSize() && !PixelUtil::isCompressed(src.format), "");
+
+        const size_t blockSize = getBlockSize(dst.format);
+        const size_t width = src.getWidth(), height = src.getHeight();
+        const size_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        uint8* data = dst.data + dst.front * PixelUtil::getMemorySize(width, height, 1, dst.format);
+
+        // convert 4 pixel high strips to RGBA, then encode their blocks. Encoding is far more
+        // expensive than decoding, so the work is split into smaller chunks
+        WorkQueue::parallelFor(blocksY * src.getDepth(), std::max<size_t>(1, 256 / blocksX),
+                               [&](size_t begin, size_t end) {
+            const size_t stripPitch = blocksX * 16;
+            std::vector<uint8> strip(stripPitch * 4);
+            uint8 pixels[64];
+            for (size_t r = begin; r < end; r++)
+            {
+                size_t z = r / blocksY, y = (r % blocksY) * 4;
+                const size_t rows = std::min<size_t>(4, height - y);
+                PixelBox stripBox(Box(0, 0, uint32(width), uint32(rows)), PF_BYTE_RGBA, strip.data());
+                stripBox.rowPitch = uint32(blocksX * 4);
+                stripBox.slicePitch = stripBox.rowPitch * 4;
+
+                PixelBox srcBox = src;
+                srcBox.top = uint32(src.top + y);
+                srcBox.bottom = uint32(srcBox.top + rows);
+                srcBox.front = uint32(src.front + z);
+                srcBox.back = srcBox.front + 1;
+                PixelUtil::bulkPixelConversion(srcBox, stripBox);
+
+                uint8* blocks = data + r * blocksX * blockSize;
+                for (size_t bx = 0; bx < blocksX; bx++)
+                {
+                    // partial blocks at the border repeat the last row and column
+                    for (size_t i = 0; i < 16; i++)
+                    {
+                        size_t px = std::min(bx * 4 + i % 4, width - 1), py = std::min(i / 4, rows - 1);
+                        memcpy(pixels + i * 4, strip.data() + py * stripPitch + px * 4, 4);
+                    }
+                    encodeBlock(dst.format, pixels, blocks + bx * blockSize, quality);
+                }
+            }
+        });
+    }
+}
+}
@@ -0,0 +1,85 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OgreBlockCompression_H__
+#define __OgreBlockCompression_H__
+
+#include "OgrePrerequisites.h"
+#include "OgrePixelFormat.h"
+
+namespace Ogre {
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Image
+    *  @{
+    */
+
+    /** Software decoding and encoding of block compressed pixel formats
+
+        Decoding is used as fallback, when the RenderSystem does not support a compressed format
+        or there is no RenderSystem at all. Encoding allows baking compressed textures without
+        external tools. In both directions rows of blocks are processed concurrently on the WorkQueue.
+        The block kernels are portable integer code, the endpoint interpolation of BC7 and ASTC uses SSE2
+        where available.
+    */
+    namespace BlockCompression
+    {
+        /** Whether blocks of this format can be decoded. DXT1-5, BC4, BC5, BC6H, BC7, ETC1, ETC2 and ASTC LDR
+            are supported
+
+            BC6H is decoded to half floats, the other formats to 8 bits per channel. ASTC blocks are decoded with
+            2D footprints, so 3D ASTC data is not supported.
+        */
+        bool canDecompress(PixelFormat format);
+
+        /** Decode the compressed src into the uncompressed dst of the same size
+
+            src must be consecutive, as compressed boxes only have slice granularity
+        */
+        void decompress(const PixelBox& src, const PixelBox& dst);
+
+        /** Whether blocks of this format can be encoded. DXT1, DXT3, DXT5, BC4, BC5, BC7, ETC1 and ETC2 RGB/ RGBA
+            are supported
+
+            BC7 is only encoded in mode 6, a single subset with RGBA endpoints
+        */
+        bool canCompress(PixelFormat format);
+
+        /** Encode the uncompressed src into the compressed dst of the same size
+
+            dst must be consecutive, as compressed boxes only have slice granularity
+            @param quality in [0, 1]. Higher values search more endpoint and modifier candidates,
+            which is slower but reduces the error
+        */
+        void compress(const PixelBox& src, const PixelBox& dst, float quality = 0.5f);
+    }
+    /** @} */
+    /** @} */
+}
+
+#endif
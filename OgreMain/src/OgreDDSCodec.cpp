@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include "OgreDDSCodec.h"
 #include "OgreImage.h"
+#include "OgreBlockCompression.h"
 
 namespace Ogre {
     // Internal DDS structure definitions
@@ -96,22 +97,6 @@ namespace Ogre {
         // 16 2-bit indexes, each byte here is one row
         uint8 indexRow[4];
     };
-    // An 8-byte DXT explicit alpha block, represents a 4x4 texel area. Used by DXT2/3
-    struct DXTExplicitAlphaBlock
-    {
-        // 16 4-bit values, each 16-bit value is one row
-        uint16 alphaRow[4];
-    };
-    // An 8-byte DXT interpolated alpha block, represents a 4x4 texel area. Used by DXT4/5
-    struct DXTInterpolatedAlphaBlock
-    {
-        // 2 alpha ranges
-        uint8 alpha_0;
-        uint8 alpha_1;
-        // 16 3-bit indexes. Unfortunately 3 bits doesn't map too well to row bytes
-        // so just stored raw
-        uint8 indexes[6];
-    };
     
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
 #pragma pack (pop)
@@ -130,6 +115,7 @@ namespace {
     const uint32 DDSD_WIDTH = 0x00000004;
     const uint32 DDSD_PIXELFORMAT = 0x00001000;
     const uint32 DDSD_DEPTH = 0x00800000;
+    const uint32 DDSD_LINEARSIZE = 0x00080000;
     const uint32 DDPF_ALPHAPIXELS = 0x00000001;
     const uint32 DDPF_FOURCC = 0x00000004;
     const uint32 DDPF_RGB = 0x00000040;
@@ -148,7 +134,6 @@ namespace {
     // Currently unused
 //    const uint32 DDSD_PITCH = 0x00000008;
 //    const uint32 DDSD_MIPMAPCOUNT = 0x00020000;
-//    const uint32 DDSD_LINEARSIZE = 0x00080000;
 
     // Special FourCC codes
     const uint32 D3DFMT_R16F            = 111;
@@ -240,6 +225,12 @@ namespace {
         case PF_FLOAT16_R:
         case PF_FLOAT16_RGBA:
         case PF_FLOAT32_RGBA:
+        case PF_DXT1:
+        case PF_DXT3:
+        case PF_DXT5:
+        case PF_BC4_UNORM:
+        case PF_BC5_UNORM:
+        case PF_BC7_UNORM:
             break;
         default:
             // No crazy FOURCC or 565 et al. file formats at this stage
@@ -317,6 +308,40 @@ namespace {
             // Initalise the SizeOrPitch flags (power two textures for now)
             ddsHeaderSizeOrPitch = static_cast<uint32>(ddsHeaderRgbBits * image->getWidth());
 
+            uint32 compressedFourCC = 0;
+            switch(image->getFormat())
+            {
+            case PF_DXT1:
+                compressedFourCC = FOURCC('D', 'X', 'T', '1');
+                break;
+            case PF_DXT3:
+                compressedFourCC = FOURCC('D', 'X', 'T', '3');
+                break;
+            case PF_DXT5:
+                compressedFourCC = FOURCC('D', 'X', 'T', '5');
+                break;
+            case PF_BC4_UNORM:
+                compressedFourCC = FOURCC('B', 'C', '4', 'U');
+                break;
+            case PF_BC5_UNORM:
+                compressedFourCC = FOURCC('B', 'C', '5', 'U');
+                break;
+            case PF_BC7_UNORM:
+                // only expressible through the extended header
+                compressedFourCC = FOURCC('D', 'X', '1', '0');
+                break;
+            default:
+                break;
+            }
+
+            if (compressedFourCC)
+            {
+                // block compressed data, sizeOrPitch is the size of the top level
+                ddsHeaderFlags |= DDSD_LINEARSIZE;
+                ddsHeaderSizeOrPitch = static_cast<uint32>(
+                    PixelUtil::getMemorySize(image->getWidth(), image->getHeight(), 1, image->getFormat()));
+            }
+
             // Initalise the caps flags
             ddsHeaderCaps1 = (isVolume||isCubeMap) ? DDSCAPS_COMPLEX|DDSCAPS_TEXTURE : DDSCAPS_TEXTURE;
             if (isVolume)
@@ -365,6 +390,10 @@ namespace {
             else if (isFloat32) {
                 ddsHeader.pixelFormat.fourCC = D3DFMT_A32B32G32R32F;
             }
+            else if (compressedFourCC) {
+                ddsHeader.pixelFormat.flags = DDPF_FOURCC;
+                ddsHeader.pixelFormat.fourCC = compressedFourCC;
+            }
             else {
                 ddsHeader.pixelFormat.fourCC = 0;
             }
@@ -379,11 +408,31 @@ namespace {
             if( flipRgbMasks )
                 std::swap( ddsHeader.pixelFormat.redMask, ddsHeader.pixelFormat.blueMask );
 
+            if (compressedFourCC)
+            {
+                ddsHeader.pixelFormat.alphaMask = 0;
+                ddsHeader.pixelFormat.redMask = 0;
+                ddsHeader.pixelFormat.greenMask = 0;
+                ddsHeader.pixelFormat.blueMask = 0;
+            }
+
             ddsHeader.caps.caps1 = ddsHeaderCaps1;
             ddsHeader.caps.caps2 = ddsHeaderCaps2;
 //          ddsHeader.caps.reserved[0] = 0;
 //          ddsHeader.caps.reserved[1] = 0;
 
+            DDSExtendedHeader ddsExtendedHeader;
+            const bool hasExtendedHeader = compressedFourCC == FOURCC('D', 'X', '1', '0');
+            if (hasExtendedHeader)
+            {
+                ddsExtendedHeader.dxgiFormat = 98; // DXGI_FORMAT_BC7_UNORM
+                ddsExtendedHeader.resourceDimension = isVolume ? 4 : 3; // D3D10_RESOURCE_DIMENSION_TEXTURE3D/ 2D
+                ddsExtendedHeader.miscFlag = isCubeMap ? 0x4 : 0; // D3D10_RESOURCE_MISC_TEXTURECUBE
+                ddsExtendedHeader.arraySize = 1;
+                ddsExtendedHeader.reserved = 0;
+                flipEndian(&ddsExtendedHeader, 4, sizeof(DDSExtendedHeader) / 4);
+            }
+
             // Swap endian
             flipEndian(&ddsMagic, sizeof(uint32));
             flipEndian(&ddsHeader, 4, sizeof(DDSHeader) / 4);
@@ -409,6 +458,8 @@ namespace {
                 of.open(outFileName.c_str(), std::ios_base::binary|std::ios_base::out);
                 of.write((const char *)&ddsMagic, sizeof(uint32));
                 of.write((const char *)&ddsHeader, DDS_HEADER_SIZE);
+                if (hasExtendedHeader)
+                    of.write((const char *)&ddsExtendedHeader, sizeof(DDSExtendedHeader));
                 // XXX flipEndian on each pixel chunk written unless isFloat32r ?
                 of.write(dataPtr, image->getSize());
                 of.close();
@@ -614,127 +665,6 @@ namespace {
             "DDSCodec::convertPixelFormat");
     }
     //---------------------------------------------------------------------
-    void DDSCodec::unpackDXTColour(PixelFormat pf, const DXTColourBlock& block, 
-        ColourValue* pCol) const
-    {
-        // Note - we assume all values have already been endian swapped
-
-        // Colour lookup table
-        ColourValue derivedColours[4];
-
-        if (pf == PF_DXT1 && block.colour_0 <= block.colour_1)
-        {
-            // 1-bit alpha
-            PixelUtil::unpackColour(&(derivedColours[0]), PF_R5G6B5, &(block.colour_0));
-            PixelUtil::unpackColour(&(derivedColours[1]), PF_R5G6B5, &(block.colour_1));
-            // one intermediate colour, half way between the other two
-            derivedColours[2] = (derivedColours[0] + derivedColours[1]) / 2;
-            // transparent colour
-            derivedColours[3] = ColourValue::ZERO;
-        }
-        else
-        {
-            PixelUtil::unpackColour(&(derivedColours[0]), PF_R5G6B5, &(block.colour_0));
-            PixelUtil::unpackColour(&(derivedColours[1]), PF_R5G6B5, &(block.colour_1));
-            // first interpolated colour, 1/3 of the way along
-            derivedColours[2] = (2 * derivedColours[0] + derivedColours[1]) / 3;
-            // second interpolated colour, 2/3 of the way along
-            derivedColours[3] = (derivedColours[0] + 2 * derivedColours[1]) / 3;
-        }
-
-        // Process 4x4 block of texels
-        for (size_t row = 0; row < 4; ++row)
-        {
-            for (size_t x = 0; x < 4; ++x)
-            {
-                // LSB come first
-                uint8 colIdx = static_cast<uint8>(block.indexRow[row] >> (x * 2) & 0x3);
-                if (pf == PF_DXT1)
-                {
-                    // Overwrite entire colour
-                    pCol[(row * 4) + x] = derivedColours[colIdx];
-                }
-                else
-                {
-                    // alpha has already been read (alpha precedes colour)
-                    ColourValue& col = pCol[(row * 4) + x];
-                    col.r = derivedColours[colIdx].r;
-                    col.g = derivedColours[colIdx].g;
-                    col.b = derivedColours[colIdx].b;
-                }
-            }
-
-        }
-
-
-    }
-    //---------------------------------------------------------------------
-    void DDSCodec::unpackDXTAlpha(
-        const DXTExplicitAlphaBlock& block, ColourValue* pCol) const
-    {
-        // Note - we assume all values have already been endian swapped
-        
-        // This is an explicit alpha block, 4 bits per pixel, LSB first
-        for (unsigned short row : block.alphaRow)
-        {
-            for (size_t x = 0; x < 4; ++x)
-            {
-                // Shift and mask off to 4 bits
-                uint8 val = static_cast<uint8>(row >> (x * 4) & 0xF);
-                // Convert to [0,1]
-                pCol->a = (Real)val / (Real)0xF;
-                pCol++;
-                
-            }
-            
-        }
-
-    }
-    //---------------------------------------------------------------------
-    void DDSCodec::unpackDXTAlpha(
-        const DXTInterpolatedAlphaBlock& block, ColourValue* pCol) const
-    {
-        // Adaptive 3-bit alpha part
-        float derivedAlphas[8];
-
-        // Explicit extremes
-        derivedAlphas[0] = ((float) block.alpha_0) * (1.0f / 255.0f);
-        derivedAlphas[1] = ((float) block.alpha_1) * (1.0f / 255.0f);
-
-        if(block.alpha_0 > block.alpha_1)
-        {
-            // 6 interpolated alpha values.
-            // full range including extremes at [0] and [7]
-            // we want to fill in [1] through [6] at weights ranging
-            // from 1/7 to 6/7
-            for(size_t i = 1; i < 7; ++i)
-                derivedAlphas[i + 1] = (derivedAlphas[0] * (7 - i) + derivedAlphas[1] * i) * (1.0f / 7.0f);
-        }
-        else
-        {
-            // 4 interpolated alpha values.
-            // full range including extremes at [0] and [5]
-            // we want to fill in [1] through [4] at weights ranging
-            // from 1/5 to 4/5
-            for(size_t i = 1; i < 5; ++i)
-                derivedAlphas[i + 1] = (derivedAlphas[0] * (5 - i) + derivedAlphas[1] * i) * (1.0f / 5.0f);
-
-            derivedAlphas[6] = 0.0f;
-            derivedAlphas[7] = 1.0f;
-        }
-
-        // Ok, now we've built the reference values, process the indexes
-        uint32 dw = block.indexes[0] | (block.indexes[1] << 8) | (block.indexes[2] << 16);
-
-        for(size_t i = 0; i < 8; ++i, dw >>= 3)
-            pCol[i].a = derivedAlphas[dw & 0x7];
-
-        dw = block.indexes[3] | (block.indexes[4] << 8) | (block.indexes[5] << 16);
-
-        for(size_t i = 8; i < 16; ++i, dw >>= 3)
-            pCol[i].a = derivedAlphas[dw & 0x7];
-    }
-    //---------------------------------------------------------------------
     void DDSCodec::decode(const DataStreamPtr& stream, const Any& output) const
     {
         Image* image = any_cast<Image*>(output);
@@ -823,8 +753,16 @@ namespace {
 
         if (PixelUtil::isCompressed(sourceFormat))
         {
-            if (Root::getSingleton().getRenderSystem() == NULL ||
-                !Root::getSingleton().getRenderSystem()->getCapabilities()->hasCapability(RSC_TEXTURE_COMPRESSION_DXT))
+            Capabilities requiredCap = RSC_TEXTURE_COMPRESSION_DXT;
+            if (sourceFormat == PF_BC4_UNORM || sourceFormat == PF_BC4_SNORM ||
+                sourceFormat == PF_BC5_UNORM || sourceFormat == PF_BC5_SNORM)
+                requiredCap = RSC_TEXTURE_COMPRESSION_BC4_BC5;
+            else if (sourceFormat == PF_BC6H_UF16 || sourceFormat == PF_BC6H_SF16 || sourceFormat == PF_BC7_UNORM)
+                requiredCap = RSC_TEXTURE_COMPRESSION_BC6H_BC7;
+
+            RenderSystem* rs = Root::getSingleton().getRenderSystem();
+            if ((!rs || !rs->getCapabilities()->hasCapability(requiredCap)) &&
+                BlockCompression::canDecompress(sourceFormat))
             {
                 // We'll need to decompress
                 decompressDXT = true;
@@ -855,15 +793,14 @@ namespace {
                         format = PF_BYTE_RGB;
                     }
                     break;
-                case PF_DXT2:
-                case PF_DXT3:
-                case PF_DXT4:
-                case PF_DXT5:
-                    // full alpha present, formats vary only in encoding 
-                    format = PF_BYTE_RGBA;
+                case PF_BC6H_UF16:
+                case PF_BC6H_SF16:
+                    // HDR colours without alpha
+                    format = PF_FLOAT16_RGB;
                     break;
                 default:
-                    // all other cases need no special format handling
+                    // full alpha present or single/dual channel formats
+                    format = PF_BYTE_RGBA;
                     break;
                 }
             }
@@ -902,92 +839,14 @@ namespace {
                     // Compressed data
                     if (decompressDXT)
                     {
-                        DXTColourBlock col;
-                        DXTInterpolatedAlphaBlock iAlpha;
-                        DXTExplicitAlphaBlock eAlpha;
-                        // 4x4 block of decompressed colour
-                        ColourValue tempColours[16];
-                        size_t destBpp = PixelUtil::getNumElemBytes(format);
-
-                        // slices are done individually
-                        for(size_t z = 0; z < depth; ++z)
-                        {
-                            size_t remainingHeight = height;
-
-                            // 4x4 blocks in x/y
-                            for (size_t y = 0; y < height; y += 4)
-                            {
-                                size_t sy = std::min<size_t>( remainingHeight, 4u );
-                                remainingHeight -= sy;
-
-                                size_t remainingWidth = width;
-
-                                for (size_t x = 0; x < width; x += 4)
-                                {
-                                    size_t sx = std::min<size_t>( remainingWidth, 4u );
-                                    size_t destPitchMinus4 = dstPitch - destBpp * sx;
-
-                                    remainingWidth -= sx;
-
-                                    if (sourceFormat == PF_DXT2 || 
-                                        sourceFormat == PF_DXT3)
-                                    {
-                                        // explicit alpha
-                                        stream->read(&eAlpha, sizeof(DXTExplicitAlphaBlock));
-                                        flipEndian(eAlpha.alphaRow, sizeof(uint16), 4);
-                                        unpackDXTAlpha(eAlpha, tempColours) ;
-                                    }
-                                    else if (sourceFormat == PF_DXT4 || 
-                                        sourceFormat == PF_DXT5)
-                                    {
-                                        // interpolated alpha
-                                        stream->read(&iAlpha, sizeof(DXTInterpolatedAlphaBlock));
-                                        flipEndian(&(iAlpha.alpha_0), sizeof(uint16));
-                                        flipEndian(&(iAlpha.alpha_1), sizeof(uint16));
-                                        unpackDXTAlpha(iAlpha, tempColours) ;
-                                    }
-                                    // always read colour
-                                    stream->read(&col, sizeof(DXTColourBlock));
-                                    flipEndian(&(col.colour_0), sizeof(uint16));
-                                    flipEndian(&(col.colour_1), sizeof(uint16));
-                                    unpackDXTColour(sourceFormat, col, tempColours);
-
-                                    // write 4x4 block to uncompressed version
-                                    for (size_t by = 0; by < sy; ++by)
-                                    {
-                                        for (size_t bx = 0; bx < sx; ++bx)
-                                        {
-                                            PixelUtil::packColour(tempColours[by*4+bx],
-                                                format, destPtr);
-                                            destPtr = static_cast<void*>(
-                                                static_cast<uchar*>(destPtr) + destBpp);
-                                        }
-                                        // advance to next row
-                                        destPtr = static_cast<void*>(
-                                            static_cast<uchar*>(destPtr) + destPitchMinus4);
-                                    }
-                                    // next block. Our dest pointer is 4 lines down
-                                    // from where it started
-                                    if (x + 4 >= width)
-                                    {
-                                        // Jump back to the start of the line
-                                        destPtr = static_cast<void*>(
-                                            static_cast<uchar*>(destPtr) - destPitchMinus4);
-                                    }
-                                    else
-                                    {
-                                        // Jump back up 4 rows and 4 pixels to the
-                                        // right to be at the next block to the right
-                                        destPtr = static_cast<void*>(
-                                            static_cast<uchar*>(destPtr) - dstPitch * sy + destBpp * sx);
-
-                                    }
-
-                                }
-
-                            }
-                        }
-
+                        // read the blocks of this mip and decode them in place
+                        size_t dxtSize = PixelUtil::getMemorySize(width, height, depth, sourceFormat);
+                        std::vector<uchar> blocks(dxtSize);
+                        stream->read(blocks.data(), dxtSize);
+                        PixelUtil::bulkPixelConversion(PixelBox(width, height, depth, sourceFormat, blocks.data()),
+                                                       PixelBox(width, height, depth, format, destPtr));
+                        destPtr = static_cast<void*>(static_cast<uchar*>(destPtr) +
+                                                     PixelUtil::getMemorySize(width, height, depth, format));
                     }
                     else
                     {
@@ -39,11 +39,6 @@ namespace Ogre {
     *  @{
     */
 
-    // Forward declarations
-    struct DXTColourBlock;
-    struct DXTExplicitAlphaBlock;
-    struct DXTInterpolatedAlphaBlock;
-
     /** Codec specialized in loading DDS (Direct Draw Surface) images.
 
         We implement our own codec here since we need to be able to keep DXT
@@ -59,13 +54,6 @@ namespace Ogre {
         PixelFormat convertPixelFormat(uint32 rgbBits, uint32 rMask,
             uint32 gMask, uint32 bMask, uint32 aMask) const;
 
-        /// Unpack DXT colours into array of 16 colour values
-        void unpackDXTColour(PixelFormat pf, const DXTColourBlock& block, ColourValue* pCol) const;
-        /// Unpack DXT alphas into array of 16 colour values
-        void unpackDXTAlpha(const DXTExplicitAlphaBlock& block, ColourValue* pCol) const;
-        /// Unpack DXT alphas into array of 16 colour values
-        void unpackDXTAlpha(const DXTInterpolatedAlphaBlock& block, ColourValue* pCol) const;
-
         /// Single registered codec instance
         static DDSCodec* msInstance;
     public:
@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include "OgreETCCodec.h"
 #include "OgreImage.h"
+#include "OgreBlockCompression.h"
 
 #define KTX_ENDIAN_REF      (0x04030201)
 #define KTX_ENDIAN_REF_REV  (0x01020304)
@@ -134,6 +135,100 @@ namespace Ogre {
         Image* image = any_cast<Image*>(output);
 
         mType == "pkm" ? decodePKM(stream, image) : decodeKTX(stream, image);
+
+        PixelFormat format = image->getFormat();
+        if (!BlockCompression::canDecompress(format))
+            return;
+
+        // KTX files may also hold DXT and ASTC blocks
+        Capabilities requiredCap = RSC_TEXTURE_COMPRESSION_ETC2;
+        if (format == PF_ETC1_RGB8)
+            requiredCap = RSC_TEXTURE_COMPRESSION_ETC1;
+        else if (format == PF_DXT1 || format == PF_DXT3 || format == PF_DXT5)
+            requiredCap = RSC_TEXTURE_COMPRESSION_DXT;
+        else if (format >= PF_ASTC_RGBA_4X4_LDR && format <= PF_ASTC_RGBA_12X12_LDR)
+            requiredCap = RSC_TEXTURE_COMPRESSION_ASTC;
+        RenderSystem* rs = Root::getSingleton().getRenderSystem();
+        if (rs && rs->getCapabilities()->hasCapability(requiredCap))
+            return;
+
+        // there is no RenderSystem or it can not sample this format, so decode it in software
+        Image compressed(*image);
+        image->create(PF_BYTE_RGBA, compressed.getWidth(), compressed.getHeight(), compressed.getDepth(),
+                      compressed.getNumFaces(), compressed.getNumMipmaps());
+        for (uint32 face = 0; face < compressed.getNumFaces(); face++)
+        {
+            for (uint32 mip = 0; mip <= compressed.getNumMipmaps(); mip++)
+                PixelUtil::bulkPixelConversion(compressed.getPixelBox(face, mip), image->getPixelBox(face, mip));
+        }
+    }
+    //---------------------------------------------------------------------
+    void ETCCodec::encodeToFile(const Any& input, const String& outFileName) const
+    {
+        if (mType != "ktx")
+            return ImageCodec::encodeToFile(input, outFileName);
+
+        Image* image = any_cast<Image*>(input);
+
+        uint32 internalFormat = 0;
+        uint32 baseInternalFormat = 0x1908; // GL_RGBA
+        switch(image->getFormat())
+        {
+        case PF_ETC1_RGB8:
+            internalFormat = 0x8D64; // GL_ETC1_RGB8_OES
+            baseInternalFormat = 0x1907; // GL_RGB
+            break;
+        case PF_ETC2_RGB8:
+            internalFormat = 37492; // GL_COMPRESSED_RGB8_ETC2
+            baseInternalFormat = 0x1907; // GL_RGB
+            break;
+        case PF_ETC2_RGBA8:
+            internalFormat = 37496; // GL_COMPRESSED_RGBA8_ETC2_EAC
+            break;
+        case PF_ETC2_RGB8A1:
+            internalFormat = 37494; // GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+            break;
+        case PF_DXT1:
+            internalFormat = 33777;
+            break;
+        case PF_DXT3:
+            internalFormat = 33778;
+            break;
+        case PF_DXT5:
+            internalFormat = 33779;
+            break;
+        default:
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+                        "KTX encoding for " + PixelUtil::getFormatName(image->getFormat()) + " not supported");
+        }
+
+        const uint8 KTXFileIdentifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+        // compressed data, so glType and glFormat are 0 and the values are in native byte order
+        KTXHeader header = {};
+        memcpy(header.identifier, KTXFileIdentifier, sizeof(KTXFileIdentifier));
+        header.endianness = KTX_ENDIAN_REF;
+        header.glTypeSize = 1;
+        header.glInternalFormat = internalFormat;
+        header.glBaseInternalFormat = baseInternalFormat;
+        header.pixelWidth = image->getWidth();
+        header.pixelHeight = image->getHeight();
+        header.numberOfFaces = image->getNumFaces();
+        header.numberOfMipmapLevels = image->getNumMipmaps() + 1;
+
+        std::ofstream of(outFileName.c_str(), std::ios_base::binary | std::ios_base::out);
+        of.write((const char*)&header, sizeof(KTXHeader));
+        for (uint32 level = 0; level < header.numberOfMipmapLevels; ++level)
+        {
+            // block sizes are multiples of 4 bytes, so no mip padding is needed
+            PixelBox box = image->getPixelBox(0, level);
+            uint32 imageSize = uint32(
+                PixelUtil::getMemorySize(box.getWidth(), box.getHeight(), box.getDepth(), box.format));
+            of.write((const char*)&imageSize, sizeof(uint32));
+
+            for (uint32 face = 0; face < header.numberOfFaces; ++face)
+                of.write((const char*)image->getPixelBox(face, level).data, imageSize);
+        }
     }
     //---------------------------------------------------------------------
     String ETCCodec::getType() const
@@ -41,7 +41,8 @@ namespace Ogre {
     /** Codec specialized in loading ETC (Ericsson Texture Compression) images.
 
         We implement our own codec here since we need to be able to keep ETC
-        data compressed if the card supports it.
+        data compressed if the card supports it. Compressed images can be saved as KTX,
+        see Image::compress.
     */
     class ETCCodec : public ImageCodec
     {
@@ -56,6 +57,7 @@ namespace Ogre {
         ETCCodec(const String &type);
         virtual ~ETCCodec() { }
 
+        void encodeToFile(const Any& input, const String& outFileName) const override;
         void decode(const DataStreamPtr& input, const Any& output) const override;
         String magicNumberToFileExt(const char *magicNumberPtr, size_t maxbytes) const override;
         String getType() const override;
@@ -48,6 +48,7 @@ namespace Ogre {
           mSkipAnimStateUpdates(false),
           mAlwaysUpdateMainSkeleton(false),
           mUpdateBoundingBoxFromSkeleton(false),
+          mClusterCulling(false),
           mVertexProgramInUse(false),
           mInitialised(false),
           mHardwarePoseCount(0),
@@ -412,6 +413,14 @@ namespace Ogre {
                 s->_invalidateCameraCache ();
             }
 
+            if (mClusterCulling)
+            {
+                // the meshlet bounds only hold for the undeformed first LOD level
+                bool cull = mMeshLodIndex == 0 && !hasSkeleton() && !hasVertexAnimation() &&
+                            cam->getSceneManager()->_getCurrentRenderStage() != SceneManager::IRS_RENDER_TO_TEXTURE;
+                for (auto *s : mSubEntityList)
+                    s->updateClusterCulling(cull ? cam : NULL);
+            }
 
         }
         // Notify any child objects
@@ -430,6 +439,20 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void Entity::setClusterCulling(bool enabled)
+    {
+        mClusterCulling = enabled;
+        if (!enabled)
+        {
+            for (auto *s : mSubEntityList)
+            {
+                s->updateClusterCulling(NULL);
+                s->mClusterIndexData.reset();
+                s->mVisibleClusters.clear();
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
     const AxisAlignedBox& Entity::getBoundingBox(void) const
     {
         // Get from Mesh
@@ -603,7 +626,7 @@ namespace Ogre {
         // Add each visible SubEntity to the queue
         for (auto *s : displayEntity->mSubEntityList)
         {
-            if(s->isVisible())
+            if(s->isVisible() && !s->isClusterCulledOut())
             {
                 // Order: first use subentity queue settings, if available
                 //        if not then use entity queue settings, if available
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "OgreImage.h"
 #include "OgreImageCodec.h"
 #include "OgreImageResampler.h"
+#include "OgreBlockCompression.h"
 
 namespace Ogre {
     //-----------------------------------------------------------------------------
@@ -377,6 +378,73 @@ namespace Ogre {
         // scale the image from temp into our resized buffer
         Image::scale(temp.getPixelBox(), getPixelBox(), filter);
     }
+    //-----------------------------------------------------------------------------
+    void Image::generateMipmaps(Filter filter, bool gammaCorrect)
+    {
+        OgreAssert(mBuffer, "No image data loaded");
+        OgreAssert(PixelUtil::isAccessible(mFormat), "compressed formats are not supported");
+
+        if (filter == FILTER_NEAREST || filter == FILTER_LINEAR)
+            filter = FILTER_BOX;
+
+        uint32 numMips = 0;
+        for (uint32 w = mWidth, h = mHeight, d = mDepth; w > 1 || h > 1 || d > 1; numMips++)
+        {
+            w = std::max(w / 2, 1u);
+            h = std::max(h / 2, 1u);
+            d = std::max(d / 2, 1u);
+        }
+
+        Image chain;
+        chain.create(mFormat, mWidth, mHeight, mDepth, getNumFaces(), numMips);
+
+        std::vector<float> level, next;
+        for (uint32 face = 0; face < getNumFaces(); face++)
+        {
+            PixelBox base = getPixelBox(face, 0);
+            PixelUtil::bulkPixelConversion(base, chain.getPixelBox(face, 0));
+
+            FilteredResampler::unpack(base, level, gammaCorrect);
+            for (uint32 mip = 1; mip <= numMips; mip++)
+            {
+                PixelBox prev = chain.getPixelBox(face, mip - 1);
+                PixelBox dst = chain.getPixelBox(face, mip);
+                FilteredResampler::resample(level, prev.getWidth(), prev.getHeight(), prev.getDepth(), next,
+                                            dst.getWidth(), dst.getHeight(), dst.getDepth(), filter);
+                FilteredResampler::pack(next, dst, gammaCorrect);
+                level.swap(next);
+            }
+        }
+
+        // take over the new buffer. The old one is released by chain, if we owned it
+        std::swap(mBuffer, chain.mBuffer);
+        std::swap(mBufSize, chain.mBufSize);
+        std::swap(mAutoDelete, chain.mAutoDelete);
+        mNumMipmaps = numMips;
+    }
+    //-----------------------------------------------------------------------
+    void Image::compress(PixelFormat format, float quality)
+    {
+        OgreAssert(mBuffer, "No image data loaded");
+        OgreAssert(!PixelUtil::isCompressed(mFormat), "Image is already compressed");
+        OgreAssert(BlockCompression::canCompress(format), "Compression to this format is not supported");
+
+        Image compressed;
+        compressed.create(format, mWidth, mHeight, mDepth, getNumFaces(), mNumMipmaps);
+        for (uint32 face = 0; face < getNumFaces(); face++)
+        {
+            for (uint32 mip = 0; mip <= mNumMipmaps; mip++)
+                BlockCompression::compress(getPixelBox(face, mip), compressed.getPixelBox(face, mip), quality);
+        }
+
+        // take over the new buffer. The old one is released by compressed, if we owned it
+        std::swap(mBuffer, compressed.mBuffer);
+        std::swap(mBufSize, compressed.mBufSize);
+        std::swap(mAutoDelete, compressed.mAutoDelete);
+        mFormat = format;
+        mPixelSize = static_cast<uchar>(PixelUtil::getNumElemBytes(mFormat));
+        mFlags |= IF_COMPRESSED;
+    }
     //-----------------------------------------------------------------------
     void Image::scale(const PixelBox &src, const PixelBox &scaled, Filter filter) 
     {
@@ -398,14 +466,14 @@ namespace Ogre {
             // super-optimized: no conversion
             switch (PixelUtil::getNumElemBytes(src.format)) 
             {
-            case 1: NearestResampler<1>::scale(src, temp); break;
-            case 2: NearestResampler<2>::scale(src, temp); break;
-            case 3: NearestResampler<3>::scale(src, temp); break;
-            case 4: NearestResampler<4>::scale(src, temp); break;
-            case 6: NearestResampler<6>::scale(src, temp); break;
-            case 8: NearestResampler<8>::scale(src, temp); break;
-            case 12: NearestResampler<12>::scale(src, temp); break;
-            case 16: NearestResampler<16>::scale(src, temp); break;
+            case 1: parallelResample<NearestResampler<1> >(src, temp); break;
+            case 2: parallelResample<NearestResampler<2> >(src, temp); break;
+            case 3: parallelResample<NearestResampler<3> >(src, temp); break;
+            case 4: parallelResample<NearestResampler<4> >(src, temp); break;
+            case 6: parallelResample<NearestResampler<6> >(src, temp); break;
+            case 8: parallelResample<NearestResampler<8> >(src, temp); break;
+            case 12: parallelResample<NearestResampler<12> >(src, temp); break;
+            case 16: parallelResample<NearestResampler<16> >(src, temp); break;
             default:
                 // never reached
                 assert(false);
@@ -434,10 +502,10 @@ namespace Ogre {
                 // super-optimized: byte-oriented math, no conversion
                 switch (PixelUtil::getNumElemBytes(src.format)) 
                 {
-                case 1: LinearResampler_Byte<1>::scale(src, temp); break;
-                case 2: LinearResampler_Byte<2>::scale(src, temp); break;
-                case 3: LinearResampler_Byte<3>::scale(src, temp); break;
-                case 4: LinearResampler_Byte<4>::scale(src, temp); break;
+                case 1: parallelResample<LinearResampler_Byte<1> >(src, temp); break;
+                case 2: parallelResample<LinearResampler_Byte<2> >(src, temp); break;
+                case 3: parallelResample<LinearResampler_Byte<3> >(src, temp); break;
+                case 4: parallelResample<LinearResampler_Byte<4> >(src, temp); break;
                 default:
                     // never reached
                     assert(false);
@@ -453,15 +521,21 @@ namespace Ogre {
                 if (scaled.format == PF_FLOAT32_RGB || scaled.format == PF_FLOAT32_RGBA)
                 {
                     // float32 to float32, avoid unpack/repack overhead
-                    LinearResampler_Float32::scale(src, scaled);
+                    parallelResample<LinearResampler_Float32>(src, scaled);
                     break;
                 }
                 // else, fall through
             default:
                 // non-optimized: floating-point math, performs conversion but always works
-                LinearResampler::scale(src, scaled);
+                parallelResample<LinearResampler>(src, scaled);
             }
             break;
+
+        case FILTER_BOX:
+        case FILTER_KAISER:
+        case FILTER_LANCZOS:
+            FilteredResampler::scale(src, scaled, filter);
+            break;
         }
     }
 
@@ -30,6 +30,11 @@ THE SOFTWARE.
 
 #include <algorithm>
 
+#include "OgreWorkQueue.h"
+#if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
+#include "OgreSIMDHelper.h"
+#endif
+
 // this file is inlined into OgreImage.cpp!
 // do not include anywhere else.
 namespace Ogre {
@@ -40,6 +45,39 @@ namespace Ogre {
     *  @{
     */
 
+/// minimal number of destination pixels resampled per task
+static const size_t RESAMPLE_GRAIN_PIXELS = 1 << 14;
+
+// destination rows (2D) or slices (3D) resampled by one task
+struct ResampleBand {
+    size_t z1, z2, y1, y2;
+    ResampleBand(const PixelBox& dst, size_t begin, size_t end)
+        : z1(0), z2(dst.getDepth()), y1(0), y2(dst.getHeight()) {
+        if (dst.getDepth() > 1) {
+            z1 = begin;
+            z2 = end;
+        } else {
+            y1 = begin;
+            y2 = end;
+        }
+    }
+    uchar* getFirstPixelPtr(const PixelBox& dst) const {
+        return dst.getTopLeftFrontPixelPtr() +
+               (z1 * dst.slicePitch + y1 * dst.rowPitch) * PixelUtil::getNumElemBytes(dst.format);
+    }
+};
+
+// splits the destination into bands, that are resampled concurrently
+template<class Resampler> void parallelResample(const PixelBox& src, const PixelBox& dst) {
+    bool volume = dst.getDepth() > 1;
+    size_t bandPixels = dst.getWidth() * (volume ? dst.getHeight() : 1);
+    WorkQueue::parallelFor(volume ? dst.getDepth() : dst.getHeight(),
+                           std::max<size_t>(1, RESAMPLE_GRAIN_PIXELS / std::max<size_t>(bandPixels, 1)),
+                           [&](size_t begin, size_t end) {
+                               Resampler::scale(src, dst, ResampleBand(dst, begin, end));
+                           });
+}
+
 // variable name hints:
 // sx_48 = 16/48-bit fixed-point x-position in source
 // stepx = difference between adjacent sx_48 values
@@ -52,12 +90,12 @@ namespace Ogre {
 // templated on bytes-per-pixel to allow compiler optimizations, such
 // as simplifying memcpy() and replacing multiplies with bitshifts
 template<unsigned int elemsize> struct NearestResampler {
-    static void scale(const PixelBox& src, const PixelBox& dst) {
+    static void scale(const PixelBox& src, const PixelBox& dst, const ResampleBand& band) {
         // assert(src.format == dst.format);
 
         // srcdata stays at beginning, pdst is a moving pointer
         uchar* srcdata = (uchar*)src.getTopLeftFrontPixelPtr();
-        uchar* pdst = (uchar*)dst.getTopLeftFrontPixelPtr();
+        uchar* pdst = band.getFirstPixelPtr(dst);
 
         // sx_48,sy_48,sz_48 represent current position in source
         // using 16/48-bit fixed precision, incremented by steps
@@ -67,12 +105,12 @@ template<unsigned int elemsize> struct NearestResampler {
 
         // note: ((stepz>>1) - 1) is an extra half-step increment to adjust
         // for the center of the destination pixel, not the top-left corner
-        uint64 sz_48 = (stepz >> 1) - 1;
-        for (size_t z = dst.front; z < dst.back; z++, sz_48 += stepz) {
+        uint64 sz_48 = (stepz >> 1) - 1 + band.z1 * stepz;
+        for (size_t z = band.z1; z < band.z2; z++, sz_48 += stepz) {
             size_t srczoff = (size_t)(sz_48 >> 48) * src.slicePitch;
             
-            uint64 sy_48 = (stepy >> 1) - 1;
-            for (size_t y = dst.top; y < dst.bottom; y++, sy_48 += stepy) {
+            uint64 sy_48 = (stepy >> 1) - 1 + band.y1 * stepy;
+            for (size_t y = band.y1; y < band.y2; y++, sy_48 += stepy) {
                 size_t srcyoff = (size_t)(sy_48 >> 48) * src.rowPitch;
             
                 uint64 sx_48 = (stepx >> 1) - 1;
@@ -92,13 +130,13 @@ template<unsigned int elemsize> struct NearestResampler {
 
 // default floating-point linear resampler, does format conversion
 struct LinearResampler {
-    static void scale(const PixelBox& src, const PixelBox& dst) {
+    static void scale(const PixelBox& src, const PixelBox& dst, const ResampleBand& band) {
         size_t srcelemsize = PixelUtil::getNumElemBytes(src.format);
         size_t dstelemsize = PixelUtil::getNumElemBytes(dst.format);
 
         // srcdata stays at beginning, pdst is a moving pointer
         uchar* srcdata = (uchar*)src.getTopLeftFrontPixelPtr();
-        uchar* pdst = (uchar*)dst.getTopLeftFrontPixelPtr();
+        uchar* pdst = band.getFirstPixelPtr(dst);
         
         // sx_48,sy_48,sz_48 represent current position in source
         // using 16/48-bit fixed precision, incremented by steps
@@ -108,8 +146,8 @@ struct LinearResampler {
         
         // note: ((stepz>>1) - 1) is an extra half-step increment to adjust
         // for the center of the destination pixel, not the top-left corner
-        uint64 sz_48 = (stepz >> 1) - 1;
-        for (size_t z = dst.front; z < dst.back; z++, sz_48+=stepz) {
+        uint64 sz_48 = (stepz >> 1) - 1 + band.z1 * stepz;
+        for (size_t z = band.z1; z < band.z2; z++, sz_48+=stepz) {
             // temp is 16/16 bit fixed precision, used to adjust a source
             // coordinate (x, y, or z) backwards by half a pixel so that the
             // integer bits represent the first sample (eg, sx1) and the
@@ -121,8 +159,8 @@ struct LinearResampler {
             uint32 sz2 = std::min(sz1+1,src.getDepth()-1);// src z, sample #2
             float szf = (temp & 0xFFFF) / 65536.f; // weight of sample #2
 
-            uint64 sy_48 = (stepy >> 1) - 1;
-            for (size_t y = dst.top; y < dst.bottom; y++, sy_48+=stepy) {
+            uint64 sy_48 = (stepy >> 1) - 1 + band.y1 * stepy;
+            for (size_t y = band.y1; y < band.y2; y++, sy_48+=stepy) {
                 temp = static_cast<unsigned int>(sy_48 >> 32);
                 temp = (temp > 0x8000)? temp - 0x8000 : 0;
                 uint32 sy1 = temp >> 16;                    // src y #1
@@ -174,7 +212,7 @@ struct LinearResampler {
 // float32 linear resampler, converts FLOAT32_RGB/FLOAT32_RGBA only.
 // avoids overhead of pixel unpack/repack function calls
 struct LinearResampler_Float32 {
-    static void scale(const PixelBox& src, const PixelBox& dst) {
+    static void scale(const PixelBox& src, const PixelBox& dst, const ResampleBand& band) {
         size_t srcchannels = PixelUtil::getNumElemBytes(src.format) / sizeof(float);
         size_t dstchannels = PixelUtil::getNumElemBytes(dst.format) / sizeof(float);
         // assert(srcchannels == 3 || srcchannels == 4);
@@ -182,7 +220,7 @@ struct LinearResampler_Float32 {
 
         // srcdata stays at beginning, pdst is a moving pointer
         float* srcdata = (float*)src.getTopLeftFrontPixelPtr();
-        float* pdst = (float*)dst.getTopLeftFrontPixelPtr();
+        float* pdst = (float*)band.getFirstPixelPtr(dst);
         
         // sx_48,sy_48,sz_48 represent current position in source
         // using 16/48-bit fixed precision, incremented by steps
@@ -192,8 +230,8 @@ struct LinearResampler_Float32 {
         
         // note: ((stepz>>1) - 1) is an extra half-step increment to adjust
         // for the center of the destination pixel, not the top-left corner
-        uint64 sz_48 = (stepz >> 1) - 1;
-        for (size_t z = dst.front; z < dst.back; z++, sz_48+=stepz) {
+        uint64 sz_48 = (stepz >> 1) - 1 + band.z1 * stepz;
+        for (size_t z = band.z1; z < band.z2; z++, sz_48+=stepz) {
             // temp is 16/16 bit fixed precision, used to adjust a source
             // coordinate (x, y, or z) backwards by half a pixel so that the
             // integer bits represent the first sample (eg, sx1) and the
@@ -205,8 +243,8 @@ struct LinearResampler_Float32 {
             uint32 sz2 = std::min(sz1+1,src.getDepth()-1);// src z, sample #2
             float szf = (temp & 0xFFFF) / 65536.f; // weight of sample #2
 
-            uint64 sy_48 = (stepy >> 1) - 1;
-            for (size_t y = dst.top; y < dst.bottom; y++, sy_48+=stepy) {
+            uint64 sy_48 = (stepy >> 1) - 1 + band.y1 * stepy;
+            for (size_t y = band.y1; y < band.y2; y++, sy_48+=stepy) {
                 temp = static_cast<unsigned int>(sy_48 >> 32);
                 temp = (temp > 0x8000)? temp - 0x8000 : 0;
                 uint32 sy1 = temp >> 16;                    // src y #1
@@ -281,26 +319,26 @@ struct LinearResampler_Float32 {
 // templated on bytes-per-pixel to allow compiler optimizations, such
 // as unrolling loops and replacing multiplies with bitshifts
 template<unsigned int channels> struct LinearResampler_Byte {
-    static void scale(const PixelBox& src, const PixelBox& dst) {
+    static void scale(const PixelBox& src, const PixelBox& dst, const ResampleBand& band) {
         // assert(src.format == dst.format);
 
         // only optimized for 2D
         if (src.getDepth() > 1 || dst.getDepth() > 1) {
-            LinearResampler::scale(src, dst);
+            LinearResampler::scale(src, dst, band);
             return;
         }
 
         // srcdata stays at beginning of slice, pdst is a moving pointer
         uchar* srcdata = (uchar*)src.getTopLeftFrontPixelPtr();
-        uchar* pdst = (uchar*)dst.getTopLeftFrontPixelPtr();
+        uchar* pdst = band.getFirstPixelPtr(dst);
 
         // sx_48,sy_48 represent current position in source
         // using 16/48-bit fixed precision, incremented by steps
         uint64 stepx = ((uint64)src.getWidth() << 48) / dst.getWidth();
         uint64 stepy = ((uint64)src.getHeight() << 48) / dst.getHeight();
         
-        uint64 sy_48 = (stepy >> 1) - 1;
-        for (size_t y = dst.top; y < dst.bottom; y++, sy_48+=stepy) {
+        uint64 sy_48 = (stepy >> 1) - 1 + band.y1 * stepy;
+        for (size_t y = band.y1; y < band.y2; y++, sy_48+=stepy) {
             // bottom 28 bits of temp are 16/12 bit fixed precision, used to
             // adjust a source coordinate backwards by half a pixel so that the
             // integer bits represent the first sample (eg, sx1) and the
@@ -337,6 +375,200 @@ template<unsigned int channels> struct LinearResampler_Byte {
         }
     }
 };
+// separable resampler with a box, Kaiser or Lanczos kernel, does format conversion.
+// works on a float RGBA copy of the source, filtering one axis after another,
+// so it can be reused for mipmap chains without converting every level again
+struct FilteredResampler {
+    // source pixels and weights contributing to each destination pixel along one axis
+    struct Taps {
+        std::vector<uint32> first;
+        std::vector<uint32> count;
+        std::vector<size_t> offset;
+        std::vector<float> weights;
+    };
+
+    static float sinc(float x) {
+        if (std::abs(x) < 1e-5f)
+            return 1.0f;
+        x *= Math::PI;
+        return std::sin(x) / x;
+    }
+
+    static float besselI0(float x) {
+        // power series, converges quickly for the arguments used by the Kaiser window
+        float sum = 1.0f, term = 1.0f, halfx = x * 0.5f;
+        for (int i = 1; i < 20; i++) {
+            term *= (halfx / i) * (halfx / i);
+            sum += term;
+            if (term < sum * 1e-7f)
+                break;
+        }
+        return sum;
+    }
+
+    static float getSupport(Image::Filter filter) {
+        return filter == Image::FILTER_BOX ? 0.5f : 3.0f;
+    }
+
+    static float evaluate(Image::Filter filter, float x) {
+        switch (filter) {
+        case Image::FILTER_LANCZOS:
+            return std::abs(x) < 3.0f ? sinc(x) * sinc(x / 3.0f) : 0.0f;
+        case Image::FILTER_KAISER: {
+            const float width = 3.0f, alpha = 4.0f;
+            float t = x / width;
+            if (std::abs(t) >= 1.0f)
+                return 0.0f;
+            return sinc(x) * besselI0(alpha * std::sqrt(1.0f - t * t)) / besselI0(alpha);
+        }
+        default:
+            // half open, so samples on the border are not counted twice
+            return x >= -0.5f && x < 0.5f ? 1.0f : 0.0f;
+        }
+    }
+
+    static void computeTaps(Image::Filter filter, uint32 srcSize, uint32 dstSize, Taps& taps) {
+        const float scale = float(srcSize) / dstSize;
+        // widen the kernel when minifying, to filter out frequencies the destination cannot hold
+        const float filterScale = std::max(1.0f, scale);
+        const float support = getSupport(filter) * filterScale;
+
+        taps.first.resize(dstSize);
+        taps.count.resize(dstSize);
+        taps.offset.resize(dstSize);
+        taps.weights.clear();
+        for (uint32 i = 0; i < dstSize; i++) {
+            float center = (i + 0.5f) * scale;
+            int lo = int(std::floor(center - support));
+            int hi = int(std::ceil(center + support));
+            uint32 first = uint32(Math::Clamp(lo, 0, int(srcSize) - 1));
+            uint32 last = uint32(Math::Clamp(hi, 0, int(srcSize) - 1));
+
+            size_t offset = taps.weights.size();
+            taps.weights.resize(offset + last - first + 1, 0.0f);
+            float sum = 0;
+            for (int j = lo; j <= hi; j++) {
+                float w = evaluate(filter, (j + 0.5f - center) / filterScale);
+                // clamp to edge
+                taps.weights[offset + Math::Clamp(j, int(first), int(last)) - first] += w;
+                sum += w;
+            }
+
+            if (std::abs(sum) < 1e-6f) {
+                // nothing in range, fall back to the nearest sample
+                std::fill(taps.weights.begin() + offset, taps.weights.end(), 0.0f);
+                taps.weights[offset + Math::Clamp(uint32(center), first, last) - first] = 1.0f;
+                sum = 1.0f;
+            }
+            for (size_t k = offset; k < taps.weights.size(); k++)
+                taps.weights[k] /= sum;
+
+            taps.first[i] = first;
+            taps.count[i] = last - first + 1;
+            taps.offset[i] = offset;
+        }
+    }
+
+    // filters along one axis. Data is laid out as [outer][axis][inner], where inner is a
+    // multiple of 4 floats: a single RGBA pixel for x, or whole rows and slices for y and z
+    static void filterAxis(const float* in, float* out, size_t outer, size_t srcSize, size_t dstSize,
+                           size_t inner, const Taps& taps) {
+        WorkQueue::parallelFor(
+            outer * dstSize, std::max<size_t>(1, RESAMPLE_GRAIN_PIXELS * 4 / inner),
+            [&](size_t begin, size_t end) {
+                for (size_t item = begin; item < end; item++) {
+                    size_t o = item / dstSize, j = item % dstSize;
+                    const float* w = &taps.weights[taps.offset[j]];
+                    const float* psrc = in + (o * srcSize + taps.first[j]) * inner;
+                    float* pdst = out + item * inner;
+                    uint32 count = taps.count[j];
+                    for (size_t c = 0; c < inner; c += 4) {
+#if __OGRE_HAVE_SSE || __OGRE_HAVE_NEON
+                        __m128 accum = _mm_setzero_ps();
+                        for (uint32 k = 0; k < count; k++)
+                            accum = _mm_add_ps(accum, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(psrc + k * inner + c)));
+                        _mm_storeu_ps(pdst + c, accum);
+#else
+                        float accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                        for (uint32 k = 0; k < count; k++)
+                            for (int ch = 0; ch < 4; ch++)
+                                accum[ch] += w[k] * psrc[k * inner + c + ch];
+                        memcpy(pdst + c, accum, sizeof(accum));
+#endif
+                    }
+                }
+            });
+    }
+
+    static float toLinear(float c) {
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static float toSRGB(float c) {
+        return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    // converts rgb between sRGB and linear space, alpha is left untouched
+    static void convertGamma(std::vector<float>& rgba, bool toLinearSpace) {
+        WorkQueue::parallelFor(rgba.size() / 4, RESAMPLE_GRAIN_PIXELS, [&](size_t begin, size_t end) {
+            for (size_t i = begin * 4; i < end * 4; i += 4)
+                for (int ch = 0; ch < 3; ch++)
+                    rgba[i + ch] = toLinearSpace ? toLinear(rgba[i + ch]) : toSRGB(std::max(rgba[i + ch], 0.0f));
+        });
+    }
+
+    static void unpack(const PixelBox& src, std::vector<float>& rgba, bool gammaCorrect) {
+        rgba.resize(src.getWidth() * src.getHeight() * src.getDepth() * 4);
+        PixelUtil::bulkPixelConversion(
+            src, PixelBox(src.getWidth(), src.getHeight(), src.getDepth(), PF_FLOAT32_RGBA, rgba.data()));
+        if (gammaCorrect)
+            convertGamma(rgba, true);
+    }
+
+    static void pack(std::vector<float>& rgba, const PixelBox& dst, bool gammaCorrect) {
+        std::vector<float> encoded;
+        if (gammaCorrect) {
+            encoded = rgba;
+            convertGamma(encoded, false);
+        }
+        PixelUtil::bulkPixelConversion(PixelBox(dst.getWidth(), dst.getHeight(), dst.getDepth(), PF_FLOAT32_RGBA,
+                                                gammaCorrect ? encoded.data() : rgba.data()),
+                                       dst);
+    }
+
+    // resamples float RGBA data. src is used as scratch space
+    static void resample(std::vector<float>& src, uint32 sw, uint32 sh, uint32 sd, std::vector<float>& dst,
+                         uint32 dw, uint32 dh, uint32 dd, Image::Filter filter) {
+        Taps taps;
+        if (sw != dw) {
+            computeTaps(filter, sw, dw, taps);
+            dst.resize(size_t(dw) * sh * sd * 4);
+            filterAxis(src.data(), dst.data(), size_t(sh) * sd, sw, dw, 4, taps);
+            src.swap(dst);
+        }
+        if (sh != dh) {
+            computeTaps(filter, sh, dh, taps);
+            dst.resize(size_t(dw) * dh * sd * 4);
+            filterAxis(src.data(), dst.data(), sd, sh, dh, size_t(dw) * 4, taps);
+            src.swap(dst);
+        }
+        if (sd != dd) {
+            computeTaps(filter, sd, dd, taps);
+            dst.resize(size_t(dw) * dh * dd * 4);
+            filterAxis(src.data(), dst.data(), 1, sd, dd, size_t(dw) * dh * 4, taps);
+            src.swap(dst);
+        }
+        src.swap(dst);
+    }
+
+    static void scale(const PixelBox& src, const PixelBox& dst, Image::Filter filter) {
+        std::vector<float> in, out;
+        unpack(src, in, false);
+        resample(in, src.getWidth(), src.getHeight(), src.getDepth(), out, dst.getWidth(), dst.getHeight(),
+                 dst.getDepth(), filter);
+        pack(out, dst, false);
+    }
+};
 /** @} */
 /** @} */
 
@@ -208,6 +208,18 @@ namespace Ogre {
             // unsigned short submesh_index;
             // float extremes [n_extremes][3];
 
+            // Optional submesh meshlet list, see SubMesh::meshlets
+            M_TABLE_MESHLETS = 0xE100,
+            // unsigned short submesh_index;
+            // Meshlet* meshlets (repeating section)
+                // unsigned int indexStart
+                // unsigned int indexCount
+                // float center[3]
+                // float radius
+                // float coneApex[3]
+                // float coneAxis[3]
+                // float coneCutoff
+
     /* Version 1.2 of the .mesh format (deprecated)
     enum MeshChunkID {
         M_HEADER                = 0x1000,
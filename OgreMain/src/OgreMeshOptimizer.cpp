@@ -0,0 +1,773 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreMeshOptimizer.h"
+
+namespace Ogre {
+namespace {
+    void readIndices(const IndexData* indexData, std::vector<uint32>& indices)
+    {
+        const auto& ibuf = indexData->indexBuffer;
+        indices.resize(indexData->indexCount);
+        HardwareBufferLockGuard lock(ibuf, indexData->indexStart * ibuf->getIndexSize(),
+                                     indexData->indexCount * ibuf->getIndexSize(), HardwareBuffer::HBL_READ_ONLY);
+        if (ibuf->getType() == HardwareIndexBuffer::IT_32BIT)
+            memcpy(indices.data(), lock.pData, indices.size() * sizeof(uint32));
+        else
+            std::copy_n(static_cast<const uint16*>(lock.pData), indices.size(), indices.begin());
+    }
+
+    void writeIndices(IndexData* indexData, const std::vector<uint32>& indices)
+    {
+        const auto& ibuf = indexData->indexBuffer;
+        HardwareBufferLockGuard lock(ibuf, indexData->indexStart * ibuf->getIndexSize(),
+                                     indexData->indexCount * ibuf->getIndexSize(), HardwareBuffer::HBL_NORMAL);
+        if (ibuf->getType() == HardwareIndexBuffer::IT_32BIT)
+            memcpy(lock.pData, indices.data(), indices.size() * sizeof(uint32));
+        else
+            std::copy(indices.begin(), indices.end(), static_cast<uint16*>(lock.pData));
+    }
+
+    /// number of misses in a FIFO cache of the given size
+    size_t countCacheMisses(const std::vector<uint32>& indices, uint32 cacheSize, std::vector<bool>* missedAll = NULL)
+    {
+        std::vector<uint32> cache(cacheSize, ~0u);
+        size_t tail = 0, misses = 0;
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            if (std::find(cache.begin(), cache.end(), indices[i]) != cache.end())
+            {
+                if (missedAll)
+                    (*missedAll)[i / 3] = false;
+                continue;
+            }
+            misses++;
+            cache[tail] = indices[i];
+            tail = (tail + 1) % cacheSize;
+        }
+        return misses;
+    }
+
+    // Linear-Speed Vertex Cache Optimisation, Tom Forsyth 2006
+    const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+    const float FORSYTH_LAST_TRI_SCORE = 0.75f;
+    const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+    const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+    float forsythScore(int cachePosition, uint32 activeTris, uint32 cacheSize)
+    {
+        if (activeTris == 0)
+            return -1.0f; // no triangles need this vertex
+
+        float score = 0.0f;
+        if (cachePosition < 0)
+            score = 0.0f;
+        else if (cachePosition < 3)
+            score = FORSYTH_LAST_TRI_SCORE; // the last triangle is penalised, to avoid strips
+        else
+            score = std::pow(1.0f - float(cachePosition - 3) / (cacheSize - 3), FORSYTH_CACHE_DECAY_POWER);
+
+        // bonus for vertices with few triangles left, so lone triangles are not left behind
+        return score + FORSYTH_VALENCE_BOOST_SCALE * std::pow(float(activeTris), -FORSYTH_VALENCE_BOOST_POWER);
+    }
+
+    /// the triangles using vertex v are triangles[offsets[v]] to triangles[offsets[v] + counts[v] - 1]
+    void buildTriangleAdjacency(const std::vector<uint32>& indices, uint32 numVertices, std::vector<uint32>& counts,
+                                std::vector<uint32>& offsets, std::vector<uint32>& triangles)
+    {
+        counts.assign(numVertices, 0);
+        for (uint32 idx : indices)
+            counts[idx]++;
+        offsets.assign(numVertices + 1, 0);
+        for (uint32 v = 0; v < numVertices; ++v)
+            offsets[v + 1] = offsets[v] + counts[v];
+        triangles.resize(indices.size());
+        std::vector<uint32> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            triangles[fill[indices[i]]++] = uint32(i / 3);
+    }
+
+    void forsythReorder(std::vector<uint32>& indices, uint32 cacheSize)
+    {
+        size_t numTris = indices.size() / 3;
+        uint32 numVertices = indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end()) + 1;
+
+        std::vector<uint32> activeTris, triOffsets, vertexTris;
+        buildTriangleAdjacency(indices, numVertices, activeTris, triOffsets, vertexTris);
+
+        std::vector<int> cachePos(numVertices, -1);
+        std::vector<float> vertexScore(numVertices);
+        for (uint32 v = 0; v < numVertices; ++v)
+            vertexScore[v] = forsythScore(-1, activeTris[v], cacheSize);
+
+        std::vector<float> triScore(numTris);
+        for (size_t t = 0; t < numTris; ++t)
+            triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+        std::vector<bool> emitted(numTris, false);
+        std::vector<uint32> cache, newCache;
+        cache.reserve(cacheSize + 3);
+        newCache.reserve(cacheSize + 3);
+
+        std::vector<uint32> result;
+        result.reserve(indices.size());
+
+        size_t cursor = 0;
+        int64 bestTri = -1;
+        for (size_t emittedCount = 0; emittedCount < numTris; ++emittedCount)
+        {
+            if (bestTri < 0)
+            {
+                // dead end, continue with the next remaining triangle in input order
+                while (emitted[cursor])
+                    cursor++;
+                bestTri = cursor;
+            }
+
+            const uint32* tri = &indices[bestTri * 3];
+            result.insert(result.end(), tri, tri + 3);
+            emitted[bestTri] = true;
+
+            // retire the triangle from its vertices and put them in front of the cache
+            newCache.assign(tri, tri + 3);
+            for (int i = 0; i < 3; ++i)
+            {
+                uint32 v = tri[i];
+                uint32* begin = &vertexTris[triOffsets[v]];
+                uint32* end = begin + activeTris[v];
+                *std::find(begin, end, uint32(bestTri)) = end[-1];
+                activeTris[v]--;
+            }
+            for (uint32 v : cache)
+            {
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                    newCache.push_back(v);
+            }
+
+            // update the scores of everything that moved in the cache or fell out of it
+            for (size_t i = 0; i < newCache.size(); ++i)
+            {
+                uint32 v = newCache[i];
+                cachePos[v] = i < cacheSize ? int(i) : -1;
+            }
+            bestTri = -1;
+            float bestScore = -1.0f;
+            for (uint32 v : newCache)
+            {
+                float score = forsythScore(cachePos[v], activeTris[v], cacheSize);
+                float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+                for (uint32 j = triOffsets[v]; j < triOffsets[v] + activeTris[v]; ++j)
+                {
+                    uint32 t = vertexTris[j];
+                    triScore[t] += delta;
+                    if (triScore[t] > bestScore)
+                    {
+                        bestScore = triScore[t];
+                        bestTri = t;
+                    }
+                }
+            }
+
+            if (newCache.size() > cacheSize)
+                newCache.resize(cacheSize);
+            cache.swap(newCache);
+        }
+
+        indices.swap(result);
+    }
+
+    bool readPositions(const VertexData* vertexData, std::vector<Vector3>& positions)
+    {
+        auto posElem = vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+        if (!posElem || posElem->getType() != VET_FLOAT3)
+            return false;
+
+        const auto& vbuf = vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+        HardwareBufferLockGuard lock(vbuf, vertexData->vertexStart * vbuf->getVertexSize(),
+                                     vertexData->vertexCount * vbuf->getVertexSize(), HardwareBuffer::HBL_READ_ONLY);
+        positions.resize(vertexData->vertexCount);
+        auto pVertex = static_cast<uint8*>(lock.pData);
+        for (size_t v = 0; v < vertexData->vertexCount; ++v, pVertex += vbuf->getVertexSize())
+        {
+            float* pFloat;
+            posElem->baseVertexPointerToElement(pVertex, &pFloat);
+            positions[v] = Vector3(pFloat);
+        }
+        return true;
+    }
+
+    std::vector<IndexData*> getTriangleLists(const SubMesh* sm, const Mesh* mesh)
+    {
+        std::vector<IndexData*> ret;
+        if (sm->operationType != RenderOperation::OT_TRIANGLE_LIST)
+            return ret;
+
+        if (sm->indexData->indexBuffer && sm->indexData->indexCount)
+            ret.push_back(sm->indexData);
+        for (ushort lod = 1; lod < mesh->getNumLodLevels(); ++lod)
+        {
+            IndexData* lodData = sm->mLodFaceList[lod - 1];
+            if (!mesh->_isManualLodLevel(lod) && lodData->indexBuffer && lodData->indexCount)
+                ret.push_back(lodData);
+        }
+        return ret;
+    }
+
+    /// ranges between the bounds of index data sharing one buffer, that are used by any of them
+    std::vector<std::pair<size_t, size_t>> getSharedRanges(const std::vector<IndexData*>& sharing)
+    {
+        std::vector<size_t> bounds;
+        for (auto indexData : sharing)
+        {
+            bounds.push_back(indexData->indexStart);
+            bounds.push_back(indexData->indexStart + indexData->indexCount);
+        }
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+        std::vector<std::pair<size_t, size_t>> ranges;
+        for (size_t i = 1; i < bounds.size(); ++i)
+        {
+            size_t start = bounds[i - 1], end = bounds[i];
+            bool used = std::any_of(sharing.begin(), sharing.end(), [start, end](const IndexData* indexData) {
+                return indexData->indexStart <= start && end <= indexData->indexStart + indexData->indexCount;
+            });
+            // ranges splitting triangles can not be reordered
+            bool whole = std::all_of(sharing.begin(), sharing.end(), [start](const IndexData* indexData) {
+                return start < indexData->indexStart || (start - indexData->indexStart) % 3 == 0;
+            });
+            if (used && whole && (end - start) % 3 == 0)
+                ranges.emplace_back(start, end);
+        }
+        return ranges;
+    }
+
+    /// all index data of the submesh, including LOD levels. Returns false if it is not indexed
+    bool getIndexData(const SubMesh* sm, const Mesh* mesh, std::vector<IndexData*>& ret)
+    {
+        if (!sm->indexData->indexBuffer || !sm->indexData->indexCount)
+            return false;
+
+        // remapping the index values keeps the primitives of any operation type intact
+        ret.push_back(sm->indexData);
+        for (ushort lod = 1; lod < mesh->getNumLodLevels(); ++lod)
+        {
+            IndexData* lodData = sm->mLodFaceList[lod - 1];
+            if (!mesh->_isManualLodLevel(lod) && lodData->indexBuffer && lodData->indexCount)
+                ret.push_back(lodData);
+        }
+        return true;
+    }
+
+    template <typename T> void remapBoneAssignments(T* target, const std::vector<uint32>& remap)
+    {
+        if (target->getBoneAssignments().empty())
+            return;
+
+        auto assignments = target->getBoneAssignments();
+        target->clearBoneAssignments();
+        for (const auto& vba : assignments)
+        {
+            VertexBoneAssignment newVba = vba.second;
+            newVba.vertexIndex = remap[vba.second.vertexIndex];
+            target->addBoneAssignment(newVba);
+        }
+    }
+}
+    //-----------------------------------------------------------------------
+    MeshOptimizer::MeshOptimizer(uint32 passes)
+        : mPasses(passes), mCacheSize(16), mOverdrawThreshold(1.05f), mMeshletMaxVertices(64),
+          mMeshletMaxTriangles(124), mAcmrBefore(0), mAcmrAfter(0)
+    {
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimizer::optimise(Mesh* mesh)
+    {
+        size_t missesBefore = 0, missesAfter = 0, triangles = 0;
+        std::vector<uint32> indices;
+
+        auto reorderTriangles = [&](IndexData* indexData, const VertexData* vertexData) {
+            if (mPasses & MO_VERTEX_CACHE)
+                optimiseVertexCache(indexData);
+            if (mPasses & MO_OVERDRAW)
+                optimiseOverdraw(indexData, vertexData);
+        };
+
+        for (auto sm : mesh->getSubMeshes())
+        {
+            const VertexData* vertexData = sm->useSharedVertices ? mesh->sharedVertexData : sm->vertexData;
+            auto lists = getTriangleLists(sm, mesh);
+            for (auto indexData : lists)
+            {
+                readIndices(indexData, indices);
+                missesBefore += countCacheMisses(indices, mCacheSize);
+                triangles += indices.size() / 3;
+            }
+
+            for (auto indexData : lists)
+            {
+                std::vector<IndexData*> sharing;
+                for (auto other : lists)
+                {
+                    if (other->indexBuffer == indexData->indexBuffer)
+                        sharing.push_back(other);
+                }
+
+                if (sharing.size() == 1)
+                    reorderTriangles(indexData, vertexData);
+                else if (sharing[0] == indexData)
+                {
+                    // e.g. compressed LOD levels, that reference overlapping ranges. Every level
+                    // consists of whole ranges between the level bounds, so these can be reordered
+                    for (const auto& range : getSharedRanges(sharing))
+                    {
+                        IndexData part;
+                        part.indexBuffer = indexData->indexBuffer;
+                        part.indexStart = range.first;
+                        part.indexCount = range.second - range.first;
+                        reorderTriangles(&part, vertexData);
+                    }
+                }
+
+                // only the first LOD level has meshlets
+                if (indexData == sm->indexData)
+                {
+                    if (sharing.size() == 1 && (mPasses & MO_MESHLETS))
+                        buildMeshlets(sm);
+                    else if (mPasses & (MO_VERTEX_CACHE | MO_OVERDRAW))
+                        sm->meshlets.clear();
+                }
+            }
+
+            for (auto indexData : lists)
+            {
+                readIndices(indexData, indices);
+                missesAfter += countCacheMisses(indices, mCacheSize);
+            }
+        }
+
+        mAcmrBefore = triangles ? float(missesBefore) / triangles : 0;
+        mAcmrAfter = triangles ? float(missesAfter) / triangles : 0;
+
+        if (!(mPasses & MO_VERTEX_FETCH))
+            return;
+
+        if (mesh->getPoseCount() > 0 || mesh->hasVertexAnimation() || mesh->isPreparedForShadowVolumes())
+        {
+            LogManager::getSingleton().logWarning("MeshOptimizer: skipping vertex fetch optimisation of " +
+                                                  mesh->getName() + ", as vertices are referenced by index");
+            return;
+        }
+
+        bool edgeListsBuilt = mesh->isEdgeListBuilt();
+        mesh->freeEdgeList();
+
+        if (mesh->sharedVertexData)
+        {
+            // every submesh drawing from the shared vertices must be remapped
+            std::vector<IndexData*> indexData;
+            bool indexed = true;
+            for (auto sm : mesh->getSubMeshes())
+            {
+                if (sm->useSharedVertices)
+                    indexed &= getIndexData(sm, mesh, indexData);
+            }
+
+            if (indexed)
+            {
+                auto remap = optimiseVertexFetch(mesh->sharedVertexData, indexData);
+                remapBoneAssignments(mesh, remap);
+            }
+            else
+            {
+                LogManager::getSingleton().logWarning(
+                    "MeshOptimizer: skipping vertex fetch optimisation of the shared vertices of " +
+                    mesh->getName() + ", as a submesh using them is not indexed");
+            }
+        }
+
+        for (auto sm : mesh->getSubMeshes())
+        {
+            std::vector<IndexData*> indexData;
+            if (sm->useSharedVertices || !getIndexData(sm, mesh, indexData))
+                continue;
+            auto remap = optimiseVertexFetch(sm->vertexData, indexData);
+            remapBoneAssignments(sm, remap);
+        }
+
+        if (edgeListsBuilt)
+            mesh->buildEdgeList();
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimizer::optimiseVertexCache(IndexData* indexData) const
+    {
+        std::vector<uint32> indices;
+        readIndices(indexData, indices);
+        indices.resize(indices.size() - indices.size() % 3);
+        forsythReorder(indices, std::max(mCacheSize, 4u));
+        writeIndices(indexData, indices);
+    }
+    //-----------------------------------------------------------------------
+    void MeshOptimizer::optimiseOverdraw(IndexData* indexData, const VertexData* vertexData) const
+    {
+        std::vector<Vector3> positions;
+        if (!vertexData || !readPositions(vertexData, positions))
+            return;
+
+        std::vector<uint32> indices;
+        readIndices(indexData, indices);
+        size_t numTris = indices.size() / 3;
+        for (uint32 idx : indices)
+        {
+            if (idx >= positions.size())
+                return;
+        }
+
+        // clusters start where the cache is cold, so moving them around barely affects the ACMR
+        std::vector<bool> missedAll(numTris, true);
+        size_t misses = countCacheMisses(indices, mCacheSize, &missedAll);
+
+        std::vector<size_t> clusterStart;
+        for (size_t t = 0; t < numTris; ++t)
+        {
+            if (missedAll[t])
+                clusterStart.push_back(t);
+        }
+        if (clusterStart.size() < 2)
+            return;
+        clusterStart.push_back(numTris);
+
+        Vector3 meshCentroid = Vector3::ZERO;
+        for (const auto& p : positions)
+            meshCentroid += p;
+        meshCentroid /= Real(positions.size());
+
+        struct Cluster
+        {
+            size_t start, end;
+            float sortKey;
+        };
+        std::vector<Cluster> clusters;
+        for (size_t c = 0; c + 1 < clusterStart.size(); ++c)
+        {
+            Vector3 centroid = Vector3::ZERO, normal = Vector3::ZERO;
+            Real area = 0;
+            for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; ++t)
+            {
+                const Vector3& a = positions[indices[t * 3]];
+                const Vector3& b = positions[indices[t * 3 + 1]];
+                const Vector3& d = positions[indices[t * 3 + 2]];
+                Vector3 n = (b - a).crossProduct(d - a); // length is twice the area
+                Real triArea = n.length();
+                centroid += (a + b + d) * triArea / 3;
+                normal += n;
+                area += triArea;
+            }
+            if (area > 0)
+                centroid /= area;
+            normal.normalise();
+            // outward facing clusters far from the center are likely occluders
+            clusters.push_back({clusterStart[c], clusterStart[c + 1], (centroid - meshCentroid).dotProduct(normal)});
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(),
+                         [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+        std::vector<uint32> sorted;
+        sorted.reserve(numTris * 3);
+        for (const auto& c : clusters)
+            sorted.insert(sorted.end(), indices.begin() + c.start * 3, indices.begin() + c.end * 3);
+
+        if (countCacheMisses(sorted, mCacheSize) > misses * mOverdrawThreshold)
+            return;
+
+        sorted.insert(sorted.end(), indices.begin() + numTris * 3, indices.end());
+        writeIndices(indexData, sorted);
+    }
+    //-----------------------------------------------------------------------
+    bool MeshOptimizer::buildMeshlets(SubMesh* subMesh) const
+    {
+        subMesh->meshlets.clear();
+
+        IndexData* indexData = subMesh->indexData;
+        const VertexData* vertexData =
+            subMesh->useSharedVertices ? subMesh->parent->sharedVertexData : subMesh->vertexData;
+        std::vector<Vector3> positions;
+        if (subMesh->operationType != RenderOperation::OT_TRIANGLE_LIST || !indexData->indexBuffer ||
+            !indexData->indexCount || !vertexData || !readPositions(vertexData, positions))
+            return false;
+
+        std::vector<uint32> indices;
+        readIndices(indexData, indices);
+        for (uint32 idx : indices)
+        {
+            if (idx >= positions.size())
+                return false;
+        }
+        size_t numTris = indices.size() / 3;
+        std::vector<uint32> rest(indices.begin() + numTris * 3, indices.end());
+        indices.resize(numTris * 3);
+
+        std::vector<uint32> triCounts, triOffsets, vertexTris;
+        buildTriangleAdjacency(indices, uint32(positions.size()), triCounts, triOffsets, vertexTris);
+
+        std::vector<Vector3> triCentroids(numTris), triNormals(numTris);
+        for (size_t t = 0; t < numTris; ++t)
+        {
+            const Vector3& a = positions[indices[t * 3]];
+            const Vector3& b = positions[indices[t * 3 + 1]];
+            const Vector3& c = positions[indices[t * 3 + 2]];
+            triCentroids[t] = (a + b + c) / 3;
+            triNormals[t] = (b - a).crossProduct(c - a);
+            triNormals[t].normalise(); // degenerate triangles keep a zero normal
+        }
+
+        const uint32 NONE = ~0u;
+        std::vector<uint32> vertexMeshlet(positions.size(), NONE);
+        std::vector<uint32> triCandidate(numTris, NONE);
+        std::vector<bool> emitted(numTris, false);
+        std::vector<uint32> result, tris, candidates;
+        result.reserve(indices.size() + rest.size());
+
+        size_t cursor = 0, numEmitted = 0;
+        while (numEmitted < numTris)
+        {
+            uint32 id = uint32(subMesh->meshlets.size());
+            uint32 numVertices = 0;
+            Vector3 centroidSum = Vector3::ZERO, normalSum = Vector3::ZERO;
+            tris.clear();
+            candidates.clear();
+
+            auto newVertices = [&](size_t t) {
+                return uint32(vertexMeshlet[indices[t * 3]] != id) + uint32(vertexMeshlet[indices[t * 3 + 1]] != id) +
+                       uint32(vertexMeshlet[indices[t * 3 + 2]] != id);
+            };
+            auto addTriangle = [&](size_t t) {
+                emitted[t] = true;
+                numEmitted++;
+                tris.push_back(uint32(t));
+                centroidSum += triCentroids[t];
+                normalSum += triNormals[t];
+                for (int i = 0; i < 3; ++i)
+                {
+                    uint32 v = indices[t * 3 + i];
+                    if (vertexMeshlet[v] == id)
+                        continue;
+                    vertexMeshlet[v] = id;
+                    numVertices++;
+                    for (uint32 j = triOffsets[v]; j < triOffsets[v] + triCounts[v]; ++j)
+                    {
+                        uint32 n = vertexTris[j];
+                        if (!emitted[n] && triCandidate[n] != id)
+                        {
+                            triCandidate[n] = id;
+                            candidates.push_back(n);
+                        }
+                    }
+                }
+            };
+
+            while (emitted[cursor])
+                cursor++;
+            addTriangle(cursor);
+
+            while (tris.size() < mMeshletMaxTriangles)
+            {
+                Vector3 centroid = centroidSum / Real(tris.size());
+                Vector3 axis = normalSum.normalisedCopy();
+
+                // prefer triangles that add few vertices, then ones keeping the meshlet compact and flat
+                int64 best = -1;
+                uint32 bestNew = 4;
+                Real bestCost = 0;
+                for (size_t i = 0; i < candidates.size();)
+                {
+                    uint32 t = candidates[i];
+                    if (emitted[t])
+                    {
+                        candidates[i] = candidates.back();
+                        candidates.pop_back();
+                        continue;
+                    }
+                    ++i;
+
+                    uint32 n = newVertices(t);
+                    if (numVertices + n > mMeshletMaxVertices)
+                        continue;
+                    Real cost = triCentroids[t].distance(centroid) * (2 - triNormals[t].dotProduct(axis));
+                    if (n < bestNew || (n == bestNew && cost < bestCost))
+                    {
+                        best = t;
+                        bestNew = n;
+                        bestCost = cost;
+                    }
+                }
+
+                if (candidates.empty())
+                {
+                    // nothing connected is left, continue with the next triangle in input order
+                    while (cursor < numTris && emitted[cursor])
+                        cursor++;
+                    if (cursor < numTris && numVertices + newVertices(cursor) <= mMeshletMaxVertices)
+                        best = cursor;
+                }
+                if (best < 0)
+                    break;
+                addTriangle(size_t(best));
+            }
+
+            // keep the vertex cache order within the meshlet
+            std::sort(tris.begin(), tris.end());
+
+            SubMesh::Meshlet m;
+            m.indexStart = uint32(indexData->indexStart + result.size());
+            m.indexCount = uint32(tris.size() * 3);
+
+            AxisAlignedBox box;
+            for (uint32 t : tris)
+            {
+                result.insert(result.end(), &indices[t * 3], &indices[t * 3] + 3);
+                for (int i = 0; i < 3; ++i)
+                    box.merge(positions[indices[t * 3 + i]]);
+            }
+            m.center = box.getCenter();
+            m.radius = 0;
+            for (uint32 t : tris)
+            {
+                for (int i = 0; i < 3; ++i)
+                    m.radius = std::max(m.radius, m.center.distance(positions[indices[t * 3 + i]]));
+            }
+
+            // the normal cone, that is widened by 90 degrees into the cone of back-facing view directions
+            m.coneAxis = normalSum.normalisedCopy();
+            m.coneApex = m.center;
+            m.coneCutoff = 1;
+            Real minDot = 1;
+            for (uint32 t : tris)
+            {
+                if (triNormals[t] != Vector3::ZERO)
+                    minDot = std::min(minDot, triNormals[t].dotProduct(m.coneAxis));
+            }
+            // wide cones are hardly ever back-facing, while their apex would be far behind the meshlet
+            if (m.coneAxis != Vector3::ZERO && minDot > Real(0.1))
+            {
+                // move the apex behind the planes of all triangles
+                Real maxT = 0;
+                for (uint32 t : tris)
+                {
+                    const Vector3& n = triNormals[t];
+                    if (n != Vector3::ZERO)
+                        maxT = std::max(maxT, (m.center - positions[indices[t * 3]]).dotProduct(n) /
+                                                  n.dotProduct(m.coneAxis));
+                }
+                m.coneApex = m.center - m.coneAxis * maxT;
+                m.coneCutoff = std::sqrt(1 - minDot * minDot);
+            }
+            subMesh->meshlets.push_back(m);
+        }
+
+        result.insert(result.end(), rest.begin(), rest.end());
+        writeIndices(indexData, result);
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    std::vector<uint32> MeshOptimizer::optimiseVertexFetch(VertexData* vertexData,
+                                                           const std::vector<IndexData*>& indexData)
+    {
+        const uint32 UNUSED = ~0u;
+        size_t vertexCount = vertexData->vertexCount;
+        std::vector<uint32> remap(vertexCount, UNUSED);
+        uint32 next = 0;
+
+        std::vector<uint32> indices;
+        for (auto id : indexData)
+        {
+            readIndices(id, indices);
+            for (uint32 idx : indices)
+            {
+                if (idx < vertexCount && remap[idx] == UNUSED)
+                    remap[idx] = next++;
+            }
+        }
+        for (auto& r : remap)
+        {
+            if (r == UNUSED)
+                r = next++;
+        }
+
+        // reorder each vertex buffer once
+        std::set<HardwareVertexBuffer*> processed;
+        std::vector<uint8> scratch;
+        for (const auto& binding : vertexData->vertexBufferBinding->getBindings())
+        {
+            const auto& vbuf = binding.second;
+            if (!processed.insert(vbuf.get()).second)
+                continue;
+
+            size_t vertexSize = vbuf->getVertexSize();
+            HardwareBufferLockGuard lock(vbuf, vertexData->vertexStart * vertexSize, vertexCount * vertexSize,
+                                         HardwareBuffer::HBL_NORMAL);
+            auto pData = static_cast<uint8*>(lock.pData);
+            scratch.assign(pData, pData + vertexCount * vertexSize);
+            for (size_t v = 0; v < vertexCount; ++v)
+                memcpy(pData + remap[v] * vertexSize, scratch.data() + v * vertexSize, vertexSize);
+        }
+
+        // remap each index buffer once
+        std::set<HardwareIndexBuffer*> remapped;
+        for (auto id : indexData)
+        {
+            if (!remapped.insert(id->indexBuffer.get()).second)
+                continue;
+
+            const auto& ibuf = id->indexBuffer;
+            HardwareBufferLockGuard lock(ibuf, HardwareBuffer::HBL_NORMAL);
+            auto remapIndex = [&](auto* pIdx) {
+                for (size_t i = 0; i < ibuf->getNumIndexes(); ++i)
+                {
+                    if (pIdx[i] < vertexCount)
+                        pIdx[i] = remap[pIdx[i]];
+                }
+            };
+            if (ibuf->getType() == HardwareIndexBuffer::IT_32BIT)
+                remapIndex(static_cast<uint32*>(lock.pData));
+            else
+                remapIndex(static_cast<uint16*>(lock.pData));
+        }
+
+        return remap;
+    }
+    //-----------------------------------------------------------------------
+    float MeshOptimizer::getAvgCacheMissRatio(const IndexData* indexData) const
+    {
+        std::vector<uint32> indices;
+        readIndices(indexData, indices);
+        return indices.size() < 3 ? 0 : float(countCacheMisses(indices, mCacheSize)) / (indices.size() / 3);
+    }
+}
@@ -47,18 +47,22 @@ namespace Ogre {
     const unsigned short HEADER_CHUNK_ID = 0x1000;
     //---------------------------------------------------------------------
     MeshSerializer::MeshSerializer()
-        :mListener(0)
+        :mListener(0), mEncodingFlags(EF_NONE)
     {
         // Init implementations
         // String identifiers have not always been 100% unified with OGRE version
         
         // Note MUST be added in reverse order so latest is first in the list
 
+        mVersionData.push_back(OGRE_NEW MeshVersionData(
+            MESH_VERSION_14_2, "[MeshSerializer_v14.2]",
+            OGRE_NEW MeshSerializerImpl()));
+
         // This one is a little ugly, 1.10 is used for version 1.1 legacy meshes.
         // So bump up to 1.100
         mVersionData.push_back(OGRE_NEW MeshVersionData(
             MESH_VERSION_1_10, "[MeshSerializer_v1.100]", 
-            OGRE_NEW MeshSerializerImpl()));
+            OGRE_NEW MeshSerializerImpl_v1_10()));
 
         mVersionData.push_back(OGRE_NEW MeshVersionData(
             MESH_VERSION_1_8, "[MeshSerializer_v1.8]", 
@@ -82,6 +86,11 @@ namespace Ogre {
         mVersionData.push_back(OGRE_NEW MeshVersionData(
             MESH_VERSION_LEGACY, "[MeshSerializer_v1.10]", 
             OGRE_NEW MeshSerializerImpl_v1_1()));
+
+        // not part of the version chain, but selected by its header all the same
+        mVersionData.push_back(OGRE_NEW MeshVersionData(
+            MESH_VERSION_FLAT, "[MeshSerializer_Flat_v1.0]",
+            OGRE_NEW MeshSerializerImpl_Flat()));
         
     }
     //---------------------------------------------------------------------
@@ -114,18 +123,24 @@ namespace Ogre {
                         "You may not supply a legacy version number (pre v1.0) for writing meshes.",
                         "MeshSerializer::exportMesh");
         
-        MeshSerializerImpl* impl = 0;
         if (version == MESH_VERSION_LATEST)
-            impl = mVersionData[0]->impl;
-        else 
         {
-            for (auto & i : mVersionData)
+            // only meshlets need 14.2, other meshes stay readable by older runtimes
+            version = MESH_VERSION_1_10;
+            for (const auto* sm : pMesh->getSubMeshes())
             {
-                if (version == i->version)
-                {
-                    impl = i->impl;
-                    break;
-                }
+                if (!sm->meshlets.empty())
+                    version = MESH_VERSION_14_2;
+            }
+        }
+
+        MeshSerializerImpl* impl = 0;
+        for (auto & i : mVersionData)
+        {
+            if (version == i->version)
+            {
+                impl = i->impl;
+                break;
             }
         }
         
@@ -133,7 +148,10 @@ namespace Ogre {
             OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "Cannot find serializer implementation for "
                     "specified version", "MeshSerializer::exportMesh");
 
-                    
+
+        if (version == MESH_VERSION_FLAT)
+            static_cast<MeshSerializerImpl_Flat*>(impl)->setEncodingFlags(mEncodingFlags);
+
         impl->exportMesh(pMesh, stream, endianMode);
     }
     //---------------------------------------------------------------------
@@ -158,23 +176,24 @@ namespace Ogre {
         stream->seek(0);
 
         // Find the implementation to use
-        MeshSerializerImpl* impl = 0;
+        MeshVersionData* data = 0;
         for (auto & i : mVersionData)
         {
             if (i->versionString == ver)
             {
-                impl = i->impl;
+                data = i;
                 break;
             }
         }           
-        if (!impl)
+        if (!data)
             OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "Cannot find serializer implementation for "
                         "mesh version " + ver, "MeshSerializer::importMesh");
         
         // Call implementation
-        impl->importMesh(stream, pDest, mListener);
-        // Warn on old version of mesh
-        if (ver != mVersionData[0]->versionString)
+        data->impl->importMesh(stream, pDest, mListener);
+        // Warn on old version of mesh. 1.10 is still written for meshes without meshlets
+        if (data->version != MESH_VERSION_14_2 && data->version != MESH_VERSION_1_10 &&
+            data->version != MESH_VERSION_FLAT)
         {
             LogManager::getSingleton().logWarning(pDest->getName() + " uses an old format " + ver +
                                                   "; upgrade with the OgreMeshUpgrader tool");
@@ -0,0 +1,972 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreMeshSerializerImpl.h"
+#include "OgreLodStrategy.h"
+#include "OgreLodStrategyManager.h"
+
+namespace Ogre {
+namespace {
+    const uint16 HEADER_CHUNK_ID = 0x1000;
+    const uint32 FLAT_NONE = uint32(-1);
+    const size_t FLAT_ALIGNMENT = 16;
+
+    size_t alignOffset(size_t offset) { return (offset + FLAT_ALIGNMENT - 1) & ~(FLAT_ALIGNMENT - 1); }
+
+    // all offsets are in bytes from the start of the file
+
+    struct FlatHeader
+    {
+        uint32 numVertexData;
+        uint32 numSubMeshes;
+        uint32 numLods;
+        uint32 sharedVertexData; // index into the vertex data table or FLAT_NONE
+        uint32 skeletonName;     // offset into the string table or FLAT_NONE
+        uint32 lodStrategyName;
+        uint32 numBoneAssignments;
+        uint32 padding;
+        uint64 vertexDataOffset; // FlatVertexData[numVertexData]
+        uint64 subMeshOffset;    // FlatSubMesh[numSubMeshes]
+        uint64 lodOffset;        // FlatLod[numLods]
+        uint64 boneAssignmentOffset;
+        uint64 stringsOffset;
+        uint64 stringsSize;
+        float bounds[6];
+        float radius;
+        uint32 padding2;
+    };
+
+    struct FlatVertexData
+    {
+        uint32 vertexCount;
+        uint32 numElements;
+        uint32 numBuffers;
+        uint32 padding;
+        uint64 elementsOffset; // FlatVertexElement[numElements]
+        uint64 buffersOffset;  // FlatVertexBuffer[numBuffers]
+    };
+
+    struct FlatVertexElement
+    {
+        uint16 source;
+        uint16 type;
+        uint16 semantic;
+        uint16 offset;
+        uint16 index;
+        uint16 padding;
+    };
+
+    enum FlatEncoding
+    {
+        FLAT_RAW = 0,
+        FLAT_QUANTISED_POSITION = 1, // the FLOAT3 position is stored as 3 uint16 relative to the bounds
+        FLAT_COMPRESSED = 2          // delta coded, see encodeVertexStream and encodeIndexStream
+    };
+
+    struct FlatVertexBuffer
+    {
+        uint32 bindIndex;
+        uint32 vertexSize;
+        uint64 dataOffset;
+        uint64 dataSize;
+        uint32 encoding;
+        uint32 positionOffset; // offset of the position inside the vertex, if quantised
+        float positionMin[3];
+        float positionScale[3];
+    };
+
+    struct FlatLod
+    {
+        float userValue;
+        uint32 manualName; // offset into the string table or FLAT_NONE for generated levels
+    };
+
+    struct FlatSubMesh
+    {
+        uint32 name;
+        uint32 materialName;
+        uint32 operationType;
+        uint32 vertexData; // index into the vertex data table or FLAT_NONE for shared vertices
+        uint32 numBoneAssignments;
+        uint32 padding;
+        uint64 boneAssignmentOffset;
+        uint64 indexDataOffset; // FlatIndexData[numLods]
+    };
+
+    struct FlatIndexData
+    {
+        uint32 indexStart;
+        uint32 indexCount;
+        uint32 bufferLod; // share the index buffer of this LOD instead of creating one or FLAT_NONE
+        uint32 indexType;
+        uint32 bufferIndexCount;
+        uint32 encoding;
+        uint64 dataOffset;
+        uint64 dataSize;
+    };
+
+    struct FlatBoneAssignment
+    {
+        uint32 vertexIndex;
+        uint16 boneIndex;
+        uint16 padding;
+        float weight;
+    };
+
+    /// appends aligned blobs to a growing buffer, that is written at once
+    class FlatWriter
+    {
+        std::vector<uint8> mData;
+        std::vector<char> mStrings;
+    public:
+        void align()
+        {
+            mData.resize(alignOffset(mData.size()));
+        }
+
+        uint64 write(const void* data, size_t size)
+        {
+            align();
+            size_t offset = mData.size();
+            mData.resize(offset + size);
+            if (size)
+                memcpy(mData.data() + offset, data, size);
+            return offset;
+        }
+
+        /// reserve space for count structs, which are accessed through at()
+        template <typename T> uint64 reserve(size_t count)
+        {
+            align();
+            size_t offset = mData.size();
+            mData.resize(offset + sizeof(T) * count);
+            return offset;
+        }
+
+        template <typename T> T* at(uint64 offset, size_t i = 0)
+        {
+            return reinterpret_cast<T*>(mData.data() + offset) + i;
+        }
+
+        uint32 addString(const String& str)
+        {
+            uint32 offset = uint32(mStrings.size());
+            mStrings.insert(mStrings.end(), str.begin(), str.end());
+            mStrings.push_back(0);
+            return offset;
+        }
+
+        const std::vector<char>& getStrings() const { return mStrings; }
+        const std::vector<uint8>& getData() const { return mData; }
+    };
+
+    /// bounds checked access to the loaded file
+    class FlatReader
+    {
+        const uint8* mData;
+        size_t mSize;
+        const char* mStrings;
+        size_t mStringsSize;
+        const String& mName;
+    public:
+        FlatReader(const uint8* data, size_t size, const String& name)
+            : mData(data), mSize(size), mStrings(NULL), mStringsSize(0), mName(name)
+        {
+        }
+
+        template <typename T> const T* at(uint64 offset, size_t count = 1) const
+        {
+            if (offset > mSize || sizeof(T) * count > mSize - offset || offset % alignof(T))
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + mName);
+            return reinterpret_cast<const T*>(mData + offset);
+        }
+
+        void setStrings(uint64 offset, size_t size)
+        {
+            mStrings = at<char>(offset, size);
+            mStringsSize = size;
+            if (size && mStrings[size - 1] != 0)
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + mName);
+        }
+
+        String getString(uint32 offset) const
+        {
+            if (offset == FLAT_NONE)
+                return BLANKSTRING;
+            if (offset >= mStringsSize)
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + mName);
+            return mStrings + offset;
+        }
+    };
+
+    // Lossless codecs in the spirit of meshoptimizer. Vertex streams are split into byte lanes, that are
+    // delta coded across consecutive vertices and bit packed in groups of 16. Index streams are
+    // delta coded and stored as varints.
+    const size_t CODEC_BLOCK_SIZE = 256; // vertices
+    const size_t CODEC_GROUP_SIZE = 16;
+    const uint8 CODEC_GROUP_BITS[4] = {0, 2, 4, 8};
+
+    inline uint8 zigzag8(uint8 v) { return uint8((v << 1) ^ uint8(int8(v) >> 7)); }
+    inline uint8 unzigzag8(uint8 v) { return uint8((v >> 1) ^ uint8(-(v & 1))); }
+
+    void encodeVertexStream(std::vector<uint8>& out, const uint8* data, size_t count, size_t stride)
+    {
+        std::vector<uint8> last(stride, 0);
+        uint8 deltas[CODEC_BLOCK_SIZE];
+
+        for (size_t base = 0; base < count; base += CODEC_BLOCK_SIZE)
+        {
+            size_t blockSize = std::min(CODEC_BLOCK_SIZE, count - base);
+            size_t numGroups = (blockSize + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+
+            for (size_t k = 0; k < stride; ++k)
+            {
+                uint8 prev = last[k];
+                for (size_t i = 0; i < blockSize; ++i)
+                {
+                    uint8 v = data[(base + i) * stride + k];
+                    deltas[i] = zigzag8(uint8(v - prev));
+                    prev = v;
+                }
+                last[k] = prev;
+                memset(deltas + blockSize, 0, numGroups * CODEC_GROUP_SIZE - blockSize);
+
+                // 2 bit selector per group
+                size_t header = out.size();
+                out.resize(header + (numGroups + 3) / 4, 0);
+
+                for (size_t g = 0; g < numGroups; ++g)
+                {
+                    const uint8* group = deltas + g * CODEC_GROUP_SIZE;
+                    uint8 bits = 0;
+                    for (size_t i = 0; i < CODEC_GROUP_SIZE; ++i)
+                        bits |= group[i];
+
+                    uint8 sel = bits == 0 ? 0 : bits < 4 ? 1 : bits < 16 ? 2 : 3;
+                    out[header + g / 4] |= uint8(sel << (g % 4) * 2);
+
+                    uint8 width = CODEC_GROUP_BITS[sel];
+                    if (width == 8)
+                    {
+                        out.insert(out.end(), group, group + CODEC_GROUP_SIZE);
+                        continue;
+                    }
+                    size_t perByte = 8 / std::max<uint8>(width, 1);
+                    for (size_t i = 0; width && i < CODEC_GROUP_SIZE; i += perByte)
+                    {
+                        uint8 packed = 0;
+                        for (size_t j = 0; j < perByte; ++j)
+                            packed |= uint8(group[i + j] << (j * width));
+                        out.push_back(packed);
+                    }
+                }
+            }
+        }
+    }
+
+    /// @return false if the stream is truncated
+    bool decodeVertexStream(uint8* dst, size_t count, size_t stride, const uint8* src, size_t size)
+    {
+        const uint8* end = src + size;
+        std::vector<uint8> last(stride, 0);
+        uint8 deltas[CODEC_BLOCK_SIZE];
+
+        for (size_t base = 0; base < count; base += CODEC_BLOCK_SIZE)
+        {
+            size_t blockSize = std::min(CODEC_BLOCK_SIZE, count - base);
+            size_t numGroups = (blockSize + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+
+            for (size_t k = 0; k < stride; ++k)
+            {
+                const uint8* header = src;
+                src += (numGroups + 3) / 4;
+                if (src > end)
+                    return false;
+
+                for (size_t g = 0; g < numGroups; ++g)
+                {
+                    uint8* group = deltas + g * CODEC_GROUP_SIZE;
+                    uint8 width = CODEC_GROUP_BITS[(header[g / 4] >> (g % 4) * 2) & 3];
+                    size_t groupBytes = width * CODEC_GROUP_SIZE / 8;
+                    if (size_t(end - src) < groupBytes)
+                        return false;
+
+                    if (width == 0)
+                    {
+                        memset(group, 0, CODEC_GROUP_SIZE);
+                        continue;
+                    }
+                    if (width == 8)
+                    {
+                        memcpy(group, src, CODEC_GROUP_SIZE);
+                        src += CODEC_GROUP_SIZE;
+                        continue;
+                    }
+                    size_t perByte = 8 / width;
+                    uint8 mask = uint8((1 << width) - 1);
+                    for (size_t i = 0; i < CODEC_GROUP_SIZE; i += perByte, ++src)
+                    {
+                        for (size_t j = 0; j < perByte; ++j)
+                            group[i + j] = (*src >> (j * width)) & mask;
+                    }
+                }
+
+                uint8 prev = last[k];
+                uint8* out = dst + base * stride + k;
+                for (size_t i = 0; i < blockSize; ++i, out += stride)
+                    *out = prev = uint8(prev + unzigzag8(deltas[i]));
+                last[k] = prev;
+            }
+        }
+        return true;
+    }
+
+    void encodeIndexStream(std::vector<uint8>& out, const void* data, size_t count, bool is32bit)
+    {
+        uint32 prev = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32 idx = is32bit ? static_cast<const uint32*>(data)[i] : static_cast<const uint16*>(data)[i];
+            int32 delta = int32(idx - prev);
+            uint32 v = (uint32(delta) << 1) ^ uint32(delta >> 31);
+            prev = idx;
+
+            while (v >= 0x80)
+            {
+                out.push_back(uint8(v | 0x80));
+                v >>= 7;
+            }
+            out.push_back(uint8(v));
+        }
+    }
+
+    /// @return false if the stream is truncated
+    template <typename T> bool decodeIndexStream(T* dst, size_t count, const uint8* src, size_t size)
+    {
+        const uint8* end = src + size;
+        uint32 prev = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32 v = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                if (src == end || shift > 28)
+                    return false;
+                uint8 b = *src++;
+                v |= uint32(b & 0x7f) << shift;
+                if (b < 0x80)
+                    break;
+            }
+            prev += (v >> 1) ^ uint32(-int32(v & 1));
+            dst[i] = T(prev);
+        }
+        return true;
+    }
+
+    uint64 writeVertexData(FlatWriter& writer, const VertexData* vertexData, uint32 encodingFlags)
+    {
+        const auto& elemList = vertexData->vertexDeclaration->getElements();
+        const auto& bindings = vertexData->vertexBufferBinding->getBindings();
+
+        uint64 elements = writer.reserve<FlatVertexElement>(elemList.size());
+        uint32 i = 0;
+        for (const auto& elem : elemList)
+        {
+            auto fe = writer.at<FlatVertexElement>(elements, i++);
+            fe->source = elem.getSource();
+            fe->type = elem.getType();
+            fe->semantic = elem.getSemantic();
+            fe->offset = uint16(elem.getOffset());
+            fe->index = elem.getIndex();
+            fe->padding = 0;
+        }
+
+        const VertexElement* posElem = vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+        if (posElem && posElem->getType() != VET_FLOAT3)
+            posElem = NULL;
+
+        uint64 buffers = writer.reserve<FlatVertexBuffer>(bindings.size());
+        i = 0;
+        for (const auto& vbi : bindings)
+        {
+            const HardwareVertexBufferSharedPtr& vbuf = vbi.second;
+            size_t vertexSize = vbuf->getVertexSize();
+            size_t count = vertexData->vertexCount;
+            // vbuf->getSizeInBytes() is too large for meshes prepared for shadow volumes
+            size_t size = vertexSize * count;
+            HardwareBufferLockGuard vbufLock(vbuf, HardwareBuffer::HBL_READ_ONLY);
+            auto pData = static_cast<const uint8*>(vbufLock.pData);
+
+            FlatVertexBuffer fb = {};
+            fb.bindIndex = vbi.first;
+            fb.vertexSize = uint32(vertexSize);
+
+            std::vector<uint8> quantised;
+            if ((encodingFlags & MeshSerializer::EF_QUANTISE_POSITIONS) && posElem &&
+                posElem->getSource() == vbi.first)
+            {
+                fb.encoding |= FLAT_QUANTISED_POSITION;
+                fb.positionOffset = uint32(posElem->getOffset());
+
+                Vector3 vmin(Math::POS_INFINITY), vmax(Math::NEG_INFINITY);
+                for (size_t v = 0; v < count; ++v)
+                {
+                    Vector3 pos(reinterpret_cast<const float*>(pData + v * vertexSize + fb.positionOffset));
+                    vmin.makeFloor(pos);
+                    vmax.makeCeil(pos);
+                }
+                Vector3 scale = count ? (vmax - vmin) / 65535.0f : Vector3::ZERO;
+                for (int c = 0; c < 3; ++c)
+                {
+                    fb.positionMin[c] = count ? float(vmin[c]) : 0.0f;
+                    fb.positionScale[c] = float(scale[c]);
+                }
+
+                // the position is replaced by 3 uint16 in place
+                size_t qVertexSize = vertexSize - 6;
+                size_t tail = vertexSize - fb.positionOffset - 12;
+                quantised.resize(qVertexSize * count);
+                for (size_t v = 0; v < count; ++v)
+                {
+                    const uint8* src = pData + v * vertexSize;
+                    uint8* dst = quantised.data() + v * qVertexSize;
+                    const float* pos = reinterpret_cast<const float*>(src + fb.positionOffset);
+                    uint16 q[3];
+                    for (int c = 0; c < 3; ++c)
+                        q[c] = scale[c] > 0 ? uint16(Math::Clamp<Real>(std::round((pos[c] - vmin[c]) / scale[c]), 0, 65535)) : 0;
+
+                    memcpy(dst, src, fb.positionOffset);
+                    memcpy(dst + fb.positionOffset, q, sizeof(q));
+                    memcpy(dst + fb.positionOffset + sizeof(q), src + fb.positionOffset + 12, tail);
+                }
+                pData = quantised.data();
+                vertexSize = qVertexSize;
+                size = quantised.size();
+            }
+
+            if (encodingFlags & MeshSerializer::EF_COMPRESS_STREAMS)
+            {
+                fb.encoding |= FLAT_COMPRESSED;
+                std::vector<uint8> encoded;
+                encodeVertexStream(encoded, pData, count, vertexSize);
+                fb.dataSize = encoded.size();
+                fb.dataOffset = writer.write(encoded.data(), encoded.size());
+            }
+            else
+            {
+                fb.dataSize = size;
+                fb.dataOffset = writer.write(pData, size);
+            }
+
+            *writer.at<FlatVertexBuffer>(buffers, i++) = fb;
+        }
+
+        uint64 offset = writer.reserve<FlatVertexData>(1);
+        auto fv = writer.at<FlatVertexData>(offset);
+        fv->vertexCount = uint32(vertexData->vertexCount);
+        fv->numElements = uint32(elemList.size());
+        fv->numBuffers = uint32(bindings.size());
+        fv->padding = 0;
+        fv->elementsOffset = elements;
+        fv->buffersOffset = buffers;
+        return offset;
+    }
+
+    void readVertexData(const FlatReader& reader, const FlatVertexData& fv, Mesh* pMesh, VertexData* dest)
+    {
+        dest->vertexStart = 0;
+        dest->vertexCount = fv.vertexCount;
+
+        auto elements = reader.at<FlatVertexElement>(fv.elementsOffset, fv.numElements);
+        for (uint32 i = 0; i < fv.numElements; ++i)
+        {
+            const auto& fe = elements[i];
+            dest->vertexDeclaration->addElement(fe.source, fe.offset, VertexElementType(fe.type),
+                                                VertexElementSemantic(fe.semantic), fe.index);
+        }
+
+        auto buffers = reader.at<FlatVertexBuffer>(fv.buffersOffset, fv.numBuffers);
+        for (uint32 i = 0; i < fv.numBuffers; ++i)
+        {
+            const auto& fb = buffers[i];
+            if (dest->vertexDeclaration->getVertexSize(fb.bindIndex) != fb.vertexSize)
+            {
+                OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                            "Buffer vertex size does not agree with vertex declaration in " + pMesh->getName());
+            }
+
+            size_t size = size_t(fb.vertexSize) * fv.vertexCount;
+            auto vbuf = pMesh->getHardwareBufferManager()->createVertexBuffer(
+                fb.vertexSize, fv.vertexCount, pMesh->getVertexBufferUsage(), pMesh->isVertexBufferShadowed());
+            dest->vertexBufferBinding->setBinding(fb.bindIndex, vbuf);
+
+            auto src = reader.at<uint8>(fb.dataOffset, fb.dataSize);
+            if (fb.encoding == FLAT_RAW)
+            {
+                if (fb.dataSize != size)
+                    OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+                vbuf->writeData(0, size, src, true);
+                continue;
+            }
+
+            bool quantised = fb.encoding & FLAT_QUANTISED_POSITION;
+            size_t storedVertexSize = quantised ? fb.vertexSize - 6 : fb.vertexSize;
+            if (quantised && (fb.vertexSize < 12 || fb.positionOffset > fb.vertexSize - 12))
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+
+            HardwareBufferLockGuard vbufLock(vbuf, HardwareBuffer::HBL_DISCARD);
+            auto pDst = static_cast<uint8*>(vbufLock.pData);
+
+            std::vector<uint8> decoded;
+            if (fb.encoding & FLAT_COMPRESSED)
+            {
+                // decode in place, unless the positions still need to be expanded
+                uint8* target = pDst;
+                if (quantised)
+                {
+                    decoded.resize(storedVertexSize * fv.vertexCount);
+                    target = decoded.data();
+                }
+                if (!decodeVertexStream(target, fv.vertexCount, storedVertexSize, src, fb.dataSize))
+                    OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+                src = target;
+            }
+            else if (fb.dataSize != storedVertexSize * fv.vertexCount)
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+            }
+
+            if (!quantised)
+                continue;
+
+            size_t tail = fb.vertexSize - fb.positionOffset - 12;
+            for (uint32 v = 0; v < fv.vertexCount; ++v)
+            {
+                const uint8* vsrc = src + v * storedVertexSize;
+                uint8* vdst = pDst + v * fb.vertexSize;
+                uint16 q[3];
+                memcpy(q, vsrc + fb.positionOffset, sizeof(q));
+                float pos[3];
+                for (int c = 0; c < 3; ++c)
+                    pos[c] = fb.positionMin[c] + fb.positionScale[c] * q[c];
+
+                memcpy(vdst, vsrc, fb.positionOffset);
+                memcpy(vdst + fb.positionOffset, pos, sizeof(pos));
+                memcpy(vdst + fb.positionOffset + sizeof(pos), vsrc + fb.positionOffset + sizeof(q), tail);
+            }
+        }
+    }
+
+    uint64 writeBoneAssignments(FlatWriter& writer, const Mesh::VertexBoneAssignmentList& assignments)
+    {
+        uint64 offset = writer.reserve<FlatBoneAssignment>(assignments.size());
+        uint32 i = 0;
+        for (const auto& vba : assignments)
+        {
+            auto fba = writer.at<FlatBoneAssignment>(offset, i++);
+            fba->vertexIndex = vba.second.vertexIndex;
+            fba->boneIndex = vba.second.boneIndex;
+            fba->padding = 0;
+            fba->weight = vba.second.weight;
+        }
+        return offset;
+    }
+
+    void writeIndexData(FlatWriter& writer, const SubMesh* sm, uint64 offset, uint32 lod, uint32 encodingFlags)
+    {
+        const IndexData* indexData = lod == 0 ? sm->indexData : sm->mLodFaceList[lod - 1];
+        auto fi = writer.at<FlatIndexData>(offset, lod);
+        *fi = FlatIndexData();
+        fi->indexStart = uint32(indexData->indexStart);
+        fi->indexCount = uint32(indexData->indexCount);
+        fi->bufferLod = FLAT_NONE;
+
+        const auto& ibuf = indexData->indexBuffer;
+        if (!ibuf)
+            return;
+
+        // merged LOD buffers are only written once
+        for (uint32 other = 0; other < lod; ++other)
+        {
+            const IndexData* otherData = other == 0 ? sm->indexData : sm->mLodFaceList[other - 1];
+            if (otherData->indexBuffer == ibuf)
+            {
+                fi->bufferLod = other;
+                return;
+            }
+        }
+
+        fi->indexType = ibuf->getType();
+        fi->bufferIndexCount = uint32(ibuf->getNumIndexes());
+
+        HardwareBufferLockGuard ibufLock(ibuf, HardwareBuffer::HBL_READ_ONLY);
+        if (encodingFlags & MeshSerializer::EF_COMPRESS_STREAMS)
+        {
+            std::vector<uint8> encoded;
+            encodeIndexStream(encoded, ibufLock.pData, ibuf->getNumIndexes(),
+                              ibuf->getType() == HardwareIndexBuffer::IT_32BIT);
+            uint64 data = writer.write(encoded.data(), encoded.size());
+            fi = writer.at<FlatIndexData>(offset, lod);
+            fi->encoding = FLAT_COMPRESSED;
+            fi->dataOffset = data;
+            fi->dataSize = encoded.size();
+            return;
+        }
+
+        uint64 data = writer.write(ibufLock.pData, ibuf->getSizeInBytes());
+        fi = writer.at<FlatIndexData>(offset, lod);
+        fi->dataOffset = data;
+        fi->dataSize = ibuf->getSizeInBytes();
+    }
+
+    HardwareIndexBufferSharedPtr readIndexBuffer(const FlatReader& reader, const FlatIndexData& fi, Mesh* pMesh)
+    {
+        auto itype = HardwareIndexBuffer::IndexType(fi.indexType);
+        if (itype != HardwareIndexBuffer::IT_16BIT && itype != HardwareIndexBuffer::IT_32BIT)
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+
+        size_t size = HardwareIndexBuffer::indexSize(itype) * fi.bufferIndexCount;
+        auto ibuf = pMesh->getHardwareBufferManager()->createIndexBuffer(
+            itype, fi.bufferIndexCount, pMesh->getIndexBufferUsage(), pMesh->isIndexBufferShadowed());
+
+        auto src = reader.at<uint8>(fi.dataOffset, fi.dataSize);
+        if (fi.encoding == FLAT_RAW)
+        {
+            if (fi.dataSize != size)
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+            ibuf->writeData(0, size, src, true);
+            return ibuf;
+        }
+
+        HardwareBufferLockGuard ibufLock(ibuf, HardwareBuffer::HBL_DISCARD);
+        bool ok = itype == HardwareIndexBuffer::IT_32BIT
+                      ? decodeIndexStream(static_cast<uint32*>(ibufLock.pData), fi.bufferIndexCount, src, fi.dataSize)
+                      : decodeIndexStream(static_cast<uint16*>(ibufLock.pData), fi.bufferIndexCount, src, fi.dataSize);
+        if (!ok)
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+        return ibuf;
+    }
+}
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_Flat::MeshSerializerImpl_Flat() : mEncodingFlags(MeshSerializer::EF_NONE)
+    {
+        // Version number
+        mVersion = "[MeshSerializer_Flat_v1.0]";
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_Flat::~MeshSerializerImpl_Flat()
+    {
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_Flat::exportMesh(const Mesh* pMesh, const DataStreamPtr& stream, Endian endianMode)
+    {
+        LogManager::getSingleton().logMessage("MeshSerializer writing flat mesh data to stream " +
+                                              stream->getName() + "...");
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+        endianMode = ENDIAN_BIG;
+#endif
+        if (endianMode == ENDIAN_BIG)
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "flat meshes are always little endian");
+
+        if (pMesh->getBounds().isNull() || pMesh->getBoundingSphereRadius() == 0.0f)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "The Mesh you have supplied does not have its"
+                " bounds completely defined. Define them first before exporting.");
+        }
+        if (pMesh->getPoseCount() > 0 || pMesh->hasVertexAnimation())
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                        "flat meshes can not store poses or vertex animation: " + pMesh->getName());
+        }
+        if (!stream->isWriteable())
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "Unable to use stream " + stream->getName() + " for writing");
+        }
+        if (pMesh->isEdgeListBuilt())
+        {
+            LogManager::getSingleton().logWarning("flat meshes do not store edge lists, they will be "
+                                                  "rebuilt on demand: " + pMesh->getName());
+        }
+        for (const auto* sm : pMesh->getSubMeshes())
+        {
+            if (!sm->extremityPoints.empty())
+            {
+                LogManager::getSingleton().logWarning("flat meshes do not store extremity points: " +
+                                                      pMesh->getName());
+                break;
+            }
+        }
+
+        FlatWriter writer;
+
+        // same header as the chunked format, so MeshSerializer can tell the formats apart.
+        // Written at once, as every write is aligned
+        String fileHeader(reinterpret_cast<const char*>(&HEADER_CHUNK_ID), sizeof(HEADER_CHUNK_ID));
+        fileHeader += mVersion + "\n";
+        writer.write(fileHeader.data(), fileHeader.size());
+
+        uint64 headerOffset = writer.reserve<FlatHeader>(1);
+
+        // strings have to be added in a fixed order. Offset 0 is the empty string
+        writer.addString("");
+
+        uint32 numVertexData = pMesh->sharedVertexData ? 1 : 0;
+        for (const auto* sm : pMesh->getSubMeshes())
+            numVertexData += sm->useSharedVertices ? 0 : 1;
+        uint64 vertexDataTable = writer.reserve<uint64>(numVertexData);
+        uint32 vertexDataIdx = 0;
+
+        uint32 sharedVertexData = FLAT_NONE;
+        if (pMesh->sharedVertexData)
+        {
+            // writing may reallocate the buffer, so only then address the table
+            uint64 vertexDataOffset = writeVertexData(writer, pMesh->sharedVertexData, mEncodingFlags);
+            *writer.at<uint64>(vertexDataTable, vertexDataIdx) = vertexDataOffset;
+            sharedVertexData = vertexDataIdx++;
+        }
+
+        uint32 numLods = 1;
+#if !OGRE_NO_MESHLOD
+        numLods = pMesh->getNumLodLevels();
+#endif
+
+        // invert the submesh name map
+        std::vector<String> subMeshNames(pMesh->getNumSubMeshes());
+        for (const auto& sn : pMesh->getSubMeshNameMap())
+            subMeshNames[sn.second] = sn.first;
+
+        uint64 subMeshes = writer.reserve<FlatSubMesh>(pMesh->getNumSubMeshes());
+        for (uint32 i = 0; i < pMesh->getNumSubMeshes(); ++i)
+        {
+            const SubMesh* sm = pMesh->getSubMesh(i);
+
+            FlatSubMesh fs = {};
+            fs.name = writer.addString(subMeshNames[i]);
+            fs.materialName = writer.addString(sm->getMaterialName());
+            fs.operationType = sm->operationType;
+            fs.vertexData = FLAT_NONE;
+            if (!sm->useSharedVertices)
+            {
+                uint64 vertexDataOffset = writeVertexData(writer, sm->vertexData, mEncodingFlags);
+                *writer.at<uint64>(vertexDataTable, vertexDataIdx) = vertexDataOffset;
+                fs.vertexData = vertexDataIdx++;
+            }
+
+            fs.numBoneAssignments = uint32(sm->getBoneAssignments().size());
+            fs.boneAssignmentOffset = writeBoneAssignments(writer, sm->getBoneAssignments());
+
+            fs.indexDataOffset = writer.reserve<FlatIndexData>(numLods);
+            for (uint32 lod = 0; lod < numLods; ++lod)
+                writeIndexData(writer, sm, fs.indexDataOffset, lod, mEncodingFlags);
+
+            *writer.at<FlatSubMesh>(subMeshes, i) = fs;
+        }
+
+        uint64 lods = writer.reserve<FlatLod>(numLods);
+        for (uint32 lod = 0; lod < numLods; ++lod)
+        {
+            const MeshLodUsage& usage = pMesh->getLodLevel(lod);
+            auto fl = writer.at<FlatLod>(lods, lod);
+            fl->userValue = usage.userValue;
+            fl->manualName = pMesh->_isManualLodLevel(lod) ? writer.addString(usage.manualName) : FLAT_NONE;
+        }
+
+        FlatHeader header = {};
+        header.numVertexData = numVertexData;
+        header.numSubMeshes = pMesh->getNumSubMeshes();
+        header.numLods = numLods;
+        header.sharedVertexData = sharedVertexData;
+        header.skeletonName = pMesh->hasSkeleton() ? writer.addString(pMesh->getSkeletonName()) : FLAT_NONE;
+        header.lodStrategyName = writer.addString(pMesh->getLodStrategy()->getName());
+        header.numBoneAssignments = uint32(pMesh->getBoneAssignments().size());
+        header.vertexDataOffset = vertexDataTable;
+        header.subMeshOffset = subMeshes;
+        header.lodOffset = lods;
+        header.boneAssignmentOffset = writeBoneAssignments(writer, pMesh->getBoneAssignments());
+        header.stringsSize = writer.getStrings().size();
+        header.stringsOffset = writer.write(writer.getStrings().data(), header.stringsSize);
+        for (int i = 0; i < 3; ++i)
+        {
+            header.bounds[i] = float(pMesh->getBounds().getMinimum()[i]);
+            header.bounds[i + 3] = float(pMesh->getBounds().getMaximum()[i]);
+        }
+        header.radius = float(pMesh->getBoundingSphereRadius());
+        *writer.at<FlatHeader>(headerOffset) = header;
+
+        stream->write(writer.getData().data(), writer.getData().size());
+
+        LogManager::getSingleton().logMessage("MeshSerializer export successful.");
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_Flat::importMesh(const DataStreamPtr& stream, Mesh* pMesh,
+                                             MeshSerializerListener* listener)
+    {
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+        OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED, "flat meshes can not be loaded on big endian hosts");
+#endif
+        // meshes are fully prebuffered by Mesh::prepareImpl, so this is usually a no-op
+        auto data = std::dynamic_pointer_cast<MemoryDataStream>(stream);
+        if (!data)
+            data = std::make_shared<MemoryDataStream>(stream);
+
+        FlatReader reader(data->getPtr(), data->size(), pMesh->getName());
+
+        size_t headerOffset = alignOffset(sizeof(HEADER_CHUNK_ID) + mVersion.size() + 1);
+        const FlatHeader& header = *reader.at<FlatHeader>(headerOffset);
+        reader.setStrings(header.stringsOffset, header.stringsSize);
+
+        auto vertexDataTable = reader.at<uint64>(header.vertexDataOffset, header.numVertexData);
+        auto vertexData = [&](uint32 idx) -> const FlatVertexData& {
+            if (idx >= header.numVertexData)
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+            return *reader.at<FlatVertexData>(vertexDataTable[idx]);
+        };
+
+        if (header.sharedVertexData != FLAT_NONE)
+        {
+            pMesh->createVertexData();
+            readVertexData(reader, vertexData(header.sharedVertexData), pMesh, pMesh->sharedVertexData);
+        }
+
+        if (header.numLods == 0)
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+
+        auto subMeshes = reader.at<FlatSubMesh>(header.subMeshOffset, header.numSubMeshes);
+        for (uint32 i = 0; i < header.numSubMeshes; ++i)
+        {
+            const FlatSubMesh& fs = subMeshes[i];
+            SubMesh* sm = pMesh->createSubMesh();
+
+            String name = reader.getString(fs.name);
+            if (!name.empty())
+                pMesh->nameSubMesh(name, i);
+
+            String materialName = reader.getString(fs.materialName);
+            if (listener)
+                listener->processMaterialName(pMesh, &materialName);
+            if (auto material = MaterialManager::getSingleton().getByName(materialName, pMesh->getGroup()))
+                sm->setMaterial(material);
+            else
+                logMaterialNotFound(materialName, pMesh->getGroup(), "SubMesh of", pMesh->getName(), LML_WARNING);
+
+            sm->operationType = RenderOperation::OperationType(fs.operationType);
+            sm->useSharedVertices = fs.vertexData == FLAT_NONE;
+            if (!sm->useSharedVertices)
+            {
+                sm->createVertexData();
+                readVertexData(reader, vertexData(fs.vertexData), pMesh, sm->vertexData);
+            }
+
+            auto assignments = reader.at<FlatBoneAssignment>(fs.boneAssignmentOffset, fs.numBoneAssignments);
+            for (uint32 j = 0; j < fs.numBoneAssignments; ++j)
+            {
+                sm->addBoneAssignment(
+                    {assignments[j].vertexIndex, assignments[j].boneIndex, assignments[j].weight});
+            }
+
+            auto indexData = reader.at<FlatIndexData>(fs.indexDataOffset, header.numLods);
+            sm->indexData->indexStart = indexData[0].indexStart;
+            sm->indexData->indexCount = indexData[0].indexCount;
+            if (indexData[0].dataOffset)
+                sm->indexData->indexBuffer = readIndexBuffer(reader, indexData[0], pMesh);
+        }
+
+#if !OGRE_NO_MESHLOD
+        if (header.numLods > 1)
+        {
+            LodStrategy* strategy =
+                LodStrategyManager::getSingleton().getStrategy(reader.getString(header.lodStrategyName));
+            if (!strategy)
+                strategy = LodStrategyManager::getSingleton().getDefaultStrategy();
+            pMesh->setLodStrategy(strategy);
+
+            pMesh->mNumLods = header.numLods;
+            pMesh->mMeshLodUsageList.resize(header.numLods);
+            auto lods = reader.at<FlatLod>(header.lodOffset, header.numLods);
+
+            for (uint32 i = 0; i < header.numSubMeshes; ++i)
+            {
+                SubMesh* sm = pMesh->getSubMesh(i);
+                auto indexData = reader.at<FlatIndexData>(subMeshes[i].indexDataOffset, header.numLods);
+
+                sm->mLodFaceList.resize(header.numLods - 1);
+                for (uint32 lod = 1; lod < header.numLods; ++lod)
+                {
+                    IndexData* dest = sm->mLodFaceList[lod - 1] = OGRE_NEW IndexData();
+                    if (lods[lod].manualName != FLAT_NONE)
+                        continue;
+
+                    const FlatIndexData& fi = indexData[lod];
+                    dest->indexStart = fi.indexStart;
+                    dest->indexCount = fi.indexCount;
+                    if (fi.bufferLod != FLAT_NONE)
+                    {
+                        if (fi.bufferLod >= lod)
+                            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "corrupt flat mesh " + pMesh->getName());
+                        const IndexData* shared = fi.bufferLod == 0 ? sm->indexData : sm->mLodFaceList[fi.bufferLod - 1];
+                        dest->indexBuffer = shared->indexBuffer;
+                    }
+                    else if (fi.dataOffset)
+                    {
+                        dest->indexBuffer = readIndexBuffer(reader, fi, pMesh);
+                    }
+                }
+            }
+
+            for (uint32 lod = 1; lod < header.numLods; ++lod)
+            {
+                MeshLodUsage& usage = pMesh->mMeshLodUsageList[lod];
+                usage.userValue = lods[lod].userValue;
+                usage.manualName = reader.getString(lods[lod].manualName);
+                usage.manualMesh.reset(); // will trigger load later with manual Lod
+                usage.edgeData = NULL;
+                pMesh->mHasManualLodLevel |= lods[lod].manualName != FLAT_NONE;
+            }
+        }
+#endif
+
+        if (header.skeletonName != FLAT_NONE)
+        {
+            String skelName = reader.getString(header.skeletonName);
+            if (listener)
+                listener->processSkeletonName(pMesh, &skelName);
+            pMesh->setSkeletonName(skelName);
+        }
+
+        auto assignments = reader.at<FlatBoneAssignment>(header.boneAssignmentOffset, header.numBoneAssignments);
+        for (uint32 j = 0; j < header.numBoneAssignments; ++j)
+        {
+            pMesh->addBoneAssignment({assignments[j].vertexIndex, assignments[j].boneIndex, assignments[j].weight});
+        }
+
+        pMesh->_setBounds(AxisAlignedBox(Vector3(header.bounds), Vector3(header.bounds + 3)), false);
+        pMesh->_setBoundingSphereRadius(header.radius);
+    }
+}
@@ -44,11 +44,13 @@ namespace Ogre {
 
     /// stream overhead = ID + size
     const long MSTREAM_OVERHEAD_SIZE = sizeof(uint16) + sizeof(uint32);
+    /// indexStart, indexCount and 11 floats of bounds
+    const size_t MESHLET_SIZE = sizeof(uint32) * 2 + sizeof(float) * 11;
     //---------------------------------------------------------------------
     MeshSerializerImpl::MeshSerializerImpl()
     {
         // Version number
-        mVersion = "[MeshSerializer_v1.100]";
+        mVersion = "[MeshSerializer_v14.2]";
     }
     //---------------------------------------------------------------------
     MeshSerializerImpl::~MeshSerializerImpl()
@@ -205,6 +207,9 @@ namespace Ogre {
 
         // Write submesh extremes
         writeExtremes(pMesh);
+
+        // Write submesh meshlets
+        writeMeshlets(pMesh);
             popInnerChunk(mStream);
         }
     }
@@ -335,6 +340,40 @@ namespace Ogre {
             s->extremityPoints.size() * sizeof (float)* 3;
     }
 
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeMeshlets(const Mesh* pMesh)
+    {
+        for (unsigned short i = 0; i < pMesh->getNumSubMeshes(); ++i)
+        {
+            const SubMesh* sm = pMesh->getSubMesh(i);
+            if (sm->meshlets.empty())
+                continue;
+
+            writeChunkHeader(M_TABLE_MESHLETS, MSTREAM_OVERHEAD_SIZE + sizeof(unsigned short) +
+                                                   sm->meshlets.size() * MESHLET_SIZE);
+            writeShorts(&i, 1);
+            for (const auto& m : sm->meshlets)
+            {
+                writeInts(&m.indexStart, 1);
+                writeInts(&m.indexCount, 1);
+                writeFloats(m.center.ptr(), 3);
+                writeFloats(&m.radius, 1);
+                writeFloats(m.coneApex.ptr(), 3);
+                writeFloats(m.coneAxis.ptr(), 3);
+                writeFloats(&m.coneCutoff, 1);
+            }
+        }
+    }
+    size_t MeshSerializerImpl::calcMeshletsSize(const Mesh* pMesh)
+    {
+        size_t size = 0;
+        for (auto *s : pMesh->getSubMeshes())
+        {
+            if (!s->meshlets.empty())
+                size += MSTREAM_OVERHEAD_SIZE + sizeof(unsigned short) + s->meshlets.size() * MESHLET_SIZE;
+        }
+        return size;
+    }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::writeSubMeshOperation(const SubMesh* sm)
     {
@@ -512,6 +551,8 @@ namespace Ogre {
 
         size += calcExtremesSize(pMesh);
 
+        size += calcMeshletsSize(pMesh);
+
         return size;
     }
     //---------------------------------------------------------------------
@@ -813,7 +854,8 @@ namespace Ogre {
                  streamID == M_EDGE_LISTS ||
                  streamID == M_POSES ||
                  streamID == M_ANIMATIONS ||
-                 streamID == M_TABLE_EXTREMES))
+                 streamID == M_TABLE_EXTREMES ||
+                 streamID == M_TABLE_MESHLETS))
             {
                 switch(streamID)
                 {
@@ -860,6 +902,9 @@ namespace Ogre {
                 case M_TABLE_EXTREMES:
                     readExtremes(stream, pMesh);
                     break;
+                case M_TABLE_MESHLETS:
+                    readMeshlets(stream, pMesh);
+                    break;
                 }
 
                 if (!stream->eof())
@@ -2562,6 +2607,35 @@ namespace Ogre {
         readFloats(stream, sm->extremityPoints.front().ptr(), n_floats);
     }
 
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readMeshlets(const DataStreamPtr& stream, Mesh *pMesh)
+    {
+        unsigned short idx;
+        readShorts(stream, &idx, 1);
+
+        SubMesh *sm = pMesh->getSubMesh(idx);
+
+        size_t count = (mCurrentstreamLen - MSTREAM_OVERHEAD_SIZE - sizeof(unsigned short)) / MESHLET_SIZE;
+        sm->meshlets.resize(count);
+        for (auto& m : sm->meshlets)
+        {
+            readInts(stream, &m.indexStart, 1);
+            readInts(stream, &m.indexCount, 1);
+            readFloats(stream, m.center.ptr(), 3);
+            readFloats(stream, &m.radius, 1);
+            readFloats(stream, m.coneApex.ptr(), 3);
+            readFloats(stream, m.coneAxis.ptr(), 3);
+            readFloats(stream, &m.coneCutoff, 1);
+
+            if (m.indexStart < sm->indexData->indexStart ||
+                m.indexStart + m.indexCount > sm->indexData->indexStart + sm->indexData->indexCount)
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                            "meshlet exceeds the index data in " + pMesh->getName());
+            }
+        }
+    }
+
     void MeshSerializerImpl::enableValidation()
     {
 #if OGRE_SERIALIZER_VALIDATE_CHUNKSIZE
@@ -2570,6 +2644,18 @@ namespace Ogre {
     }
 
 
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v1_10::MeshSerializerImpl_v1_10()
+    {
+        // Version number
+        mVersion = "[MeshSerializer_v1.100]";
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v1_10::~MeshSerializerImpl_v1_10()
+    {
+    }
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
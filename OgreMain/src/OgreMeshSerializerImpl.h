@@ -54,7 +54,7 @@ namespace Ogre {
     will remain to load the latest version.
 
      @note
-        This mesh format was used from Ogre v1.10.
+        This mesh format was used from Ogre v14.2.
 
     */
     class _OgrePrivate MeshSerializerImpl : public Serializer
@@ -70,7 +70,7 @@ namespace Ogre {
         @param stream The destination stream
         @param endianMode The endian mode for the written file
         */
-        void exportMesh(const Mesh* pMesh, const DataStreamPtr& stream,
+        virtual void exportMesh(const Mesh* pMesh, const DataStreamPtr& stream,
             Endian endianMode = ENDIAN_NATIVE);
 
         /** Imports Mesh and (optionally) Material data from a .mesh file DataStream.
@@ -80,7 +80,7 @@ namespace Ogre {
         @param stream The DataStream holding the .mesh data. Must be initialised (pos at the start of the buffer).
         @param pDest Pointer to the Mesh object which will receive the data. Should be blank already.
         */
-        void importMesh(const DataStreamPtr& stream, Mesh* pDest, MeshSerializerListener *listener);
+        virtual void importMesh(const DataStreamPtr& stream, Mesh* pDest, MeshSerializerListener *listener);
 
     protected:
 
@@ -111,6 +111,7 @@ namespace Ogre {
         virtual void writePoseKeyframePoseRef(const VertexPoseKeyFrame::PoseRef& poseRef);
         virtual void writeExtremes(const Mesh *pMesh);
         virtual void writeSubMeshExtremes(unsigned short idx, const SubMesh* s);
+        virtual void writeMeshlets(const Mesh* pMesh);
 
         virtual size_t calcMeshSize(const Mesh* pMesh);
         virtual size_t calcSubMeshSize(const SubMesh* pSub);
@@ -138,6 +139,7 @@ namespace Ogre {
         virtual size_t calcBoundsInfoSize();
         virtual size_t calcExtremesSize(const Mesh* pMesh);
         virtual size_t calcSubMeshExtremesSize(const SubMesh* s);
+        virtual size_t calcMeshletsSize(const Mesh* pMesh);
 
         virtual void readTextureLayer(const DataStreamPtr& stream, Mesh* pMesh, MaterialPtr& pMat);
         virtual void readSubMeshNameTable(const DataStreamPtr& stream, Mesh* pMesh);
@@ -170,6 +172,7 @@ namespace Ogre {
         virtual void readMorphKeyFrame(const DataStreamPtr& stream, Mesh* pMesh, VertexAnimationTrack* track);
         virtual void readPoseKeyFrame(const DataStreamPtr& stream, VertexAnimationTrack* track);
         virtual void readExtremes(const DataStreamPtr& stream, Mesh *pMesh);
+        virtual void readMeshlets(const DataStreamPtr& stream, Mesh *pMesh);
 
 
         /// Flip an entire vertex buffer from little endian
@@ -187,10 +190,24 @@ namespace Ogre {
     };
 
 
+    /** Class for providing backwards-compatibility for loading version 1.100 of the .mesh format.
+     This mesh format was used from Ogre v1.10.
+     */
+    class _OgrePrivate MeshSerializerImpl_v1_10 : public MeshSerializerImpl
+    {
+    public:
+        MeshSerializerImpl_v1_10();
+        ~MeshSerializerImpl_v1_10();
+    protected:
+        // meshlets were added in 14.2
+        void writeMeshlets(const Mesh* pMesh) override {}
+        size_t calcMeshletsSize(const Mesh* pMesh) override { return 0; }
+    };
+
     /** Class for providing backwards-compatibility for loading version 1.8 of the .mesh format. 
      This mesh format was used from Ogre v1.8.
      */
-    class _OgrePrivate MeshSerializerImpl_v1_8 : public MeshSerializerImpl
+    class _OgrePrivate MeshSerializerImpl_v1_8 : public MeshSerializerImpl_v1_10
     {
     public:
         MeshSerializerImpl_v1_8();
@@ -307,6 +324,33 @@ namespace Ogre {
             Mesh* pMesh, VertexData* dest, unsigned short set) override;
     };
 
+    /** Flat, memory-mappable container of the renderable mesh data.
+
+     Instead of chunks, the file consists of a fixed header and tables of plain structs,
+     that reference 16 byte aligned vertex, index and bone assignment blobs by their offset.
+     The blobs are stored in little endian GPU layout and are handed to the
+     HardwareBufferManager as-is on import, without any per-element parsing.
+
+     Poses, vertex animation and edge lists are not stored.
+
+     Buffers can optionally be stored with quantised positions and delta coded streams,
+     see MeshSerializer::EncodingFlags. Those are decoded straight into the locked hardware buffer.
+     */
+    class _OgrePrivate MeshSerializerImpl_Flat : public MeshSerializerImpl
+    {
+    public:
+        MeshSerializerImpl_Flat();
+        ~MeshSerializerImpl_Flat();
+
+        void exportMesh(const Mesh* pMesh, const DataStreamPtr& stream,
+            Endian endianMode = ENDIAN_NATIVE) override;
+        void importMesh(const DataStreamPtr& stream, Mesh* pDest, MeshSerializerListener *listener) override;
+
+        void setEncodingFlags(uint32 flags) { mEncodingFlags = flags; }
+    private:
+        uint32 mEncodingFlags;
+    };
+
     /** @} */
     /** @} */
 
@@ -28,6 +28,13 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgrePixelFormat.h"
 #include "OgrePixelFormatDescriptions.h"
+#include "OgreWorkQueue.h"
+#include "OgreBlockCompression.h"
+
+#if __OGRE_HAVE_SSE && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define OGRE_PIXELFORMAT_SSE2 1
+#endif
 
 namespace {
 #include "OgrePixelConversions.h"
@@ -655,14 +662,283 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    namespace {
+    /** Memory layout of formats with 8 bit unorm, half or float channels
+
+        Pixels of these formats are converted by reading and writing the channels
+        directly, instead of going through unpackColour and packColour per pixel.
+    */
+    struct ChannelLayout
+    {
+        PixelComponentType type;
+        uint8 pixelSize;
+        /// element each of r, g, b, a is unpacked from, -1 for the default value
+        int8 read[4];
+        /// element each of r, g, b, a is packed to, -1 if it is dropped
+        int8 write[4];
+    };
+
+    bool getChannelLayout(PixelFormat pf, ChannelLayout& layout)
+    {
+        const PixelFormatDescription &des = getDescriptionFor(pf);
+        layout.type = des.componentType;
+        layout.pixelSize = des.elemBytes;
+
+        switch(pf)
+        {
+        case PF_FLOAT16_R:
+        case PF_FLOAT32_R:
+            layout.read[0] = layout.read[1] = layout.read[2] = 0;
+            layout.read[3] = -1;
+            layout.write[0] = 0;
+            layout.write[1] = layout.write[2] = layout.write[3] = -1;
+            return true;
+        case PF_FLOAT16_GR:
+        case PF_FLOAT32_GR:
+            layout.read[0] = layout.read[2] = 1;
+            layout.read[1] = 0;
+            layout.read[3] = -1;
+            layout.write[0] = 1;
+            layout.write[1] = 0;
+            layout.write[2] = layout.write[3] = -1;
+            return true;
+        case PF_FLOAT16_RGB:
+        case PF_FLOAT32_RGB:
+        case PF_FLOAT16_RGBA:
+        case PF_FLOAT32_RGBA:
+            for(int i = 0; i < 4; i++)
+                layout.read[i] = layout.write[i] = i < des.componentCount ? int8(i) : -1;
+            return true;
+        default:
+            break;
+        }
+
+        if(des.componentType != PCT_BYTE || !(des.flags & PFF_NATIVEENDIAN) ||
+           (des.flags & (PFF_COMPRESSED | PFF_DEPTH | PFF_INTEGER)))
+            return false;
+
+        const uint8 bits[4] = {des.rbits, des.gbits, des.bbits, des.abits};
+        const uint8 shifts[4] = {des.rshift, des.gshift, des.bshift, des.ashift};
+        const uint64 masks[4] = {des.rmask, des.gmask, des.bmask, des.amask};
+        for(int i = 0; i < 4; i++)
+        {
+            layout.write[i] = -1;
+            if(!bits[i])
+                continue;
+            // only whole bytes can be addressed directly. The masks must agree with the
+            // shifts, as packColour and unpackColour go by both
+            if(bits[i] != 8 || shifts[i] % 8 || masks[i] != (uint64(0xFF) << shifts[i]))
+                return false;
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+            layout.write[i] = int8(des.elemBytes - 1 - shifts[i] / 8);
+#else
+            layout.write[i] = int8(shifts[i] / 8);
+#endif
+        }
+        for(int i = 0; i < 4; i++)
+            layout.read[i] = layout.write[i];
+        if(des.flags & PFF_LUMINANCE)
+            layout.read[1] = layout.read[2] = layout.read[0];
+        return true;
+    }
+
+    const float* getUnorm8ToFloatTable()
+    {
+        struct Table
+        {
+            float values[256];
+            Table()
+            {
+                for(unsigned i = 0; i < 256; i++)
+                    values[i] = Bitwise::fixedToFloat(i, 8);
+            }
+        };
+        static const Table table;
+        return table.values;
+    }
+
+    template<PixelComponentType T> struct ChannelAccess;
+    template<> struct ChannelAccess<PCT_BYTE>
+    {
+        static float read(const uint8* src, int i, const float* unorm8) { return unorm8[src[i]]; }
+        static void write(uint8* dst, const int8* idx, const float* c)
+        {
+#if OGRE_PIXELFORMAT_SSE2
+            // same result as Bitwise::floatToFixed for all 4 channels at once
+            __m128 v = _mm_mul_ps(_mm_loadu_ps(c), _mm_set1_ps(256.0f));
+            v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+            __m128i packed = _mm_cvttps_epi32(v);
+            packed = _mm_packs_epi32(packed, packed);
+            packed = _mm_packus_epi16(packed, packed);
+            uint32 rgba = (uint32)_mm_cvtsi128_si32(packed);
+            for(int i = 0; i < 4; i++)
+                if(idx[i] >= 0)
+                    dst[idx[i]] = uint8(rgba >> (8 * i));
+#else
+            for(int i = 0; i < 4; i++)
+                if(idx[i] >= 0)
+                    dst[idx[i]] = uint8(Bitwise::floatToFixed(c[i], 8));
+#endif
+        }
+    };
+    template<> struct ChannelAccess<PCT_FLOAT16>
+    {
+        static float read(const uint8* src, int i, const float*)
+        {
+            return Bitwise::halfToFloat(reinterpret_cast<const uint16*>(src)[i]);
+        }
+        static void write(uint8* dst, const int8* idx, const float* c)
+        {
+            for(int i = 0; i < 4; i++)
+                if(idx[i] >= 0)
+                    reinterpret_cast<uint16*>(dst)[idx[i]] = Bitwise::floatToHalf(c[i]);
+        }
+    };
+    template<> struct ChannelAccess<PCT_FLOAT32>
+    {
+        static float read(const uint8* src, int i, const float*)
+        {
+            return reinterpret_cast<const float*>(src)[i];
+        }
+        static void write(uint8* dst, const int8* idx, const float* c)
+        {
+            for(int i = 0; i < 4; i++)
+                if(idx[i] >= 0)
+                    reinterpret_cast<float*>(dst)[idx[i]] = c[i];
+        }
+    };
+
+    template<PixelComponentType S, PixelComponentType D>
+    void convertChannelRow(const uint8* src, const ChannelLayout& sl, uint8* dst, const ChannelLayout& dl,
+                           size_t width)
+    {
+        const float* unorm8 = getUnorm8ToFloatTable();
+        size_t x = 0;
+#if OGRE_PIXELFORMAT_SSE2
+        // float rgba to 4 byte formats, e.g. when saving HDR renders: 4 pixels per iteration
+        if(S == PCT_FLOAT32 && D == PCT_BYTE && sl.read[3] == 3 && dl.pixelSize == 4 &&
+           dl.write[0] >= 0 && dl.write[1] >= 0 && dl.write[2] >= 0 && dl.write[3] >= 0)
+        {
+            const bool rgbaOrder = dl.write[0] == 0 && dl.write[1] == 1 && dl.write[2] == 2;
+            const __m128 scale = _mm_set1_ps(256.0f), maxVal = _mm_set1_ps(255.0f), zero = _mm_setzero_ps();
+            for(; x + 4 <= width; x += 4)
+            {
+                const float* p = reinterpret_cast<const float*>(src) + 4 * x;
+                __m128i c[4];
+                for(int i = 0; i < 4; i++)
+                {
+                    __m128 v = _mm_mul_ps(_mm_loadu_ps(p + 4 * i), scale);
+                    c[i] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(v, zero), maxVal));
+                }
+                __m128i packed = _mm_packus_epi16(_mm_packs_epi32(c[0], c[1]), _mm_packs_epi32(c[2], c[3]));
+                uint8* out = dst + 4 * x;
+                if(rgbaOrder)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+                    continue;
+                }
+                alignas(16) uint8 bytes[16];
+                _mm_store_si128(reinterpret_cast<__m128i*>(bytes), packed);
+                for(int i = 0; i < 4; i++)
+                    for(int ch = 0; ch < 4; ch++)
+                        out[4 * i + dl.write[ch]] = bytes[4 * i + ch];
+            }
+        }
+#endif
+        src += x * sl.pixelSize;
+        dst += x * dl.pixelSize;
+        for(; x < width; x++)
+        {
+            float c[4];
+            for(int i = 0; i < 4; i++)
+                c[i] = sl.read[i] < 0 ? (i == 3 ? 1.0f : 0.0f) : ChannelAccess<S>::read(src, sl.read[i], unorm8);
+            ChannelAccess<D>::write(dst, dl.write, c);
+            src += sl.pixelSize;
+            dst += dl.pixelSize;
+        }
+    }
+
+    typedef void (*ChannelRowConverter)(const uint8*, const ChannelLayout&, uint8*, const ChannelLayout&, size_t);
+
+    template<PixelComponentType S> ChannelRowConverter getChannelRowConverter(PixelComponentType dst)
+    {
+        switch(dst)
+        {
+        case PCT_BYTE:
+            return convertChannelRow<S, PCT_BYTE>;
+        case PCT_FLOAT16:
+            return convertChannelRow<S, PCT_FLOAT16>;
+        default:
+            return convertChannelRow<S, PCT_FLOAT32>;
+        }
+    }
+
+    /// converts between 8 bit unorm, half and float formats. Returns false for other formats
+    bool doChannelConversion(const PixelBox &src, const PixelBox &dst)
+    {
+        ChannelLayout sl, dl;
+        if(!getChannelLayout(src.format, sl) || !getChannelLayout(dst.format, dl))
+            return false;
+
+        ChannelRowConverter convertRow;
+        switch(sl.type)
+        {
+        case PCT_BYTE:
+            convertRow = getChannelRowConverter<PCT_BYTE>(dl.type);
+            break;
+        case PCT_FLOAT16:
+            convertRow = getChannelRowConverter<PCT_FLOAT16>(dl.type);
+            break;
+        default:
+            convertRow = getChannelRowConverter<PCT_FLOAT32>(dl.type);
+            break;
+        }
+
+        const size_t srcRowPitchBytes = src.rowPitch * sl.pixelSize;
+        const size_t srcSlicePitchBytes = src.slicePitch * sl.pixelSize;
+        const size_t dstRowPitchBytes = dst.rowPitch * dl.pixelSize;
+        const size_t dstSlicePitchBytes = dst.slicePitch * dl.pixelSize;
+        const uint8* srcslice = src.getTopLeftFrontPixelPtr();
+        uint8* dstslice = dst.getTopLeftFrontPixelPtr();
+        for(size_t z = src.front; z < src.back; z++)
+        {
+            const uint8* srcptr = srcslice;
+            uint8* dstptr = dstslice;
+            for(size_t y = src.top; y < src.bottom; y++)
+            {
+                convertRow(srcptr, sl, dstptr, dl, src.getWidth());
+                srcptr += srcRowPitchBytes;
+                dstptr += dstRowPitchBytes;
+            }
+            srcslice += srcSlicePitchBytes;
+            dstslice += dstSlicePitchBytes;
+        }
+        return true;
+    }
+
+    /// minimal number of pixels converted per task
+    const size_t CONVERSION_GRAIN_PIXELS = 1 << 16;
+    }
+    static void convertPixelBox(const PixelBox &src, const PixelBox &dst);
+    //-----------------------------------------------------------------------
     /* Convert pixels from one format to another */
     void PixelUtil::bulkPixelConversion(const PixelBox &src, const PixelBox &dst)
     {
         OgreAssert(src.getSize() == dst.getSize(), "");
 
-        // Check for compressed formats, we don't support decompression, compression or recoding
+        // Check for compressed formats, we only support software coding of some block formats
         if(PixelUtil::isCompressed(src.format) || PixelUtil::isCompressed(dst.format))
         {
+            if(!PixelUtil::isCompressed(dst.format) && BlockCompression::canDecompress(src.format))
+            {
+                BlockCompression::decompress(src, dst);
+                return;
+            }
+            if(!PixelUtil::isCompressed(src.format) && BlockCompression::canCompress(dst.format))
+            {
+                BlockCompression::compress(src, dst);
+                return;
+            }
             OgreAssert(src.format == dst.format && src.isConsecutive() && dst.isConsecutive(),
                        "This method can not be used to compress or decompress images");
             // we can copy with slice granularity, useful for Tex2DArray handling
@@ -672,6 +948,37 @@ namespace Ogre {
             return;
         }
 
+        // split large conversions into bands of rows or slices, that are converted concurrently
+        const size_t width = src.getWidth(), height = src.getHeight();
+        const size_t grainRows = std::max<size_t>(1, CONVERSION_GRAIN_PIXELS / std::max<size_t>(width, 1));
+        if(src.getDepth() == 1)
+        {
+            WorkQueue::parallelFor(height, grainRows, [&](size_t begin, size_t end) {
+                PixelBox srcBand = src, dstBand = dst;
+                srcBand.top = src.top + uint32(begin);
+                srcBand.bottom = src.top + uint32(end);
+                dstBand.top = dst.top + uint32(begin);
+                dstBand.bottom = dst.top + uint32(end);
+                convertPixelBox(srcBand, dstBand);
+            });
+        }
+        else
+        {
+            WorkQueue::parallelFor(src.getDepth(), std::max<size_t>(1, grainRows / std::max<size_t>(height, 1)),
+                                   [&](size_t begin, size_t end) {
+                PixelBox srcBand = src, dstBand = dst;
+                srcBand.front = src.front + uint32(begin);
+                srcBand.back = src.front + uint32(end);
+                dstBand.front = dst.front + uint32(begin);
+                dstBand.back = dst.front + uint32(end);
+                convertPixelBox(srcBand, dstBand);
+            });
+        }
+    }
+    //-----------------------------------------------------------------------
+    /* Convert a band of pixels on the current thread */
+    static void convertPixelBox(const PixelBox &src, const PixelBox &dst)
+    {
         // The easy case
         if(src.format == dst.format) {
             uint8 *srcptr = src.getTopLeftFrontPixelPtr();
@@ -719,18 +1026,18 @@ namespace Ogre {
             // optimized conversions
             PixelBox tempdst = dst;
             tempdst.format = dst.format==PF_X8R8G8B8?PF_A8R8G8B8:PF_A8B8G8R8;
-            bulkPixelConversion(src, tempdst);
+            convertPixelBox(src, tempdst);
             return;
         }
         // Converting from PF_X8R8G8B8 is exactly the same as converting from
         // PF_A8R8G8B8, given that the destination format does not have alpha.
-        if((src.format == PF_X8R8G8B8||src.format == PF_X8B8G8R8) && !hasAlpha(dst.format))
+        if((src.format == PF_X8R8G8B8||src.format == PF_X8B8G8R8) && !PixelUtil::hasAlpha(dst.format))
         {
             // Do the same conversion, with PF_A8R8G8B8, which has a lot of
             // optimized conversions
             PixelBox tempsrc = src;
             tempsrc.format = src.format==PF_X8R8G8B8?PF_A8R8G8B8:PF_A8B8G8R8;
-            bulkPixelConversion(tempsrc, dst);
+            convertPixelBox(tempsrc, dst);
             return;
         }
 
@@ -744,6 +1051,10 @@ namespace Ogre {
         }
 #endif
 
+        // Byte, half and float channels can be accessed directly
+        if(doChannelConversion(src, dst))
+            return;
+
         const size_t srcPixelSize = PixelUtil::getNumElemBytes(src.format);
         const size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
         uint8* srcptr = src.getTopLeftFrontPixelPtr();
@@ -766,8 +1077,8 @@ namespace Ogre {
             {
                 for(size_t x=src.left; x<src.right; x++)
                 {
-                    unpackColour(&r, &g, &b, &a, src.format, srcptr);
-                    packColour(r, g, b, a, dst.format, dstptr);
+                    PixelUtil::unpackColour(&r, &g, &b, &a, src.format, srcptr);
+                    PixelUtil::packColour(r, g, b, a, dst.format, dstptr);
                     srcptr += srcPixelSize;
                     dstptr += dstPixelSize;
                 }
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreMaterial.h"
 #include "OgreRenderQueueSortingGrouping.h"
 #include "OgreSceneManagerEnumerator.h"
+#include "OgreTextureManager.h"
 
 namespace Ogre {
 
@@ -271,6 +272,11 @@ namespace Ogre {
         if (!onlyShadowCasters || mo->getCastShadows())
         {
             mo->_updateRenderQueue(this);
+            if (!onlyShadowCasters && TextureManager::getSingletonPtr() &&
+                TextureManager::getSingleton()._hasStreamingTextures())
+            {
+                TextureManager::getSingleton()._notifyObjectVisible(mo, cam);
+            }
             if (visibleBounds)
             {
                 visibleBounds->merge(bbox, bsphere, cam, receiveShadows);
@@ -679,6 +679,10 @@ namespace Ogre {
         if (HardwareBufferManager::getSingletonPtr())
             HardwareBufferManager::getSingleton()._releaseBufferCopies();
 
+        // Stream texture levels requested this frame
+        if (TextureManager::getSingletonPtr())
+            TextureManager::getSingleton()._updateStreaming();
+
         // Tell the queue to process responses
         mWorkQueue->processMainThreadTasks();
 
@@ -31,6 +31,11 @@ THE SOFTWARE.
 #include "OgreEdgeListBuilder.h"
 #include "OgreLodStrategy.h"
 #include "OgreSubEntity.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreWorkQueue.h"
+#include "OgreStreamSerialiser.h"
+#include "OgreLodStrategyManager.h"
+#include "OgreViewport.h"
 
 namespace Ogre {
 
@@ -39,6 +44,39 @@ namespace Ogre {
     #define REGION_MAX_INDEX 511
     #define REGION_MIN_INDEX -512
 
+    static const uint32 CHUNK_ID = StreamSerialiser::makeIdentifier("SGEO");
+    static const uint16 CHUNK_VERSION = 1;
+    static const uint32 REGION_CHUNK_ID = StreamSerialiser::makeIdentifier("SGRG");
+    static const uint16 REGION_CHUNK_VERSION = 1;
+    static const uint32 REGION_DATA_CHUNK_ID = StreamSerialiser::makeIdentifier("SGRD");
+    static const uint16 REGION_DATA_CHUNK_VERSION = 1;
+
+    /// Region caches are stored in the native byte order
+    static const StreamSerialiser::Endian NATIVE_ENDIAN =
+        OGRE_ENDIAN == OGRE_ENDIAN_BIG ? StreamSerialiser::ENDIAN_BIG : StreamSerialiser::ENDIAN_LITTLE;
+
+    /// The open region cache, read by the loading tasks
+    struct StaticGeometry::RegionCache
+    {
+        DataStreamPtr stream;
+        OGRE_WQ_MUTEX(mutex);
+        /// Reset by destroy, so that loads still in flight are dropped. Main thread only
+        StaticGeometry* owner;
+    };
+
+    /// Streams regions in and out for every viewport camera
+    class StaticGeometry::StreamingListener : public SceneManager::Listener
+    {
+        StaticGeometry* mParent;
+    public:
+        StreamingListener(StaticGeometry* parent) : mParent(parent) {}
+        void preFindVisibleObjects(SceneManager* source, SceneManager::IlluminationRenderStage irs,
+                                   Viewport* v) override
+        {
+            if (irs == SceneManager::IRS_NONE)
+                mParent->updateRegionStreaming(v->getCamera());
+        }
+    };
     //--------------------------------------------------------------------------
     StaticGeometry::StaticGeometry(SceneManager* owner, const String& name):
         mOwner(owner),
@@ -52,7 +90,9 @@ namespace Ogre {
         mVisible(true),
         mRenderQueueID(RENDER_QUEUE_MAIN),
         mRenderQueueIDSet(false),
-        mVisibilityFlags(Ogre::MovableObject::getDefaultVisibilityFlags())
+        mVisibilityFlags(Ogre::MovableObject::getDefaultVisibilityFlags()),
+        mStreamingHysteresis(1.25f),
+        mListener(0)
     {
     }
     //--------------------------------------------------------------------------
@@ -152,21 +192,26 @@ namespace Ogre {
         Region* ret = getRegion(index);
         if (!ret && autoCreate)
         {
-            // Make a name
-            StringStream str;
-            str << mName << ":" << index;
-            // Calculate the region centre
-            Vector3 centre = getRegionCentre(x, y, z);
-            ret = OGRE_NEW Region(this, str.str(), mOwner, index, centre);
-            mOwner->injectMovableObject(ret);
-            ret->setVisible(mVisible);
-            ret->setCastShadows(mCastShadows);
-            if (mRenderQueueIDSet)
-            {
-                ret->setRenderQueueGroup(mRenderQueueID);
-            }
-            mRegionMap[index] = ret;
+            ret = createRegion(index, getRegionCentre(x, y, z));
+        }
+        return ret;
+    }
+    //--------------------------------------------------------------------------
+    StaticGeometry::Region* StaticGeometry::createRegion(uint32 index, const Vector3& centre)
+    {
+        // Make a name
+        StringStream str;
+        str << mName << ":" << index;
+        Region* ret = OGRE_NEW Region(this, str.str(), mOwner, index, centre);
+        mOwner->injectMovableObject(ret);
+        ret->setVisible(mVisible);
+        ret->setCastShadows(mCastShadows);
+        if (mRenderQueueIDSet)
+        {
+            ret->setRenderQueueGroup(mRenderQueueID);
         }
+        ret->setVisibilityFlags(mVisibilityFlags);
+        mRegionMap[index] = ret;
         return ret;
     }
     //--------------------------------------------------------------------------
@@ -540,6 +585,80 @@ namespace Ogre {
             ri.second->setVisibilityFlags(mVisibilityFlags);
         }
 
+        // Fill the buckets, one region at a time
+        fillGeometryBuckets();
+
+        if (stencilShadows)
+        {
+            for (auto & ri : mRegionMap)
+            {
+                for (LODBucket* lodBucket : ri.second->getLODBuckets())
+                    lodBucket->buildShadowData();
+            }
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::fillGeometryBuckets(void)
+    {
+        struct CopyTask
+        {
+            const GeometryBucket* bucket;
+            const QueuedGeometry* geom;
+            uint32 vertexStart;
+            size_t indexStart;
+        };
+        // Hardware buffers may only be locked on this thread. Only the buffers of one
+        // region and the source buffers it uses are locked at a time. The source buffers
+        // are shared by all instances of a mesh, so each is locked just once per region.
+        for (auto & ri : mRegionMap)
+        {
+            std::vector<CopyTask> tasks;
+            std::map<HardwareBuffer*, HardwareBufferLockGuard> guards;
+            BufferLockMap locks;
+            auto lockBuffer = [&](HardwareBuffer* buf, HardwareBuffer::LockOptions options)
+            {
+                HardwareBufferLockGuard& guard = guards[buf];
+                if (!guard.pData)
+                {
+                    guard.lock(buf, options);
+                    locks[buf] = guard.pData;
+                }
+            };
+
+            for (LODBucket* lodBucket : ri.second->getLODBuckets())
+            {
+                for (auto & mi : lodBucket->getMaterialBuckets())
+                {
+                    for (GeometryBucket* gb : mi.second->getGeometryList())
+                    {
+                        const VertexBufferBinding* binds = gb->getVertexData()->vertexBufferBinding;
+                        for (ushort b = 0; b < binds->getBufferCount(); ++b)
+                            lockBuffer(binds->getBuffer(b).get(), HardwareBuffer::HBL_DISCARD);
+                        lockBuffer(gb->getIndexData()->indexBuffer.get(), HardwareBuffer::HBL_DISCARD);
+
+                        CopyTask task = {gb, NULL, 0, 0};
+                        for (QueuedGeometry* geom : gb->getQueuedGeometry())
+                        {
+                            const VertexBufferBinding* srcBinds = geom->geometry->vertexData->vertexBufferBinding;
+                            for (ushort b = 0; b < srcBinds->getBufferCount(); ++b)
+                                lockBuffer(srcBinds->getBuffer(b).get(), HardwareBuffer::HBL_READ_ONLY);
+                            lockBuffer(geom->geometry->indexData->indexBuffer.get(), HardwareBuffer::HBL_READ_ONLY);
+
+                            task.geom = geom;
+                            tasks.push_back(task);
+                            task.vertexStart += geom->geometry->vertexData->vertexCount;
+                            task.indexStart += geom->geometry->indexData->indexCount;
+                        }
+                    }
+                }
+            }
+
+            // every task writes to its own range of the buffers
+            WorkQueue::parallelFor(tasks.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i)
+                    tasks[i].bucket->copyGeometry(tasks[i].geom, tasks[i].vertexStart, tasks[i].indexStart, locks);
+            });
+        }
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::destroy(void)
@@ -551,6 +670,176 @@ namespace Ogre {
             OGRE_DELETE i.second;
         }
         mRegionMap.clear();
+
+        // and close any region cache
+        if (mStreamingListener)
+        {
+            mOwner->removeListener(mStreamingListener.get());
+            mStreamingListener.reset();
+        }
+        mStreamedRegions.clear();
+        if (mRegionCache)
+        {
+            mRegionCache->owner = 0;
+            mRegionCache.reset();
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::saveRegions(const String& filename)
+    {
+        saveRegions(Root::createFileStream(filename, RGN_DEFAULT, true));
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::saveRegions(const DataStreamPtr& stream)
+    {
+        for (auto & ri : mRegionMap)
+        {
+            OgreAssert(ri.second->isLoaded(), "Regions must be built or loaded before saving");
+        }
+
+        StreamSerialiser ser(stream);
+        ser.writeChunkBegin(CHUNK_ID, CHUNK_VERSION);
+        ser.write(&mRegionDimensions);
+        ser.write(&mOrigin);
+        for (auto & ri : mRegionMap)
+        {
+            Region* region = ri.second;
+            uint32 id = region->getID();
+            ser.writeChunkBegin(REGION_CHUNK_ID, REGION_CHUNK_VERSION);
+            ser.write(&id);
+            ser.write(&region->getCentre());
+            region->save(ser);
+            ser.writeChunkEnd(REGION_CHUNK_ID);
+        }
+        ser.writeChunkEnd(CHUNK_ID);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::loadRegions(const String& filename, const String& groupName, bool streaming)
+    {
+        loadRegions(ResourceGroupManager::getSingleton().openResource(filename, groupName), streaming);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::loadRegions(const DataStreamPtr& stream, bool streaming)
+    {
+        destroy();
+
+        StreamSerialiser ser(stream);
+        ser.readChunkBegin(CHUNK_ID, CHUNK_VERSION, "StaticGeometry::loadRegions");
+        // the vertex data is stored raw
+        if (ser.getEndian() != NATIVE_ENDIAN)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Region cache '" + stream->getName() +
+                        "' was written on a platform with a different byte order",
+                        "StaticGeometry::loadRegions");
+        }
+
+        Vector3 regionDimensions;
+        ser.read(&regionDimensions);
+        setRegionDimensions(regionDimensions);
+        ser.read(&mOrigin);
+
+        while (!ser.isEndOfChunk(CHUNK_ID))
+        {
+            ser.readChunkBegin(REGION_CHUNK_ID, REGION_CHUNK_VERSION, "StaticGeometry::loadRegions");
+            uint32 id;
+            Vector3 centre;
+            ser.read(&id);
+            ser.read(&centre);
+            createRegion(id, centre)->prepare(ser);
+            // the geometry is the last sub chunk
+            StreamedRegion streamed = {stream->tell(), 0, 0, false};
+            ser.readChunkEnd(REGION_CHUNK_ID);
+            streamed.size = stream->tell() - streamed.offset;
+            mStreamedRegions[id] = streamed;
+        }
+        ser.readChunkEnd(CHUNK_ID);
+
+        if (streaming)
+        {
+            mRegionCache = std::make_shared<RegionCache>();
+            mRegionCache->stream = stream;
+            mRegionCache->owner = this;
+            mStreamingListener.reset(new StreamingListener(this));
+            mOwner->addListener(mStreamingListener.get());
+            return;
+        }
+
+        bool stencilShadows = mCastShadows && mOwner->isShadowTechniqueStencilBased();
+        for (auto & ri : mRegionMap)
+        {
+            stream->seek(mStreamedRegions[ri.first].offset);
+            ri.second->load(ser, stencilShadows);
+        }
+        mStreamedRegions.clear();
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::updateRegionStreaming(const Camera* cam)
+    {
+        if (mStreamedRegions.empty())
+            return;
+
+        const Vector3& camPos = cam->getLodCamera()->getDerivedPosition();
+        unsigned long frame = Root::getSingleton().getNextFrameNumber();
+        for (auto & si : mStreamedRegions)
+        {
+            Region* region = mRegionMap[si.first];
+            Real distance = camPos.distance(region->getCentre()) - region->getBoundingRadius();
+            if (mUpperDistance <= 0 || distance <= mUpperDistance * mStreamingHysteresis)
+                si.second.lastFrame = frame;
+
+            if (si.second.pending)
+                continue;
+
+            if (!region->isLoaded() && (mUpperDistance <= 0 || distance <= mUpperDistance))
+            {
+                si.second.pending = true;
+                loadRegionAsync(si.first, si.second);
+            }
+            else if (region->isLoaded() && si.second.lastFrame + 1 < frame)
+            {
+                if (mListener)
+                    mListener->regionUnloaded(this, region);
+                region->unload();
+            }
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::loadRegionAsync(uint32 id, const StreamedRegion& streamed)
+    {
+        std::shared_ptr<RegionCache> cache = mRegionCache;
+        size_t offset = streamed.offset, size = streamed.size;
+        WorkQueue* queue = Root::getSingleton().getWorkQueue();
+        queue->addTask([cache, id, offset, size, queue]() {
+            // read the raw bytes on the worker, the buffers must be created on the main thread
+            auto data = std::make_shared<MemoryDataStream>(size);
+            {
+                OGRE_WQ_LOCK_MUTEX(cache->mutex);
+                cache->stream->seek(offset);
+                cache->stream->read(data->getPtr(), size);
+            }
+
+            queue->addMainThreadTask([cache, id, data]() {
+                StaticGeometry* self = cache->owner;
+                if (!self)
+                    return;
+                auto si = self->mStreamedRegions.find(id);
+                if (si == self->mStreamedRegions.end() || !si->second.pending)
+                    return;
+                si->second.pending = false;
+
+                Region* region = self->mRegionMap[id];
+                StreamSerialiser ser(data, NATIVE_ENDIAN, false);
+                region->load(ser, self->mCastShadows && self->mOwner->isShadowTechniqueStencilBased());
+                if (self->mListener)
+                    self->mListener->regionLoaded(self, region);
+            });
+        });
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::setStreamingHysteresis(Real factor)
+    {
+        OgreAssert(factor >= 1, "the hysteresis must not be below 1");
+        mStreamingHysteresis = factor;
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::reset(void)
@@ -784,9 +1073,73 @@ namespace Ogre {
             // now build
             lodBucket->build(stencilShadows);
         }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::save(StreamSerialiser& stream) const
+    {
+        stream.write(&mAABB);
+        stream.write(&mBoundingRadius);
+        String lodStrategy = mLodStrategy ? mLodStrategy->getName() : BLANKSTRING;
+        stream.write(&lodStrategy);
+        uint16 numLods = static_cast<uint16>(mLodValues.size());
+        stream.write(&numLods);
+        stream.write(mLodValues.data(), numLods);
 
+        stream.writeChunkBegin(REGION_DATA_CHUNK_ID, REGION_DATA_CHUNK_VERSION);
+        for (LODBucket* lodBucket : mLodBucketList)
+        {
+            lodBucket->save(stream);
+        }
+        stream.writeChunkEnd(REGION_DATA_CHUNK_ID);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::prepare(StreamSerialiser& stream)
+    {
+        stream.read(&mAABB);
+        stream.read(&mBoundingRadius);
+        String lodStrategy;
+        stream.read(&lodStrategy);
+        mLodStrategy = LodStrategyManager::getSingleton().getStrategy(lodStrategy);
+        if (!mLodStrategy)
+            mLodStrategy = LodStrategyManager::getSingleton().getDefaultStrategy();
+        uint16 numLods;
+        stream.read(&numLods);
+        mLodValues.resize(numLods);
+        stream.read(mLodValues.data(), numLods);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::load(StreamSerialiser& stream, bool stencilShadows)
+    {
+        stream.readChunkBegin(REGION_DATA_CHUNK_ID, REGION_DATA_CHUNK_VERSION, "StaticGeometry::Region::load");
+        for (ushort lod = 0; lod < mLodValues.size(); ++lod)
+        {
+            LODBucket* lodBucket = OGRE_NEW LODBucket(this, lod, mLodValues[lod]);
+            mLodBucketList.push_back(lodBucket);
+            lodBucket->load(stream);
+            if (stencilShadows)
+                lodBucket->buildShadowData();
+        }
+        stream.readChunkEnd(REGION_DATA_CHUNK_ID);
 
-
+        SceneNode* node = mManager->getRootSceneNode()->createChildSceneNode(mCentre);
+        node->attachObject(this);
+        // the scene graph may already be updated for this frame
+        node->_update(true, false);
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::Region::unload(void)
+    {
+        if (mParentNode)
+        {
+            mManager->destroySceneNode(static_cast<SceneNode*>(mParentNode));
+            mParentNode = 0;
+        }
+        for (auto & i : mLodBucketList)
+        {
+            OGRE_DELETE i;
+        }
+        mLodBucketList.clear();
+        mCurrentLod = 0;
     }
     //--------------------------------------------------------------------------
     const String& StaticGeometry::Region::getMovableType(void) const
@@ -991,52 +1344,85 @@ namespace Ogre {
     //--------------------------------------------------------------------------
     void StaticGeometry::LODBucket::build(bool stencilShadows)
     {
-
-        EdgeListBuilder eb;
-        size_t vertexSet = 0;
-
         // Just pass this on to child buckets
         for (auto & i : mMaterialBucketMap)
         {
             MaterialBucket* mat = i.second;
 
             mat->build(stencilShadows);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::LODBucket::buildShadowData(void)
+    {
+        EdgeListBuilder eb;
+        size_t vertexSet = 0;
 
-            if (stencilShadows)
+        for (auto & i : mMaterialBucketMap)
+        {
+            // Check if we have vertex programs here
+            Technique* t = i.second->getMaterial()->getBestTechnique();
+            if (t)
             {
-                // Check if we have vertex programs here
-                Technique* t = mat->getMaterial()->getBestTechnique();
-                if (t)
+                Pass* p = t->getPass(0);
+                if (p)
                 {
-                    Pass* p = t->getPass(0);
-                    if (p)
+                    if (p->hasVertexProgram())
                     {
-                        if (p->hasVertexProgram())
-                        {
-                            mVertexProgramInUse = true;
-                        }
+                        mVertexProgramInUse = true;
                     }
                 }
+            }
 
-                for (GeometryBucket* geom : mat->getGeometryList())
-                {
-                    // Check we're dealing with 16-bit indexes here
-                    // Since stencil shadows can only deal with 16-bit
-                    // More than that and stencil is probably too CPU-heavy
-                    // in any case
-                    assert(geom->getIndexData()->indexBuffer->getType()
-                        == HardwareIndexBuffer::IT_16BIT &&
-                        "Only 16-bit indexes allowed when using stencil shadows");
-                    eb.addVertexData(geom->getVertexData());
-                    eb.addIndexData(geom->getIndexData(), vertexSet++);
-                }
-
+            for (GeometryBucket* geom : i.second->getGeometryList())
+            {
+                // Check we're dealing with 16-bit indexes here
+                // Since stencil shadows can only deal with 16-bit
+                // More than that and stencil is probably too CPU-heavy
+                // in any case
+                assert(geom->getIndexData()->indexBuffer->getType()
+                    == HardwareIndexBuffer::IT_16BIT &&
+                    "Only 16-bit indexes allowed when using stencil shadows");
+                geom->prepareForShadowVolume();
+                eb.addVertexData(geom->getVertexData());
+                eb.addIndexData(geom->getIndexData(), vertexSet++);
             }
         }
 
-        if (stencilShadows)
+        mEdgeList = eb.build();
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::LODBucket::save(StreamSerialiser& stream) const
+    {
+        uint16 numMaterials = static_cast<uint16>(mMaterialBucketMap.size());
+        stream.write(&numMaterials);
+        for (auto & i : mMaterialBucketMap)
         {
-            mEdgeList = eb.build();
+            stream.write(&i.second->getMaterial()->getName());
+            stream.write(&i.second->getMaterial()->getGroup());
+            i.second->save(stream);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::LODBucket::load(StreamSerialiser& stream)
+    {
+        uint16 numMaterials;
+        stream.read(&numMaterials);
+        for (uint16 m = 0; m < numMaterials; ++m)
+        {
+            String name, group;
+            stream.read(&name);
+            stream.read(&group);
+            MaterialPtr material = MaterialManager::getSingleton().getByName(name, group);
+            if (!material)
+            {
+                LogManager::getSingleton().logError("StaticGeometry: Can't assign material '" + name +
+                                                    "' as it was not found, using default material");
+                material = MaterialManager::getSingleton().getDefaultSettings();
+            }
+            MaterialBucket* mbucket = OGRE_NEW MaterialBucket(this, material);
+            mMaterialBucketMap[name] = mbucket;
+            mbucket->load(stream);
         }
     }
     //--------------------------------------------------------------------------
@@ -1212,6 +1598,28 @@ namespace Ogre {
         }
     }
     //--------------------------------------------------------------------------
+    void StaticGeometry::MaterialBucket::save(StreamSerialiser& stream) const
+    {
+        uint16 numBuckets = static_cast<uint16>(mGeometryBucketList.size());
+        stream.write(&numBuckets);
+        for (auto gb : mGeometryBucketList)
+        {
+            gb->save(stream);
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::MaterialBucket::load(StreamSerialiser& stream)
+    {
+        mTechnique = 0;
+        mMaterial->load();
+        uint16 numBuckets;
+        stream.read(&numBuckets);
+        for (uint16 b = 0; b < numBuckets; ++b)
+        {
+            mGeometryBucketList.push_back(OGRE_NEW GeometryBucket(this, stream));
+        }
+    }
+    //--------------------------------------------------------------------------
     void StaticGeometry::MaterialBucket::addRenderables(RenderQueue* queue,
         uint8 group, Real lodValue)
     {
@@ -1320,6 +1728,66 @@ namespace Ogre {
         }
 
 
+    }
+    //--------------------------------------------------------------------------
+    StaticGeometry::GeometryBucket::GeometryBucket(MaterialBucket* parent, StreamSerialiser& stream)
+        : Renderable(), mParent(parent)
+    {
+        mVertexData = OGRE_NEW VertexData();
+        mIndexData = OGRE_NEW IndexData();
+
+        uint32 vertexCount;
+        stream.read(&vertexCount);
+        mVertexData->vertexCount = vertexCount;
+
+        uint16 numElements;
+        stream.read(&numElements);
+        for (uint16 e = 0; e < numElements; ++e)
+        {
+            uint16 source, type, semantic, index;
+            uint32 offset;
+            stream.read(&source);
+            stream.read(&offset);
+            stream.read(&type);
+            stream.read(&semantic);
+            stream.read(&index);
+            mVertexData->vertexDeclaration->addElement(source, offset, VertexElementType(type),
+                                                       VertexElementSemantic(semantic), index);
+        }
+
+        uint16 numBuffers;
+        stream.read(&numBuffers);
+        for (uint16 b = 0; b < numBuffers; ++b)
+        {
+            uint16 bindIndex;
+            uint32 vertexSize;
+            stream.read(&bindIndex);
+            stream.read(&vertexSize);
+            HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+                vertexSize, vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+            HardwareBufferLockGuard vbufLock(vbuf, HardwareBuffer::HBL_DISCARD);
+            stream.readData(vbufLock.pData, 1, vertexSize * vertexCount);
+            mVertexData->vertexBufferBinding->setBinding(bindIndex, vbuf);
+        }
+
+        uint16 indexType;
+        uint32 indexCount;
+        stream.read(&indexType);
+        stream.read(&indexCount);
+        mIndexData->indexCount = indexCount;
+        mIndexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+            HardwareIndexBuffer::IndexType(indexType), indexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        HardwareBufferLockGuard ibufLock(mIndexData->indexBuffer, HardwareBuffer::HBL_DISCARD);
+        if (indexType == HardwareIndexBuffer::IT_32BIT)
+        {
+            stream.read(static_cast<uint32*>(ibufLock.pData), indexCount);
+            mMaxVertexIndex = 0xFFFFFFFF;
+        }
+        else
+        {
+            stream.read(static_cast<uint16*>(ibufLock.pData), indexCount);
+            mMaxVertexIndex = 0xFFFF;
+        }
     }
     //--------------------------------------------------------------------------
     StaticGeometry::GeometryBucket::~GeometryBucket()
@@ -1406,6 +1874,7 @@ namespace Ogre {
             }
         }
     }
+    //--------------------------------------------------------------------------
     void StaticGeometry::GeometryBucket::build(bool stencilShadows)
     {
         // Need to double the vertex count for the position buffer
@@ -1414,164 +1883,147 @@ namespace Ogre {
                    "Index range exceeded when using stencil shadows, consider reducing your region size or "
                    "reducing poly count");
 
-        // Ok, here's where we transfer the vertices and indexes to the shared
-        // buffers
-        // Shortcuts
-        VertexDeclaration* dcl = mVertexData->vertexDeclaration;
-        VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
-
-        // create index buffer, and lock
-        auto indexType = mIndexData->indexBuffer->getType();
+        // create the buffers, the geometry is copied into them by copyGeometry
         mIndexData->indexBuffer = HardwareBufferManager::getSingleton()
-            .createIndexBuffer(indexType, mIndexData->indexCount,
+            .createIndexBuffer(mIndexData->indexBuffer->getType(), mIndexData->indexCount,
                 HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-        HardwareBufferLockGuard dstIndexLock(mIndexData->indexBuffer, HardwareBuffer::HBL_DISCARD);
-        uint32* p32Dest = static_cast<uint32*>(dstIndexLock.pData);
-        uint16* p16Dest = static_cast<uint16*>(dstIndexLock.pData);
-        // create all vertex buffers, and lock
-        ushort b;
 
-        std::vector<uchar*> destBufferLocks;
-        std::vector<VertexDeclaration::VertexElementList> bufferElements;
-        for (b = 0; b < binds->getBufferCount(); ++b)
+        VertexDeclaration* dcl = mVertexData->vertexDeclaration;
+        VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
+        for (ushort b = 0; b < binds->getBufferCount(); ++b)
         {
-            HardwareVertexBufferSharedPtr vbuf =
-                HardwareBufferManager::getSingleton().createVertexBuffer(
-                    dcl->getVertexSize(b),
-                    mVertexData->vertexCount,
-                    HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-            binds->setBinding(b, vbuf);
-            uchar* pLock = static_cast<uchar*>(
-                vbuf->lock(HardwareBuffer::HBL_DISCARD));
-            destBufferLocks.push_back(pLock);
-            // Pre-cache vertex elements per buffer
-            bufferElements.push_back(dcl->findElementsBySource(b));
-        }
-
-
-        // Iterate over the geometry items
-        uint32 indexOffset = 0;
-        QueuedGeometryList::iterator gi, giend;
-        giend = mQueuedGeometry.end();
+            binds->setBinding(b, HardwareBufferManager::getSingleton().createVertexBuffer(
+                dcl->getVertexSize(b), mVertexData->vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY));
+        }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::GeometryBucket::copyGeometry(const QueuedGeometry* geom, uint32 vertexStart,
+                                                      size_t indexStart, const BufferLockMap& locks) const
+    {
+        // Copy indexes across with offset
+        const IndexData* srcIdxData = geom->geometry->indexData;
+        size_t indexSize = mIndexData->indexBuffer->getIndexSize();
+        const uchar* pSrcIdx = static_cast<const uchar*>(locks.at(srcIdxData->indexBuffer.get())) +
+                               srcIdxData->indexStart * indexSize;
+        uchar* pDstIdx = static_cast<uchar*>(locks.at(mIndexData->indexBuffer.get())) + indexStart * indexSize;
+        if (mIndexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT)
+        {
+            copyIndexes(reinterpret_cast<const uint32*>(pSrcIdx), reinterpret_cast<uint32*>(pDstIdx),
+                        srcIdxData->indexCount, vertexStart);
+        }
+        else
+        {
+            copyIndexes(reinterpret_cast<const uint16*>(pSrcIdx), reinterpret_cast<uint16*>(pDstIdx),
+                        srcIdxData->indexCount, vertexStart);
+        }
+
         Vector3 regionCentre = mParent->getParent()->getParent()->getCentre();
-        for (gi = mQueuedGeometry.begin(); gi != giend; ++gi)
-        {
-            QueuedGeometry* geom = *gi;
-            // Copy indexes across with offset
-            IndexData* srcIdxData = geom->geometry->indexData;
-            HardwareBufferLockGuard srcIdxLock(srcIdxData->indexBuffer,
-                                               srcIdxData->indexStart * srcIdxData->indexBuffer->getIndexSize(), 
-                                               srcIdxData->indexCount * srcIdxData->indexBuffer->getIndexSize(),
-                                               HardwareBuffer::HBL_READ_ONLY);
-            if (indexType == HardwareIndexBuffer::IT_32BIT)
-            {
-                uint32* pSrc = static_cast<uint32*>(srcIdxLock.pData);
-                copyIndexes(pSrc, p32Dest, srcIdxData->indexCount, indexOffset);
-                p32Dest += srcIdxData->indexCount;
-            }
-            else
-            {
-                // Lock source indexes
-                uint16* pSrc = static_cast<uint16*>(srcIdxLock.pData);
-                copyIndexes(pSrc, p16Dest, srcIdxData->indexCount, indexOffset);
-                p16Dest += srcIdxData->indexCount;
-            }
-            srcIdxLock.unlock();
 
-            // Now deal with vertex buffers
-            // we can rely on buffer counts / formats being the same
-            VertexData* srcVData = geom->geometry->vertexData;
-            VertexBufferBinding* srcBinds = srcVData->vertexBufferBinding;
-            for (b = 0; b < binds->getBufferCount(); ++b)
+        // Now deal with vertex buffers
+        // we can rely on buffer counts / formats being the same
+        const VertexData* srcVData = geom->geometry->vertexData;
+        const VertexBufferBinding* srcBinds = srcVData->vertexBufferBinding;
+        const VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
+        for (ushort b = 0; b < binds->getBufferCount(); ++b)
+        {
+            const HardwareVertexBufferSharedPtr& srcBuf = srcBinds->getBuffer(b);
+            size_t vertexSize = srcBuf->getVertexSize();
+            const uchar* pSrcBase = static_cast<const uchar*>(locks.at(srcBuf.get()));
+            uchar* pDstBase = static_cast<uchar*>(locks.at(binds->getBuffer(b).get())) + vertexStart * vertexSize;
+
+            // raw copy, then transform the elements which need it in place
+            memcpy(pDstBase, pSrcBase, srcVData->vertexCount * vertexSize);
+
+            for (const VertexElement& elem : mVertexData->vertexDeclaration->getElements())
             {
-                // lock source
-                HardwareVertexBufferSharedPtr srcBuf = srcBinds->getBuffer(b);
-                HardwareBufferLockGuard srcBufLock(srcBuf, HardwareBuffer::HBL_READ_ONLY);
-                uchar* pSrcBase = static_cast<uchar*>(srcBufLock.pData);
-                // Get buffer lock pointer, we'll update this later
-                uchar* pDstBase = destBufferLocks[b];
-                size_t bufInc = srcBuf->getVertexSize();
-
-                // Iterate over vertices
-                float *pSrcReal, *pDstReal;
-                Vector3 tmp;
+                if (elem.getSource() != b)
+                    continue;
+
+                VertexElementSemantic sem = elem.getSemantic();
+                if (sem != VES_POSITION && sem != VES_NORMAL && sem != VES_TANGENT && sem != VES_BINORMAL)
+                    continue;
+
+                float *pSrc, *pDst;
+                elem.baseVertexPointerToElement(const_cast<uchar*>(pSrcBase), &pSrc);
+                elem.baseVertexPointerToElement(pDstBase, &pDst);
                 for (size_t v = 0; v < srcVData->vertexCount; ++v)
                 {
-                    // Iterate over vertex elements
-                    VertexDeclaration::VertexElementList& elems =
-                        bufferElements[b];
-                    VertexDeclaration::VertexElementList::iterator ei;
-                    for (ei = elems.begin(); ei != elems.end(); ++ei)
+                    Vector3 tmp(pSrc[0], pSrc[1], pSrc[2]);
+                    if (sem == VES_POSITION)
                     {
-                        VertexElement& elem = *ei;
-                        elem.baseVertexPointerToElement(pSrcBase, &pSrcReal);
-                        elem.baseVertexPointerToElement(pDstBase, &pDstReal);
-                        switch (elem.getSemantic())
-                        {
-                        case VES_POSITION:
-                            tmp.x = *pSrcReal++;
-                            tmp.y = *pSrcReal++;
-                            tmp.z = *pSrcReal++;
-                            // transform
-                            tmp = (geom->orientation * (tmp * geom->scale)) +
-                                geom->position;
-                            // Adjust for region centre
-                            tmp -= regionCentre;
-                            *pDstReal++ = tmp.x;
-                            *pDstReal++ = tmp.y;
-                            *pDstReal++ = tmp.z;
-                            break;
-                        case VES_NORMAL:
-                        case VES_TANGENT:
-                        case VES_BINORMAL:
-                            tmp.x = *pSrcReal++;
-                            tmp.y = *pSrcReal++;
-                            tmp.z = *pSrcReal++;
-                            // scale (invert)
-                            tmp = tmp / geom->scale;
-                            tmp.normalise();
-                            // rotation
-                            tmp = geom->orientation * tmp;
-                            *pDstReal++ = tmp.x;
-                            *pDstReal++ = tmp.y;
-                            *pDstReal++ = tmp.z;
-                            // copy parity for tangent.
-                            if (elem.getType() == Ogre::VET_FLOAT4)
-                                *pDstReal = *pSrcReal;
-                            break;
-                        default:
-                            // just raw copy
-                            memcpy(pDstReal, pSrcReal,
-                                    VertexElement::getTypeSize(elem.getType()));
-                            break;
-                        };
-
+                        // transform and adjust for region centre
+                        tmp = (geom->orientation * (tmp * geom->scale)) + geom->position;
+                        tmp -= regionCentre;
                     }
-
-                    // Increment both pointers
-                    pDstBase += bufInc;
-                    pSrcBase += bufInc;
-
+                    else
+                    {
+                        // scale (invert), then rotate. The parity of 4 component tangents is already copied
+                        tmp = tmp / geom->scale;
+                        tmp.normalise();
+                        tmp = geom->orientation * tmp;
+                    }
+                    pDst[0] = tmp.x;
+                    pDst[1] = tmp.y;
+                    pDst[2] = tmp.z;
+                    advanceRawPointer(pSrc, vertexSize);
+                    advanceRawPointer(pDst, vertexSize);
                 }
-
-                // Update pointer
-                destBufferLocks[b] = pDstBase;
             }
-
-            indexOffset += geom->geometry->vertexData->vertexCount;
         }
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::GeometryBucket::prepareForShadowVolume(void)
+    {
+        mVertexData->prepareForShadowVolume();
+    }
+    //--------------------------------------------------------------------------
+    void StaticGeometry::GeometryBucket::save(StreamSerialiser& stream) const
+    {
+        uint32 vertexCount = static_cast<uint32>(mVertexData->vertexCount);
+        stream.write(&vertexCount);
 
-        // Unlock everything
-        dstIndexLock.unlock();
-        for (b = 0; b < binds->getBufferCount(); ++b)
+        const VertexDeclaration::VertexElementList& elems = mVertexData->vertexDeclaration->getElements();
+        uint16 numElements = static_cast<uint16>(elems.size());
+        stream.write(&numElements);
+        for (const VertexElement& elem : elems)
         {
-            binds->getBuffer(b)->unlock();
+            uint16 source = elem.getSource();
+            uint32 offset = static_cast<uint32>(elem.getOffset());
+            uint16 type = elem.getType();
+            uint16 semantic = elem.getSemantic();
+            uint16 index = elem.getIndex();
+            stream.write(&source);
+            stream.write(&offset);
+            stream.write(&type);
+            stream.write(&semantic);
+            stream.write(&index);
         }
 
-        if (stencilShadows)
+        // a position buffer prepared for shadow volumes holds the vertices twice, keep the first half
+        const VertexBufferBinding::VertexBufferBindingMap& bindings =
+            mVertexData->vertexBufferBinding->getBindings();
+        uint16 numBuffers = static_cast<uint16>(bindings.size());
+        stream.write(&numBuffers);
+        for (const auto& b : bindings)
         {
-            mVertexData->prepareForShadowVolume();
+            uint16 bindIndex = b.first;
+            uint32 vertexSize = static_cast<uint32>(b.second->getVertexSize());
+            stream.write(&bindIndex);
+            stream.write(&vertexSize);
+            HardwareBufferLockGuard vbufLock(b.second, 0, vertexSize * vertexCount, HardwareBuffer::HBL_READ_ONLY);
+            stream.writeData(vbufLock.pData, 1, vertexSize * vertexCount);
         }
+
+        const HardwareIndexBufferSharedPtr& ibuf = mIndexData->indexBuffer;
+        uint16 indexType = ibuf->getType();
+        uint32 indexCount = static_cast<uint32>(mIndexData->indexCount);
+        stream.write(&indexType);
+        stream.write(&indexCount);
+        HardwareBufferLockGuard ibufLock(ibuf, HardwareBuffer::HBL_READ_ONLY);
+        if (indexType == HardwareIndexBuffer::IT_32BIT)
+            stream.write(static_cast<const uint32*>(ibufLock.pData), indexCount);
+        else
+            stream.write(static_cast<const uint16*>(ibufLock.pData), indexCount);
     }
     //--------------------------------------------------------------------------
     std::ostream& operator<<(std::ostream& o, const StaticGeometry::GeometryBucket& b)
@@ -45,6 +45,7 @@ namespace Ogre {
         mHardwarePoseCount = 0;
         mIndexStart = 0;
         mIndexEnd = 0;
+        mClusterCulled = false;
         setMaterial(MaterialManager::getSingleton().getDefaultMaterial());
     }
     SubEntity::~SubEntity() = default; // ensure unique_ptr destructors are in cpp
@@ -98,6 +99,9 @@ namespace Ogre {
         // Deal with any vertex data overrides
         op.vertexData = getVertexDataForBinding();
 
+        if (mClusterCulled)
+            op.indexData = mClusterIndexData.get();
+
         // If we use custom index position the client is responsible to set meaningful values 
         if(mIndexStart != mIndexEnd)
         {
@@ -106,6 +110,84 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void SubEntity::updateClusterCulling(const Camera* cam)
+    {
+        const SubMesh::MeshletList& meshlets = mSubMesh->meshlets;
+        mClusterCulled = false;
+        if (!cam || meshlets.empty() || mIndexStart != mIndexEnd || !mVisible)
+            return;
+
+        const Affine3& xform = mParentEntity->_getParentNodeFullTransform();
+        const Vector3& scale = mParentEntity->getParentNode()->_getDerivedScale();
+        Real maxScale = std::max(std::max(Math::Abs(scale.x), Math::Abs(scale.y)), Math::Abs(scale.z));
+
+        // the normal cones are only preserved by uniform scaling and the default winding
+        Real tolerance = scale.x * Real(1e-3);
+        bool cullBackFacing = !cam->isReflected() && scale.x > 0 && Math::RealEqual(scale.x, scale.y, tolerance) &&
+                              Math::RealEqual(scale.x, scale.z, tolerance);
+        if (Technique* tech = cullBackFacing ? getTechnique() : NULL)
+        {
+            for (const Pass* pass : tech->getPasses())
+                cullBackFacing &= pass->getCullingMode() == CULL_CLOCKWISE;
+        }
+
+        // the view direction for orthographic cameras, else the camera position, in object space
+        Affine3 toObject = xform.inverse();
+        bool ortho = cam->getProjectionType() == PT_ORTHOGRAPHIC;
+        Vector3 view = ortho ? (toObject.linear() * cam->getDerivedDirection()).normalisedCopy()
+                             : toObject * cam->getDerivedPosition();
+
+        std::vector<bool> visible(meshlets.size());
+        for (size_t i = 0; i < meshlets.size(); ++i)
+        {
+            const SubMesh::Meshlet& m = meshlets[i];
+            bool vis = cam->isVisible(Sphere(xform * m.center, m.radius * maxScale));
+            if (vis && cullBackFacing && m.coneCutoff < 1)
+            {
+                Vector3 dir = ortho ? view : (m.coneApex - view).normalisedCopy();
+                vis = dir.dotProduct(m.coneAxis) < m.coneCutoff;
+            }
+            visible[i] = vis;
+        }
+
+        // everything is visible, so the SubMesh index data is rendered as is
+        if (std::find(visible.begin(), visible.end(), false) == visible.end())
+            return;
+
+        mClusterCulled = true;
+        if (mClusterIndexData && visible == mVisibleClusters)
+            return;
+
+        const IndexData* src = mSubMesh->indexData;
+        if (!mClusterIndexData)
+        {
+            mClusterIndexData.reset(OGRE_NEW IndexData());
+            mClusterIndexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+                src->indexBuffer->getType(), src->indexCount, HBU_GPU_ONLY);
+        }
+
+        // copy consecutive visible meshlets at once, on the GPU if possible
+        HardwareIndexBuffer& dst = *mClusterIndexData->indexBuffer;
+        size_t indexSize = dst.getIndexSize();
+        size_t count = 0;
+        for (size_t i = 0; i < meshlets.size();)
+        {
+            if (!visible[i])
+            {
+                ++i;
+                continue;
+            }
+            size_t start = meshlets[i].indexStart, runCount = 0;
+            for (; i < meshlets.size() && visible[i] && meshlets[i].indexStart == start + runCount; ++i)
+                runCount += meshlets[i].indexCount;
+            dst.copyData(*src->indexBuffer, start * indexSize, count * indexSize, runCount * indexSize, count == 0);
+            count += runCount;
+        }
+        mClusterIndexData->indexStart = 0;
+        mClusterIndexData->indexCount = count;
+        mVisibleClusters.swap(visible);
+    }
+    //-----------------------------------------------------------------------
     void SubEntity::setIndexDataStartIndex(size_t start_index)
     {
         if(start_index < mSubMesh->indexData->indexCount)
@@ -370,6 +370,7 @@ namespace Ogre {
         newSub->operationType = this->operationType;
         newSub->useSharedVertices = this->useSharedVertices;
         newSub->extremityPoints = this->extremityPoints;
+        newSub->meshlets = this->meshlets;
 
         if (!this->useSharedVertices)
         {
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "OgreHardwarePixelBuffer.h"
 #include "OgreImage.h"
 #include "OgreTexture.h"
+#include "OgreWorkQueue.h"
 
 namespace Ogre {
     static const char* CUBEMAP_SUFFIXES[] = {"_rt", "_lf", "_up", "_dn", "_fr", "_bk"};
@@ -59,7 +60,14 @@ namespace Ogre {
             mTextureType(TEX_TYPE_2D),
             mDesiredIntegerBitDepth(0),
             mDesiredFloatBitDepth(0),
-            mDesiredFormat(PF_UNKNOWN)
+            mDesiredFormat(PF_UNKNOWN),
+            mStreaming(false),
+            mStreamingPending(false),
+            mResidentMip(0),
+            mRequestedMip(std::numeric_limits<uint32>::max()),
+            mLastRequestFrame(0),
+            mStreamingGeneration(0),
+            mStreamingTailMip(0)
     {
         if (createParamDictionary("Texture"))
         {
@@ -193,6 +201,37 @@ namespace Ogre {
             mFormat = PixelUtil::getFormatForBitDepths(mSrcFormat, mDesiredIntegerBitDepth, mDesiredFloatBitDepth);
         }
 
+        // only textures loaded from a file can be streamed, as the higher levels are read again
+        if (mStreaming && !mIsManual && mLayerNames.empty() && images.size() == 1 &&
+            mTextureType == TEX_TYPE_2D && mGamma == 1.0f && mNumRequestedMipmaps > 0)
+        {
+            // streaming needs the mipmaps on the CPU
+            Image generated;
+            const Image* src = images[0];
+            if (src->getNumMipmaps() == 0 && !PixelUtil::isCompressed(src->getFormat()))
+            {
+                generated = *src;
+                generated.generateMipmaps();
+                src = &generated;
+            }
+
+            if (src->getNumMipmaps() > 0)
+            {
+                uint32 lastMip = std::min(src->getNumMipmaps(), mNumRequestedMipmaps);
+                uint32 baseSize = TextureManager::getSingleton().getStreamingBaseSize();
+                mStreamingTailMip = 0;
+                while (mStreamingTailMip < lastMip &&
+                       std::max(mSrcWidth >> mStreamingTailMip, mSrcHeight >> mStreamingTailMip) > baseSize)
+                    mStreamingTailMip++;
+
+                extractMips(*src, mStreamingTailMip, lastMip, mStreamingTail);
+                mUsage &= ~TU_AUTOMIPMAP;
+                createResidentMips(NULL, mStreamingTailMip);
+                TextureManager::getSingleton()._notifyStreamingTexture(this, true);
+                return;
+            }
+        }
+
         // The custom mipmaps in the image clamp the request
         uint32 imageMips = images[0]->getNumMipmaps();
 
@@ -359,8 +398,164 @@ namespace Ogre {
     //-----------------------------------------------------------------------------
     void Texture::unloadImpl(void)
     {
+        if (mStreaming)
+        {
+            if (TextureManager::getSingletonPtr())
+                TextureManager::getSingleton()._notifyStreamingTexture(this, false);
+            // results of pending loads are discarded
+            mStreamingGeneration++;
+            mStreamingTail.freeMemory();
+            mResidentMip = 0;
+
+            // back to the full size. Resource::unload subtracts mSize afterwards, so report it here already
+            if (mCreator && mLoadingState.load() == LOADSTATE_UNLOADING)
+                mCreator->_notifyResourceUnloaded(this);
+            mSize = 0;
+            mWidth = mSrcWidth;
+            mHeight = mSrcHeight;
+        }
         freeInternalResources();
     }
+    //-----------------------------------------------------------------------------
+    void Texture::extractMips(const Image& img, uint32 first, uint32 last, Image& levels)
+    {
+        PixelBox top = img.getPixelBox(0, first);
+        levels.create(img.getFormat(), top.getWidth(), top.getHeight(), 1, 1, last - first);
+        for (uint32 mip = first; mip <= last; mip++)
+            PixelUtil::bulkPixelConversion(img.getPixelBox(0, mip), levels.getPixelBox(0, mip - first));
+    }
+    //-----------------------------------------------------------------------------
+    void Texture::createResidentMips(const Image* levels, uint32 mip)
+    {
+        // recreate the hardware texture at the new size, without changing the loading state
+        if (mInternalResourcesCreated)
+        {
+            mSurfaceList.clear();
+            freeInternalResourcesImpl();
+            mInternalResourcesCreated = false;
+        }
+
+        mWidth = std::max(mSrcWidth >> mip, 1u);
+        mHeight = std::max(mSrcHeight >> mip, 1u);
+        mNumMipmaps = mStreamingTailMip + mStreamingTail.getNumMipmaps() - mip;
+        // some render systems size the texture by the source dimensions
+        uint32 srcWidth = mSrcWidth, srcHeight = mSrcHeight;
+        mSrcWidth = mWidth;
+        mSrcHeight = mHeight;
+        createInternalResourcesImpl();
+        mInternalResourcesCreated = true;
+        mSrcWidth = srcWidth;
+        mSrcHeight = srcHeight;
+
+        // the streamed levels, then the tail
+        for (uint32 level = 0; level <= mNumMipmaps; level++)
+        {
+            PixelBox src = mip + level < mStreamingTailMip ? levels->getPixelBox(0, level)
+                                                           : mStreamingTail.getPixelBox(0, mip + level - mStreamingTailMip);
+            auto buffer = getBuffer(0, level);
+            buffer->blitFromMemory(src, Box(0, 0, 0, buffer->getWidth(), buffer->getHeight(), buffer->getDepth()));
+        }
+
+        mResidentMip = mip;
+
+        // the manager accounts the size of loaded resources, so report the change
+        bool accounted = mCreator && isLoaded();
+        if (accounted)
+            mCreator->_notifyResourceUnloaded(this);
+        mSize = calculateSize();
+        if (accounted)
+            mCreator->_notifyResourceLoaded(this);
+    }
+    //-----------------------------------------------------------------------------
+    void Texture::_requestMip(uint32 mip)
+    {
+        mRequestedMip = std::min(mRequestedMip, mip);
+        mLastRequestFrame = Root::getSingleton().getNextFrameNumber();
+    }
+    //-----------------------------------------------------------------------------
+    void Texture::_resetMipRequest()
+    {
+        mRequestedMip = std::numeric_limits<uint32>::max();
+    }
+    //-----------------------------------------------------------------------------
+    size_t Texture::_getStreamingSize(uint32 mip) const
+    {
+        uint32 lastMip = mStreamingTailMip + mStreamingTail.getNumMipmaps();
+        return Image::calculateSize(lastMip - mip, getNumFaces(), std::max(mSrcWidth >> mip, 1u),
+                                    std::max(mSrcHeight >> mip, 1u), 1, mFormat) +
+               mStreamingTail.getSize();
+    }
+    //-----------------------------------------------------------------------------
+    void Texture::_evictMips()
+    {
+        if (mResidentMip >= mStreamingTailMip)
+            return;
+        mStreamingGeneration++;
+        createResidentMips(NULL, mStreamingTailMip);
+    }
+    //-----------------------------------------------------------------------------
+    void Texture::_streamIn(uint32 mip)
+    {
+        OgreAssert(mStreaming && isLoaded(), "texture is not streamed");
+
+        // keep the texture alive, while the task is in flight
+        TexturePtr self = static_pointer_cast<Texture>(getCreator()->getByHandle(getHandle()));
+        if (!self)
+            return;
+        mStreamingPending = true;
+
+        // the worker must not touch members the main thread modifies
+        uint32 generation = mStreamingGeneration;
+        uint32 tailMip = mStreamingTailMip;
+        uint32 srcWidth = mSrcWidth, srcHeight = mSrcHeight;
+
+        WorkQueue* queue = Root::getSingleton().getWorkQueue();
+        queue->addTask([self, mip, tailMip, generation, srcWidth, srcHeight, queue]() {
+            // only the levels from mip up to the tail, the rest of the image is released right away
+            auto levels = std::make_shared<Image>();
+            try
+            {
+                // decode the full image again. Codecs can not decode individual levels
+                String baseName, ext;
+                StringUtil::splitBaseFilename(self->getName(), baseName, ext);
+                LoadedImages imgs;
+                self->readImage(imgs, self->getName(), ext, true);
+
+                Image& img = imgs[0];
+                uint32 first = mip;
+                if (img.getWidth() != srcWidth || img.getHeight() != srcHeight || img.getNumMipmaps() < tailMip)
+                {
+                    // reduce to the requested level first, so no larger levels are generated
+                    img.resize(std::max(srcWidth >> mip, 1u), std::max(srcHeight >> mip, 1u), Image::FILTER_BOX);
+                    img.generateMipmaps();
+                    first = 0;
+                }
+                extractMips(img, first, first + tailMip - mip - 1, *levels);
+            }
+            catch (const Exception& e)
+            {
+                LogManager::getSingleton().logError("Texture '" + self->getName() +
+                                                    "': failed to stream mipmaps. " + e.getDescription());
+                levels.reset();
+            }
+
+            queue->addMainThreadTask([self, levels, mip, generation]() {
+                self->mStreamingPending = false;
+                if (!levels)
+                {
+                    // do not try again every frame
+                    TextureManager::getSingleton()._notifyStreamingTexture(self.get(), false);
+                    return;
+                }
+                // the texture may have been evicted or unloaded meanwhile
+                if (generation != self->mStreamingGeneration || !self->isLoaded() ||
+                    mip >= self->mResidentMip)
+                    return;
+                // levels are released with this task
+                self->createResidentMips(levels.get(), mip);
+            });
+        });
+    }
     //-----------------------------------------------------------------------------   
     void Texture::copyToTexture( TexturePtr& target )
     {
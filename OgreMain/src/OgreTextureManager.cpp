@@ -27,6 +27,7 @@ THE SOFTWARE.
 */
 #include "OgreStableHeaders.h"
 #include "OgrePixelFormat.h"
+#include "OgreViewport.h"
 
 namespace Ogre {
     //-----------------------------------------------------------------------
@@ -44,6 +45,8 @@ namespace Ogre {
          : mPreferredIntegerBitDepth(0)
          , mPreferredFloatBitDepth(0)
          , mDefaultNumMipmaps(MIP_UNLIMITED)
+         , mStreamingBudget(std::numeric_limits<size_t>::max())
+         , mStreamingBaseSize(64)
     {
         mResourceType = "Texture";
         mLoadOrder = 75.0f;
@@ -307,6 +310,153 @@ namespace Ogre {
         mDefaultNumMipmaps = num;
     }
     //-----------------------------------------------------------------------
+    size_t TextureManager::getStreamingMemoryUsage() const
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        size_t usage = 0;
+        for (const auto& entry : mStreamingTextures)
+        {
+            if (auto tex = entry.second.lock())
+                usage += tex->_getStreamingSize(tex->getResidentMip());
+        }
+        return usage;
+    }
+    //-----------------------------------------------------------------------
+    std::vector<TexturePtr> TextureManager::getStreamingTextures()
+    {
+        std::vector<TexturePtr> ret;
+        ret.reserve(mStreamingTextures.size());
+        auto it = mStreamingTextures.begin();
+        while (it != mStreamingTextures.end())
+        {
+            if (auto tex = it->second.lock())
+            {
+                ret.push_back(tex);
+                ++it;
+            }
+            else
+                it = mStreamingTextures.erase(it);
+        }
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    void TextureManager::_notifyStreamingTexture(Texture* tex, bool loaded)
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        auto it = std::find_if(mStreamingTextures.begin(), mStreamingTextures.end(),
+                               [tex](const std::pair<Texture*, std::weak_ptr<Texture>>& e) { return e.first == tex; });
+        if (loaded && it == mStreamingTextures.end())
+        {
+            // only managed textures can be tracked safely
+            auto ptr = static_pointer_cast<Texture>(getByHandle(tex->getHandle()));
+            if (ptr.get() == tex)
+                mStreamingTextures.emplace_back(tex, ptr);
+        }
+        else if (!loaded && it != mStreamingTextures.end())
+            mStreamingTextures.erase(it);
+    }
+    //-----------------------------------------------------------------------
+    void TextureManager::_notifyObjectVisible(MovableObject* mo, const Camera* cam)
+    {
+        Viewport* vp = cam->getViewport();
+        if (!vp)
+            return;
+
+        // projected diameter of the bounding sphere in pixels
+        const Sphere& bounds = mo->getWorldBoundingSphere();
+        float pixels;
+        if (cam->getProjectionType() == PT_PERSPECTIVE)
+        {
+            Real distance = cam->getDerivedPosition().distance(bounds.getCenter());
+            if (distance <= bounds.getRadius())
+                pixels = std::numeric_limits<float>::max();
+            else
+                pixels = bounds.getRadius() / (distance * Math::Tan(cam->getFOVy() * 0.5f)) * vp->getActualHeight();
+        }
+        else
+            pixels = 2 * bounds.getRadius() / cam->getOrthoWindowHeight() * vp->getActualHeight();
+
+        struct TextureRequestVisitor : public Renderable::Visitor
+        {
+            float pixels;
+            void visit(Renderable* rend, ushort, bool, Any*) override
+            {
+                Technique* tech = rend->getTechnique();
+                if (!tech)
+                    return;
+                for (auto *pass : tech->getPasses())
+                {
+                    for (auto *tus : pass->getTextureUnitStates())
+                    {
+                        for (unsigned int frame = 0; frame < tus->getNumFrames(); frame++)
+                        {
+                            const TexturePtr& tex = tus->_getTexturePtr(frame);
+                            if (!tex || !tex->isStreaming())
+                                continue;
+                            // assume the texture is mapped once across the object
+                            float texels = float(std::max(tex->getSrcWidth(), tex->getSrcHeight()));
+                            float ratio = texels / std::max(pixels, 1.0f);
+                            tex->_requestMip(ratio > 1 ? uint32(Math::Log2(ratio)) : 0);
+                        }
+                    }
+                }
+            }
+        } visitor;
+        visitor.pixels = pixels;
+        mo->visitRenderables(&visitor);
+    }
+    //-----------------------------------------------------------------------
+    void TextureManager::_updateStreaming()
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        if (mStreamingTextures.empty())
+            return;
+
+        const unsigned long frame = Root::getSingleton().getNextFrameNumber();
+        size_t usage = getStreamingMemoryUsage();
+
+        // keep the textures alive while updating. Released ones untrack themselves on unload
+        std::vector<TexturePtr> textures = getStreamingTextures();
+
+        if (usage > mStreamingBudget)
+        {
+            // drop the streamed levels of textures not visible in the last frame, least recently used first
+            std::vector<TexturePtr> lru = textures;
+            std::sort(lru.begin(), lru.end(), [](const TexturePtr& a, const TexturePtr& b) {
+                return a->_getLastRequestFrame() < b->_getLastRequestFrame();
+            });
+            for (auto& tex : lru)
+            {
+                if (usage <= mStreamingBudget || tex->_getLastRequestFrame() + 1 >= frame)
+                    break;
+                // textures with a load in flight are evicted, once it completed
+                if (tex->_isStreamingPending() || tex->getResidentMip() >= tex->_getStreamingTailMip())
+                    continue;
+                usage -= tex->_getStreamingSize(tex->getResidentMip());
+                tex->_evictMips();
+                usage += tex->_getStreamingSize(tex->getResidentMip());
+            }
+        }
+
+        for (auto& tex : textures)
+        {
+            uint32 mip = tex->_getRequestedMip();
+            tex->_resetMipRequest();
+            if (tex->_isStreamingPending() || mip >= tex->getResidentMip())
+                continue;
+
+            // only stream in what fits, possibly a smaller level. Usage grows once the levels are uploaded
+            size_t resident = tex->_getStreamingSize(tex->getResidentMip());
+            while (mip < tex->getResidentMip() && usage + tex->_getStreamingSize(mip) - resident > mStreamingBudget)
+                mip++;
+            if (mip >= tex->getResidentMip())
+                continue;
+            size_t growth = tex->_getStreamingSize(mip) - resident;
+            usage += growth;
+            tex->_streamIn(mip);
+        }
+    }
+    //-----------------------------------------------------------------------
     bool TextureManager::isFormatSupported(TextureType ttype, PixelFormat format, int usage)
     {
         return getNativeFormat(ttype, format, usage) == format;
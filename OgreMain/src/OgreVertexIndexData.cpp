@@ -69,6 +69,39 @@ namespace Ogre {
             pFloat[3] = pPacked->w;
     }
 
+    static void pack_ushort2_norm(uint8* pDst, uint8* pSrc, int elemOffset)
+    {
+        float* pFloat = (float*)(pSrc + elemOffset);
+        uint16 packed[2] = {uint16(Math::saturate(pFloat[0]) * 65535 + 0.5f),
+                            uint16(Math::saturate(pFloat[1]) * 65535 + 0.5f)};
+        memcpy(pDst + elemOffset, packed, sizeof(packed));
+    }
+
+    static void unpack_ushort2_norm(uint8* pDst, uint8* pSrc, int elemOffset)
+    {
+        uint16* pPacked = (uint16*)(pSrc + elemOffset);
+        float* pFloat = (float*)(pDst + elemOffset);
+
+        pFloat[0] = pPacked[0] / 65535.0f;
+        pFloat[1] = pPacked[1] / 65535.0f;
+    }
+
+    static bool inUnitRange(const VertexElement* elem, const HardwareVertexBufferPtr& vbuf)
+    {
+        HardwareBufferLockGuard lock(vbuf, HardwareBuffer::HBL_READ_ONLY);
+        auto pSrc = static_cast<uint8*>(lock.pData) + elem->getOffset();
+        for (size_t v = 0; v < vbuf->getNumVertices(); ++v, pSrc += vbuf->getVertexSize())
+        {
+            float* pFloat = (float*)pSrc;
+            for (int i = 0; i < VertexElement::getTypeCount(elem->getType()); ++i)
+            {
+                if (pFloat[i] < 0 || pFloat[i] > 1)
+                    return false;
+            }
+        }
+        return true;
+    }
+
     static void copy_float3(uint8* pDst, uint8* pSrc, int elemOffset)
     {
         memcpy(pDst, pSrc + elemOffset, sizeof(float) * 3);
@@ -131,7 +164,7 @@ namespace Ogre {
             if (&e == elem)
             {
                 // Modify element
-                decl->modifyElement(idx, newSource, newElemOffset, newType, elem->getSemantic());
+                decl->modifyElement(idx, newSource, newElemOffset, newType, elem->getSemantic(), elem->getIndex());
             }
             else if (e.getSource() == oldSource && e.getOffset() > oldElemOffset)
             {
@@ -243,52 +276,74 @@ namespace Ogre {
 
     void VertexData::convertVertexElement(VertexElementSemantic semantic, VertexElementType dstType)
     {
-        auto elem = vertexDeclaration->findElementBySemantic(semantic);
+        // convert every set of the semantic, e.g. all texture coordinates
+        std::vector<unsigned short> indices;
+        for (const auto& e : vertexDeclaration->getElements())
+            if (e.getSemantic() == semantic)
+                indices.push_back(e.getIndex());
 
-        if (!elem || VertexElement::getBaseType(elem->getType()) == VertexElement::getBaseType(dstType))
-            return; // nothing to do
+        for (auto index : indices)
+        {
+            auto elem = vertexDeclaration->findElementBySemantic(semantic, index);
 
-        auto srcType = elem->getType();
-        auto vbuf = vertexBufferBinding->getBuffer(elem->getSource());
+            if (VertexElement::getBaseType(elem->getType()) == VertexElement::getBaseType(dstType))
+                continue; // nothing to do
 
-        size_t newElemSize = VertexElement::getTypeSize(dstType);
-        size_t newVertexSize = vbuf->getVertexSize() - elem->getSize() + newElemSize;
-        auto newVBuf = vbuf->getManager()->createVertexBuffer(newVertexSize, vbuf->getNumVertices(), vbuf->getUsage(),
-                                                              vbuf->hasShadowBuffer());
+            auto srcType = elem->getType();
+            auto vbuf = vertexBufferBinding->getBuffer(elem->getSource());
 
-        {
-            HardwareBufferLockGuard dst(newVBuf, HardwareBuffer::HBL_DISCARD);
-            auto pDst = static_cast<uint8*>(dst.pData);
+            // only 2 component coordinates within 0..1 can be represented
+            if (dstType == VET_USHORT2_NORM && (srcType != VET_FLOAT2 || !inUnitRange(elem, vbuf)))
+                continue;
+
+            size_t newElemSize = VertexElement::getTypeSize(dstType);
+            size_t newVertexSize = vbuf->getVertexSize() - elem->getSize() + newElemSize;
+            auto newVBuf = vbuf->getManager()->createVertexBuffer(newVertexSize, vbuf->getNumVertices(),
+                                                                  vbuf->getUsage(), vbuf->hasShadowBuffer());
 
-            if(dstType == VET_INT_10_10_10_2_NORM)
             {
-                if(srcType == VET_FLOAT3)
-                    spliceElement(elem, vbuf, pDst, pDst, newElemSize, pack_10_10_10_2<false>);
+                HardwareBufferLockGuard dst(newVBuf, HardwareBuffer::HBL_DISCARD);
+                auto pDst = static_cast<uint8*>(dst.pData);
+
+                if(dstType == VET_INT_10_10_10_2_NORM)
+                {
+                    if(srcType == VET_FLOAT3)
+                        spliceElement(elem, vbuf, pDst, pDst, newElemSize, pack_10_10_10_2<false>);
+                    else
+                    {
+                        OgreAssert(srcType == VET_FLOAT4, "unsupported conversion");
+                        spliceElement(elem, vbuf, pDst, pDst, newElemSize, pack_10_10_10_2<true>);
+                    }
+                }
+                else if(dstType == VET_USHORT2_NORM)
+                {
+                    spliceElement(elem, vbuf, pDst, pDst, newElemSize, pack_ushort2_norm);
+                }
+                else if(dstType == VET_FLOAT2)
+                {
+                    OgreAssert(srcType == VET_USHORT2_NORM, "unsupported conversion");
+                    spliceElement(elem, vbuf, pDst, pDst, newElemSize, unpack_ushort2_norm);
+                }
+                else if(dstType == VET_FLOAT3)
+                {
+                    OgreAssert(srcType == VET_INT_10_10_10_2_NORM, "unsupported conversion");
+                    spliceElement(elem, vbuf, pDst, pDst, newElemSize, unpack_10_10_10_2<false>);
+                }
+                else if(dstType == VET_FLOAT4)
+                {
+                    OgreAssert(srcType == VET_INT_10_10_10_2_NORM, "unsupported conversion");
+                    spliceElement(elem, vbuf, pDst, pDst, newElemSize, unpack_10_10_10_2<true>);
+                }
                 else
                 {
-                    OgreAssert(srcType == VET_FLOAT4, "unsupported conversion");
-                    spliceElement(elem, vbuf, pDst, pDst, newElemSize, pack_10_10_10_2<true>);
+                    OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "unsupported dstType");
                 }
             }
-            else if(dstType == VET_FLOAT3)
-            {
-                OgreAssert(srcType == VET_INT_10_10_10_2_NORM, "unsupported conversion");
-                spliceElement(elem, vbuf, pDst, pDst, newElemSize, unpack_10_10_10_2<false>);
-            }
-            else if(dstType == VET_FLOAT4)
-            {
-                OgreAssert(srcType == VET_INT_10_10_10_2_NORM, "unsupported conversion");
-                spliceElement(elem, vbuf, pDst, pDst, newElemSize, unpack_10_10_10_2<true>);
-            }
-            else
-            {
-                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "unsupported dstType");
-            }
-        }
 
-        // Bind the new buffer
-        vertexBufferBinding->setBinding(elem->getSource(), newVBuf);
-        updateVertexDeclaration(vertexDeclaration, elem, dstType, elem->getSource());
+            // Bind the new buffer
+            vertexBufferBinding->setBinding(elem->getSource(), newVBuf);
+            updateVertexDeclaration(vertexDeclaration, elem, dstType, elem->getSource());
+        }
     }
     //-----------------------------------------------------------------------
     void VertexData::prepareForShadowVolume(void)
@@ -59,8 +59,8 @@ namespace Ogre {
 #endif
             
         // Set the default material scheme
-        RenderSystem* rs = Root::getSingleton().getRenderSystem();
-        mMaterialSchemeName = rs->_getDefaultViewportMaterialScheme();
+        if (RenderSystem* rs = Root::getSingleton().getRenderSystem())
+            mMaterialSchemeName = rs->_getDefaultViewportMaterialScheme();
         
         // Calculate actual dimensions
         _updateDimensions();
@@ -28,6 +28,9 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgreWorkQueue.h"
 #include "OgreTimer.h"
+#include "OgreRoot.h"
+
+#include <atomic>
 
 namespace Ogre {
     void WorkQueue::processMainThreadTasks()
@@ -37,6 +40,90 @@ namespace Ogre {
         OGRE_IGNORE_DEPRECATED_END
     }
     //---------------------------------------------------------------------
+    void WorkQueue::parallelFor(size_t count, size_t grainSize,
+                                const std::function<void(size_t, size_t)>& task)
+    {
+        if (!count)
+            return;
+
+        WorkQueue* queue = Root::getSingletonPtr() ? Root::getSingleton().getWorkQueue() : NULL;
+        size_t numWorkers = queue ? queue->getWorkerThreadCount() : 0;
+        // a few chunks per thread, so uneven chunks still balance out
+        size_t numChunks = std::min((count + grainSize - 1) / std::max<size_t>(grainSize, 1), (numWorkers + 1) * 4);
+
+#if OGRE_THREAD_SUPPORT
+        if (numWorkers == 0 || numChunks < 2)
+#endif
+        {
+            task(0, count);
+            return;
+        }
+
+#if OGRE_THREAD_SUPPORT
+        struct ParallelForState
+        {
+            const std::function<void(size_t, size_t)>* task;
+            size_t count;
+            size_t chunkSize;
+            size_t numChunks;
+            std::atomic<size_t> nextChunk;
+            std::atomic<size_t> doneChunks;
+            std::exception_ptr error;
+            OGRE_WQ_MUTEX(mutex);
+            OGRE_WQ_THREAD_SYNCHRONISER(doneSync);
+
+            // claims chunks until none are left. Tasks that only start after all chunks were
+            // claimed return right away and never touch the callers task or stack.
+            void process()
+            {
+                size_t chunk;
+                while ((chunk = nextChunk++) < numChunks)
+                {
+                    size_t begin = chunk * chunkSize;
+                    try
+                    {
+                        (*task)(begin, std::min(begin + chunkSize, count));
+                    }
+                    catch (...)
+                    {
+                        OGRE_WQ_LOCK_MUTEX(mutex);
+                        if (!error)
+                            error = std::current_exception();
+                    }
+
+                    if (++doneChunks == numChunks)
+                    {
+                        OGRE_WQ_LOCK_MUTEX(mutex);
+                        OGRE_THREAD_NOTIFY_ALL(doneSync);
+                    }
+                }
+            }
+        };
+
+        auto state = std::make_shared<ParallelForState>();
+        state->task = &task;
+        state->count = count;
+        state->chunkSize = (count + numChunks - 1) / numChunks;
+        state->numChunks = (count + state->chunkSize - 1) / state->chunkSize;
+        state->nextChunk = 0;
+        state->doneChunks = 0;
+
+        for (size_t i = 0, n = std::min(numWorkers, state->numChunks - 1); i < n; ++i)
+            queue->addTask([state]() { state->process(); });
+
+        state->process();
+
+        {
+            OGRE_WQ_LOCK_MUTEX_NAMED(state->mutex, lock);
+            while (state->doneChunks < state->numChunks)
+                OGRE_THREAD_WAIT(state->doneSync, state->mutex, lock);
+        }
+
+        if (state->error)
+            std::rethrow_exception(state->error);
+#endif
+    }
+    //---------------------------------------------------------------------
     WorkQueue::Request::Request(uint16 channel, uint16 rtype, const Any& rData, uint8 retry, RequestID rid)
         : mChannel(channel), mType(rtype), mData(rData), mRetryCount(retry), mID(rid), mAborted(false)
     {
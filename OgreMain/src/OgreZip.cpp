@@ -28,19 +28,210 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 
 #if OGRE_NO_ZIP_ARCHIVE == 0
-#include <zip.h>
+#define MINIZ_HEADER_FILE_ONLY
+#include <miniz.h>
 
 namespace Ogre {
 namespace {
+    // read by worker threads inside ZipArchive::open
+    std::atomic<size_t> gEntryCacheBudget(16 * 1024 * 1024);
+    std::atomic<size_t> gStreamingThreshold(8 * 1024 * 1024);
+
+    /// read-only view into memory owned by another stream, which is kept alive by the view
+    class MemoryViewStream : public MemoryDataStream
+    {
+        MemoryDataStreamPtr mOwner;
+    public:
+        MemoryViewStream(const String& name, const MemoryDataStreamPtr& owner, size_t offset, size_t size)
+            : MemoryDataStream(name, owner->getPtr() + offset, size, false, true), mOwner(owner)
+        {
+        }
+    };
+
+    /** Read-only stream, that inflates a deflated zip entry on demand
+
+        Only a window of TINFL_LZ_DICT_SIZE bytes is kept in memory. To keep seeking cheap,
+        the inflator state is captured every SEEK_POINT_INTERVAL bytes of output, so seeking
+        backwards resumes from the closest seek point instead of the start of the entry.
+    */
+    class InflateEntryStream : public DataStream
+    {
+        static const size_t SEEK_POINT_INTERVAL = 1 << 20;
+
+        struct SeekPoint
+        {
+            tinfl_decompressor inflator;
+            size_t srcPos;
+            size_t outPos;
+            std::vector<uint8> dict;
+        };
+
+        MemoryDataStreamPtr mOwner;
+        const uint8* mSrc;
+        size_t mSrcSize;
+        size_t mSrcPos;
+
+        tinfl_decompressor mInflator;
+        tinfl_status mStatus;
+        std::vector<uint8> mDict;
+        /// decoded bytes of the current block are mDict[mBlockBegin, mBlockEnd)
+        size_t mBlockBegin;
+        size_t mBlockEnd;
+        /// logical position of mBlockBegin
+        size_t mBlockPos;
+        /// read position inside the current block
+        size_t mCursor;
+
+        std::vector<SeekPoint> mSeekPoints;
+
+        void rewind()
+        {
+            tinfl_init(&mInflator);
+            mStatus = TINFL_STATUS_HAS_MORE_OUTPUT;
+            mSrcPos = 0;
+            mBlockBegin = mBlockEnd = mCursor = 0;
+            mBlockPos = 0;
+        }
+
+        /// inflate the next block into the dictionary. Returns false at the end of the entry
+        bool inflateBlock()
+        {
+            if (mStatus != TINFL_STATUS_HAS_MORE_OUTPUT)
+                return false;
+
+            size_t outPos = mBlockPos + (mBlockEnd - mBlockBegin);
+            size_t dictOfs = mBlockEnd & (TINFL_LZ_DICT_SIZE - 1);
+            if (outPos / SEEK_POINT_INTERVAL > mSeekPoints.size())
+                mSeekPoints.push_back({mInflator, mSrcPos, outPos, mDict});
+
+            size_t inBytes = mSrcSize - mSrcPos;
+            size_t outBytes = TINFL_LZ_DICT_SIZE - dictOfs;
+            mStatus = tinfl_decompress(&mInflator, mSrc + mSrcPos, &inBytes, mDict.data(),
+                                       mDict.data() + dictOfs, &outBytes, 0);
+            mSrcPos += inBytes;
+
+            if (mStatus < TINFL_STATUS_DONE)
+                OGRE_EXCEPT(Exception::ERR_INVALID_STATE, "corrupt zip entry " + mName);
+
+            mBlockPos = outPos;
+            mBlockBegin = mCursor = dictOfs;
+            mBlockEnd = dictOfs + outBytes;
+            return outBytes > 0;
+        }
+    public:
+        InflateEntryStream(const String& name, const MemoryDataStreamPtr& owner, size_t offset,
+                           size_t compressedSize, size_t uncompressedSize)
+            : DataStream(name), mOwner(owner), mSrc(owner->getPtr() + offset), mSrcSize(compressedSize),
+              mDict(TINFL_LZ_DICT_SIZE)
+        {
+            mSize = uncompressedSize;
+            rewind();
+        }
+
+        size_t read(void* buf, size_t count) override
+        {
+            size_t total = 0;
+            while (total < count)
+            {
+                if (mCursor == mBlockEnd && !inflateBlock())
+                    break;
+                size_t n = std::min(count - total, mBlockEnd - mCursor);
+                memcpy(static_cast<uint8*>(buf) + total, mDict.data() + mCursor, n);
+                mCursor += n;
+                total += n;
+            }
+            return total;
+        }
+
+        void skip(long count) override
+        {
+            // clamp at the start instead of wrapping around
+            size_t pos = tell();
+            seek(count < 0 && size_t(-count) > pos ? 0 : pos + count);
+        }
+
+        void seek(size_t pos) override
+        {
+            pos = std::min(pos, mSize);
+            if (pos < mBlockPos)
+            {
+                // outside of the current block. Resume from the last seek point before pos
+                auto sp = std::upper_bound(mSeekPoints.begin(), mSeekPoints.end(), pos,
+                                           [](size_t p, const SeekPoint& s) { return p < s.outPos; });
+                if (sp == mSeekPoints.begin())
+                {
+                    rewind();
+                }
+                else
+                {
+                    --sp;
+                    mInflator = sp->inflator;
+                    mStatus = TINFL_STATUS_HAS_MORE_OUTPUT;
+                    mSrcPos = sp->srcPos;
+                    mDict = sp->dict;
+                    mBlockBegin = mBlockEnd = mCursor = sp->outPos & (TINFL_LZ_DICT_SIZE - 1);
+                    mBlockPos = sp->outPos;
+                }
+            }
+
+            while (pos > mBlockPos + (mBlockEnd - mBlockBegin))
+            {
+                if (!inflateBlock())
+                {
+                    mCursor = mBlockEnd;
+                    return;
+                }
+            }
+            mCursor = mBlockBegin + (pos - mBlockPos);
+        }
+
+        size_t tell() const override { return mBlockPos + (mCursor - mBlockBegin); }
+
+        bool eof() const override { return tell() >= mSize; }
+
+        void close() override
+        {
+            mOwner.reset();
+            mSeekPoints.clear();
+            mAccess = 0;
+        }
+    };
+
     class ZipArchive : public Archive
     {
     protected:
+        /// location of an entry inside mBuffer
+        struct Entry
+        {
+            uint64 localHeaderOffset;
+            size_t compressedSize;
+            size_t uncompressedSize;
+            uint16 method;
+        };
+
         /// Handle to root zip file
-        zip_t* mZipFile;
+        mz_zip_archive* mZipFile;
         MemoryDataStreamPtr mBuffer;
         /// File list (since zziplib seems to only allow scanning of dir tree once)
         FileInfoList mFileList;
+        /// entries indexed by their full name inside the archive
+        std::unordered_map<String, Entry> mEntries;
+#if !OGRE_RESOURCEMANAGER_STRICT
+        /// full entry names by basename, empty if the basename is ambiguous
+        std::unordered_map<String, String> mBasenames;
+#endif
+
+        /// recently inflated entries, most recently used first
+        typedef std::list<std::pair<String, MemoryDataStreamPtr>> EntryCache;
+        mutable EntryCache mCache;
+        mutable std::unordered_map<String, EntryCache::iterator> mCacheIndex;
+        mutable size_t mCacheSize;
+        OGRE_WQ_MUTEX(mCacheMutex);
         OGRE_AUTO_MUTEX;
+
+        const Entry* findEntry(const String& filename) const;
+        MemoryDataStreamPtr getCachedEntry(const String& filename) const;
+        void cacheEntry(const String& filename, const MemoryDataStreamPtr& data) const;
     public:
         ZipArchive(const String& name, const String& archType, const uint8* externBuf = 0, size_t externBufSz = 0);
         ~ZipArchive();
@@ -81,10 +272,18 @@ namespace {
         /// @copydoc Archive::getModifiedTime
         time_t getModifiedTime(const String& filename) const override;
     };
+
+    String entryKey(String name)
+    {
+#if !OGRE_RESOURCEMANAGER_STRICT
+        StringUtil::toLowerCase(name);
+#endif
+        return name;
+    }
 }
     //-----------------------------------------------------------------------
     ZipArchive::ZipArchive(const String& name, const String& archType, const uint8* externBuf, size_t externBufSz)
-        : Archive(name, archType), mZipFile(0)
+        : Archive(name, archType), mZipFile(0), mCacheSize(0)
     {
         if(externBuf)
             mBuffer.reset(new MemoryDataStream(const_cast<uint8*>(externBuf), externBufSz));
@@ -103,25 +302,33 @@ namespace {
             if(!mBuffer)
                 mBuffer.reset(new MemoryDataStream(_openFileStream(mName, std::ios::binary)));
 
-            mZipFile = zip_stream_open((const char*)mBuffer->getPtr(), mBuffer->size(), 0, 'r');
+            mZipFile = new mz_zip_archive();
+            if (!mz_zip_reader_init_mem(mZipFile, mBuffer->getPtr(), mBuffer->size(), 0))
+            {
+                delete mZipFile;
+                mZipFile = 0;
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "could not open " + mName);
+            }
 
             // Cache names
-            int n = zip_entries_total(mZipFile);
-            for (int i = 0; i < n; ++i) {
+            mz_uint n = mz_zip_reader_get_num_files(mZipFile);
+            for (mz_uint i = 0; i < n; ++i) {
+                mz_zip_archive_file_stat stat;
+                if (!mz_zip_reader_file_stat(mZipFile, i, &stat))
+                    continue;
+
                 FileInfo info;
                 info.archive = this;
 
-                zip_entry_openbyindex(mZipFile, i);
-
-                info.filename = zip_entry_name(mZipFile);
+                info.filename = stat.m_filename;
                 // Get basename / path
                 StringUtil::splitFilename(info.filename, info.basename, info.path);
 
                 // Get sizes
-                info.uncompressedSize = zip_entry_size(mZipFile);
-                info.compressedSize = zip_entry_comp_size(mZipFile);
+                info.uncompressedSize = stat.m_uncomp_size;
+                info.compressedSize = stat.m_comp_size;
 
-                if (zip_entry_isdir(mZipFile))
+                if (stat.m_is_directory)
                 {
                     info.filename = info.filename.substr(0, info.filename.length() - 1);
                     StringUtil::splitFilename(info.filename, info.basename, info.path);
@@ -129,13 +336,20 @@ namespace {
                     // the compressed size of a folder, and if he does, its useless anyway
                     info.compressedSize = size_t(-1);
                 }
-#if !OGRE_RESOURCEMANAGER_STRICT
                 else
                 {
+                    Entry entry = {stat.m_local_header_ofs, size_t(stat.m_comp_size), size_t(stat.m_uncomp_size),
+                                   stat.m_method};
+                    if (stat.m_is_encrypted)
+                        entry.method = uint16(-1);
+                    mEntries.emplace(entryKey(stat.m_filename), entry);
+#if !OGRE_RESOURCEMANAGER_STRICT
+                    auto basename = mBasenames.emplace(entryKey(info.basename), stat.m_filename);
+                    if (!basename.second)
+                        basename.first->second.clear();
                     info.filename = info.basename;
-                }
 #endif
-                zip_entry_close(mZipFile);
+                }
                 mFileList.push_back(info);
             }
         }
@@ -146,49 +360,141 @@ namespace {
         OGRE_LOCK_AUTO_MUTEX;
         if (mZipFile)
         {
-            zip_close(mZipFile);
+            mz_zip_reader_end(mZipFile);
+            delete mZipFile;
             mZipFile = 0;
             mFileList.clear();
+            mEntries.clear();
+#if !OGRE_RESOURCEMANAGER_STRICT
+            mBasenames.clear();
+#endif
             mBuffer.reset();
+
+            OGRE_WQ_LOCK_MUTEX(mCacheMutex);
+            mCache.clear();
+            mCacheIndex.clear();
+            mCacheSize = 0;
         }
     
     }
     //-----------------------------------------------------------------------
+    const ZipArchive::Entry* ZipArchive::findEntry(const String& filename) const
+    {
+        auto it = mEntries.find(entryKey(filename));
+        return it == mEntries.end() ? NULL : &it->second;
+    }
+    //-----------------------------------------------------------------------
+    MemoryDataStreamPtr ZipArchive::getCachedEntry(const String& filename) const
+    {
+        OGRE_WQ_LOCK_MUTEX(mCacheMutex);
+        // keyed like the entries, so different spellings share one cached copy
+        auto it = mCacheIndex.find(entryKey(filename));
+        if (it == mCacheIndex.end())
+            return MemoryDataStreamPtr();
+
+        // move to front
+        mCache.splice(mCache.begin(), mCache, it->second);
+        return it->second->second;
+    }
+    //-----------------------------------------------------------------------
+    void ZipArchive::cacheEntry(const String& filename, const MemoryDataStreamPtr& data) const
+    {
+        size_t budget = gEntryCacheBudget;
+        if (data->size() > budget)
+            return;
+
+        String key = entryKey(filename);
+        OGRE_WQ_LOCK_MUTEX(mCacheMutex);
+        if (mCacheIndex.find(key) != mCacheIndex.end())
+            return; // another thread was faster
+
+        mCache.emplace_front(key, data);
+        mCacheIndex[key] = mCache.begin();
+        mCacheSize += data->size();
+
+        // evict least recently used
+        while (mCacheSize > budget)
+        {
+            mCacheSize -= mCache.back().second->size();
+            mCacheIndex.erase(mCache.back().first);
+            mCache.pop_back();
+        }
+    }
+    //-----------------------------------------------------------------------
     DataStreamPtr ZipArchive::open(const String& filename, bool readOnly) const
     {
-        // zip is not threadsafe
-        OGRE_LOCK_AUTO_MUTEX;
+        // no lock needed: mBuffer, mEntries and mBasenames are immutable while loaded and
+        // entries are inflated directly from memory
         String lookUpFileName = filename;
 
-        bool open = zip_entry_open(mZipFile, lookUpFileName.c_str(), OGRE_RESOURCEMANAGER_STRICT) == 0;
+        const Entry* entry = findEntry(lookUpFileName);
 #if !OGRE_RESOURCEMANAGER_STRICT
-        if (!open) // Try if we find the file
+        if (!entry) // Try if we find the file
         {
             String basename, path;
             StringUtil::splitFilename(lookUpFileName, basename, path);
-            const FileInfoListPtr fileNfo = findFileInfo(basename, true);
-            if (fileNfo->size() == 1) // If there are more files with the same do not open anyone
+            auto it = mBasenames.find(entryKey(basename));
+            // If there are more files with the same do not open anyone
+            if (it != mBasenames.end() && !it->second.empty())
             {
-                Ogre::FileInfo info = fileNfo->at(0);
-                lookUpFileName = info.path + info.basename;
-                open = zip_entry_open(mZipFile, lookUpFileName.c_str(), OGRE_RESOURCEMANAGER_STRICT) == 0;
+                lookUpFileName = it->second;
+                entry = findEntry(lookUpFileName);
             }
         }
 #endif
 
-        if (!open)
+        if (!entry)
         {
             OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND, "could not open "+lookUpFileName);
         }
 
+        if (readOnly)
+        {
+            if (auto cached = getCachedEntry(lookUpFileName))
+                return std::make_shared<MemoryViewStream>(lookUpFileName, cached, 0, cached->size());
+        }
+
+        // locate the data behind the local file header
+        const uint8* header = mBuffer->getPtr() + entry->localHeaderOffset;
+        if (entry->localHeaderOffset + 30 > mBuffer->size() ||
+            header[0] != 0x50 || header[1] != 0x4b || header[2] != 0x03 || header[3] != 0x04)
+            OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND, "could not read "+lookUpFileName);
+        size_t nameLen = header[26] | (header[27] << 8);
+        size_t extraLen = header[28] | (header[29] << 8);
+        size_t dataOffset = entry->localHeaderOffset + 30 + nameLen + extraLen;
+        if (dataOffset + entry->compressedSize > mBuffer->size())
+            OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND, "could not read "+lookUpFileName);
+
+        if (entry->method == 0)
+        {
+            // stored entries are served straight from the archive buffer
+            if (readOnly)
+                return std::make_shared<MemoryViewStream>(lookUpFileName, mBuffer, dataOffset,
+                                                          entry->uncompressedSize);
+            auto ret = std::make_shared<MemoryDataStream>(lookUpFileName, entry->uncompressedSize);
+            memcpy(ret->getPtr(), mBuffer->getPtr() + dataOffset, ret->size());
+            return ret;
+        }
+
+        if (entry->method != MZ_DEFLATED)
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED, "unsupported compression method in "+lookUpFileName);
+
+        if (readOnly && entry->uncompressedSize >= gStreamingThreshold)
+            return std::make_shared<InflateEntryStream>(lookUpFileName, mBuffer, dataOffset,
+                                                        entry->compressedSize, entry->uncompressedSize);
+
         // Construct & return stream
-        auto ret = std::make_shared<MemoryDataStream>(lookUpFileName, zip_entry_size(mZipFile));
+        auto ret = std::make_shared<MemoryDataStream>(lookUpFileName, entry->uncompressedSize);
 
-        if(zip_entry_noallocread(mZipFile, ret->getPtr(), ret->size()) < 0)
+        if (tinfl_decompress_mem_to_mem(ret->getPtr(), ret->size(), mBuffer->getPtr() + dataOffset,
+                                        entry->compressedSize, 0) != ret->size())
             OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND, "could not read "+lookUpFileName);
-        zip_entry_close(mZipFile);
 
-        return ret;
+        if (!readOnly)
+            return ret;
+
+        cacheEntry(lookUpFileName, ret);
+        return std::make_shared<MemoryViewStream>(lookUpFileName, ret, 0, ret->size());
     }
     //---------------------------------------------------------------------
     DataStreamPtr ZipArchive::create(const String& filename)
@@ -316,6 +622,12 @@ namespace {
         return name;
     }
     //-----------------------------------------------------------------------
+    void ZipArchiveFactory::setEntryCacheBudget(size_t bytes) { gEntryCacheBudget = bytes; }
+    size_t ZipArchiveFactory::getEntryCacheBudget() { return gEntryCacheBudget; }
+    //-----------------------------------------------------------------------
+    void ZipArchiveFactory::setStreamingThreshold(size_t bytes) { gStreamingThreshold = bytes; }
+    size_t ZipArchiveFactory::getStreamingThreshold() { return gStreamingThreshold; }
+    //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     //  EmbeddedZipArchiveFactory
     //-----------------------------------------------------------------------
@@ -17,9 +17,14 @@
 #include "OgreMeshLodGenerator.h"
 #include "OgrePixelCountLodStrategy.h"
 #include "OgreLodCollapseCostQuadric.h"
+#include "OgreLodCollapseCostCurvature.h"
 #include "OgreRenderWindow.h"
 #include "OgreLodConfigSerializer.h"
 #include "OgreWorkQueue.h"
+#include "OgreLodData.h"
+#include "OgreMeshOptimizer.h"
+
+#include <array>
 
 using namespace Ogre;
 
@@ -126,11 +131,67 @@ void MeshLodTests::blockedWaitForLodGeneration(const MeshPtr& mesh)
     EXPECT_TRUE(success);
 }
 //--------------------------------------------------------------------------
+TEST_F(MeshLodTests,OptimiseCompressedLevels)
+{
+    LodConfig config;
+    setTestLodConfig(config);
+    MeshLodGenerator::getSingleton().generateLodLevels(config);
+
+    MeshOptimizer optimizer(MeshOptimizer::MO_VERTEX_CACHE);
+    // the sorted triangles of every generated level and the sum of their cache miss ratios
+    auto getLevels = [&](float& acmr, bool& shared) {
+        std::vector<std::vector<std::array<uint32, 3>>> ret;
+        acmr = 0;
+        shared = false;
+        for (auto sm : mMesh->getSubMeshes())
+        {
+            for (auto indexData : sm->mLodFaceList)
+            {
+                for (auto other : sm->mLodFaceList)
+                    shared |= other != indexData && other->indexBuffer == indexData->indexBuffer;
+
+                std::vector<std::array<uint32, 3>> triangles(indexData->indexCount / 3);
+                if (triangles.empty())
+                {
+                    ret.push_back(triangles);
+                    continue;
+                }
+                acmr += optimizer.getAvgCacheMissRatio(indexData);
+
+                auto ibuf = indexData->indexBuffer;
+                HardwareBufferLockGuard lock(ibuf, indexData->indexStart * ibuf->getIndexSize(),
+                                             indexData->indexCount * ibuf->getIndexSize(),
+                                             HardwareBuffer::HBL_READ_ONLY);
+                for (size_t i = 0; i < indexData->indexCount; ++i)
+                {
+                    triangles[i / 3][i % 3] = ibuf->getType() == HardwareIndexBuffer::IT_32BIT
+                                                  ? static_cast<const uint32*>(lock.pData)[i]
+                                                  : static_cast<const uint16*>(lock.pData)[i];
+                }
+                std::sort(triangles.begin(), triangles.end());
+                ret.push_back(triangles);
+            }
+        }
+        return ret;
+    };
+
+    float acmrBefore, acmrAfter;
+    bool shared;
+    auto before = getLevels(acmrBefore, shared);
+    ASSERT_TRUE(shared);
+
+    // the compressed levels are reordered within their ranges and keep their triangles
+    optimizer.optimise(mMesh.get());
+    EXPECT_EQ(before, getLevels(acmrAfter, shared));
+    EXPECT_LT(acmrAfter, acmrBefore);
+}
+//--------------------------------------------------------------------------
 TEST_F(MeshLodTests,LodConfigSerializer)
 {
     LodConfig config, config2;
     setTestLodConfig(config);
     addProfile(config);
+    config.advanced.optimiseVertexCache = true;
     LodConfigSerializer serializer;
     serializer.exportLodConfig(config, "testLodConfigSerializer.lodconfig");
     serializer.importLodConfig(&config2, "testLodConfigSerializer.lodconfig");
@@ -141,6 +202,7 @@ TEST_F(MeshLodTests,LodConfigSerializer)
     EXPECT_EQ(config.advanced.useBackgroundQueue, config.advanced.useBackgroundQueue);
     EXPECT_EQ(config.advanced.useCompression, config.advanced.useCompression);
     EXPECT_EQ(config.advanced.useVertexNormals, config.advanced.useVertexNormals);
+    EXPECT_EQ(config.advanced.optimiseVertexCache, config2.advanced.optimiseVertexCache);
 
     {
         // Compare profiles
@@ -188,6 +250,77 @@ TEST_F(MeshLodTests,QuadricError)
     gen.generateLodLevels(config, LodCollapseCostPtr(new LodCollapseCostQuadric()));
 }
 //--------------------------------------------------------------------------
+TEST_F(MeshLodTests,CollapseCostHeap)
+{
+    LodData::Vertex v[6];
+    LodData::CollapseCostHeap heap;
+    const Real costs[] = {3, 1, 2, 1, 3, 0.5};
+    for (int i = 0; i < 6; i++)
+    {
+        v[i].costHeapPosition = LodData::CollapseCostHeap::INVALID_POSITION;
+        EXPECT_FALSE(heap.contains(&v[i]));
+        heap.push(&v[i], costs[i]);
+        EXPECT_TRUE(heap.contains(&v[i]));
+    }
+
+    // lower cost moves up, raising the cost orders it after the vertices of the same cost
+    heap.update(&v[2], 0.25);
+    heap.update(&v[5], 3);
+    heap.erase(&v[0]);
+    EXPECT_FALSE(heap.contains(&v[0]));
+    EXPECT_EQ(heap.size(), 5u);
+
+    // equal costs keep their insertion order
+    LodData::Vertex* expected[] = {&v[2], &v[1], &v[3], &v[4], &v[5]};
+    for (auto *e : expected)
+    {
+        ASSERT_EQ(heap.top().vertex, e);
+        EXPECT_EQ(heap.getCost(e), heap.top().cost);
+        heap.erase(e);
+    }
+    EXPECT_TRUE(heap.empty());
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshLodTests,ParallelCostInitialisation)
+{
+    // the generated levels must not depend on the threads computing the initial costs
+    auto generate = [this](const LodCollapseCostPtr& cost) {
+        LodConfig config;
+        setTestLodConfig(config);
+        config.advanced.useCompression = false;
+        mMesh->removeLodLevels();
+        MeshLodGenerator::getSingleton().generateLodLevels(config, cost);
+
+        std::vector<std::vector<uint8> > indices;
+        for (auto *sm : mMesh->getSubMeshes())
+        {
+            for (auto *id : sm->mLodFaceList)
+            {
+                std::vector<uint8> data(id->indexCount * id->indexBuffer->getIndexSize());
+                id->indexBuffer->readData(id->indexStart * id->indexBuffer->getIndexSize(), data.size(),
+                                          data.data());
+                indices.push_back(data);
+            }
+        }
+        return indices;
+    };
+
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->setWorkerThreadCount(0);
+    auto serial = generate(LodCollapseCostPtr(new LodCollapseCostCurvature()));
+    auto serialQuadric = generate(LodCollapseCostPtr(new LodCollapseCostQuadric()));
+
+    wq->setWorkerThreadCount(3);
+    wq->startup();
+    auto parallel = generate(LodCollapseCostPtr(new LodCollapseCostCurvature()));
+    auto parallelQuadric = generate(LodCollapseCostPtr(new LodCollapseCostQuadric()));
+    wq->shutdown();
+
+    ASSERT_FALSE(serial.empty());
+    EXPECT_EQ(serial, parallel);
+    EXPECT_EQ(serialQuadric, parallelQuadric);
+}
+//--------------------------------------------------------------------------
 void MeshLodTests::setTestLodConfig(LodConfig& config)
 {
     config.mesh = mMesh;
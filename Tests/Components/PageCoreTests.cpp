@@ -26,10 +26,16 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
 
 #include "OgreRoot.h"
 #include "OgrePageManager.h"
 #include "OgreGrid2DPageStrategy.h"
+#include "OgrePagedWorld.h"
+#include "OgrePagedWorldSection.h"
+#include "OgreCamera.h"
+#include "OgreSceneNode.h"
 #include "OgreBuildSettings.h"
 
 
@@ -102,3 +108,112 @@ TEST_F(PageCoreTests,SimpleCreateSaveLoadWorld)
 }
 //--------------------------------------------------------------------------
 
+namespace
+{
+/// records page requests instead of loading them
+class RecordingSection : public PagedWorldSection
+{
+public:
+    std::set<PageID> requested;
+    RecordingSection(PagedWorld* parent, SceneManager* sm) : PagedWorldSection("Recording", parent, sm) {}
+    void loadPage(PageID pageID, bool) override { requested.insert(pageID); }
+};
+}
+TEST_F(PageCoreTests,PredictiveLoading)
+{
+    PagedWorld* world = mPageManager->createWorld();
+    RecordingSection section(world, mSceneMgr);
+    section.setStrategy("Grid2D");
+    auto data = static_cast<Grid2DPageStrategyData*>(section.getStrategyData());
+    data->setCellSize(100);
+    data->setLoadRadius(100);
+    data->setHoldRadius(200);
+    data->setLookAheadTime(2);
+
+    Camera* cam = mSceneMgr->createCamera("cam");
+    SceneNode* node = mSceneMgr->getRootSceneNode()->createChildSceneNode();
+    node->attachObject(cam);
+
+    // fly along +x at 200 units per second
+    for (int frame = 0; frame < 3; frame++)
+    {
+        node->setPosition(frame * 20, 0, 0);
+        section.getStrategy()->frameStart(0.1f, &section);
+        section.getStrategy()->notifyCamera(cam, &section);
+    }
+
+    // the smoothed velocity reaches 150 units per second, so the camera is predicted at x = 340
+    // in cell 3, and the load radius adds cell 4
+    EXPECT_TRUE(section.requested.count(data->calculatePageID(4, 0)));
+    EXPECT_FALSE(section.requested.count(data->calculatePageID(5, 0)));
+    EXPECT_FALSE(section.requested.count(data->calculatePageID(-2, 0)));
+
+    // pages ahead come first
+    PageStrategy* strategy = section.getStrategy();
+    EXPECT_LT(strategy->getPagePriority(data->calculatePageID(2, 0), &section),
+              strategy->getPagePriority(data->calculatePageID(-2, 0), &section));
+
+    // hints within the hold radius are requested
+    data->setLookAheadTime(0);
+    data->addPathHint(Vector3(0, 0, -150));
+    section.requested.clear();
+    section.getStrategy()->notifyCamera(cam, &section);
+    EXPECT_TRUE(section.requested.count(data->calculatePageID(0, 3)));
+}
+//--------------------------------------------------------------------------
+
+namespace
+{
+/// generates empty pages, recording the order they are loaded in
+class RecordingProvider : public PageProvider
+{
+public:
+    std::atomic<int> prepared{0};
+    std::vector<PageID> loaded;
+    bool prepareProceduralPage(Page*, PagedWorldSection*) override
+    {
+        prepared++;
+        return true;
+    }
+    bool loadProceduralPage(Page* page, PagedWorldSection*) override
+    {
+        loaded.push_back(page->getID());
+        return true;
+    }
+};
+}
+TEST_F(PageCoreTests,ScheduledLoading)
+{
+    mRoot->getWorkQueue()->startup(false);
+    mPageManager->setMaxConcurrentPreparations(1);
+
+    RecordingProvider provider;
+    PagedWorld* world = mPageManager->createWorld();
+    PagedWorldSection* section = world->createSection("Grid2D", mSceneMgr);
+    section->setPageProvider(&provider);
+    auto data = static_cast<Grid2DPageStrategyData*>(section->getStrategyData());
+    data->setCellSize(100);
+
+    std::vector<PageID> ids = {data->calculatePageID(3, 0), data->calculatePageID(1, 0),
+                               data->calculatePageID(2, 0), data->calculatePageID(5, 0)};
+    for (PageID id : ids)
+        section->loadPage(id);
+
+    // leaves the hold radius before being prepared
+    section->unloadPage(ids[3]);
+    EXPECT_EQ(size_t(3), mPageManager->getPendingPageLoadCount());
+
+    for (int i = 0; i < 5000 && mPageManager->getPendingPageLoadCount(); i++)
+    {
+        mRoot->_fireFrameStarted();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // nearest first
+    EXPECT_EQ(3, provider.prepared);
+    EXPECT_EQ(std::vector<PageID>({ids[1], ids[2], ids[0]}), provider.loaded);
+    EXPECT_FALSE(section->getPage(ids[0])->isDeferredProcessInProgress());
+
+    mPageManager->destroyWorld(world);
+}
+//--------------------------------------------------------------------------
@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include "OgreRoot.h"
 #include "OgreTerrain.h"
+#include "OgreTerrainLodManager.h"
 #include "OgreFileSystemLayer.h"
 
 #include "OgreBuildSettings.h"
@@ -39,6 +40,10 @@ THE SOFTWARE.
 #include "OgreSTBICodec.h"
 #include "OgreStreamSerialiser.h"
 #include "OgreDefaultHardwareBufferManager.h"
+#include "OgreTerrainLayerBlendMap.h"
+#include "OgreTerrainQuadTreeNode.h"
+#include "OgreWorkQueue.h"
+#include "MemoryTextureManager.h"
 
 using namespace Ogre;
 
@@ -125,3 +130,492 @@ TEST_F(TerrainTests, create)
     FileSystemLayer::removeFile("TerrainTest.dat");
 }
 //--------------------------------------------------------------------------
+TEST_F(TerrainTests, lightmap)
+{
+    Vector3 lightDir = Vector3(1, -0.2, 0.6).normalisedCopy();
+    mTerrainOpts->setLightMapDirection(lightDir);
+    mTerrainOpts->setLightMapSize(128);
+
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Image img;
+    img.load("terrain.png", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    Terrain::ImportData imp;
+    imp.inputImage = &img;
+    imp.inputScale = 200;
+    imp.terrainSize = 513;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 33;
+    imp.maxBatchSize = 65;
+    ASSERT_TRUE(t->prepare(imp));
+
+    Rect rect;
+    PixelBox* box = t->calculateLightmap(Rect(0, 0, imp.terrainSize, imp.terrainSize), Rect(), rect);
+    ASSERT_EQ(rect, Rect(0, 0, 128, 128));
+
+    // compare with casting a ray towards the light from each texel
+    Real heightPad = (t->getMaxHeight() - t->getMinHeight()) * 1.0e-3f;
+    auto isDark = [box](int x, int y) { return box->getColourAt(x, 127 - y, 0).r < 0.5f; };
+    int shadowed = 0, mismatches = 0;
+    for (int y = 0; y < 128; y++)
+    {
+        for (int x = 0; x < 128; x++)
+        {
+            Real tx = x / 127.0f, ty = y / 127.0f;
+            Vector3 pos;
+            t->getPosition(tx, ty, t->getHeightAtTerrainPosition(tx, ty) + heightPad, &pos);
+            bool hit = t->rayIntersects(Ray(pos, -lightDir), true, imp.worldSize).first;
+
+            shadowed += isDark(x, y);
+            if (isDark(x, y) == hit)
+                continue;
+
+            // the sweep walks along the texel grid, so only shadow edges may differ
+            bool nearEdge = false;
+            for (int ny = std::max(0, y - 1); ny <= std::min(127, y + 1); ny++)
+                for (int nx = std::max(0, x - 1); nx <= std::min(127, x + 1); nx++)
+                    nearEdge |= isDark(nx, ny) == hit;
+            mismatches += !nearEdge;
+        }
+    }
+    EXPECT_GT(shadowed, 128 * 128 / 20);
+    EXPECT_LT(mismatches, 128 * 128 / 200);
+
+    OGRE_FREE(box->data, MEMCATEGORY_GENERAL);
+    OGRE_DELETE box;
+    OGRE_DELETE t;
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, rayIntersects)
+{
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Image img;
+    img.load("terrain.png", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    Terrain::ImportData imp;
+    imp.inputImage = &img;
+    imp.inputScale = 200;
+    imp.terrainSize = 513;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 33;
+    imp.maxBatchSize = 65;
+    ASSERT_TRUE(t->prepare(imp));
+
+    std::vector<Ray> rays;
+    for (int i = 0; i < 256; i++)
+    {
+        // from above the terrain, looking down at various angles
+        Vector3 origin(Math::RangeRandom(-500, 500), 300, Math::RangeRandom(-500, 500));
+        Vector3 dir(Math::RangeRandom(-1, 1), -Math::RangeRandom(0.05, 1), Math::RangeRandom(-1, 1));
+        rays.push_back(Ray(origin, dir.normalisedCopy()));
+    }
+
+    std::vector<std::pair<bool, Vector3> > results;
+    t->rayIntersects(rays, results);
+    ASSERT_EQ(results.size(), rays.size());
+
+    int hits = 0;
+    for (size_t i = 0; i < rays.size(); i++)
+    {
+        auto single = t->rayIntersects(rays[i]);
+        ASSERT_EQ(single.first, results[i].first);
+        if (!single.first)
+            continue;
+        hits++;
+        EXPECT_EQ(single.second, results[i].second);
+
+        // the hit lies on the surface and the ray is above it just before
+        const Vector3& pos = single.second;
+        EXPECT_NEAR(t->getHeightAtWorldPosition(pos), pos.y, 0.5);
+        Real dist = rays[i].getOrigin().distance(pos);
+        Vector3 before = rays[i].getPoint(std::max<Real>(dist - 5, 0));
+        EXPECT_GE(before.y + 0.5, t->getHeightAtWorldPosition(before));
+    }
+    EXPECT_GT(hits, 128);
+
+    // looking up from above the terrain hits nothing
+    EXPECT_FALSE(t->rayIntersects(Ray(Vector3(0, 300, 0), Vector3(0.3, 1, 0.2).normalisedCopy())).first);
+
+    // the height pyramid follows edits
+    Ray down(Vector3(0, 1000, 0), Vector3::NEGATIVE_UNIT_Y);
+    long x, y;
+    Vector3 terrainPos;
+    t->getTerrainPosition(Vector3::ZERO, &terrainPos);
+    x = long(terrainPos.x * (imp.terrainSize - 1));
+    y = long(terrainPos.y * (imp.terrainSize - 1));
+    for (long j = y - 2; j <= y + 2; j++)
+        for (long i = x - 2; i <= x + 2; i++)
+            *t->getHeightData(i, j) = 500;
+    t->dirtyRect(Rect(x - 2, y - 2, x + 3, y + 3));
+    auto hit = t->rayIntersects(down);
+    ASSERT_TRUE(hit.first);
+    EXPECT_NEAR(hit.second.y, 500, 1e-3);
+
+    OGRE_DELETE t;
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, quantisedLodData)
+{
+    // the vertex data is created while saving and freed with the terrain
+    DefaultHardwareBufferManager hbm;
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Image img;
+    img.load("terrain.png", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    Terrain::ImportData imp;
+    imp.inputImage = &img;
+    imp.inputScale = 200;
+    imp.terrainSize = 129;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 17;
+    imp.maxBatchSize = 33;
+    ASSERT_TRUE(t->prepare(imp));
+
+    const float precision = 0.01f;
+    auto save = [t, this](float savePrecision, const String& filename) {
+        mTerrainOpts->setHeightSavePrecision(savePrecision);
+        StreamSerialiser ser(Root::createFileStream(filename));
+        t->save(ser);
+        return Root::openFileStream(filename)->size();
+    };
+    size_t rawSize = save(0, "TerrainRaw.dat");
+    size_t quantisedSize = save(precision, "TerrainQuantised.dat");
+    EXPECT_LT(quantisedSize, rawSize);
+
+    // read-back all LOD levels, the heights are predicted from the coarser levels
+    Terrain* t2 = OGRE_NEW Terrain(mSceneMgr);
+    {
+        StreamSerialiser ser(Root::openFileStream("TerrainQuantised.dat"));
+        ASSERT_TRUE(t2->prepare(ser));
+        ASSERT_EQ(t2->getSize(), t->getSize());
+        TerrainLodManager lodManager(t2, "TerrainQuantised.dat");
+        lodManager.readLodData(t2->getNumLodLevels() - 1, 0);
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < size_t(t->getSize()) * t->getSize(); i++)
+        mismatches += std::abs(t2->getHeightData()[i] - t->getHeightData()[i]) > precision * 0.51f;
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_NE(t2->getMaxHeight(), t2->getMinHeight());
+
+    OGRE_DELETE t2;
+    OGRE_DELETE t;
+
+    FileSystemLayer::removeFile("TerrainRaw.dat");
+    FileSystemLayer::removeFile("TerrainQuantised.dat");
+}
+/// accepts everything but drops it, like a custom queue that is shutting down
+struct DroppingWorkQueue : public WorkQueue
+{
+    void startup(bool) override {}
+    void addTask(std::function<void()>) override {}
+    void setPaused(bool) override {}
+    bool isPaused() const override { return false; }
+    void setRequestsAccepted(bool) override {}
+    bool getRequestsAccepted() const override { return true; }
+    unsigned long getResponseProcessingTimeLimit() const override { return 0; }
+    void setResponseProcessingTimeLimit(unsigned long) override {}
+    void addMainThreadTask(std::function<void()>) override {}
+    void shutdown() override {}
+};
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, blendStamps)
+{
+    MemoryTextureManager texMgr;
+    mTerrainOpts->setLayerBlendMapSize(64);
+
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Image img;
+    img.load("terrain.png", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    Terrain::ImportData imp;
+    imp.inputImage = &img;
+    imp.terrainSize = 129;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 17;
+    imp.maxBatchSize = 33;
+    imp.layerList.resize(1);
+    ASSERT_TRUE(t->prepare(imp));
+    t->addLayer(Real(100));
+    t->addLayer(Real(100));
+    ASSERT_EQ(t->getLayerCount(), 3);
+
+    // both blend maps share the first texture, in the red and green channel
+    auto buffer = static_cast<MemoryPixelBuffer*>(t->getLayerBlendTexture(0)->getBuffer().get());
+    auto uploaded = [buffer](int x, int y, int channel) { return buffer->mData.getColourAt(x, y, 0)[channel]; };
+
+    // falloff at 4 texels from the centre: (1 - 16/64)^2
+    const float w = 0.5625f;
+    std::vector<TerrainBlendStamp> stamps = {{32, 32, 8, 1, 2}, {32, 32, 8, 1, 1}, {60, 4, 8, 0.5f, 2}};
+    t->applyBlendStamps(stamps);
+
+    TerrainLayerBlendMap* map1 = t->getLayerBlendMap(1);
+    TerrainLayerBlendMap* map2 = t->getLayerBlendMap(2);
+    EXPECT_FLOAT_EQ(map1->getBlendValue(32, 32), 1);
+    EXPECT_FLOAT_EQ(map2->getBlendValue(32, 32), 0); // faded out by painting the layer below
+    EXPECT_FLOAT_EQ(map1->getBlendValue(36, 32), w);
+    EXPECT_FLOAT_EQ(map2->getBlendValue(36, 32), w * (1 - w));
+    EXPECT_FLOAT_EQ(map1->getBlendValue(41, 32), 0);
+    EXPECT_FLOAT_EQ(map2->getBlendValue(60, 4), 0.5f); // clipped at the border
+    EXPECT_FLOAT_EQ(map2->getBlendValue(63, 0), 0.5f * (1 - 25 / 64.0f) * (1 - 25 / 64.0f));
+
+    // uploaded, once the main thread tasks run
+    EXPECT_EQ(uploaded(32, 32, 0), 0);
+    mRoot->getWorkQueue()->processMainThreadTasks();
+    EXPECT_NEAR(uploaded(32, 32, 0), 1, 1 / 255.0f);
+    EXPECT_NEAR(uploaded(36, 32, 0), w, 1 / 255.0f);
+    EXPECT_NEAR(uploaded(36, 32, 1), w * (1 - w), 1 / 255.0f);
+    EXPECT_NEAR(uploaded(60, 4, 1), 0.5f, 1 / 255.0f);
+
+    // uploaded right away, when the queue would drop the task. Otherwise the destructor would wait forever
+    mRoot->getWorkQueue()->setRequestsAccepted(false);
+    t->applyBlendStamps({{16, 48, 4, 1, 1}});
+    EXPECT_NEAR(uploaded(16, 48, 0), 1, 1 / 255.0f);
+    mRoot->getWorkQueue()->setRequestsAccepted(true);
+
+    // a queue may also drop the task without telling, then waiting uploads instead
+    mRoot->setWorkQueue(new DroppingWorkQueue);
+    t->applyBlendStamps({{48, 16, 4, 1, 1}});
+    EXPECT_EQ(uploaded(48, 16, 0), 0);
+    t->waitForDerivedProcesses();
+    EXPECT_NEAR(uploaded(48, 16, 0), 1, 1 / 255.0f);
+
+    OGRE_DELETE t;
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, blendMapDirtyBoxes)
+{
+    MemoryTextureManager texMgr;
+    mTerrainOpts->setLayerBlendMapSize(64);
+
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Image img;
+    img.load("terrain.png", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    Terrain::ImportData imp;
+    imp.inputImage = &img;
+    imp.terrainSize = 129;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 17;
+    imp.maxBatchSize = 33;
+    imp.layerList.resize(1);
+    ASSERT_TRUE(t->prepare(imp));
+    t->addLayer(Real(100));
+
+    auto buffer = static_cast<MemoryPixelBuffer*>(t->getLayerBlendTexture(0)->getBuffer().get());
+    auto uploaded = [buffer](int x, int y) { return buffer->mData.getColourAt(x, y, 0).r; };
+    TerrainLayerBlendMap* map = t->getLayerBlendMap(1);
+    // modified without marking it dirty
+    auto sneak = [map](int x, int y) { map->getBlendPointer()[y * 64 + x] = 1; };
+
+    // disjoint regions are uploaded separately
+    map->setBlendValue(4, 4, 1);
+    map->setBlendValue(20, 20, 1);
+    sneak(12, 12);
+    map->update();
+    EXPECT_EQ(uploaded(4, 4), 1);
+    EXPECT_EQ(uploaded(20, 20), 1);
+    EXPECT_EQ(uploaded(12, 12), 0);
+
+    // overlapping ones are merged
+    map->dirtyRect(Rect(30, 30, 34, 34));
+    map->dirtyRect(Rect(32, 32, 36, 36));
+    map->dirtyRect(Rect(36, 30, 38, 32));
+    sneak(35, 35);
+    sneak(37, 31);
+    map->update();
+    EXPECT_EQ(uploaded(35, 35), 1);
+    EXPECT_EQ(uploaded(37, 31), 1);
+    EXPECT_EQ(uploaded(12, 12), 0);
+
+    // beyond MAX_DIRTY_BOXES, everything collapses into the bounding box
+    // the regions added afterwards are kept separately again
+    for (int i = 0; i < 20; i++)
+        map->setBlendValue(2 * i, 50, 1);
+    sneak(13, 50);
+    sneak(35, 50);
+    map->update();
+    for (int i = 0; i < 20; i++)
+        EXPECT_EQ(uploaded(2 * i, 50), 1);
+    EXPECT_EQ(uploaded(13, 50), 1);
+    EXPECT_EQ(uploaded(35, 50), 0);
+    EXPECT_EQ(uploaded(12, 12), 0);
+
+    OGRE_DELETE t;
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, parallelDerivedData)
+{
+    DefaultHardwareBufferManager hbm;
+    MemoryTextureManager texMgr;
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->setWorkerThreadCount(3);
+    wq->startup();
+
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Image img;
+    img.load("terrain.png", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    Terrain::ImportData imp;
+    imp.inputImage = &img;
+    imp.inputScale = 200;
+    imp.terrainSize = 129;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 17;
+    imp.maxBatchSize = 33;
+    ASSERT_TRUE(t->prepare(imp));
+    t->_setNormalMapRequired(true);
+    t->_setLightMapRequired(true, false);
+    t->waitForDerivedProcesses();
+
+    typedef std::vector<float> Values;
+    auto bytes = [](const void* data, size_t size) { return std::vector<uchar>((const uchar*)data, (const uchar*)data + size); };
+    auto takeBox = [&bytes](PixelBox* box) {
+        auto ret = bytes(box->data, box->getConsecutiveSize());
+        OGRE_FREE(box->data, MEMCATEGORY_GENERAL);
+        OGRE_DELETE box;
+        return ret;
+    };
+    auto texture = [&bytes](const TexturePtr& tex) {
+        const Image& data = static_cast<MemoryPixelBuffer*>(tex->getBuffer().get())->mData;
+        return bytes(data.getData(), data.getSize());
+    };
+    // the maximum delta of every quadtree node and LOD
+    std::function<void(TerrainQuadTreeNode*, bool, Values&)> lodDeltas = [&](TerrainQuadTreeNode* node, bool calc, Values& out) {
+        for (uint16 lod = 0; lod < node->getLodCount(); lod++)
+            out.push_back(calc ? node->getLodLevel(lod)->calcMaxHeightDelta : node->getLodLevel(lod)->maxHeightDelta);
+        if (!node->isLeaf())
+            for (unsigned short i = 0; i < 4; i++)
+                lodDeltas(node->getChild(i), calc, out);
+    };
+
+    struct DerivedData
+    {
+        Values calcLodDeltas, lodDeltas, deltas;
+        std::vector<uchar> normals, lightmap, normalMap, lightmapTexture;
+    };
+    Rect all(0, 0, t->getSize(), t->getSize());
+    auto derive = [&]() {
+        DerivedData d;
+        // directly, what the background request does
+        t->calculateHeightDeltas(all);
+        lodDeltas(t->getQuadTree(), true, d.calcLodDeltas);
+        Rect finalRect;
+        d.normals = takeBox(t->calculateNormals(all, finalRect));
+        d.lightmap = takeBox(t->calculateLightmap(all, Rect(), finalRect));
+
+        // through updateDerivedDataImpl, including finalising
+        memset(const_cast<float*>(t->getDeltaData()), 0, sizeof(float) * t->getSize() * t->getSize());
+        t->dirty();
+        t->updateDerivedData(true);
+        EXPECT_FALSE(t->isDerivedDataUpdateInProgress());
+        lodDeltas(t->getQuadTree(), false, d.lodDeltas);
+        d.deltas.assign(t->getDeltaData(), t->getDeltaData() + t->getSize() * t->getSize());
+        d.normalMap = texture(t->getTerrainNormalMap());
+        d.lightmapTexture = texture(t->getLightmap());
+        return d;
+    };
+
+    DerivedData parallel = derive();
+    // parallelFor runs everything on the calling thread
+    wq->setWorkerThreadCount(0);
+    DerivedData serial = derive();
+
+    EXPECT_EQ(parallel.calcLodDeltas, serial.calcLodDeltas);
+    EXPECT_EQ(parallel.normals, serial.normals);
+    EXPECT_EQ(parallel.lightmap, serial.lightmap);
+    EXPECT_EQ(parallel.lodDeltas, serial.lodDeltas);
+    EXPECT_EQ(parallel.deltas, serial.deltas);
+    EXPECT_EQ(parallel.normalMap, serial.normalMap);
+    EXPECT_EQ(parallel.lightmapTexture, serial.lightmapTexture);
+    // not trivially equal
+    EXPECT_NE(*std::max_element(serial.lodDeltas.begin(), serial.lodDeltas.end()), 0);
+    EXPECT_NE(serial.normals, std::vector<uchar>(serial.normals.size()));
+
+    OGRE_DELETE t;
+    wq->shutdown();
+}
+//--------------------------------------------------------------------------
+TEST_F(TerrainTests, heightDeltas)
+{
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+    Image img;
+    img.load("terrain.png", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+    Terrain::ImportData imp;
+    imp.inputImage = &img;
+    imp.inputScale = 200;
+    imp.terrainSize = 129;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 17;
+    imp.maxBatchSize = 33;
+    ASSERT_TRUE(t->prepare(imp));
+
+    typedef std::vector<float> Values;
+    std::function<void(TerrainQuadTreeNode*, Values&)> lodDeltas = [&](TerrainQuadTreeNode* node, Values& out) {
+        for (uint16 lod = 0; lod < node->getLodCount(); lod++)
+            out.push_back(node->getLodLevel(lod)->calcMaxHeightDelta);
+        if (!node->isLeaf())
+            for (unsigned short i = 0; i < 4; i++)
+                lodDeltas(node->getChild(i), out);
+    };
+
+    // the per vertex algorithm, notifying the quadtree of every vertex
+    const int size = t->getSize();
+    const Real scale = t->getWorldSize() / Real(size - 1), base = -t->getWorldSize() * 0.5f;
+    auto point = [&](int x, int y) { return Vector3(x * scale + base, y * scale + base, *t->getHeightData(x, y)); };
+    Values expectedDeltas(size * size);
+    t->getQuadTree()->preDeltaCalculation(Rect(0, 0, size, size));
+    for (int targetLevel = 1; targetLevel < t->getNumLodLevels(); ++targetLevel)
+    {
+        int step = 1 << targetLevel;
+        for (int j = 0; j < size - step; j += step)
+        {
+            for (int i = 0; i < size - step; i += step)
+            {
+                Vector3 v0 = point(i, j), v1 = point(i + step, j), v2 = point(i, j + step),
+                        v3 = point(i + step, j + step);
+                bool backwardTri = (j / step) % 2 != 0;
+                Vector4 t1 = backwardTri ? Math::calculateFaceNormalWithoutNormalize(v1, v3, v2)
+                                         : Math::calculateFaceNormalWithoutNormalize(v0, v1, v3);
+                Vector4 t2 = backwardTri ? Math::calculateFaceNormalWithoutNormalize(v0, v1, v2)
+                                         : Math::calculateFaceNormalWithoutNormalize(v0, v3, v2);
+
+                for (int y = 0; y <= (j == size - step ? step : step - 1); y++)
+                {
+                    for (int x = 0; x <= (i == size - step ? step : step - 1); x++)
+                    {
+                        if ((i + x) % step == 0 && (j + y) % step == 0)
+                            continue;
+                        Real ypct = Real(y) / step, xpct = Real(x) / step;
+                        Vector3 actualPos = point(i + x, j + y);
+                        const Vector4& plane =
+                            (xpct > ypct && !backwardTri) || (xpct > (1 - ypct) && backwardTri) ? t1 : t2;
+                        Real delta = (-plane.x * actualPos.x - plane.y * actualPos.y - plane.w) / plane.z - actualPos.z;
+
+                        t->getQuadTree()->notifyDelta(i + x, j + y, targetLevel - 1, delta);
+                        int halfStep = step / 2;
+                        if (((i + x) % step == halfStep && (j + y) % halfStep == 0) ||
+                            ((j + y) % step == halfStep && (i + x) % halfStep == 0))
+                            expectedDeltas[i + x + (j + y) * size] = delta;
+                    }
+                }
+            }
+        }
+    }
+    Values expectedLodDeltas;
+    lodDeltas(t->getQuadTree(), expectedLodDeltas);
+
+    // tiled, reduced per cell of the minimum batch size
+    memset(const_cast<float*>(t->getDeltaData()), 0, sizeof(float) * size * size);
+    t->calculateHeightDeltas(Rect(0, 0, size, size));
+    Values actualLodDeltas;
+    lodDeltas(t->getQuadTree(), actualLodDeltas);
+
+    EXPECT_EQ(actualLodDeltas, expectedLodDeltas);
+    EXPECT_EQ(Values(t->getDeltaData(), t->getDeltaData() + size * size), expectedDeltas);
+    EXPECT_NE(*std::max_element(expectedLodDeltas.begin(), expectedLodDeltas.end()), 0);
+
+    OGRE_DELETE t;
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,437 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <gtest/gtest.h>
+
+#include "OgreBuildSettings.h"
+#include "OgreRoot.h"
+#include "OgreFileSystemLayer.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMaterialManager.h"
+#include "OgreSceneManager.h"
+#include "OgreVolumeCacheSource.h"
+#include "OgreVolumeChunk.h"
+#include "OgreVolumeCSGSource.h"
+#include "OgreVolumeHalfFloatGridSource.h"
+#include "OgreVolumeMeshBuilder.h"
+#include "OgreVolumeDualGridGenerator.h"
+#include "OgreVolumeIsoSurfaceMC.h"
+#include "OgreVolumeOctreeNode.h"
+#include "OgreVolumeOctreeNodeSplitPolicy.h"
+#include "OgreWorkQueue.h"
+
+#include <atomic>
+#include <map>
+#include <set>
+#include <thread>
+
+using namespace Ogre;
+using namespace Ogre::Volume;
+
+namespace
+{
+    std::vector<Vector3> gridPositions(Real extent, int steps)
+    {
+        std::vector<Vector3> positions;
+        Real step = 2 * extent / (steps - 1);
+        for (int z = 0; z < steps; z++)
+            for (int y = 0; y < steps; y++)
+                for (int x = 0; x < steps; x++)
+                    positions.push_back(Vector3(-extent + x * step, -extent + y * step, -extent + z * step));
+        return positions;
+    }
+
+    struct MeshData : public MeshBuilderCallback
+    {
+        VecVertex vertices;
+        VecIndices indices;
+
+        void ready(const SimpleRenderable*, const VecVertex& v, const VecIndices& i, size_t, int) override
+        {
+            vertices = v;
+            indices = i;
+        }
+        bool operator==(const MeshData& o) const
+        {
+            // vertices are welded bitwise, so compare them the same way
+            return indices == o.indices && vertices.size() == o.vertices.size() &&
+                   (vertices.empty() || !memcmp(vertices.data(), o.vertices.data(), vertices.size() * sizeof(Vertex)));
+        }
+    };
+
+    MeshData getMesh(const MeshBuilder& mb)
+    {
+        MeshData mesh;
+        mb.executeCallback(&mesh, NULL, 0, 0);
+        return mesh;
+    }
+
+    // a source which can be modified after loading a chunk tree
+    struct SwitchableSource : public Source
+    {
+        const Source* src;
+        Vector4 getValueAndGradient(const Vector3& position) const override { return src->getValueAndGradient(position); }
+        Real getValue(const Vector3& position) const override { return src->getValue(position); }
+    };
+
+    // the last mesh built for each chunk
+    struct ChunkMeshes : public MeshBuilderCallback
+    {
+        std::map<const SimpleRenderable*, MeshData> meshes;
+        std::set<const SimpleRenderable*> built;
+
+        void ready(const SimpleRenderable* chunk, const VecVertex& v, const VecIndices& i, size_t level, int inProcess) override
+        {
+            meshes[chunk].ready(chunk, v, i, level, inProcess);
+            built.insert(chunk);
+        }
+    };
+
+    // two triangles per quad of a bumpy grid, the inner vertices are shared by six triangles
+    void addGridTriangles(MeshBuilder& mb, int from, int to)
+    {
+        auto pos = [](int x, int y) { return Vector3(x, y, (x * y) % 3); };
+        for (int i = from; i < to; i++)
+        {
+            int x = i % 8, y = i / 8;
+            mb.addTriangle(pos(x, y), Vector3::UNIT_Z, pos(x + 1, y), Vector3::UNIT_Z, pos(x + 1, y + 1), Vector3::UNIT_Z);
+            mb.addTriangle(pos(x, y), Vector3::UNIT_Z, pos(x + 1, y + 1), Vector3::UNIT_Z, pos(x, y + 1), Vector3::UNIT_Z);
+        }
+    }
+}
+
+TEST(VolumeCacheSource, MatchesSource)
+{
+    CSGSphereSource sphere(5, Vector3::ZERO);
+    CSGCubeSource cube(Vector3(-3, -3, -3), Vector3(3, 3, 3));
+    CSGDifferenceSource src(&sphere, &cube);
+    auto positions = gridPositions(6, 20);
+
+    // small enough to replace entries
+    const size_t budget = 64 * 1024;
+    CacheSource cache(&src, budget);
+    EXPECT_LT(cache.getCapacity(), positions.size());
+    EXPECT_EQ(cache.getMemoryUsage(), 0u);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (const auto& p : positions)
+        {
+            ASSERT_EQ(cache.getValueAndGradient(p), src.getValueAndGradient(p));
+            ASSERT_EQ(cache.getValue(p), src.getValue(p));
+        }
+
+        std::vector<Vector4> values(positions.size());
+        cache.getValuesAndGradients(positions.data(), values.data(), positions.size());
+        for (size_t i = 0; i < positions.size(); i++)
+            ASSERT_EQ(values[i], src.getValueAndGradient(positions[i]));
+    }
+    EXPECT_GT(cache.getMemoryUsage(), 0u);
+    // the victim counters add a byte per set
+    EXPECT_LE(cache.getMemoryUsage(), budget + cache.getCapacity());
+
+    cache.clear();
+    EXPECT_EQ(cache.getMemoryUsage(), 0u);
+    EXPECT_EQ(cache.getValueAndGradient(positions[0]), src.getValueAndGradient(positions[0]));
+}
+
+TEST(VolumeCacheSource, GrowsLazily)
+{
+    CSGSphereSource src(5, Vector3::ZERO);
+    CacheSource cache(&src);
+    auto positions = gridPositions(6, 3);
+    for (const auto& p : positions)
+        EXPECT_EQ(cache.getValueAndGradient(p), src.getValueAndGradient(p));
+
+    // a few sets per touched stripe, not the whole budget
+    EXPECT_GT(cache.getMemoryUsage(), 0u);
+    EXPECT_LT(cache.getMemoryUsage(), 64 * 1024u);
+    EXPECT_GE(cache.getCapacity() * sizeof(Vector4), 8 * 1024 * 1024u);
+
+    // all cached now
+    for (const auto& p : positions)
+        EXPECT_EQ(cache.getValueAndGradient(p), src.getValueAndGradient(p));
+}
+
+#if OGRE_THREAD_SUPPORT
+TEST(VolumeCacheSource, ConcurrentAccess)
+{
+    CSGSphereSource sphere(5, Vector3::ZERO);
+    CSGNegateSource src(&sphere);
+    auto positions = gridPositions(6, 24);
+
+    // threads fill, grow and evict the same stripes at the same time
+    CacheSource cache(&src, 256 * 1024);
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for (int pass = 0; pass < 3; pass++)
+            {
+                if (t % 2)
+                {
+                    std::vector<Vector4> values(positions.size());
+                    cache.getValuesAndGradients(positions.data(), values.data(), positions.size());
+                    for (size_t i = 0; i < positions.size(); i++)
+                        mismatches += values[i] != src.getValueAndGradient(positions[i]);
+                    continue;
+                }
+                for (size_t i = 0; i < positions.size(); i++)
+                {
+                    const Vector3& p = positions[t ? positions.size() - 1 - i : i];
+                    mismatches += cache.getValueAndGradient(p) != src.getValueAndGradient(p);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(mismatches, 0);
+}
+#endif
+
+TEST(VolumeSource, BatchedMatchesScalar)
+{
+    Root root("");
+
+    CSGSphereSource sphere(4, Vector3(0.5, 0, 0));
+    CSGPlaneSource plane(1, Vector3::UNIT_Y);
+    CSGCubeSource cube(Vector3(-3, -2, -3), Vector3(2, 3, 1));
+    CSGIntersectionSource intersection(&sphere, &cube);
+    CSGUnionSource unionSource(&sphere, &plane);
+    CSGDifferenceSource difference(&cube, &sphere);
+    CSGNegateSource negate(&sphere);
+    CSGScaleSource scale(&cube, 1.5);
+    Real frequencies[] = {1.01, 0.48};
+    Real amplitudes[] = {0.25, 0.5};
+    CSGNoiseSource noise(&sphere, frequencies, amplitudes, 2, 42);
+    CacheSource cache(&difference, 64 * 1024);
+
+    sphere.serialize(Vector3(-6, -6, -6), Vector3(6, 6, 6), 0.5, "VolumeBatchTest.dat");
+    HalfFloatGridSource grid("VolumeBatchTest.dat");
+    HalfFloatGridSource gridNearest("VolumeBatchTest.dat", false);
+    HalfFloatGridSource gridTrilinear("VolumeBatchTest.dat", true, true);
+    HalfFloatGridSource gridSobel("VolumeBatchTest.dat", true, false, true);
+
+    std::vector<std::pair<const char*, const Source*> > sources = {
+        {"sphere", &sphere}, {"plane", &plane}, {"cube", &cube},
+        {"intersection", &intersection}, {"union", &unionSource}, {"difference", &difference},
+        {"negate", &negate}, {"scale", &scale}, {"noise", &noise}, {"cache", &cache},
+        {"grid", &grid}, {"gridNearest", &gridNearest}, {"gridTrilinear", &gridTrilinear},
+        {"gridSobel", &gridSobel}};
+
+    // not aligned to the voxels of the grids
+    auto samples = gridPositions(5.3, 17);
+    // the grids start at their origin, negative positions would not map to any voxel
+    auto gridSamples = samples;
+    for (auto& p : gridSamples)
+        p += Vector3(6, 6, 6);
+
+    for (const auto& s : sources)
+    {
+        SCOPED_TRACE(s.first);
+        const Source* src = s.second;
+        const auto& positions = dynamic_cast<const GridSource*>(src) ? gridSamples : samples;
+        std::vector<Vector4> values(positions.size());
+        std::vector<Real> densities(positions.size());
+        src->getValuesAndGradients(positions.data(), values.data(), positions.size());
+        src->getValues(positions.data(), densities.data(), positions.size());
+
+        size_t mismatches = 0;
+        // bit identical, the batches do the same operations in the same order
+        for (size_t i = 0; i < positions.size(); i++)
+            mismatches += values[i] != src->getValueAndGradient(positions[i]) ||
+                          densities[i] != src->getValue(positions[i]);
+        EXPECT_EQ(mismatches, 0u);
+    }
+
+    FileSystemLayer::removeFile("VolumeBatchTest.dat");
+}
+
+TEST(VolumeMeshBuilder, ReserveKeepsMesh)
+{
+    MeshBuilder plain;
+    addGridTriangles(plain, 0, 64);
+    MeshData expected = getMesh(plain);
+    // 9x9 grid points
+    ASSERT_EQ(expected.vertices.size(), 81u);
+    ASSERT_EQ(expected.indices.size(), 64u * 6);
+
+    MeshBuilder reserved;
+    reserved.reserve(81, 64 * 6);
+    addGridTriangles(reserved, 0, 64);
+    EXPECT_TRUE(getMesh(reserved) == expected);
+    EXPECT_EQ(reserved.getBoundingBox(), plain.getBoundingBox());
+
+    // too small, reserved midway and shrinking requests are all fine
+    MeshBuilder grown;
+    grown.reserve(4, 6);
+    addGridTriangles(grown, 0, 20);
+    grown.reserve(200, 1000);
+    addGridTriangles(grown, 20, 40);
+    grown.reserve(1, 1);
+    addGridTriangles(grown, 40, 64);
+    EXPECT_TRUE(getMesh(grown) == expected);
+    EXPECT_EQ(grown.getBoundingBox(), plain.getBoundingBox());
+}
+
+TEST(VolumeMeshBuilder, AppendMatchesDirect)
+{
+    MeshBuilder direct;
+    addGridTriangles(direct, 0, 64);
+    MeshData expected = getMesh(direct);
+
+    // the parts share the vertices along their seams
+    MeshBuilder parts[3];
+    addGridTriangles(parts[0], 0, 19);
+    addGridTriangles(parts[1], 19, 45);
+    addGridTriangles(parts[2], 45, 64);
+
+    MeshBuilder merged;
+    for (const auto& part : parts)
+        merged.append(part);
+    merged.append(MeshBuilder());
+    EXPECT_TRUE(getMesh(merged) == expected);
+    EXPECT_EQ(merged.getBoundingBox(), direct.getBoundingBox());
+
+    // appending to a builder which already holds triangles
+    MeshBuilder mixed;
+    addGridTriangles(mixed, 0, 30);
+    MeshBuilder rest;
+    addGridTriangles(rest, 30, 64);
+    mixed.append(rest);
+    EXPECT_TRUE(getMesh(mixed) == expected);
+}
+
+TEST(VolumeDualGridGenerator, ParallelMatchesSerial)
+{
+    Root root("");
+    WorkQueue* wq = root.getWorkQueue();
+    wq->setWorkerThreadCount(3);
+    wq->startup();
+
+    CSGSphereSource sphere(6, Vector3(0.3, -0.2, 0.1));
+    CSGCubeSource cube(Vector3(-2, -9, -2), Vector3(3, 2, 9));
+    CSGDifferenceSource src(&sphere, &cube);
+    IsoSurfaceMC is(&src);
+    Vector3 from(-8, -8, -8), to(8, 8, 8);
+
+    for (Real error : {Real(0.5), Real(1), Real(2)})
+    {
+        SCOPED_TRACE(error);
+        OctreeNodeSplitPolicy policy(&src, error);
+
+        // the same subdivision as the chunks use
+        OctreeNode serialRoot(from, to);
+        serialRoot.split(&policy, &src, error);
+        MeshBuilder serial;
+        DualGridGenerator serialGenerator;
+        serialGenerator.generateDualGrid(&serialRoot, &is, &serial, error, from, to, false);
+
+        OctreeNode parallelRoot(from, to);
+        parallelRoot.split(&policy, &src, error, 2);
+        MeshBuilder parallel;
+        DualGridGenerator parallelGenerator;
+        parallelGenerator.generateDualGrid(&parallelRoot, &is, &parallel, error, from, to, false, true);
+
+        MeshData expected = getMesh(serial);
+        ASSERT_FALSE(expected.indices.empty());
+        // the 27 steps are merged in the order of the serial traversal
+        EXPECT_TRUE(getMesh(parallel) == expected);
+        EXPECT_EQ(parallel.getBoundingBox(), serial.getBoundingBox());
+    }
+
+    wq->shutdown();
+}
+
+TEST(VolumeChunk, UpdateRemeshesRegion)
+{
+    Root root("");
+    DefaultHardwareBufferManager hbm;
+    MaterialManager::getSingleton().initialise();
+    SceneManager* sm = root.createSceneManager();
+    // the chunks are meshed on the workers
+    WorkQueue* wq = root.getWorkQueue();
+    wq->setWorkerThreadCount(1);
+    wq->startup();
+
+    CSGSphereSource sphere(6, Vector3::ZERO);
+    CSGSphereSource bump(1.5, Vector3(4, 4, 4));
+    CSGUnionSource bumped(&sphere, &bump);
+    SwitchableSource src;
+    src.src = &sphere;
+
+    Vector3 from(-8, -8, -8), to(8, 8, 8);
+    const size_t levels = 3;
+    ChunkParameters parameters;
+    parameters.sceneManager = sm;
+    parameters.src = &src;
+    parameters.baseError = 0.5;
+    parameters.skirtFactor = 0.7;
+
+    ChunkMeshes updatedMeshes;
+    parameters.lodCallback = &updatedMeshes;
+    Chunk updated;
+    updated.load(sm->getRootSceneNode()->createChildSceneNode(), from, to, levels, &parameters);
+    size_t loaded = updatedMeshes.built.size();
+    // the root, 8 octants and their leaves
+    ASSERT_EQ(loaded, 17u);
+
+    // the bump only touches the chunks of one octant
+    src.src = &bumped;
+    updatedMeshes.built.clear();
+    updated.update(Vector3(2, 2, 2), Vector3(6, 6, 6));
+    EXPECT_EQ(updatedMeshes.built.size(), levels);
+    EXPECT_EQ(updated.getChunkParameters()->updateFrom, Vector3::ZERO);
+    EXPECT_EQ(updated.getChunkParameters()->updateTo, Vector3::ZERO);
+
+    // the same as loading the modified volume from scratch
+    ChunkMeshes freshMeshes;
+    parameters.lodCallback = &freshMeshes;
+    Chunk fresh;
+    fresh.load(sm->getRootSceneNode()->createChildSceneNode(), from, to, levels, &parameters);
+    ASSERT_EQ(freshMeshes.built.size(), loaded);
+
+    for (size_t level = 0; level < levels; level++)
+    {
+        SCOPED_TRACE(level);
+        Chunk::VecChunk updatedChunks, freshChunks;
+        updated.getChunksOfLevel(level, updatedChunks);
+        fresh.getChunksOfLevel(level, freshChunks);
+        ASSERT_EQ(updatedChunks.size(), freshChunks.size());
+        for (size_t i = 0; i < freshChunks.size(); i++)
+        {
+            EXPECT_TRUE(updatedMeshes.meshes[updatedChunks[i]] == freshMeshes.meshes[freshChunks[i]]);
+            EXPECT_EQ(updatedChunks[i]->getBoundingBox(), freshChunks[i]->getBoundingBox());
+        }
+    }
+
+    wq->shutdown();
+}
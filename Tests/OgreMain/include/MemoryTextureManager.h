@@ -0,0 +1,96 @@
+// This file is part of the OGRE project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at https://www.ogre3d.org/licensing.
+// SPDX-License-Identifier: MIT
+
+#ifndef TESTS_OGREMAIN_INCLUDE_MEMORYTEXTUREMANAGER_H_
+#define TESTS_OGREMAIN_INCLUDE_MEMORYTEXTUREMANAGER_H_
+
+#include "OgreTextureManager.h"
+#include "OgreHardwarePixelBuffer.h"
+#include "OgreImage.h"
+
+namespace Ogre
+{
+/// video memory stand-in, so textures can be used without a render system
+struct MemoryPixelBuffer : public HardwarePixelBuffer
+{
+    Image mData;
+    MemoryPixelBuffer(uint32 width, uint32 height, PixelFormat format)
+        : HardwarePixelBuffer(width, height, 1, format, HBU_CPU_ONLY, false), mData(format, width, height)
+    {
+    }
+    PixelBox lockImpl(const Box& lockBox, LockOptions) override { return mData.getPixelBox().getSubVolume(lockBox); }
+    void unlockImpl() override {}
+    void blitFromMemory(const PixelBox& src, const Box& dstBox) override
+    {
+        PixelUtil::bulkPixelConversion(src, mData.getPixelBox().getSubVolume(dstBox));
+    }
+    void blitToMemory(const Box& srcBox, const PixelBox& dst) override
+    {
+        PixelUtil::bulkPixelConversion(mData.getPixelBox().getSubVolume(srcBox), dst);
+    }
+};
+
+class MemoryTexture : public Texture
+{
+    std::vector<HardwarePixelBufferSharedPtr> mBuffers;
+
+public:
+    MemoryTexture(ResourceManager* creator, const String& name, ResourceHandle handle, const String& group)
+        : Texture(creator, name, handle, group)
+    {
+    }
+    ~MemoryTexture() { unload(); }
+    const HardwarePixelBufferSharedPtr& getBuffer(size_t, size_t mipmap) override { return mBuffers.at(mipmap); }
+
+protected:
+    void createInternalResourcesImpl() override
+    {
+        for (uint32 mip = 0; mip <= mNumMipmaps; mip++)
+            mBuffers.push_back(std::make_shared<MemoryPixelBuffer>(std::max(mWidth >> mip, 1u),
+                                                                   std::max(mHeight >> mip, 1u), mFormat));
+    }
+    void freeInternalResourcesImpl() override { mBuffers.clear(); }
+    // the default path queries the render system capabilities
+    void prepareImpl() override {}
+    void loadImpl() override
+    {
+        Image img;
+        img.load(mName, mGroup);
+        _loadImages({&img});
+    }
+};
+
+/// creates MemoryTexture instances
+struct MemoryTextureManager : public DefaultTextureManager
+{
+    Resource* createImpl(const String& name, ResourceHandle handle, const String& group, bool,
+                         ManualResourceLoader*, const NameValuePairList*) override
+    {
+        return new MemoryTexture(this, name, handle, group);
+    }
+    using TextureManager::createManual;
+    // the default path checks the render system capabilities
+    TexturePtr createManual(const String& name, const String& group, TextureType texType, uint width,
+                            uint height, uint depth, int numMipmaps, PixelFormat format, int usage,
+                            ManualResourceLoader* loader, bool hwGamma, uint fsaa,
+                            const String& fsaaHint) override
+    {
+        TexturePtr ret = create(name, group, true, loader);
+        ret->setTextureType(texType);
+        ret->setWidth(width);
+        ret->setHeight(height);
+        ret->setDepth(depth);
+        ret->setNumMipmaps(numMipmaps == MIP_DEFAULT ? mDefaultNumMipmaps : uint32(numMipmaps));
+        ret->setFormat(format);
+        ret->setUsage(usage);
+        ret->setHardwareGammaEnabled(hwGamma);
+        ret->setFSAA(fsaa, fsaaHint);
+        ret->createInternalResources();
+        return ret;
+    }
+};
+}
+
+#endif /* TESTS_OGREMAIN_INCLUDE_MEMORYTEXTUREMANAGER_H_ */
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreEntity.h"
 #include "OgreCamera.h"
 #include "RootWithoutRenderSystemFixture.h"
+#include "MemoryTextureManager.h"
 #include "OgreStaticPluginLoader.h"
 
 #include "OgreMaterialSerializer.h"
@@ -43,10 +44,16 @@ THE SOFTWARE.
 #include "OgreHighLevelGpuProgramManager.h"
 #include "OgreMeshManager.h"
 #include "OgreMesh.h"
+#include "OgreSubMesh.h"
+#include "OgreSubEntity.h"
+#include "OgreMeshOptimizer.h"
+#include "OgreStaticGeometry.h"
+#include "OgreFrameListener.h"
 #include "OgreSkeletonManager.h"
 #include "OgreSkeletonInstance.h"
 #include "OgreCompositorManager.h"
 #include "OgreTextureManager.h"
+#include "OgreWorkQueue.h"
 #include "OgreFileSystem.h"
 #include "OgreArchiveManager.h"
 
@@ -56,8 +63,16 @@ THE SOFTWARE.
 
 #include "OgreBillboardSet.h"
 #include "OgreBillboard.h"
+#include "OgreRenderQueue.h"
+#include "OgreViewport.h"
+#include "OgreRenderTarget.h"
+#include "OgreSimpleRenderable.h"
 
 #include <random>
+#include <array>
+#include <set>
+#include <thread>
+#include <future>
 using std::minstd_rand;
 
 using namespace Ogre;
@@ -188,6 +203,392 @@ TEST_F(SceneNodeTest, destroyChildAndObjects)
     EXPECT_TRUE(mSceneMgr->hasEntity("sinbad"));
 }
 
+TEST_F(SceneNodeTest, ClusterCulling)
+{
+    MeshPtr mesh = MeshManager::getSingleton().load("sphere.mesh", RGN_DEFAULT)->clone("sphere_meshlets");
+    MeshOptimizer optimizer(MeshOptimizer::MO_MESHLETS);
+    optimizer.setMeshletSize(64, 32);
+    optimizer.optimise(mesh.get());
+    SubMesh* sm = mesh->getSubMesh(0);
+    ASSERT_GT(sm->meshlets.size(), 4u);
+
+    Entity* ent = mSceneMgr->createEntity(mesh);
+    mSceneMgr->getRootSceneNode()->attachObject(ent);
+    Camera* cam = mSceneMgr->createCamera("cam");
+    SceneNode* camNode = mSceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(0, 0, 500));
+    camNode->attachObject(cam);
+    mSceneMgr->getRootSceneNode()->_update(true, false);
+
+    ent->setClusterCulling(true);
+    ent->_notifyCurrentCamera(cam);
+
+    RenderOperation op;
+    ent->getSubEntity(0)->getRenderOperation(op);
+    EXPECT_NE(op.indexData, sm->indexData);
+    EXPECT_GT(op.indexData->indexCount, 0u);
+    EXPECT_LT(op.indexData->indexCount, sm->indexData->indexCount);
+
+    // every triangle facing the camera must survive
+    auto triangles = [](const IndexData* indexData) {
+        std::set<std::array<uint32, 3>> ret;
+        auto ibuf = indexData->indexBuffer;
+        HardwareBufferLockGuard lock(ibuf, HardwareBuffer::HBL_READ_ONLY);
+        for (size_t i = indexData->indexStart; i + 2 < indexData->indexStart + indexData->indexCount; i += 3)
+        {
+            std::array<uint32, 3> tri;
+            for (int j = 0; j < 3; j++)
+                tri[j] = ibuf->getType() == HardwareIndexBuffer::IT_32BIT
+                             ? static_cast<uint32*>(lock.pData)[i + j]
+                             : static_cast<uint16*>(lock.pData)[i + j];
+            ret.insert(tri);
+        }
+        return ret;
+    };
+    auto visible = triangles(op.indexData);
+
+    const VertexData* vertexData = sm->useSharedVertices ? mesh->sharedVertexData : sm->vertexData;
+    const VertexElement* posElem = vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+    auto vbuf = vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+    HardwareBufferLockGuard vlock(vbuf, HardwareBuffer::HBL_READ_ONLY);
+    auto position = [&](uint32 v) {
+        float* pos;
+        posElem->baseVertexPointerToElement((uint8*)vlock.pData + v * vbuf->getVertexSize(), &pos);
+        return Vector3(pos);
+    };
+    for (const auto& tri : triangles(sm->indexData))
+    {
+        Vector3 p0 = position(tri[0]);
+        Vector3 n = (position(tri[1]) - p0).crossProduct(position(tri[2]) - p0);
+        if (n.dotProduct(camNode->getPosition() - p0) > 0)
+        {
+            EXPECT_TRUE(visible.count(tri));
+        }
+    }
+
+    ent->setClusterCulling(false);
+    ent->getSubEntity(0)->getRenderOperation(op);
+    EXPECT_EQ(op.indexData, sm->indexData);
+}
+
+TEST_F(SceneNodeTest, StaticGeometry)
+{
+    // the vertices are copied on the worker and the calling thread
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->setWorkerThreadCount(1);
+    wq->startup();
+
+    auto& matMgr = MaterialManager::getSingleton();
+    auto groupName = ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME;
+    MaterialPtr materials[] = {matMgr.create("StaticGeometryA", groupName), matMgr.create("StaticGeometryB", groupName),
+                               matMgr.create("StaticGeometryC", groupName)};
+
+    // several meshes, instances and materials
+    Entity* sphere = mSceneMgr->createEntity("sphere.mesh");
+    sphere->setMaterial(materials[2]);
+    Entity* sphereB = mSceneMgr->createEntity("sphere.mesh");
+    sphereB->setMaterial(materials[1]);
+    Entity* head = mSceneMgr->createEntity("ogrehead.mesh");
+    ASSERT_GT(head->getNumSubEntities(), 1u);
+    for (uint i = 0; i < head->getNumSubEntities(); ++i)
+        head->getSubEntity(i)->setMaterial(materials[i % 2]);
+
+    StaticGeometry* sg = mSceneMgr->createStaticGeometry("sg");
+    sg->addEntity(sphere, Vector3(100, 50, 0), Quaternion(Degree(30), Vector3::UNIT_Y), Vector3(1, 2, 3));
+    sg->addEntity(sphereB, Vector3(-200, 0, 100));
+    // the meshes use different LOD strategies, which a region can not mix
+    sg->addEntity(head, Vector3(3000, 0, -100), Quaternion(Degree(-45), Vector3::UNIT_X), Vector3(2, 2, 2));
+    sg->addEntity(head, Vector3(3050, 100, 50), Quaternion(Degree(90), Vector3::UNIT_Z));
+    sg->addEntity(sphere, Vector3(300, 0, 300), Quaternion::IDENTITY, Vector3(0.5, 0.5, 0.5));
+    sg->build();
+
+    // fetch position and normal of every index, in order
+    auto getVertices = [](const VertexData* vertexData, const IndexData* indexData, size_t indexStart, size_t indexCount) {
+        std::vector<std::pair<Vector3, Vector3>> ret;
+        auto ibuf = indexData->indexBuffer;
+        HardwareBufferLockGuard ilock(ibuf, HardwareBuffer::HBL_READ_ONLY);
+        std::map<const HardwareBuffer*, HardwareBufferLockGuard> vlocks;
+        auto getElement = [&](VertexElementSemantic sem, uint32 v) {
+            const VertexElement* elem = vertexData->vertexDeclaration->findElementBySemantic(sem);
+            auto vbuf = vertexData->vertexBufferBinding->getBuffer(elem->getSource());
+            auto& lock = vlocks[vbuf.get()];
+            if (!lock.pData)
+                lock.lock(vbuf, HardwareBuffer::HBL_READ_ONLY);
+            float* p;
+            elem->baseVertexPointerToElement(static_cast<uint8*>(lock.pData) + v * vbuf->getVertexSize(), &p);
+            return Vector3(p);
+        };
+        for (size_t i = indexStart; i < indexStart + indexCount; ++i)
+        {
+            uint32 v = ibuf->getType() == HardwareIndexBuffer::IT_32BIT ? static_cast<uint32*>(ilock.pData)[i]
+                                                                         : static_cast<uint16*>(ilock.pData)[i];
+            ret.emplace_back(getElement(VES_POSITION, v), getElement(VES_NORMAL, v));
+        }
+        return ret;
+    };
+
+    // every bucket holds its queued geometry back to back, transformed into region space
+    size_t geometries = 0;
+    std::set<String> materialNames;
+    for (const auto& r : sg->getRegions())
+    {
+        StaticGeometry::Region* region = r.second;
+        for (const auto& mb : region->getLODBuckets()[0]->getMaterialBuckets())
+        {
+            materialNames.insert(mb.first);
+            for (auto gb : mb.second->getGeometryList())
+            {
+                auto dst = getVertices(gb->getVertexData(), gb->getIndexData(), gb->getIndexData()->indexStart,
+                                       gb->getIndexData()->indexCount);
+                size_t offset = 0;
+                for (auto geom : gb->getQueuedGeometry())
+                {
+                    const IndexData* indexData = geom->geometry->indexData;
+                    auto src = getVertices(geom->geometry->vertexData, indexData, indexData->indexStart,
+                                           indexData->indexCount);
+                    ASSERT_LE(offset + src.size(), dst.size());
+                    // the same expressions as a scalar per vertex transform, so bit identical
+                    for (size_t i = 0; i < src.size(); ++i)
+                    {
+                        const auto& d = dst[offset + i];
+                        Vector3 pos = geom->orientation * (src[i].first * geom->scale) + geom->position;
+                        pos -= region->getCentre();
+                        EXPECT_EQ(Vector3(Vector3f(pos)), d.first);
+                        Vector3 normal = geom->orientation * (src[i].second / geom->scale).normalisedCopy();
+                        EXPECT_EQ(Vector3(Vector3f(normal)), d.second);
+                    }
+                    offset += src.size();
+                    geometries++;
+                }
+                EXPECT_EQ(offset, dst.size());
+            }
+        }
+    }
+    EXPECT_EQ(geometries, 3 + 2 * head->getNumSubEntities());
+    EXPECT_EQ(materialNames, std::set<String>({"StaticGeometryA", "StaticGeometryB", "StaticGeometryC"}));
+
+    wq->shutdown();
+}
+
+/// Runs the pending tasks of a WorkQueue with a single worker and then the main thread tasks
+static void waitForWorkQueue(WorkQueue* wq)
+{
+    // the worker runs the tasks in order, so everything queued before is done with this
+    std::promise<void> done;
+    wq->addTask([&done]() { done.set_value(); });
+    done.get_future().wait();
+    wq->processMainThreadTasks();
+}
+
+TEST_F(SceneNodeTest, StaticGeometryParallel)
+{
+    Entity* sphere = mSceneMgr->createEntity("sphere.mesh");
+    auto build = [&](const String& name) {
+        StaticGeometry* sg = mSceneMgr->createStaticGeometry(name);
+        // several instances per region, in several regions
+        sg->setRegionDimensions(Vector3(400));
+        for (int i = 0; i < 16; i++)
+        {
+            sg->addEntity(sphere, Vector3(100 * i, 50, -20 * i), Quaternion(Degree(30 * i), Vector3::UNIT_Y),
+                          Vector3(1, 2, 3));
+            sg->addEntity(sphere, Vector3(-100 * i, 0, 100), Quaternion(Degree(-45), Vector3::UNIT_X),
+                          Vector3(0.5f * i + 1));
+        }
+        sg->build();
+        return sg;
+    };
+
+    // without worker threads everything is copied on the calling thread
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->setWorkerThreadCount(0);
+    StaticGeometry* serial = build("serial");
+    wq->setWorkerThreadCount(3);
+    wq->startup();
+    StaticGeometry* parallel = build("parallel");
+    wq->shutdown();
+
+    auto compare = [](const HardwareBufferPtr& a, const HardwareBufferPtr& b) {
+        ASSERT_EQ(a->getSizeInBytes(), b->getSizeInBytes());
+        HardwareBufferLockGuard lockA(a, HardwareBuffer::HBL_READ_ONLY);
+        HardwareBufferLockGuard lockB(b, HardwareBuffer::HBL_READ_ONLY);
+        EXPECT_EQ(memcmp(lockA.pData, lockB.pData, a->getSizeInBytes()), 0);
+    };
+
+    size_t buckets = 0;
+    ASSERT_EQ(serial->getRegions().size(), parallel->getRegions().size());
+    for (const auto& r : serial->getRegions())
+    {
+        StaticGeometry::Region* other = parallel->getRegions().at(r.first);
+        auto& lods = r.second->getLODBuckets();
+        ASSERT_EQ(lods.size(), other->getLODBuckets().size());
+        for (size_t lod = 0; lod < lods.size(); lod++)
+        {
+            for (const auto& mb : lods[lod]->getMaterialBuckets())
+            {
+                const auto& geometry = mb.second->getGeometryList();
+                const auto& otherGeometry = other->getLODBuckets()[lod]->getMaterialBuckets().at(mb.first)->getGeometryList();
+                ASSERT_EQ(geometry.size(), otherGeometry.size());
+                for (size_t i = 0; i < geometry.size(); i++)
+                {
+                    const VertexBufferBinding* binds = geometry[i]->getVertexData()->vertexBufferBinding;
+                    for (ushort b = 0; b < binds->getBufferCount(); ++b)
+                        compare(binds->getBuffer(b), otherGeometry[i]->getVertexData()->vertexBufferBinding->getBuffer(b));
+                    compare(geometry[i]->getIndexData()->indexBuffer, otherGeometry[i]->getIndexData()->indexBuffer);
+                    buckets++;
+                }
+            }
+        }
+    }
+    EXPECT_GT(buckets, 1u);
+}
+
+TEST_F(SceneNodeTest, StaticGeometryRegions)
+{
+    Entity* ent = mSceneMgr->createEntity("sphere.mesh");
+
+    StaticGeometry* sg = mSceneMgr->createStaticGeometry("sg");
+    for (int i = 0; i < 3; ++i)
+        sg->addEntity(ent, Vector3(i * 3000, 0, 0));
+    sg->build();
+    ASSERT_EQ(sg->getRegions().size(), 3u);
+    sg->saveRegions("StaticGeometryRegions.bin");
+
+    auto getGeometry = [](StaticGeometry::Region* region) {
+        auto gb = region->getLODBuckets()[0]->getMaterialBuckets().begin()->second->getGeometryList()[0];
+        return gb;
+    };
+
+    StaticGeometry* loaded = mSceneMgr->createStaticGeometry("loaded");
+    loaded->loadRegions(Root::openFileStream("StaticGeometryRegions.bin"));
+    ASSERT_EQ(loaded->getRegions().size(), 3u);
+    for (auto& r : sg->getRegions())
+    {
+        StaticGeometry::Region* region = loaded->getRegions().at(r.first);
+        ASSERT_TRUE(region->isLoaded());
+        EXPECT_EQ(region->getCentre(), r.second->getCentre());
+        EXPECT_EQ(region->getBoundingBox(), r.second->getBoundingBox());
+        EXPECT_TRUE(region->isInScene());
+
+        auto src = getGeometry(r.second);
+        auto dst = getGeometry(region);
+        EXPECT_EQ(src->getMaterial(), dst->getMaterial());
+        ASSERT_EQ(src->getVertexData()->vertexCount, dst->getVertexData()->vertexCount);
+        ASSERT_EQ(src->getIndexData()->indexCount, dst->getIndexData()->indexCount);
+
+        auto vsrc = src->getVertexData()->vertexBufferBinding->getBuffer(0);
+        auto vdst = dst->getVertexData()->vertexBufferBinding->getBuffer(0);
+        ASSERT_EQ(vsrc->getSizeInBytes(), vdst->getSizeInBytes());
+        HardwareBufferLockGuard vsrcLock(vsrc, HardwareBuffer::HBL_READ_ONLY);
+        HardwareBufferLockGuard vdstLock(vdst, HardwareBuffer::HBL_READ_ONLY);
+        EXPECT_EQ(memcmp(vsrcLock.pData, vdstLock.pData, vsrc->getSizeInBytes()), 0);
+
+        auto isrc = src->getIndexData()->indexBuffer;
+        auto idst = dst->getIndexData()->indexBuffer;
+        ASSERT_EQ(isrc->getSizeInBytes(), idst->getSizeInBytes());
+        HardwareBufferLockGuard isrcLock(isrc, HardwareBuffer::HBL_READ_ONLY);
+        HardwareBufferLockGuard idstLock(idst, HardwareBuffer::HBL_READ_ONLY);
+        EXPECT_EQ(memcmp(isrcLock.pData, idstLock.pData, isrc->getSizeInBytes()), 0);
+    }
+
+    // streaming: only the regions near the camera are loaded
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->setWorkerThreadCount(1);
+    wq->setResponseProcessingTimeLimit(0);
+    wq->startup();
+
+    struct CountingListener : public StaticGeometry::Listener
+    {
+        int loads = 0, unloads = 0;
+        void regionLoaded(StaticGeometry*, StaticGeometry::Region* region) override
+        {
+            EXPECT_TRUE(region->isLoaded());
+            loads++;
+        }
+        void regionUnloaded(StaticGeometry*, StaticGeometry::Region* region) override
+        {
+            EXPECT_TRUE(region->isLoaded());
+            unloads++;
+        }
+    } listener;
+
+    StaticGeometry* streamed = mSceneMgr->createStaticGeometry("streamed");
+    streamed->setRenderingDistance(1000);
+    streamed->setListener(&listener);
+    streamed->loadRegions(Root::openFileStream("StaticGeometryRegions.bin"), true);
+    ASSERT_EQ(streamed->getRegions().size(), 3u);
+    for (auto& r : streamed->getRegions())
+        EXPECT_FALSE(r.second->isLoaded());
+
+    Camera* cam = mSceneMgr->createCamera("cam");
+    SceneNode* camNode = mSceneMgr->getRootSceneNode()->createChildSceneNode(Vector3(0, 0, 200));
+    camNode->attachObject(cam);
+    camNode->_update(true, false);
+
+    auto loadedCount = [&]() {
+        size_t count = 0;
+        for (auto& r : streamed->getRegions())
+            count += r.second->isLoaded();
+        return count;
+    };
+    FrameEvent evt;
+    auto update = [&](const Vector3& pos) {
+        camNode->setPosition(pos);
+        camNode->_update(true, false);
+        mRoot->_fireFrameRenderingQueued(evt);
+        streamed->updateRegionStreaming(cam);
+        waitForWorkQueue(wq);
+    };
+
+    // the file is read in the background and the region only appears on the main thread
+    streamed->updateRegionStreaming(cam);
+    EXPECT_EQ(loadedCount(), 0u);
+    waitForWorkQueue(wq);
+    EXPECT_EQ(loadedCount(), 1u);
+    EXPECT_EQ(listener.loads, 1);
+    StaticGeometry::Region* first = streamed->getRegions().begin()->second;
+    EXPECT_TRUE(first->isLoaded());
+
+    // between the rendering distance and the hysteresis, regions are neither loaded nor unloaded
+    Vector3 band = first->getCentre() - Vector3(first->getBoundingRadius() + 1100, 0, 0);
+    update(band);
+    update(band);
+    EXPECT_TRUE(first->isLoaded());
+    EXPECT_EQ(listener.loads, 1);
+    EXPECT_EQ(listener.unloads, 0);
+
+    // the first region stays loaded for a frame after the camera left
+    update(Vector3(6000, 0, 200));
+    EXPECT_EQ(loadedCount(), 2u);
+    EXPECT_TRUE(first->isLoaded());
+
+    update(Vector3(6000, 0, 200));
+    EXPECT_EQ(loadedCount(), 1u);
+    EXPECT_FALSE(first->isLoaded());
+    EXPECT_TRUE(streamed->getRegions().rbegin()->second->isLoaded());
+    EXPECT_EQ(listener.loads, 2);
+    EXPECT_EQ(listener.unloads, 1);
+
+    update(band);
+    EXPECT_FALSE(first->isLoaded());
+    EXPECT_EQ(listener.loads, 2);
+
+    // and comes back when the camera does
+    update(Vector3(0, 0, 200));
+    EXPECT_TRUE(first->isLoaded());
+    EXPECT_EQ(listener.loads, 3);
+
+    // loads in flight are dropped with the geometry
+    camNode->setPosition(3000, 0, 200);
+    camNode->_update(true, false);
+    streamed->updateRegionStreaming(cam);
+    mSceneMgr->destroyStaticGeometry(streamed);
+    waitForWorkQueue(wq);
+    EXPECT_EQ(listener.loads, 3);
+
+    mSceneMgr->destroyStaticGeometry(loaded);
+    std::remove("StaticGeometryRegions.bin");
+    wq->shutdown();
+}
+
 static void createRandomEntityClones(Entity* ent, size_t cloneCount, const Vector3& min,
                                      const Vector3& max, SceneManager* mgr)
 {
@@ -358,6 +759,149 @@ TEST(Image, Resize)
     ASSERT_TRUE(!memcmp(img.getData(), ref.getData(), ref.getSize()));
 }
 
+TEST(Image, FilteredResize)
+{
+    // constant images stay constant with every filter, as the weights are normalised
+    for (auto filter : {Image::FILTER_BOX, Image::FILTER_KAISER, Image::FILTER_LANCZOS})
+    {
+        Image img(PF_BYTE_RGBA, 37, 21);
+        for (uint32 y = 0; y < img.getHeight(); y++)
+            for (uint32 x = 0; x < img.getWidth(); x++)
+                img.setColourAt(ColourValue(0.2, 0.4, 0.6, 0.8), x, y, 0);
+
+        img.resize(16, 48, filter);
+        EXPECT_EQ(img.getWidth(), 16u);
+        EXPECT_EQ(img.getHeight(), 48u);
+        for (uint32 y = 0; y < img.getHeight(); y++)
+            for (uint32 x = 0; x < img.getWidth(); x++)
+            {
+                ColourValue c = img.getColourAt(x, y, 0);
+                EXPECT_NEAR(c.r, 0.2f, 1.0f / 255);
+                EXPECT_NEAR(c.g, 0.4f, 1.0f / 255);
+                EXPECT_NEAR(c.b, 0.6f, 1.0f / 255);
+                EXPECT_NEAR(c.a, 0.8f, 1.0f / 255);
+            }
+    }
+}
+
+TEST(Image, GenerateMipmaps)
+{
+    // black and white checkerboard
+    Image img(PF_FLOAT32_RGBA, 8, 4);
+    for (uint32 y = 0; y < img.getHeight(); y++)
+        for (uint32 x = 0; x < img.getWidth(); x++)
+            img.setColourAt(((x + y) % 2) ? ColourValue::White : ColourValue::Black, x, y, 0);
+
+    Image chain(img);
+    chain.generateMipmaps(Image::FILTER_BOX);
+    ASSERT_EQ(chain.getNumMipmaps(), 3u);
+    EXPECT_TRUE(!memcmp(chain.getData(), img.getData(), img.getSize()));
+
+    PixelBox mip = chain.getPixelBox(0, 1);
+    EXPECT_EQ(mip.getWidth(), 4u);
+    EXPECT_EQ(mip.getHeight(), 2u);
+    EXPECT_FLOAT_EQ(mip.getColourAt(1, 1, 0).r, 0.5f);
+
+    mip = chain.getPixelBox(0, 3);
+    EXPECT_EQ(mip.getWidth(), 1u);
+    EXPECT_EQ(mip.getHeight(), 1u);
+    EXPECT_NEAR(mip.getColourAt(0, 0, 0).g, 0.5f, 1e-5f);
+    EXPECT_FLOAT_EQ(mip.getColourAt(0, 0, 0).a, 1.0f);
+
+    // averaging in linear space makes the sRGB result brighter
+    chain = img;
+    chain.generateMipmaps(Image::FILTER_BOX, true);
+    EXPECT_NEAR(chain.getPixelBox(0, 1).getColourAt(0, 0, 0).b, 0.7354f, 1e-3f);
+}
+
+TEST(Image, Compress)
+{
+    // smooth gradients, which block compression preserves well
+    Image img(PF_BYTE_RGBA, 30, 20);
+    for (uint32 y = 0; y < img.getHeight(); y++)
+        for (uint32 x = 0; x < img.getWidth(); x++)
+            img.setColourAt(ColourValue(x / 60.0f, y / 40.0f, 0.5f, 1 - x / 60.0f), x, y, 0);
+
+    for (auto format : {PF_DXT1, PF_DXT3, PF_DXT5, PF_BC4_UNORM, PF_BC5_UNORM, PF_BC7_UNORM, PF_ETC2_RGB8, PF_ETC2_RGBA8})
+    {
+        Image compressed(img);
+        compressed.compress(format, 1.0f);
+        EXPECT_EQ(compressed.getFormat(), format);
+        EXPECT_EQ(compressed.getSize(), PixelUtil::getMemorySize(30, 20, 1, format));
+
+        Image decoded(PF_BYTE_RGBA, img.getWidth(), img.getHeight());
+        PixelUtil::bulkPixelConversion(compressed.getPixelBox(), decoded.getPixelBox());
+
+        int channels = PixelUtil::getComponentCount(format);
+        bool hasAlpha = PixelUtil::hasAlpha(format) && format != PF_DXT1;
+        for (uint32 y = 0; y < img.getHeight(); y++)
+            for (uint32 x = 0; x < img.getWidth(); x++)
+            {
+                ColourValue ref = img.getColourAt(x, y, 0), res = decoded.getColourAt(x, y, 0);
+                EXPECT_NEAR(res.r, ref.r, 0.05f) << PixelUtil::getFormatName(format);
+                if (channels > 1)
+                {
+                    EXPECT_NEAR(res.g, ref.g, 0.05f) << PixelUtil::getFormatName(format);
+                }
+                if (channels > 2)
+                {
+                    EXPECT_NEAR(res.b, ref.b, 0.05f) << PixelUtil::getFormatName(format);
+                }
+                if (hasAlpha)
+                {
+                    EXPECT_NEAR(res.a, ref.a, 0.05f) << PixelUtil::getFormatName(format);
+                }
+            }
+    }
+}
+
+TEST(Image, SaveCompressed)
+{
+    Root root;
+    Image img(PF_BYTE_RGBA, 16, 16);
+    for (uint32 y = 0; y < img.getHeight(); y++)
+        for (uint32 x = 0; x < img.getWidth(); x++)
+            img.setColourAt(ColourValue(x / 16.0f, y / 16.0f, 0.5f, 1), x, y, 0);
+    img.generateMipmaps();
+
+#if OGRE_NO_DDS_CODEC == 0
+    Image dds(img);
+    dds.compress(PF_DXT5);
+    dds.save("compressed.dds");
+    Image loaded;
+    loaded.load(Root::openFileStream("compressed.dds"), "dds");
+    // no RenderSystem available, will decompress
+    EXPECT_EQ(loaded.getFormat(), PF_BYTE_RGBA);
+    EXPECT_EQ(loaded.getNumMipmaps(), img.getNumMipmaps());
+    EXPECT_NEAR(loaded.getColourAt(8, 4, 0).r, 0.5f, 0.05f);
+
+    // BC7 needs the extended header
+    dds = img;
+    dds.compress(PF_BC7_UNORM);
+    dds.save("compressed.dds");
+    loaded.load(Root::openFileStream("compressed.dds"), "dds");
+    ASSERT_EQ(loaded.getFormat(), PF_BYTE_RGBA);
+    EXPECT_EQ(loaded.getNumMipmaps(), img.getNumMipmaps());
+    Image decodedBC7(PF_BYTE_RGBA, img.getWidth(), img.getHeight());
+    PixelUtil::bulkPixelConversion(dds.getPixelBox(), decodedBC7.getPixelBox());
+    EXPECT_TRUE(!memcmp(loaded.getData(), decodedBC7.getData(), decodedBC7.getSize()));
+    remove("compressed.dds");
+#endif
+
+#if OGRE_NO_ETC_CODEC == 0
+    Image ktx(img);
+    ktx.compress(PF_ETC2_RGBA8);
+    ktx.save("compressed.ktx");
+    loaded.load(Root::openFileStream("compressed.ktx"), "ktx");
+    // no RenderSystem available, will decompress
+    ASSERT_EQ(loaded.getFormat(), PF_BYTE_RGBA);
+    EXPECT_EQ(loaded.getNumMipmaps(), img.getNumMipmaps());
+    Image decoded(PF_BYTE_RGBA, img.getWidth(), img.getHeight());
+    PixelUtil::bulkPixelConversion(ktx.getPixelBox(), decoded.getPixelBox());
+    EXPECT_TRUE(!memcmp(loaded.getData(), decoded.getData(), decoded.getSize()));
+    remove("compressed.ktx");
+#endif
+}
 
 TEST(Image, Combine)
 {
@@ -408,15 +952,16 @@ TEST(Image, Compressed)
 #endif
 
 #if OGRE_NO_ETC_CODEC == 0
+    // no RenderSystem available, will decompress
     img.load(Root::openFileStream(testPath+"/Texture.pkm"), "pkm");
-    EXPECT_EQ(img.getFormat(), PF_ETC2_RGB8);
+    EXPECT_EQ(img.getFormat(), PF_BYTE_RGBA);
     img.load(Root::openFileStream(testPath+"/etc2-rgba8.ktx"), "ktx");
-    EXPECT_EQ(img.getFormat(), PF_ETC2_RGBA8);
+    EXPECT_EQ(img.getFormat(), PF_BYTE_RGBA);
 #endif
 
 #if OGRE_NO_ASTC_CODEC == 0
     img.load(Root::openFileStream(testPath+"/Earth-Color10x6.astc"), "astc");
-    EXPECT_EQ(img.getFormat(), PF_ASTC_RGBA_10X6_LDR);
+    EXPECT_EQ(img.getFormat(), PF_BYTE_RGBA); // no RenderSystem available, will decompress
 #endif
 
 #if OGRE_NO_DDS_CODEC == 0
@@ -425,6 +970,248 @@ TEST(Image, Compressed)
 #endif
 }
 
+TEST(Image, Decompress)
+{
+    Root root;
+    ConfigFile cf;
+    cf.load(FileSystemLayer(OGRE_VERSION_NAME).getConfigFilePath("resources.cfg"));
+    auto testPath = cf.getSettings("Tests").begin()->second;
+
+#if OGRE_NO_ETC_CODEC == 0
+    // no RenderSystem available, so the codec decodes the blocks
+    Image decoded;
+    decoded.load(Root::openFileStream(testPath+"/etc2-rgba8.ktx"), "ktx");
+    ASSERT_EQ(decoded.getFormat(), PF_BYTE_RGBA);
+
+    // transparent border around an opaque photo
+    EXPECT_EQ(decoded.getColourAt(0, 0, 0).a, 0);
+    ColourValue centre = decoded.getColourAt(64, 64, 0);
+    EXPECT_EQ(centre.a, 1);
+    EXPECT_GT(centre.r, centre.b);
+
+    // decoding into a float format gives the same values
+    Image img(decoded);
+    img.compress(PF_ETC2_RGBA8);
+    decoded = Image(PF_BYTE_RGBA, img.getWidth(), img.getHeight());
+    PixelUtil::bulkPixelConversion(img.getPixelBox(), decoded.getPixelBox());
+    centre = decoded.getColourAt(64, 64, 0);
+    Image decodedFloat(PF_FLOAT32_RGBA, img.getWidth(), img.getHeight());
+    PixelUtil::bulkPixelConversion(img.getPixelBox(), decodedFloat.getPixelBox());
+    ColourValue centreFloat = decodedFloat.getColourAt(64, 64, 0);
+    EXPECT_NEAR(centreFloat.r, centre.r, 1e-3);
+    EXPECT_NEAR(centreFloat.g, centre.g, 1e-3);
+    EXPECT_NEAR(centreFloat.b, centre.b, 1e-3);
+#endif
+}
+
+/// assembles a 16 byte block, starting at the lsb of its first byte
+struct BlockWriter
+{
+    uint8 data[16] = {};
+    uint32 pos = 0;
+    void write(uint32 v, uint32 count)
+    {
+        for (uint32 i = 0; i < count; i++, pos++)
+            data[pos >> 3] |= uint8(((v >> i) & 0x1) << (pos & 0x7));
+    }
+};
+
+TEST(Image, DecompressBC7)
+{
+    // mode 6: a single subset with p bits per endpoint and 4 bit indices
+    BlockWriter mode6;
+    mode6.write(1 << 6, 7);
+    for (uint32 v : {127, 0, 0, 0, 64, 0, 127, 0}) // R0 R1 G0 G1 B0 B1 A0 A1
+        mode6.write(v, 7);
+    mode6.write(1, 1);
+    mode6.write(0, 1);
+    for (uint32 i = 0; i < 16; i++)
+        mode6.write(i == 1 ? 15 : i == 2 ? 8 : 0, i == 0 ? 3 : 4);
+    ASSERT_EQ(mode6.pos, 128u);
+
+    Image decoded(PF_BYTE_RGBA, 4, 4);
+    PixelUtil::bulkPixelConversion(PixelBox(4, 4, 1, PF_BC7_UNORM, mode6.data), decoded.getPixelBox());
+    auto pixel = [&decoded](uint32 x, uint32 y) {
+        const uint8* p = decoded.getData() + (y * 4 + x) * 4;
+        return std::vector<uint8>(p, p + 4);
+    };
+    EXPECT_EQ(pixel(0, 0), std::vector<uint8>({255, 1, 129, 255}));
+    EXPECT_EQ(pixel(1, 0), std::vector<uint8>({0, 0, 0, 0}));
+    EXPECT_EQ(pixel(2, 0), std::vector<uint8>({120, 0, 60, 120}));
+
+    // mode 1: partition 13 splits the rows in halves, pixel 15 is the anchor of the second subset
+    BlockWriter mode1;
+    mode1.write(1 << 1, 2);
+    mode1.write(13, 6);
+    for (uint32 v : {63, 63, 0, 0, 0, 0, 63, 0, 0, 0, 0, 0}) // R, G and B of 4 endpoints
+        mode1.write(v, 6);
+    mode1.write(1, 1);
+    mode1.write(0, 1);
+    for (uint32 i = 0; i < 16; i++)
+        mode1.write(i == 14 ? 7 : i == 15 ? 3 : 0, i == 0 || i == 15 ? 2 : 3);
+    ASSERT_EQ(mode1.pos, 128u);
+
+    PixelUtil::bulkPixelConversion(PixelBox(4, 4, 1, PF_BC7_UNORM, mode1.data), decoded.getPixelBox());
+    EXPECT_EQ(pixel(3, 1), std::vector<uint8>({255, 2, 2, 255}));
+    EXPECT_EQ(pixel(0, 2), std::vector<uint8>({0, 253, 0, 255}));
+    EXPECT_EQ(pixel(2, 3), std::vector<uint8>({0, 0, 0, 255}));
+    EXPECT_EQ(pixel(3, 3), std::vector<uint8>({0, 146, 0, 255}));
+}
+
+TEST(Image, DecompressBC6H)
+{
+    // mode 11: a single region with 10 bit endpoints and 4 bit indices
+    BlockWriter mode11;
+    mode11.write(0x3, 5);
+    for (uint32 v : {0, 0, 0, 1023, 512, 0}) // RGB of both endpoints
+        mode11.write(v, 10);
+    for (uint32 i = 0; i < 16; i++)
+        mode11.write(i == 1 ? 15 : i == 2 ? 8 : 0, i == 0 ? 3 : 4);
+    ASSERT_EQ(mode11.pos, 128u);
+
+    Image decoded(PF_FLOAT16_RGBA, 4, 4);
+    PixelUtil::bulkPixelConversion(PixelBox(4, 4, 1, PF_BC6H_UF16, mode11.data), decoded.getPixelBox());
+    auto pixel = [&decoded](uint32 x, uint32 y) {
+        const uint16* p = reinterpret_cast<const uint16*>(decoded.getData()) + (y * 4 + x) * 4;
+        return std::vector<uint16>(p, p + 4);
+    };
+    // half floats, the largest endpoint maps to 65504
+    EXPECT_EQ(pixel(0, 0), std::vector<uint16>({0, 0, 0, 0x3C00}));
+    EXPECT_EQ(pixel(1, 0), std::vector<uint16>({0x7BFF, 0x3E0F, 0, 0x3C00}));
+    EXPECT_EQ(pixel(2, 0), std::vector<uint16>({0x41DF, 0x20F8, 0, 0x3C00}));
+
+    // mode 1: two regions with signed 5 bit deltas to the 10 bit first endpoint
+    BlockWriter mode1;
+    mode1.write(0, 2);
+    mode1.write(0, 3); // gy[4], by[4], bz[4]
+    mode1.write(100, 10); // rw
+    mode1.write(0, 10); // gw
+    mode1.write(0x200, 10); // bw, -512
+    mode1.write(0x1F, 5); // rx, -1
+    mode1.write(0, 25); // gz[4], gy[3:0], gx[4:0], bz[0], gz[3:0], bx[4:0], bz[1], by[3:0]
+    mode1.write(0x10, 5); // ry, -16
+    mode1.write(0, 1); // bz[2]
+    mode1.write(5, 5); // rz
+    mode1.write(0, 1); // bz[3]
+    // partition 0 splits the columns in halves, pixel 15 is the anchor of the second region
+    mode1.write(0, 5);
+    for (uint32 i = 0; i < 16; i++)
+        mode1.write(i == 1 ? 4 : i == 3 ? 7 : 0, i == 0 || i == 15 ? 2 : 3);
+    ASSERT_EQ(mode1.pos, 128u);
+
+    PixelUtil::bulkPixelConversion(PixelBox(4, 4, 1, PF_BC6H_SF16, mode1.data), decoded.getPixelBox());
+    EXPECT_EQ(pixel(0, 0), std::vector<uint16>({0x1857, 0, 0xFBFF, 0x3C00}));
+    EXPECT_EQ(pixel(1, 0), std::vector<uint16>({0x1833, 0, 0xFBFF, 0x3C00}));
+    EXPECT_EQ(pixel(2, 0), std::vector<uint16>({0x1477, 0, 0xFBFF, 0x3C00}));
+    EXPECT_EQ(pixel(3, 0), std::vector<uint16>({0x198D, 0, 0xFBFF, 0x3C00}));
+
+    // reserved modes decode to black
+    BlockWriter reserved;
+    reserved.write(0x13, 5);
+    PixelUtil::bulkPixelConversion(PixelBox(4, 4, 1, PF_BC6H_UF16, reserved.data), decoded.getPixelBox());
+    EXPECT_EQ(pixel(3, 3), std::vector<uint16>({0, 0, 0, 0x3C00}));
+}
+
+TEST(Image, DecompressASTC)
+{
+    Image decoded(PF_BYTE_RGBA, 4, 4);
+    auto pixel = [&decoded](uint32 x, uint32 y) {
+        const uint8* p = decoded.getData() + (y * 4 + x) * 4;
+        return std::vector<uint8>(p, p + 4);
+    };
+    // weights are stored bit reversed from the top of the block
+    auto writeWeights = [](BlockWriter& block, const BlockWriter& weights) {
+        for (uint32 i = 0; i < weights.pos; i++)
+        {
+            if (weights.data[i >> 3] & (1 << (i & 0x7)))
+                block.data[(127 - i) >> 3] |= uint8(1 << ((127 - i) & 0x7));
+        }
+    };
+
+    // void extent: block mode 0x1FC, LDR, an unbounded extent and 16 bit RGBA
+    BlockWriter voidExtent;
+    voidExtent.write(0xDFC, 12);
+    for (int i = 0; i < 4; i++)
+        voidExtent.write(0x1FFF, 13);
+    for (uint32 v : {0x80FF, 0x4000, 0xFF00, 0xFFFF})
+        voidExtent.write(v, 16);
+    PixelUtil::bulkPixelConversion(PixelBox(4, 4, 1, PF_ASTC_RGBA_4X4_LDR, voidExtent.data), decoded.getPixelBox());
+    EXPECT_EQ(pixel(2, 3), std::vector<uint8>({0x80, 0x40, 0xFF, 0xFF}));
+
+    // 4x4 weights of 2 bits, a single partition with direct RGB endpoints, which fit in 8 bits each
+    BlockWriter rgb;
+    rgb.write(0x42, 11);
+    rgb.write(0, 2);
+    rgb.write(8, 4);
+    for (uint32 v : {0, 255, 0, 128, 255, 0}) // R0 R1 G0 G1 B0 B1
+        rgb.write(v, 8);
+    BlockWriter weights;
+    for (uint32 i = 0; i < 16; i++)
+        weights.write(i % 4, 2);
+    writeWeights(rgb, weights);
+
+    PixelUtil::bulkPixelConversion(PixelBox(4, 4, 1, PF_ASTC_RGBA_4X4_LDR, rgb.data), decoded.getPixelBox());
+    // weights 0, 21, 43 and 64, the endpoints are interpolated with 16 bits
+    EXPECT_EQ(pixel(0, 1), std::vector<uint8>({0, 0, 255, 255}));
+    EXPECT_EQ(pixel(1, 1), std::vector<uint8>({84, 42, 171, 255}));
+    EXPECT_EQ(pixel(2, 2), std::vector<uint8>({171, 86, 84, 255}));
+    EXPECT_EQ(pixel(3, 3), std::vector<uint8>({255, 128, 0, 255}));
+
+    // 2x2 weights in two planes, infilled to 4x4. Direct RGBA endpoints, with alpha on the second plane
+    BlockWriter rgba;
+    rgba.write(0x71D, 11);
+    rgba.write(0, 2);
+    rgba.write(12, 4);
+    for (uint32 v : {0, 255, 255, 0, 0, 0, 255, 0}) // R0 R1 G0 G1 B0 B1 A0 A1
+        rgba.write(v, 8);
+    rgba.pos = 97;
+    rgba.write(3, 2);
+    // 12 weight levels: 2 bits per value and trits, packed 5 to 8 bits and interleaved with the values.
+    // The values 0 11 5 11 0, 9 5 9 give the weights 0 36 59 36 0, 53 59 53 and use the packed trits 88 and 27
+    BlockWriter trits;
+    const uint32 sequence[][2] = {{0, 2}, {0, 2}, {3, 2}, {2, 2}, {1, 2}, {1, 1}, {3, 2}, {2, 2},
+                                  {0, 2}, {0, 1}, {1, 2}, {3, 2}, {1, 2}, {2, 2}, {1, 2}, {1, 1}};
+    for (const auto& bits : sequence)
+        trits.write(bits[0], bits[1]);
+    ASSERT_EQ(trits.pos, 29u);
+    writeWeights(rgba, trits);
+
+    PixelUtil::bulkPixelConversion(PixelBox(4, 4, 1, PF_ASTC_RGBA_4X4_LDR, rgba.data), decoded.getPixelBox());
+    // colour weights 0, 18, 41, 59 along x and alpha weights 36, 41, 48, 53 along y
+    EXPECT_EQ(pixel(0, 0), std::vector<uint8>({0, 255, 0, 112}));
+    EXPECT_EQ(pixel(2, 1), std::vector<uint8>({163, 92, 0, 92}));
+    EXPECT_EQ(pixel(1, 2), std::vector<uint8>({72, 183, 0, 64}));
+    EXPECT_EQ(pixel(3, 3), std::vector<uint8>({235, 20, 0, 44}));
+
+    // reserved block modes decode to the error colour
+    uint8 reserved[16] = {};
+    PixelUtil::bulkPixelConversion(PixelBox(4, 4, 1, PF_ASTC_RGBA_4X4_LDR, reserved), decoded.getPixelBox());
+    EXPECT_EQ(pixel(1, 1), std::vector<uint8>({255, 0, 255, 255}));
+
+#if OGRE_NO_ASTC_CODEC == 0
+    Root root;
+    ConfigFile cf;
+    cf.load(FileSystemLayer(OGRE_VERSION_NAME).getConfigFilePath("resources.cfg"));
+    auto testPath = cf.getSettings("Tests").begin()->second;
+
+    // the file uses void extents, up to 4 partitions, dual planes and mixed endpoint modes
+    Image earth;
+    earth.load(Root::openFileStream(testPath+"/Earth-Color10x6.astc"), "astc");
+    ASSERT_EQ(earth.getFormat(), PF_BYTE_RGBA);
+    const uint8 magenta[4] = {255, 0, 255, 255};
+    size_t errors = 0;
+    for (size_t i = 0; i < earth.getWidth() * earth.getHeight(); i++)
+        errors += memcmp(earth.getData() + i * 4, magenta, 4) == 0;
+    EXPECT_EQ(errors, 0u);
+    auto texel = [&earth](uint32 x, uint32 y) {
+        const uint8* p = earth.getData() + (y * earth.getWidth() + x) * 4;
+        return std::vector<uint8>(p, p + 4);
+    };
+    EXPECT_EQ(texel(100, 250), std::vector<uint8>({13, 55, 79, 255})); // ocean
+    EXPECT_EQ(texel(600, 300), std::vector<uint8>({202, 172, 118, 255})); // desert
+#endif
+}
+
 struct UsePreviousResourceLoadingListener : public ResourceLoadingListener
 {
     bool resourceCollision(Resource *resource, ResourceManager *resourceManager) override { return false; }
@@ -495,6 +1282,188 @@ TEST_F(TextureTests, Blank)
     EXPECT_EQ(tus->isHardwareGammaEnabled(), false);
 }
 
+namespace
+{
+/// Render target, that only provides the viewport size
+struct ViewportOnlyTarget : public RenderTarget
+{
+    ViewportOnlyTarget(uint32 size)
+    {
+        mName = "ViewportOnlyTarget";
+        mWidth = mHeight = size;
+    }
+    void copyContentsToMemory(const Box& src, const PixelBox& dst, FrameBuffer buffer) override {}
+    bool requiresTextureFlipping() const override { return false; }
+};
+
+/// Unit cube, that uses the first technique as there is no RenderSystem to compile for
+struct StreamedObject : public SimpleRenderable
+{
+    StreamedObject(const MaterialPtr& mat) : SimpleRenderable("StreamedObject")
+    {
+        setMaterial(mat);
+        setBoundingBox(AxisAlignedBox(Vector3(-1), Vector3(1)));
+    }
+    Real getBoundingRadius() const override { return Math::Sqrt(3); }
+    Real getSquaredViewDepth(const Camera*) const override { return 0; }
+    Technique* getTechnique() const override { return getMaterial()->getTechnique(0); }
+};
+}
+
+TEST_F(TextureTests, Streaming)
+{
+    STBIImageCodec::startup();
+    MemoryTextureManager texMgr;
+    WorkQueue* wq = mRoot->getWorkQueue();
+    wq->setWorkerThreadCount(1);
+    wq->setResponseProcessingTimeLimit(0);
+    wq->startup();
+
+    auto tex = texMgr.create("decal1.png", "Tests");
+    tex->setStreaming(true);
+    tex->load();
+
+    Image img;
+    img.load("decal1.png", "Tests");
+
+    // the hardware levels plus the tail kept on the CPU
+    auto allocated = [&]() {
+        size_t size = Image::calculateSize(6, 1, 64, 64, 1, img.getFormat());
+        for (uint32 level = 0; level <= tex->getNumMipmaps(); level++)
+            size += static_cast<MemoryPixelBuffer*>(tex->getBuffer(0, level).get())->mData.getSize();
+        return size;
+    };
+
+    // 512px, starting with the 64px tail, that is all the texture allocates
+    ASSERT_EQ(tex->_getStreamingTailMip(), 3u);
+    EXPECT_EQ(tex->getResidentMip(), 3u);
+    EXPECT_EQ(tex->getSrcWidth(), 512u);
+    EXPECT_EQ(tex->getWidth(), 64u);
+    EXPECT_EQ(tex->getNumMipmaps(), 6u);
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), tex->_getStreamingSize(3));
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), allocated());
+
+    // the resource memory usage follows the size of the top level
+    size_t otherUsage = texMgr.getMemoryUsage() - tex->getSize();
+    auto accounted = [&](uint32 width) {
+        return otherUsage + PixelUtil::getMemorySize(width, width, 1, tex->getFormat());
+    };
+    EXPECT_EQ(texMgr.getMemoryUsage(), accounted(64));
+
+    // request levels through the visibility of an object using the texture
+    SceneManager* sm = mRoot->createSceneManager();
+    auto mat = MaterialManager::getSingleton().create("StreamedTexture", "Tests");
+    mat->getTechnique(0)->getPass(0)->createTextureUnitState()->setTexture(tex);
+    std::unique_ptr<StreamedObject> obj(new StreamedObject(mat));
+    sm->getRootSceneNode()->attachObject(obj.get());
+    sm->getRootSceneNode()->_update(true, false);
+
+    Camera* cam = sm->createCamera("cam");
+    SceneNode* camNode = sm->getRootSceneNode()->createChildSceneNode();
+    camNode->attachObject(cam);
+    ViewportOnlyTarget target(512);
+    target.addViewport(cam);
+
+    // the object covers about 200 of 512 pixels, which asks for the 256px level
+    Real radius = obj->getWorldBoundingSphere(true).getRadius();
+    Vector3 mip1Pos(0, 0, radius * 512 / (200 * Math::Tan(cam->getFOVy() * 0.5f)));
+    auto frame = [&](const Vector3* camPos) {
+        if (camPos)
+        {
+            camNode->setPosition(*camPos);
+            camNode->_update(true, false);
+            sm->getRenderQueue()->processVisibleObject(obj.get(), cam, false, NULL);
+        }
+        mRoot->_fireFrameRenderingQueued();
+        mRoot->_fireFrameEnded();
+    };
+
+    // the image is decoded on the worker and the texture grows to the requested level
+    frame(&mip1Pos);
+    waitForWorkQueue(wq);
+    EXPECT_FALSE(tex->_isStreamingPending());
+    ASSERT_EQ(tex->getResidentMip(), 1u);
+    EXPECT_EQ(tex->getWidth(), 256u);
+    EXPECT_EQ(tex->getNumMipmaps(), 8u);
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), tex->_getStreamingSize(1));
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), allocated());
+    EXPECT_EQ(texMgr.getMemoryUsage(), accounted(256));
+
+    // the decoded image is not kept, the next level is decoded again
+    frame(&Vector3::ZERO);
+    EXPECT_TRUE(tex->_isStreamingPending());
+    waitForWorkQueue(wq);
+    ASSERT_EQ(tex->getResidentMip(), 0u);
+    EXPECT_EQ(tex->getWidth(), 512u);
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), allocated());
+    EXPECT_EQ(texMgr.getMemoryUsage(), accounted(512));
+
+    auto top = static_cast<MemoryPixelBuffer*>(tex->getBuffer(0, 0).get());
+    ASSERT_EQ(top->mData.getSize(), img.getSize());
+    EXPECT_EQ(memcmp(top->mData.getData(), img.getData(), img.getSize()), 0);
+
+    // drop back to the tail
+    tex->_evictMips();
+    EXPECT_EQ(tex->getResidentMip(), 3u);
+    EXPECT_EQ(tex->getWidth(), 64u);
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), allocated());
+    EXPECT_EQ(texMgr.getMemoryUsage(), accounted(64));
+
+    // a load in flight completes while over budget
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    wq->addTask([released]() { released.wait(); });
+    frame(&mip1Pos);
+    EXPECT_TRUE(tex->_isStreamingPending());
+    texMgr.setStreamingBudget(tex->_getStreamingSize(2));
+    release.set_value();
+    waitForWorkQueue(wq);
+    EXPECT_FALSE(tex->_isStreamingPending());
+    EXPECT_EQ(tex->getResidentMip(), 1u);
+    EXPECT_GT(texMgr.getStreamingMemoryUsage(), texMgr.getStreamingBudget());
+
+    // not visible anymore, so it is evicted until the allocation fits the budget
+    frame(NULL);
+    frame(NULL);
+    EXPECT_EQ(tex->getResidentMip(), 3u);
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), tex->_getStreamingSize(3));
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), allocated());
+    EXPECT_LE(texMgr.getStreamingMemoryUsage(), texMgr.getStreamingBudget());
+
+    // and only streamed in again as far as it fits
+    frame(&Vector3::ZERO);
+    waitForWorkQueue(wq);
+    EXPECT_EQ(tex->getResidentMip(), 2u);
+    EXPECT_LE(texMgr.getStreamingMemoryUsage(), texMgr.getStreamingBudget());
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), allocated());
+    EXPECT_EQ(texMgr.getMemoryUsage(), accounted(128));
+
+    // unloading subtracts what is accounted at the current size, then reports the full size again
+    tex->unload();
+    EXPECT_EQ(texMgr.getMemoryUsage(), otherUsage);
+    EXPECT_EQ(tex->getSize(), 0u);
+    EXPECT_EQ(tex->getWidth(), 512u);
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), 0u);
+    tex->load();
+    EXPECT_EQ(tex->getResidentMip(), 3u);
+    EXPECT_EQ(texMgr.getMemoryUsage(), accounted(64));
+
+    // released textures are not tracked anymore
+    target.removeAllViewports();
+    sm->getRootSceneNode()->detachObject(obj.get());
+    obj.reset();
+    mRoot->destroySceneManager(sm);
+    MaterialManager::getSingleton().remove(mat);
+    mat.reset();
+    texMgr.remove(tex);
+    tex.reset();
+    EXPECT_FALSE(texMgr._hasStreamingTextures());
+    EXPECT_EQ(texMgr.getStreamingMemoryUsage(), 0u);
+
+    wq->shutdown();
+    STBIImageCodec::shutdown();
+}
+
 TEST(GpuSharedParameters, align)
 {
     Root root("");
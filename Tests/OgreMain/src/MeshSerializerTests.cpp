@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreMeshManager.h"
 #include "OgreSubMesh.h"
 #include "OgreMeshSerializer.h"
+#include "OgreMeshOptimizer.h"
 #include "OgreRoot.h"
 #include "OgreException.h"
 #include "OgreArchive.h"
@@ -48,6 +49,7 @@ THE SOFTWARE.
 #include "OgreKeyFrame.h"
 
 #include <fstream>
+#include <array>
 
 //#define I_HAVE_LOT_OF_FREE_TIME
 
@@ -177,7 +179,8 @@ void MeshSerializerTests::testMesh(MeshVersion version)
     MeshSerializer serializer;
     serializer.exportMesh(mOrigMesh.get(), mMeshFullPath, version);
     mMesh->reload();
-    assertMeshClone(mOrigMesh.get(), mMesh.get(), version);
+    // 14.2 stores everything the latest version does, but is not ordered with the older ones
+    assertMeshClone(mOrigMesh.get(), mMesh.get(), version == MESH_VERSION_14_2 ? MESH_VERSION_LATEST : version);
 }
 //--------------------------------------------------------------------------
 TEST_F(MeshSerializerTests,Skeleton_Version_1_8)
@@ -198,11 +201,21 @@ TEST_F(MeshSerializerTests,Skeleton_Version_1_0)
     }
 }
 //--------------------------------------------------------------------------
-TEST_F(MeshSerializerTests,Mesh_Version_1_10)
+TEST_F(MeshSerializerTests,Mesh_Version_Latest)
 {
     testMesh(MESH_VERSION_LATEST);
 }
 //--------------------------------------------------------------------------
+TEST_F(MeshSerializerTests,Mesh_Version_14_2)
+{
+    testMesh(MESH_VERSION_14_2);
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshSerializerTests,Mesh_Version_1_10)
+{
+    testMesh(MESH_VERSION_1_10);
+}
+//--------------------------------------------------------------------------
 TEST_F(MeshSerializerTests,Mesh_Version_1_8)
 {
     testMesh(MESH_VERSION_1_8);
@@ -223,6 +236,289 @@ TEST_F(MeshSerializerTests,Mesh_Version_1_3)
     testMesh(MESH_VERSION_1_0);
 }
 //--------------------------------------------------------------------------
+TEST_F(MeshSerializerTests,Mesh_Version_Flat)
+{
+    MeshSerializer serializer;
+
+    // the flat format stores renderable data only
+    mOrigMesh->createPose(0);
+    EXPECT_THROW(serializer.exportMesh(mOrigMesh.get(), mMeshFullPath, MESH_VERSION_FLAT),
+                 InvalidParametersException);
+
+    mOrigMesh->removeAllAnimations();
+    mOrigMesh->removeAllPoses();
+    mOrigMesh->freeEdgeList();
+    mOrigMesh->setAutoBuildEdgeLists(false);
+
+    serializer.exportMesh(mOrigMesh.get(), mMeshFullPath, MESH_VERSION_FLAT);
+    mMesh->reload();
+    assertMeshClone(mOrigMesh.get(), mMesh.get());
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshSerializerTests,Mesh_Version_Flat_Encoded)
+{
+    mOrigMesh->removeAllAnimations();
+    mOrigMesh->removeAllPoses();
+    mOrigMesh->freeEdgeList();
+    mOrigMesh->setAutoBuildEdgeLists(false);
+
+    // delta coding is lossless
+    MeshSerializer serializer;
+    serializer.setEncodingFlags(MeshSerializer::EF_COMPRESS_STREAMS);
+    serializer.exportMesh(mOrigMesh.get(), mMeshFullPath, MESH_VERSION_FLAT);
+    mMesh->reload();
+    assertMeshClone(mOrigMesh.get(), mMesh.get());
+
+    // quantised positions stay within a step of the original
+    serializer.setEncodingFlags(MeshSerializer::EF_COMPRESS_STREAMS | MeshSerializer::EF_QUANTISE_POSITIONS);
+    serializer.exportMesh(mOrigMesh.get(), mMeshFullPath, MESH_VERSION_FLAT);
+    mMesh->reload();
+
+    VertexData* a = mOrigMesh->getSubMesh(0)->useSharedVertices ? mOrigMesh->sharedVertexData
+                                                                 : mOrigMesh->getSubMesh(0)->vertexData;
+    VertexData* b = mMesh->getSubMesh(0)->useSharedVertices ? mMesh->sharedVertexData
+                                                             : mMesh->getSubMesh(0)->vertexData;
+    ASSERT_EQ(a->vertexCount, b->vertexCount);
+
+    const VertexElement* posElem = a->vertexDeclaration->findElementBySemantic(VES_POSITION);
+    auto abuf = a->vertexBufferBinding->getBuffer(posElem->getSource());
+    auto bbuf = b->vertexBufferBinding->getBuffer(posElem->getSource());
+    HardwareBufferLockGuard alock(abuf, HardwareBuffer::HBL_READ_ONLY);
+    HardwareBufferLockGuard block(bbuf, HardwareBuffer::HBL_READ_ONLY);
+
+    float tolerance = mOrigMesh->getBounds().getSize().length() / 65535;
+    for (size_t v = 0; v < a->vertexCount; ++v)
+    {
+        float *apos, *bpos;
+        posElem->baseVertexPointerToElement((uint8*)alock.pData + v * abuf->getVertexSize(), &apos);
+        posElem->baseVertexPointerToElement((uint8*)block.pData + v * bbuf->getVertexSize(), &bpos);
+        EXPECT_LE(Vector3(apos).distance(Vector3(bpos)), tolerance);
+    }
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshSerializerTests,ConvertTexCoords)
+{
+    // set 0 has 3 components, set 1 is in range, set 2 is not
+    VertexData vertexData;
+    VertexDeclaration* decl = vertexData.vertexDeclaration;
+    decl->addElement(0, 0, VET_FLOAT3, VES_TEXTURE_COORDINATES, 0);
+    decl->addElement(0, 12, VET_FLOAT2, VES_TEXTURE_COORDINATES, 1);
+    decl->addElement(0, 20, VET_FLOAT2, VES_TEXTURE_COORDINATES, 2);
+    const float vertices[2][7] = {{0, 0.5, 1, 0.25, 0.75, -1, 2}, {1, 0, 0.5, 1, 0, 0.5, 0.5}};
+    vertexData.vertexCount = 2;
+    auto vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(28, 2, HBU_CPU_ONLY);
+    vbuf->writeData(0, sizeof(vertices), vertices);
+    vertexData.vertexBufferBinding->setBinding(0, vbuf);
+
+    vertexData.convertVertexElement(VES_TEXTURE_COORDINATES, VET_USHORT2_NORM);
+
+    EXPECT_EQ(VET_FLOAT3, decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 0)->getType());
+    const VertexElement* set1 = decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 1);
+    EXPECT_EQ(VET_USHORT2_NORM, set1->getType());
+    EXPECT_EQ(VET_FLOAT2, decl->findElementBySemantic(VES_TEXTURE_COORDINATES, 2)->getType());
+
+    vbuf = vertexData.vertexBufferBinding->getBuffer(0);
+    HardwareBufferLockGuard lock(vbuf, HardwareBuffer::HBL_READ_ONLY);
+    for (int v = 0; v < 2; ++v)
+    {
+        uint16* uv;
+        set1->baseVertexPointerToElement((uint8*)lock.pData + v * vbuf->getVertexSize(), &uv);
+        EXPECT_NEAR(vertices[v][3], uv[0] / 65535.0f, 1e-4f);
+        EXPECT_NEAR(vertices[v][4], uv[1] / 65535.0f, 1e-4f);
+    }
+}
+//--------------------------------------------------------------------------
+static std::vector<std::array<float, 9>> getTriangles(const Mesh* mesh, const SubMesh* sm)
+{
+    const VertexData* vertexData = sm->useSharedVertices ? mesh->sharedVertexData : sm->vertexData;
+    const VertexElement* posElem = vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+    auto vbuf = vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+    auto ibuf = sm->indexData->indexBuffer;
+    HardwareBufferLockGuard vlock(vbuf, HardwareBuffer::HBL_READ_ONLY);
+    HardwareBufferLockGuard ilock(ibuf, HardwareBuffer::HBL_READ_ONLY);
+
+    std::vector<std::array<float, 9>> ret(sm->indexData->indexCount / 3);
+    for (size_t i = 0; i < ret.size() * 3; ++i)
+    {
+        size_t idx = sm->indexData->indexStart + i;
+        uint32 v = ibuf->getType() == HardwareIndexBuffer::IT_32BIT ? static_cast<uint32*>(ilock.pData)[idx]
+                                                                     : static_cast<uint16*>(ilock.pData)[idx];
+        float* pos;
+        posElem->baseVertexPointerToElement((uint8*)vlock.pData + v * vbuf->getVertexSize(), &pos);
+        std::copy(pos, pos + 3, ret[i / 3].begin() + (i % 3) * 3);
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+TEST_F(MeshSerializerTests,MeshOptimizer)
+{
+    // vertex fetch optimisation is skipped for meshes with poses
+    mOrigMesh->removeAllAnimations();
+    mOrigMesh->removeAllPoses();
+
+    std::vector<std::vector<std::array<float, 9>>> triangles;
+    for (auto sm : mOrigMesh->getSubMeshes())
+        triangles.push_back(getTriangles(mOrigMesh.get(), sm));
+
+    MeshOptimizer optimizer(MeshOptimizer::MO_ALL);
+    optimizer.optimise(mOrigMesh.get());
+    EXPECT_LT(optimizer.getAvgCacheMissRatioAfter(), optimizer.getAvgCacheMissRatioBefore());
+
+    // the same triangles are rendered
+    for (size_t i = 0; i < mOrigMesh->getNumSubMeshes(); ++i)
+        EXPECT_EQ(triangles[i], getTriangles(mOrigMesh.get(), mOrigMesh->getSubMesh(i)));
+
+    // and survive a round trip
+    testMesh(MESH_VERSION_LATEST);
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshSerializerTests,MeshOptimizerSharedVertices)
+{
+    MeshPtr mesh = MeshManager::getSingleton().createManual("SharedVertices", RGN_DEFAULT);
+    mesh->sharedVertexData = OGRE_NEW VertexData();
+    mesh->sharedVertexData->vertexCount = 6;
+    mesh->sharedVertexData->vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+    auto vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(12, 6, HBU_CPU_ONLY);
+    std::vector<float> positions;
+    for (int v = 0; v < 6; ++v)
+        positions.insert(positions.end(), {float(v), 0, 0});
+    vbuf->writeData(0, vbuf->getSizeInBytes(), positions.data());
+    mesh->sharedVertexData->vertexBufferBinding->setBinding(0, vbuf);
+
+    auto addSubMesh = [&](RenderOperation::OperationType type, std::vector<uint16> indices) {
+        SubMesh* sm = mesh->createSubMesh();
+        sm->useSharedVertices = true;
+        sm->operationType = type;
+        if (indices.empty())
+            return;
+        sm->indexData->indexCount = indices.size();
+        sm->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+            HardwareIndexBuffer::IT_16BIT, indices.size(), HBU_CPU_ONLY);
+        sm->indexData->indexBuffer->writeData(0, indices.size() * 2, indices.data());
+    };
+    // x coordinate of every vertex referenced by the submesh
+    auto getReferenced = [&](SubMesh* sm) {
+        std::vector<float> ret;
+        std::vector<uint16> indices(sm->indexData->indexCount);
+        sm->indexData->indexBuffer->readData(0, indices.size() * 2, indices.data());
+        vbuf->readData(0, vbuf->getSizeInBytes(), positions.data());
+        for (uint16 i : indices)
+            ret.push_back(positions[i * 3]);
+        return ret;
+    };
+
+    addSubMesh(RenderOperation::OT_TRIANGLE_LIST, {5, 4, 3});
+    addSubMesh(RenderOperation::OT_LINE_LIST, {0, 5});
+
+    // all submeshes are remapped, not just the triangle lists
+    MeshOptimizer optimizer(MeshOptimizer::MO_VERTEX_FETCH);
+    optimizer.optimise(mesh.get());
+    EXPECT_EQ(std::vector<float>({5, 4, 3}), getReferenced(mesh->getSubMesh(0)));
+    EXPECT_EQ(std::vector<float>({0, 5}), getReferenced(mesh->getSubMesh(1)));
+    EXPECT_EQ(5, positions[0]);
+
+    // vertices used without indices can not be moved
+    addSubMesh(RenderOperation::OT_POINT_LIST, {});
+    std::vector<float> before = positions;
+    optimizer.optimise(mesh.get());
+    vbuf->readData(0, vbuf->getSizeInBytes(), positions.data());
+    EXPECT_EQ(before, positions);
+
+    MeshManager::getSingleton().remove(mesh);
+}
+//--------------------------------------------------------------------------
+TEST_F(MeshSerializerTests,Meshlets)
+{
+    // the latest version is 14.2 only for meshes with meshlets
+    auto header = [this]() {
+        auto stream = Root::openFileStream(mMeshFullPath);
+        stream->skip(sizeof(uint16)); // M_HEADER
+        return stream->getLine();
+    };
+    MeshSerializer().exportMesh(mOrigMesh.get(), mMeshFullPath);
+    EXPECT_NE(header().find("[MeshSerializer_v1.100]"), String::npos);
+
+    std::vector<std::vector<std::array<float, 9>>> triangles;
+    for (auto sm : mOrigMesh->getSubMeshes())
+        triangles.push_back(getTriangles(mOrigMesh.get(), sm));
+
+    MeshOptimizer optimizer(MeshOptimizer::MO_MESHLETS);
+    optimizer.setMeshletSize(32, 48);
+    optimizer.optimise(mOrigMesh.get());
+
+    for (size_t i = 0; i < mOrigMesh->getNumSubMeshes(); ++i)
+    {
+        SubMesh* sm = mOrigMesh->getSubMesh(i);
+        EXPECT_EQ(triangles[i], getTriangles(mOrigMesh.get(), sm));
+        ASSERT_FALSE(sm->meshlets.empty());
+
+        const VertexData* vertexData = sm->useSharedVertices ? mOrigMesh->sharedVertexData : sm->vertexData;
+        const VertexElement* posElem = vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+        auto vbuf = vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+        auto ibuf = sm->indexData->indexBuffer;
+        HardwareBufferLockGuard vlock(vbuf, HardwareBuffer::HBL_READ_ONLY);
+        HardwareBufferLockGuard ilock(ibuf, HardwareBuffer::HBL_READ_ONLY);
+        auto position = [&](size_t idx) {
+            uint32 v = ibuf->getType() == HardwareIndexBuffer::IT_32BIT ? static_cast<uint32*>(ilock.pData)[idx]
+                                                                         : static_cast<uint16*>(ilock.pData)[idx];
+            float* pos;
+            posElem->baseVertexPointerToElement((uint8*)vlock.pData + v * vbuf->getVertexSize(), &pos);
+            return Vector3(pos);
+        };
+
+        // the meshlets cover the triangles in order
+        uint32 next = sm->indexData->indexStart;
+        for (const auto& m : sm->meshlets)
+        {
+            EXPECT_EQ(next, m.indexStart);
+            EXPECT_LE(m.indexCount, 48u * 3);
+            next = m.indexStart + m.indexCount;
+
+            for (uint32 j = m.indexStart; j < m.indexStart + m.indexCount; j += 3)
+            {
+                Vector3 p[3] = {position(j), position(j + 1), position(j + 2)};
+                for (const auto& v : p)
+                    EXPECT_LE(m.center.distance(v), m.radius * 1.001f + 1e-4f);
+
+                Vector3 n = (p[1] - p[0]).crossProduct(p[2] - p[0]);
+                if (m.coneCutoff >= 1 || n.normalise() == 0)
+                    continue;
+                // the cone of back-facing directions is behind every triangle
+                EXPECT_GE(n.dotProduct(m.coneAxis), std::sqrt(1 - m.coneCutoff * m.coneCutoff) - 1e-3f);
+                EXPECT_GE(n.dotProduct(p[0] - m.coneApex), -1e-3f);
+            }
+        }
+        EXPECT_EQ(next, sm->indexData->indexStart + sm->indexData->indexCount);
+    }
+
+    MeshSerializer serializer;
+    serializer.exportMesh(mOrigMesh.get(), mMeshFullPath);
+    EXPECT_NE(header().find("[MeshSerializer_v14.2]"), String::npos);
+    mMesh->reload();
+    for (size_t i = 0; i < mOrigMesh->getNumSubMeshes(); ++i)
+    {
+        const auto& a = mOrigMesh->getSubMesh(i)->meshlets;
+        const auto& b = mMesh->getSubMesh(i)->meshlets;
+        ASSERT_EQ(a.size(), b.size());
+        for (size_t j = 0; j < a.size(); ++j)
+        {
+            EXPECT_EQ(a[j].indexStart, b[j].indexStart);
+            EXPECT_EQ(a[j].indexCount, b[j].indexCount);
+            EXPECT_TRUE(isEqual(a[j].center, b[j].center));
+            EXPECT_TRUE(isEqual(a[j].coneAxis, b[j].coneAxis));
+        }
+    }
+
+    // older versions do not store them
+    for (auto version : {MESH_VERSION_1_10, MESH_VERSION_1_8})
+    {
+        serializer.exportMesh(mOrigMesh.get(), mMeshFullPath, version);
+        mMesh->reload();
+        EXPECT_TRUE(mMesh->getSubMesh(0)->meshlets.empty());
+    }
+}
+//--------------------------------------------------------------------------
 #ifdef I_HAVE_LOT_OF_FREE_TIME
 TEST_F(MeshSerializerTests,Mesh_Version_1_2)
 {
@@ -249,6 +545,7 @@ TEST_F(MeshSerializerTests,Mesh_Version_1_2)
             }
             mOrigMesh = mMesh->clone(mMesh->getName() + ".orig.mesh", mMesh->getGroup());
             testMesh_XML();
+            testMesh(MESH_VERSION_14_2);
             testMesh(MESH_VERSION_1_10);
             testMesh(MESH_VERSION_1_8);
             testMesh(MESH_VERSION_1_7);
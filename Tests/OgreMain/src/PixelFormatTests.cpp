@@ -248,4 +248,58 @@ TEST_F(PixelFormatTests,BulkConversion)
     testCase(PF_X8B8G8R8, PF_R8G8B8A8);
 }
 //--------------------------------------------------------------------------
+TEST_F(PixelFormatTests,BulkChannelConversion)
+{
+    // valid float data, including values that need clamping
+    const uint32 width = 67, height = 5, depth = 3;
+    std::vector<float> floats(width * height * depth * 4);
+    for(size_t i = 0; i < floats.size(); i++)
+        floats[i] = float(rand() % 1500) / 1000.0f - 0.25f;
+    PixelBox floatBox(width, height, depth, PF_FLOAT32_RGBA, floats.data());
+
+    const PixelFormat formats[] = {PF_FLOAT32_RGBA, PF_FLOAT32_RGB, PF_FLOAT32_GR, PF_FLOAT32_R,
+                                   PF_FLOAT16_RGBA, PF_FLOAT16_RGB, PF_FLOAT16_GR, PF_FLOAT16_R,
+                                   PF_A8R8G8B8,     PF_A8B8G8R8,   PF_B8G8R8A8,   PF_R8G8B8A8,
+                                   PF_R8G8B8,       PF_B8G8R8,     PF_L8,         PF_R8G8};
+
+    for(auto srcFormat : formats)
+    {
+        std::vector<uint8> srcData(PixelUtil::getMemorySize(width, height, depth, srcFormat));
+        PixelBox src(width, height, depth, srcFormat, srcData.data());
+        PixelUtil::bulkPixelConversion(floatBox, src);
+
+        for(auto dstFormat : formats)
+        {
+            if(srcFormat == dstFormat)
+                continue;
+            // unpackColour leaves missing channels of byte formats undefined
+            if(srcFormat == PF_R8G8 && PixelUtil::getComponentType(dstFormat) != PCT_BYTE)
+                continue;
+
+            size_t dstSize = PixelUtil::getMemorySize(width, height, depth, dstFormat);
+            std::vector<uint8> dst1(dstSize + 2, 0x56), dst2(dstSize, 0);
+            PixelBox dstBox1(width, height, depth, dstFormat, dst1.data());
+            PixelBox dstBox2(width, height, depth, dstFormat, dst2.data());
+
+            PixelUtil::bulkPixelConversion(src, dstBox1);
+            naiveBulkPixelConversion(src, dstBox2);
+
+            EXPECT_EQ(dst1[dstSize], 0x56);
+            EXPECT_EQ(dst1[dstSize + 1], 0x56);
+            EXPECT_TRUE(memcmp(dst1.data(), dst2.data(), dstSize) == 0)
+                << "Conversion mismatch [" << PixelUtil::getFormatName(srcFormat) << "->"
+                << PixelUtil::getFormatName(dstFormat) << "]";
+        }
+    }
+
+    // sub boxes respect the row and slice pitches
+    std::vector<uint8> dst1(width * height * depth * 4, 0), dst2(width * height * depth * 4, 0);
+    Box def(1, 1, 1, width - 2, height - 1, depth);
+    PixelUtil::bulkPixelConversion(floatBox.getSubVolume(def),
+                                   PixelBox(width, height, depth, PF_A8B8G8R8, dst1.data()).getSubVolume(def));
+    naiveBulkPixelConversion(floatBox.getSubVolume(def),
+                             PixelBox(width, height, depth, PF_A8B8G8R8, dst2.data()).getSubVolume(def));
+    EXPECT_TRUE(dst1 == dst2);
+}
+//--------------------------------------------------------------------------
 
@@ -29,8 +29,11 @@ THE SOFTWARE.
 #include "Threading/OgreThreadHeaders.h"
 #include "OgreCommon.h"
 #include "OgreConfigFile.h"
+#include "OgreDeflate.h"
 #include "OgreFileSystemLayer.h"
 
+#include <thread>
+
 using namespace Ogre;
 
 static String fileId(const String& path) {
@@ -250,3 +253,222 @@ TEST_F(ZipArchiveTests,ReadInterleave)
     EXPECT_TRUE(stream2->eof());
 }
 //--------------------------------------------------------------------------
+static void writeLE(std::vector<uint8>& out, uint32 val, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out.push_back(uint8(val >> (8 * i)));
+}
+typedef std::vector<std::pair<String, std::vector<uint8>>> ZipEntries;
+/// zip archive holding deflated entries
+static std::vector<uint8> makeZip(const ZipEntries& entries)
+{
+    struct Written
+    {
+        uint32 crc;
+        uint32 compressedSize;
+        uint32 offset;
+    };
+    std::vector<Written> written;
+
+    std::vector<uint8> zip;
+    auto writeHeader = [&](uint32 signature, const String& name, size_t size, const Written& w, bool central) {
+        writeLE(zip, signature, 4);
+        if (central)
+            writeLE(zip, 20, 2); // version made by
+        writeLE(zip, 20, 2);     // version needed
+        writeLE(zip, 0, 2);      // flags
+        writeLE(zip, 8, 2);      // deflated
+        writeLE(zip, 0, 4);      // time, date
+        writeLE(zip, w.crc, 4);
+        writeLE(zip, w.compressedSize, 4);
+        writeLE(zip, uint32(size), 4);
+        writeLE(zip, uint32(name.size()), 2);
+        writeLE(zip, 0, 2); // extra
+        if (central)
+        {
+            writeLE(zip, 0, 2); // comment
+            writeLE(zip, 0, 4); // disk, internal attributes
+            writeLE(zip, 0, 4); // external attributes
+            writeLE(zip, w.offset, 4);
+        }
+        zip.insert(zip.end(), name.begin(), name.end());
+    };
+
+    for (const auto& e : entries)
+    {
+        const std::vector<uint8>& data = e.second;
+        uint32 crc = ~0u;
+        for (uint8 b : data)
+        {
+            crc ^= b;
+            for (int k = 0; k < 8; k++)
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+
+        // compressed at the default level, so the entry has Huffman coded blocks with back-references
+        auto compressed = std::make_shared<MemoryDataStream>(data.size() + 1024);
+        DeflateStream deflate(e.first, compressed, DeflateStream::Deflate);
+        deflate.write(data.data(), data.size());
+        deflate.close();
+
+        Written w = {~crc, uint32(compressed->tell()), uint32(zip.size())};
+        writeHeader(0x04034b50, e.first, data.size(), w, false);
+        zip.insert(zip.end(), compressed->getPtr(), compressed->getPtr() + compressed->tell());
+        written.push_back(w);
+    }
+
+    uint32 centralOffset = uint32(zip.size());
+    for (size_t i = 0; i < entries.size(); i++)
+        writeHeader(0x02014b50, entries[i].first, entries[i].second.size(), written[i], true);
+    uint32 centralSize = uint32(zip.size()) - centralOffset;
+    writeLE(zip, 0x06054b50, 4);
+    writeLE(zip, 0, 4); // disk numbers
+    writeLE(zip, uint32(entries.size()), 2);
+    writeLE(zip, uint32(entries.size()), 2);
+    writeLE(zip, centralSize, 4);
+    writeLE(zip, centralOffset, 4);
+    writeLE(zip, 0, 2); // comment
+    return zip;
+}
+//--------------------------------------------------------------------------
+TEST(ZipArchive,StreamedRead)
+{
+    // large enough for several seek points and many inflate windows
+    std::vector<uint32> words(3 * 1024 * 1024);
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] = uint32(i);
+    std::vector<uint8> data((uint8*)words.data(), (uint8*)(words.data() + words.size()));
+    std::vector<uint8> zip = makeZip({{"large.bin", data}});
+    ASSERT_LT(zip.size(), data.size() / 2);
+
+    EmbeddedZipArchiveFactory factory;
+    EmbeddedZipArchiveFactory::addEmbbeddedFile("StreamedRead.zip", zip.data(), zip.size(), NULL);
+    Archive* arch = factory.createInstance("StreamedRead.zip", true);
+    arch->load();
+
+    size_t threshold = ZipArchiveFactory::getStreamingThreshold();
+    ZipArchiveFactory::setStreamingThreshold(1024 * 1024);
+    DataStreamPtr stream = arch->open("large.bin");
+    ASSERT_TRUE(stream);
+    ASSERT_EQ(data.size(), stream->size());
+    // inflated in chunks, not into memory
+    EXPECT_FALSE(dynamic_cast<MemoryDataStream*>(stream.get()));
+
+    std::vector<uint8> buf(data.size());
+    EXPECT_EQ(data.size(), stream->read(buf.data(), buf.size()));
+    EXPECT_TRUE(buf == data);
+    EXPECT_TRUE(stream->eof());
+
+    // backwards and forwards across seek points
+    for (size_t word : {2500000, 300000, 0, 2600000, 1048575, 3 * 1024 * 1024 - 10})
+    {
+        stream->seek(word * 4);
+        uint32 val[10];
+        size_t count = std::min<size_t>(10, words.size() - word);
+        EXPECT_EQ(count * 4, stream->read(val, sizeof(val)));
+        for (size_t i = 0; i < count; i++)
+            EXPECT_EQ(word + i, val[i]);
+    }
+
+    // skipping back past the start clamps to it
+    stream->seek(100);
+    stream->skip(-1000);
+    EXPECT_EQ(0u, stream->tell());
+
+    // below the threshold the entry is inflated into memory at once and returns the same data
+    ZipArchiveFactory::setStreamingThreshold(data.size() + 1);
+    DataStreamPtr inflated = arch->open("large.bin");
+    ZipArchiveFactory::setStreamingThreshold(threshold);
+    EXPECT_TRUE(dynamic_cast<MemoryDataStream*>(inflated.get()));
+    EXPECT_EQ(String((char*)data.data(), data.size()), inflated->getAsString());
+
+    stream.reset();
+    inflated.reset();
+    factory.destroyInstance(arch);
+    EmbeddedZipArchiveFactory::removeEmbbeddedFile("StreamedRead.zip");
+}
+//--------------------------------------------------------------------------
+TEST(ZipArchive,EntryCache)
+{
+    ZipEntries entries;
+    for (const char* name : {"a.bin", "b.bin", "c.bin"})
+    {
+        std::vector<uint8> data(64 * 1024);
+        for (size_t i = 0; i < data.size(); i++)
+            data[i] = uint8(i * name[0]);
+        entries.emplace_back(name, data);
+    }
+    std::vector<uint8> zip = makeZip(entries);
+
+    EmbeddedZipArchiveFactory factory;
+    EmbeddedZipArchiveFactory::addEmbbeddedFile("EntryCache.zip", zip.data(), zip.size(), NULL);
+    Archive* arch = factory.createInstance("EntryCache.zip", true);
+    arch->load();
+
+    // room for two of the entries
+    size_t budget = ZipArchiveFactory::getEntryCacheBudget();
+    ZipArchiveFactory::setEntryCacheBudget(2 * 64 * 1024);
+
+    // a cached entry is not inflated again, but shares the memory. The streams are kept,
+    // so a new inflation can not end up at the address of an old one
+    std::vector<DataStreamPtr> streams;
+    auto open = [&](const String& name) {
+        DataStreamPtr stream = arch->open(name);
+        streams.push_back(stream);
+        return static_cast<MemoryDataStream*>(stream.get())->getPtr();
+    };
+    uchar* a = open("a.bin");
+    uchar* b = open("b.bin");
+    EXPECT_EQ(a, open("a.bin"));
+    EXPECT_EQ(b, open("b.bin"));
+    EXPECT_EQ(String((char*)entries[0].second.data(), 64 * 1024), streams[2]->getAsString());
+
+    // c evicts the least recently used a
+    uchar* c = open("c.bin");
+    EXPECT_EQ(c, open("c.bin"));
+    EXPECT_EQ(b, open("b.bin"));
+    uchar* a2 = open("a.bin");
+    EXPECT_NE(a, a2);
+    EXPECT_EQ(String((char*)entries[0].second.data(), 64 * 1024), streams.back()->getAsString());
+
+    // and is cached again, evicting c now
+    EXPECT_EQ(a2, open("a.bin"));
+    EXPECT_EQ(b, open("b.bin"));
+    EXPECT_NE(c, open("c.bin"));
+
+    // other spellings of the name share the cached entry, unless names are case sensitive
+    if (!arch->isCaseSensitive())
+        EXPECT_EQ(b, open("B.BIN"));
+
+    // writable streams are not shared with the cache
+    EXPECT_NE(b, static_cast<MemoryDataStream*>(arch->open("b.bin", false).get())->getPtr());
+
+    ZipArchiveFactory::setEntryCacheBudget(budget);
+    streams.clear();
+    factory.destroyInstance(arch);
+    EmbeddedZipArchiveFactory::removeEmbbeddedFile("EntryCache.zip");
+}
+//--------------------------------------------------------------------------
+TEST_F(ZipArchiveTests,ConcurrentRead)
+{
+    String expected1 = arch->open("rootfile.txt")->getAsString();
+    String expected2 = arch->open("rootfile2.txt")->getAsString();
+
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 100; i++)
+            {
+                if (arch->open("rootfile.txt")->getAsString() != expected1 ||
+                    arch->open("rootfile2.txt")->getAsString() != expected2)
+                    failures++;
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    EXPECT_EQ(0, failures);
+}
@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "Ogre.h"
 #include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMeshOptimizer.h"
 #include "OgreMeshLodGenerator.h"
 #include "OgreDistanceLodStrategy.h"
 #include "OgreLodStrategyManager.h"
@@ -50,7 +51,13 @@ R"HELP(Usage: OgreMeshUpgrader [opts] sourcefile [destfile]
   Upgrades or downgrades .mesh file versions.
 
 -pack          = Pack normals and tangents as int_10_10_10_2
+-quantise      = -pack and store 2D texture coordinates as ushort2_norm, if in 0..1.
+                 Also quantises positions to 16 bit, if writing a flat mesh
+-compress      = Delta code vertex and index streams, if writing a flat mesh
 -optvtxcache   = Reorder the indexes to optimise vertex cache utilisation
+-optvtxfetch   = Reorder the vertices in the order they are first used
+-optoverdraw   = Additionally sort triangle clusters to reduce overdraw
+-meshlets      = Group the triangles into meshlets for cluster culling
 -autogen       = Generate autoconfigured LOD. No LOD options needed
 -l lodlevels   = number of LOD levels
 -d loddist     = distance increment to reduce LOD
@@ -65,7 +72,8 @@ R"HELP(Usage: OgreMeshUpgrader [opts] sourcefile [destfile]
 -E endian      = Set endian mode 'big' 'little' or 'native' (default)
 -b             = Recalculate bounding box (static meshes only)
 -V version     = Specify OGRE version format to write instead of latest
-                 Options are: 1.10, 1.8, 1.7, 1.4, 1.0
+                 Options are: 14.2, 1.10, 1.8, 1.7, 1.4, 1.0
+                 'flat' writes the zero-parse format for static meshes
 -log filename  = name of the log file (default: 'OgreMeshUpgrader.log')
 sourcefile     = name of file to convert
 destfile       = optional name of file to write to. If you don't
@@ -82,7 +90,12 @@ struct UpgradeOptions {
     bool dontReorganise;
     bool lodAutoconfigure;
     bool packNormalsTangents;
+    bool quantise;
+    bool compress;
     bool optimiseVertexCache;
+    bool optimiseVertexFetch;
+    bool optimiseOverdraw;
+    bool meshlets;
     unsigned short numLods;
     Real lodDist;
     Real lodPercent;
@@ -125,7 +138,12 @@ UpgradeOptions parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.lodAutoconfigure = unOpts["-autogen"];
     opts.dontReorganise = unOpts["-r"];
     opts.packNormalsTangents = unOpts["-pack"];
+    opts.quantise = unOpts["-quantise"];
+    opts.compress = unOpts["-compress"];
     opts.optimiseVertexCache = unOpts["-optvtxcache"];
+    opts.optimiseVertexFetch = unOpts["-optvtxfetch"];
+    opts.optimiseOverdraw = unOpts["-optoverdraw"];
+    opts.meshlets = unOpts["-meshlets"];
 
     // Unary options (true/false options that don't take a parameter)
     if (unOpts["-b"]) {
@@ -180,7 +198,9 @@ UpgradeOptions parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
 
     bi = binOpts.find("-V");
     if (!bi->second.empty()) {
-        if (bi->second == "1.10") {
+        if (bi->second == "14.2") {
+            opts.targetVersion = MESH_VERSION_14_2;
+        } else if (bi->second == "1.10") {
             opts.targetVersion = MESH_VERSION_1_10;
         } else if (bi->second == "1.8") {
             opts.targetVersion = MESH_VERSION_1_8;
@@ -190,6 +210,8 @@ UpgradeOptions parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
             opts.targetVersion = MESH_VERSION_1_4;
         } else if (bi->second == "1.0") {
             opts.targetVersion = MESH_VERSION_1_0;
+        } else if (bi->second == "flat") {
+            opts.targetVersion = MESH_VERSION_FLAT;
         } else {
             LogManager::getSingleton().logError("Unrecognised target mesh version '" + bi->second + "'");
         }
@@ -450,8 +472,13 @@ int main(int numargs, char** args)
         unOptList["-r"] = false;
         unOptList["-autogen"] = false;
         unOptList["-pack"] = false;
+        unOptList["-quantise"] = false;
+        unOptList["-compress"] = false;
         unOptList["-b"] = false;
         unOptList["-optvtxcache"] = false;
+        unOptList["-optvtxfetch"] = false;
+        unOptList["-optoverdraw"] = false;
+        unOptList["-meshlets"] = false;
         binOptList["-l"] = "";
         binOptList["-d"] = "";
         binOptList["-p"] = "";
@@ -553,35 +580,54 @@ int main(int numargs, char** args)
             }
         }
 
-        if(opts.packNormalsTangents)
+        if(opts.packNormalsTangents || opts.quantise)
         {
             mesh->_convertVertexElement(VES_NORMAL, VET_INT_10_10_10_2_NORM);
             mesh->_convertVertexElement(VES_TANGENT, VET_INT_10_10_10_2_NORM);
         }
 
+        if(opts.quantise)
+        {
+            mesh->_convertVertexElement(VES_TEXTURE_COORDINATES, VET_USHORT2_NORM);
+        }
+
+        uint32 encoding = MeshSerializer::EF_NONE;
+        if(opts.quantise)
+            encoding |= MeshSerializer::EF_QUANTISE_POSITIONS;
+        if(opts.compress)
+            encoding |= MeshSerializer::EF_COMPRESS_STREAMS;
+        if(opts.quantise && opts.targetVersion != MESH_VERSION_FLAT)
+            logMgr.logWarning("-quantise keeps the positions as float, unless writing '-V flat'");
+        if(opts.compress && opts.targetVersion != MESH_VERSION_FLAT)
+            logMgr.logWarning("-compress requires '-V flat'");
+        meshSerializer.setEncodingFlags(encoding);
+
         if (opts.recalcBounds) {
             recalcBounds(mesh);
         }
 
-        if(opts.optimiseVertexCache)
+        if(opts.meshlets && opts.targetVersion != MESH_VERSION_LATEST && opts.targetVersion != MESH_VERSION_14_2)
+            logMgr.logWarning("meshlets are only stored by '-V 14.2'");
+
+        if(opts.optimiseVertexCache || opts.optimiseVertexFetch || opts.optimiseOverdraw || opts.meshlets)
         {
             logMgr.logMessage("Vertex cache optimization...");
-            VertexCacheProfiler vcp;
-            VertexCacheProfiler vcpnew;
-
-            for (auto s : mesh->getSubMeshes())
-            {
-                if(!s->indexData->indexBuffer)
-                    continue;
-                vcp.profile(s->indexData->indexBuffer);
-                s->indexData->optimiseVertexCacheTriList();
-                vcpnew.profile(s->indexData->indexBuffer);
-                vcp.flush();
-                vcpnew.flush();
-            }
+            uint32 passes = 0;
+            if(opts.optimiseVertexCache || opts.optimiseOverdraw || opts.meshlets)
+                passes |= MeshOptimizer::MO_VERTEX_CACHE;
+            if(opts.optimiseVertexFetch)
+                passes |= MeshOptimizer::MO_VERTEX_FETCH;
+            if(opts.optimiseOverdraw)
+                passes |= MeshOptimizer::MO_OVERDRAW;
+            if(opts.meshlets)
+                passes |= MeshOptimizer::MO_MESHLETS;
+
+            MeshOptimizer optimizer(passes);
+            optimizer.optimise(mesh);
 
             logMgr.logMessage(StringUtil::format("Vertex cache optimization: ACMR change %.2f -> %.2f",
-                                                 vcp.getAvgCacheMissRatio(), vcpnew.getAvgCacheMissRatio()));
+                                                 optimizer.getAvgCacheMissRatioBefore(),
+                                                 optimizer.getAvgCacheMissRatioAfter()));
         }
 
         meshSerializer.exportMesh(mesh, dest, opts.targetVersion, opts.endian);